@@ -1,7 +1,50 @@
 # api/src/spirographicals/objects.py
 
+import array
+
 from . import spirographicals as _internal
 
+try:
+    import numpy as _np
+except ImportError:
+    _np = None
+
+
+def _pack_points(x, y):
+    """
+    Interleaves x and y into one float32 buffer of [x0, y0, x1, y1, ...].
+
+    The native layer reads such buffers in place, so plotting never creates a Python
+    object per sample. NumPy input is converted in bulk when NumPy is available.
+    """
+    if _np is not None:
+        x, y = _np.asarray(x), _np.asarray(y)
+        if x.shape != y.shape or x.ndim != 1:
+            raise ValueError(f"x and y must be 1-D and the same length, got {x.shape} and {y.shape}")
+        xy = _np.empty((len(x), 2), dtype=_np.float32)
+        xy[:, 0] = x
+        xy[:, 1] = y
+        return xy
+
+    xs, ys = array.array("f", x), array.array("f", y)
+    if len(xs) != len(ys):
+        raise ValueError(f"x and y must be the same length, got {len(xs)} and {len(ys)}")
+    xy = array.array("f", [0.0]) * (2 * len(xs))
+    xy[0::2] = xs
+    xy[1::2] = ys
+    return xy
+
+
+# Matplotlib marker codes understood by Axes.scatter.
+_MARKERS = {
+    'o': 'Circle',
+    's': 'Square',
+    '^': 'Triangle',
+    'x': 'Cross',
+    '+': 'Plus',
+}
+
+
 class Figure:
     """
     The top-level container for all the plot elements.
@@ -20,17 +63,16 @@ class Figure:
         self.axes.append(ax)
         return ax
 
-    def show(self):
+    def _to_rust_figure(self, dpi=None):
         """
-        Triggers the backend rendering pipeline by converting the Python object
-        model into Rust data structures and calling the native render function.
+        Converts the Python object model into the Rust data structures
+        consumed by the native render functions.
         """
-        if not _internal:
-            raise RuntimeError("Spirographicals core extension not loaded.")
+        dpi = self.dpi if dpi is None else dpi
 
         # 1. Create the top-level Rust Figure object from our Python data.
         rust_figure = _internal.Figure()
-        rust_figure.size_pixels = (int(self.figsize[0] * self.dpi), int(self.figsize[1] * self.dpi))
+        rust_figure.size_pixels = (int(self.figsize[0] * dpi), int(self.figsize[1] * dpi))
         rust_figure.face_color = _internal.Color.from_hex(self.face_color_hex)
         
         # 2. Convert each Python Axes object into a Rust PlotAxes object.
@@ -44,27 +86,52 @@ class Figure:
             # 3. Convert each Python plot command into a Rust Artist object.
             for command in ax._plot_commands:
                 if command["type"] == "line":
-                    points = [_internal.Vec2(p[0], p[1]) for p in zip(command["x"], command["y"])]
                     color = _internal.Color.from_hex(command["color"])
                     
                     line_artist = _internal.LineArtist(
-                        points=points,
+                        points=command["points"],
                         color=color,
                         linewidth=command["linewidth"],
                         style=_internal.LineStyle.Solid
                     )
                     rust_axes.add_artist(line_artist)
+                elif command["type"] == "scatter":
+                    scatter_artist = _internal.ScatterArtist(
+                        points=command["points"],
+                        color=_internal.Color.from_hex(command["color"]),
+                        size=command["size"],
+                        marker=getattr(_internal.MarkerStyle, _MARKERS[command["marker"]])
+                    )
+                    rust_axes.add_artist(scatter_artist)
             
             rust_figure.add_axes(rust_axes)
 
-        # 4. Call the main render function in the Rust backend.
+        return rust_figure
+
+    def show(self):
+        """
+        Triggers the backend rendering pipeline by converting the Python object
+        model into Rust data structures and calling the native render function.
+        """
+        if not _internal:
+            raise RuntimeError("Spirographicals core extension not loaded.")
+
+        # Call the main render function in the Rust backend.
         # This will open the window and start the render loop.
-        _internal.render_figure(rust_figure)
+        _internal.render_figure(self._to_rust_figure())
 
     def savefig(self, path, dpi=None):
-        """Saves the current figure to a file."""
-        print(f"Figure.savefig() -> Not yet implemented. Would save to '{path}'")
-        pass
+        """
+        Renders the figure into an offscreen canvas and saves it to a file.
+
+        No window or display server is needed. Paths ending in '.raw' or
+        '.rgba' receive the top-down RGBA8 pixels as-is; anything else is
+        written as PNG.
+        """
+        if not _internal:
+            raise RuntimeError("Spirographicals core extension not loaded.")
+
+        _internal.save_figure(self._to_rust_figure(dpi), str(path))
 
 
 class Axes:
@@ -75,17 +142,40 @@ class Axes:
         self._title = {}
 
     def plot(self, x, y, color='#00FFFF', linewidth=1.5, label=None):
-        """Plot y versus x as lines."""
+        """
+        Plot y versus x as lines.
+
+        x and y may be any sequences of numbers; NumPy arrays are copied once into a packed
+        float32 buffer instead of point by point.
+        """
         self._plot_commands.append({
             "type": "line",
-            "x": list(x),
-            "y": list(y),
+            "points": _pack_points(x, y),
             "color": color,
             "linewidth": linewidth,
             "label": label
         })
         return self
     
+    def scatter(self, x, y, color='#00FFFF', size=6.0, marker='o', label=None):
+        """
+        Plot y versus x as markers.
+
+        size is the marker width in pixels. marker is one of 'o', 's', '^', 'x' or '+'.
+        Every point becomes one instance of a single GPU draw, so millions of points are fine.
+        """
+        if marker not in _MARKERS:
+            raise ValueError(f"Unknown marker {marker!r}; expected one of {', '.join(_MARKERS)}")
+        self._plot_commands.append({
+            "type": "scatter",
+            "points": _pack_points(x, y),
+            "color": color,
+            "size": float(size),
+            "marker": marker,
+            "label": label
+        })
+        return self
+
     def set_title(self, title, color='white'):
         """Sets the title for the axes."""
         self._title = {"text": title, "color": color}
@@ -74,6 +74,18 @@ def plot(*args, **kwargs):
     if ax:
         ax.plot(*args, **kwargs)
 
+def scatter(x, y, **kwargs):
+    """
+    Plot y versus x as markers on the active axes.
+
+    Args:
+        x, y: Sequences or arrays of marker positions.
+        **kwargs: Keyword arguments to be passed to the Axes.scatter() method.
+    """
+    ax = _get_active_axes()
+    if ax:
+        ax.scatter(x, y, **kwargs)
+
 def title(label, **kwargs):
     """
     Set a title for the current axes.
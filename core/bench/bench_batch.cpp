@@ -0,0 +1,784 @@
+#include <benchmark/benchmark.h>
+#include <spirographicals/spirographicals.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// What a segment uploaded before the indexed batcher: 6 vertices of {vec2, vec4, vec2, float}.
+// For comparison only; the current figure is measured.
+constexpr double LEGACY_BYTES_PER_SEGMENT = 6 * 36;
+
+void BM_StrokeTimeSeries(benchmark::State& state)
+{
+    // Sine wave across the canvas. Sorted in x, past 4 samples per column the core decimates it;
+    // swept back and forth 20 times instead, every segment is stroked and uploaded.
+    const int segments = (int)state.range(0);
+    const bool sorted = state.range(1) != 0;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_pen_config_t pen_config = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 10.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &pen_config);
+    sp_set_pen(canvas, pen);
+
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_move_to(path, sorted ? 0.0f : 960.0f, 540.0f);
+    for (int i = 1; i <= segments; ++i) {
+        const float x = sorted ? (float)(1920.0 * i / segments) : (float)(960.0 + 900.0 * std::sin(20.0 * 6.283185307 * i / segments));
+        sp_path_line_to(path, x, 540.0f + 400.0f * std::sin(i * 0.001f));
+    }
+
+    uint64_t uploadBytes = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_stroke_path(canvas, path);
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) uploadBytes += stats.upload_bytes;
+    }
+
+    state.SetItemsProcessed(state.iterations() * segments);
+    state.SetBytesProcessed((int64_t)uploadBytes);
+    state.counters["bytes_per_segment"] = (double)uploadBytes / ((double)state.iterations() * segments);
+    state.counters["legacy_bytes_per_segment"] = LEGACY_BYTES_PER_SEGMENT;
+
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_SoftwareSpirograph(benchmark::State& state)
+{
+    // A hypotrochoid is not x-sorted, so all of its segments reach the rasterizer undecimated.
+    const int segments = (int)state.range(0), threads = (int)state.range(1);
+    std::vector<uint8_t> pixels((size_t)1920 * 1080 * 4);
+    sp_software_config_t config = {1920, 1080, pixels.data(), 0, threads};
+    sp_canvas_t* canvas = sp_create_software_canvas(&config);
+    if (!canvas) {
+        state.SkipWithError("Software canvas creation failed");
+        return;
+    }
+    sp_pen_config_t pen_config = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 10.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &pen_config);
+    sp_set_pen(canvas, pen);
+
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_move_to(path, 960.0f + 300.0f + 200.0f, 540.0f);
+    for (int i = 1; i <= segments; ++i) {
+        const double t = i * 0.002;
+        sp_path_line_to(path, (float)(960.0 + 300.0 * std::cos(t) + 200.0 * std::cos(t * 7.3)),
+                        (float)(540.0 + 300.0 * std::sin(t) - 200.0 * std::sin(t * 7.3)));
+    }
+
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_set_color(canvas, {0.1f, 0.2f, 0.8f, 0.5f});
+        sp_stroke_path(canvas, path);
+        sp_end_frame(canvas);
+    }
+
+    state.SetItemsProcessed(state.iterations() * segments);
+    state.counters["fps"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["threads"] = threads;
+
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_destroy_canvas(canvas);
+}
+
+void BM_LiveSeries(benchmark::State& state)
+{
+    // A scrolling 100k-sample window gaining 500 samples a frame, redrawn either by rebuilding a
+    // path over the window (0) or by appending to a series (1).
+    const bool streamed = state.range(0) != 0;
+    const size_t window = 20000, perFrame = 500;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_pen_config_t pen_config = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 10.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &pen_config);
+    sp_set_pen(canvas, pen);
+    sp_set_color(canvas, {0.1f, 0.2f, 0.8f, 1.0f});
+    sp_path_t* path = sp_create_path(canvas);
+    sp_series_t* series = sp_create_series(canvas, window);
+
+    std::vector<float> xy;
+    std::vector<float> xs(perFrame), ys(perFrame);
+    size_t total = 0;
+    auto generate = [&](size_t n) {
+        for (size_t i = 0; i < n; ++i, ++total) {
+            xs[i] = total * (1920.0f / window);
+            ys[i] = 540.0f + 400.0f * std::sin(total * 0.001f) + 40.0f * std::sin(total * 0.37f);
+        }
+        if (streamed) sp_series_append(series, xs.data(), ys.data(), n);
+        else for (size_t i = 0; i < n; ++i) { xy.push_back(xs[i]); xy.push_back(ys[i]); }
+    };
+    for (size_t i = 0; i < window; i += perFrame) generate(perFrame);
+
+    uint64_t uploadBytes = 0;
+    double strokeMs = 0.0;
+    // The first frame tessellates the whole window either way; only the frames after it count.
+    for (int frame = -1; frame == -1 || state.KeepRunning(); ++frame) {
+        generate(perFrame);
+        if (!streamed) xy.erase(xy.begin(), xy.begin() + 2 * perFrame);
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_save_state(canvas);
+        sp_translate(canvas, -(float)(total - window) * (1920.0f / window), 0.0f);
+        if (streamed) sp_draw_series(canvas, series);
+        else {
+            sp_path_set_points(path, xy.data(), xy.size() / 2, 0);
+            sp_stroke_path(canvas, path);
+        }
+        sp_restore_state(canvas);
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (frame >= 0 && sp_get_frame_stats(canvas, &stats)) { uploadBytes += stats.upload_bytes; strokeMs += stats.stroke_ms; }
+    }
+
+    state.SetItemsProcessed(state.iterations() * perFrame);
+    state.counters["upload_bytes_per_frame"] = benchmark::Counter((double)uploadBytes / state.iterations());
+    state.counters["stroke_ms_per_frame"] = benchmark::Counter(strokeMs / state.iterations());
+
+    sp_destroy_series(series);
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_FillPolygons(benchmark::State& state)
+{
+    // Either one area plot under a 100k-sample series (0), which is too large to triangulate on
+    // the CPU and goes through the stencil, or 10k small glyph-sized polygons (1), alternating
+    // convex hexagons and concave stars, which are triangulated into the batch.
+    const bool small = state.range(0) != 0;
+    const size_t samples = 100000, polygons = 10000;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_path_t* path = sp_create_path(canvas);
+    std::vector<float> xy;
+    std::vector<size_t> starts;
+    if (small) {
+        for (size_t i = 0; i < polygons; ++i) {
+            const float cx = 10.0f + (float)(i % 100) * 19.0f, cy = 10.0f + (float)(i / 100) * 10.5f;
+            const int corners = i % 2 ? 10 : 6;
+            starts.push_back(xy.size() / 2);
+            for (int k = 0; k < corners; ++k) {
+                const float angle = k * 6.2831853f / corners, r = (i % 2 && k % 2) ? 2.0f : 5.0f;
+                xy.push_back(cx + r * std::cos(angle));
+                xy.push_back(cy + r * std::sin(angle));
+            }
+        }
+    } else {
+        starts.push_back(0);
+        for (size_t i = 0; i < samples; ++i) {
+            xy.push_back(1920.0f * i / (samples - 1));
+            xy.push_back(540.0f + 300.0f * std::sin(i * 0.0002f) + 60.0f * std::sin(i * 0.37f));
+        }
+        xy.insert(xy.end(), {1920.0f, 1000.0f, 0.0f, 1000.0f});
+    }
+    starts.push_back(xy.size() / 2);
+
+    uint64_t drawCalls = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_set_color(canvas, {0.1f, 0.4f, 0.8f, 0.6f});
+        for (size_t i = 0; i + 1 < starts.size(); ++i) {
+            sp_path_set_points(path, &xy[starts[i] * 2], starts[i + 1] - starts[i], 0);
+            sp_fill_path(canvas, path);
+        }
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) drawCalls += stats.draw_calls;
+    }
+
+    state.SetItemsProcessed(state.iterations() * (int64_t)(starts.size() - 1));
+    state.counters["vertices"] = (double)(xy.size() / 2);
+    state.counters["draw_calls_per_frame"] = benchmark::Counter((double)drawCalls / state.iterations());
+
+    sp_destroy_path(path);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_CurveSpirograph(benchmark::State& state)
+{
+    // A hypotrochoid as 100 cubic Beziers (Hermite segments through the exact curve), drawn
+    // zoomed in by range(0) about the canvas center. Flattening follows the zoom, so the
+    // vertices counter grows with it; the flattened points are cached between frames.
+    const float zoom = (float)state.range(0);
+    const int curves = 100;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_pen_config_t pen_config = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 10.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &pen_config);
+    sp_path_t* path = sp_create_path(canvas);
+    const float R = 5.0f, r = 3.0f, d = 5.0f, scale = 40.0f, turns = 6.2831853f * 3.0f;
+    auto at = [&](float t) { return sp_vec2_t{scale * ((R - r) * std::cos(t) + d * std::cos((R - r) / r * t)), scale * ((R - r) * std::sin(t) - d * std::sin((R - r) / r * t))}; };
+    auto tangent = [&](float t) { return sp_vec2_t{scale * (-(R - r) * std::sin(t) - d * (R - r) / r * std::sin((R - r) / r * t)), scale * ((R - r) * std::cos(t) - d * (R - r) / r * std::cos((R - r) / r * t))}; };
+    const float dt = turns / curves;
+    sp_path_move_to(path, at(0).x, at(0).y);
+    for (int i = 0; i < curves; ++i) {
+        const float t0 = i * dt, t1 = t0 + dt;
+        const sp_vec2_t p0 = at(t0), p1 = at(t1), v0 = tangent(t0), v1 = tangent(t1);
+        sp_path_cubic_bezier_to(path, p0.x + v0.x * dt / 3, p0.y + v0.y * dt / 3, p1.x - v1.x * dt / 3, p1.y - v1.y * dt / 3, p1.x, p1.y);
+    }
+
+    uint64_t vertices = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_set_pen(canvas, pen);
+        sp_set_color(canvas, {0.1f, 0.2f, 0.8f, 1.0f});
+        sp_translate(canvas, 960.0f, 540.0f);
+        sp_scale(canvas, zoom, zoom);
+        sp_stroke_path(canvas, path);
+        sp_reset_transform(canvas);
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) vertices += stats.vertices;
+    }
+
+    state.SetItemsProcessed(state.iterations() * curves);
+    state.counters["vertices_per_frame"] = benchmark::Counter((double)vertices / state.iterations());
+
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_IconScatter(benchmark::State& state)
+{
+    // Scatter markers drawn from `images` distinct 32x32 icons, 10k per frame. The draw_calls
+    // counter is what the 16 texture slots used to cost once every icon had its own texture.
+    const int images = (int)state.range(0), icons = 10000;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    sp_offscreen_config_t icon_config = {32, 32, 1};
+    sp_canvas_t* icon_canvas = canvas ? sp_create_offscreen_canvas(&icon_config) : nullptr;
+    if (!icon_canvas) {
+        if (canvas) sp_destroy_canvas(canvas);
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    std::vector<sp_image_t*> loaded;
+    for (int i = 0; i < images; ++i) {
+        const std::string path = "spiro_bench_icon_" + std::to_string(i) + ".png";
+        sp_begin_frame(icon_canvas);
+        sp_clear(icon_canvas, {(float)(i % 7) / 6.0f, (float)(i % 5) / 4.0f, 1.0f, 1.0f});
+        sp_end_frame(icon_canvas);
+        sp_save_png(icon_canvas, path.c_str());
+        loaded.push_back(sp_load_image(canvas, path.c_str()));
+        std::remove(path.c_str());
+    }
+    sp_destroy_canvas(icon_canvas);
+
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        // Cycling through the icons is the worst order for a small slot table.
+        for (int i = 0; i < icons; ++i)
+            sp_draw_image(canvas, loaded[i % images], (float)(i * 37 % 1900), (float)(i * 53 % 1060));
+        sp_end_frame(canvas);
+    }
+
+    sp_frame_stats_t stats;
+    if (sp_get_frame_stats(canvas, &stats)) state.counters["draw_calls"] = stats.draw_calls;
+    state.SetItemsProcessed(state.iterations() * icons);
+    for (sp_image_t* image : loaded) sp_destroy_image(image);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_ScatterMarkers(benchmark::State& state)
+{
+    // A million-point scatter plot of 6 px circles, either as instanced markers (1) or as the
+    // tessellated fans sp_fill_circle draws (0).
+    const int points = (int)state.range(0);
+    const bool instanced = state.range(1) != 0;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    std::vector<sp_marker_t> markers(points);
+    const uint32_t color = sp_pack_color({0.1f, 0.4f, 0.8f, 0.5f});
+    for (int i = 0; i < points; ++i)
+        markers[i] = {(float)(i * 37 % 1920), 540.0f + 500.0f * std::sin(i * 0.0007f) * std::cos(i * 0.013f), 6.0f, color, SP_MARKER_CIRCLE};
+
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        if (instanced) {
+            sp_draw_markers(canvas, markers.data(), markers.size());
+        } else {
+            sp_set_color(canvas, {0.1f, 0.4f, 0.8f, 0.5f});
+            for (const sp_marker_t& m : markers) sp_fill_circle(canvas, m.x, m.y, m.size / 2);
+        }
+        sp_end_frame(canvas);
+    }
+
+    sp_frame_stats_t stats;
+    if (sp_get_frame_stats(canvas, &stats)) {
+        state.counters["draw_calls"] = stats.draw_calls;
+        state.counters["bytes_per_point"] = (double)stats.upload_bytes / points;
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_FillRects(benchmark::State& state)
+{
+    // The immediate path in isolation: every sp_fill_rect is one Renderer::addQuad, and the
+    // batch flushes whenever it fills or the frame ends. The rects are 2x2 so the rasterizer
+    // stays out of the measurement.
+    const int rects = (int)state.range(0);
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+
+    uint64_t drawCalls = 0, uploadBytes = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_set_color(canvas, {0.8f, 0.3f, 0.1f, 0.5f});
+        for (int i = 0; i < rects; ++i) sp_fill_rect(canvas, (float)(i % 1900), (float)(i / 1900 % 1060), 2.0f, 2.0f);
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) { drawCalls += stats.draw_calls; uploadBytes += stats.upload_bytes; }
+    }
+
+    state.SetItemsProcessed(state.iterations() * rects);
+    state.SetBytesProcessed((int64_t)uploadBytes);
+    state.counters["draw_calls_per_frame"] = benchmark::Counter((double)drawCalls / state.iterations());
+
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_TextLayout(benchmark::State& state)
+{
+    // 2000 axis tick labels a frame, either the same labels every frame (0), which the run
+    // cache serves, or labels that change every frame (1), which are shaped again each time.
+    const bool changing = state.range(0) != 0;
+    const int labels = 2000;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_font_t* font = sp_load_font(canvas, "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+    if (!font) {
+        sp_destroy_canvas(canvas);
+        sp_terminate();
+        state.SkipWithError("DejaVu Sans is not installed");
+        return;
+    }
+    sp_set_font(canvas, font, 12.0f);
+
+    char text[32];
+    int64_t frame = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_set_color(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        for (int i = 0; i < labels; ++i) {
+            std::snprintf(text, sizeof(text), "%.2f", (i + (changing ? frame * labels : 0)) * 0.25);
+            const sp_rect_t bounds = sp_measure_text(canvas, text);
+            sp_draw_text(canvas, text, (float)(i % 20 * 96) + 90.0f - bounds.w, (float)(i / 20 * 10 + 12));
+        }
+        sp_end_frame(canvas);
+        frame++;
+    }
+
+    state.SetItemsProcessed(state.iterations() * labels);
+    sp_destroy_font(font);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_PanelTransforms(benchmark::State& state)
+{
+    // A 16x16 grid of small-multiple panels, each under its own translate and scale: 64 bars
+    // and a 200-sample line per panel. Drawn directly (0), everything is transformed on the CPU
+    // into the batch; as one mesh per panel (1), every panel flushes and sets its transform as
+    // a uniform, the flush-per-transform approach.
+    const bool meshes = state.range(0) != 0;
+    const int grid = 16, bars = 64, samples = 200;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_path_t* line = sp_create_path(canvas);
+    sp_path_move_to(line, 0.0f, 50.0f);
+    for (int i = 1; i < samples; ++i) sp_path_line_to(line, 100.0f * i / samples, 50.0f + 40.0f * std::sin(i * 0.1f));
+    auto drawPanel = [&] {
+        sp_set_color(canvas, {0.6f, 0.7f, 0.9f, 1.0f});
+        for (int b = 0; b < bars; ++b) sp_fill_rect(canvas, b * 100.0f / bars, 100.0f - b, 1.0f, (float)b);
+        sp_set_color(canvas, {0.1f, 0.1f, 0.1f, 1.0f});
+        sp_stroke_path(canvas, line);
+    };
+    std::vector<sp_mesh_t*> panels;
+    for (int p = 0; meshes && p < grid * grid; ++p) {
+        sp_begin_mesh(canvas);
+        drawPanel();
+        panels.push_back(sp_end_mesh(canvas));
+    }
+
+    uint64_t drawCalls = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        for (int p = 0; p < grid * grid; ++p) {
+            sp_save_state(canvas);
+            sp_translate(canvas, (float)(p % grid) * 120.0f, (float)(p / grid) * 67.5f);
+            sp_scale(canvas, 1.1f, 0.6f);
+            if (meshes) sp_draw_mesh(canvas, panels[p]);
+            else drawPanel();
+            sp_restore_state(canvas);
+        }
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) drawCalls += stats.draw_calls;
+    }
+
+    state.SetItemsProcessed(state.iterations() * grid * grid);
+    state.counters["draw_calls_per_frame"] = benchmark::Counter((double)drawCalls / state.iterations());
+    for (sp_mesh_t* mesh : panels) sp_destroy_mesh(mesh);
+    sp_destroy_path(line);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_BlendModes(benchmark::State& state)
+{
+    // 20000 swatches in a grid, each switching to the next of `modes` blend modes. None of
+    // them overlap, so the batch draws once per mode however often the mode changes.
+    const int modes = (int)state.range(0), swatches = 20000;
+    const sp_blend_mode_t cycle[] = {SP_BLEND_MODE_NORMAL, SP_BLEND_MODE_ADD, SP_BLEND_MODE_MULTIPLY, SP_BLEND_MODE_SCREEN};
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+
+    uint64_t drawCalls = 0;
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.5f, 0.5f, 0.5f, 1.0f});
+        sp_set_color(canvas, {0.8f, 0.3f, 0.1f, 0.5f});
+        for (int i = 0; i < swatches; ++i) {
+            sp_set_blend_mode(canvas, cycle[i % modes]);
+            sp_fill_rect(canvas, (float)(i % 190) * 10.0f, (float)(i / 190) * 10.0f, 6.0f, 6.0f);
+        }
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) drawCalls += stats.draw_calls;
+    }
+
+    state.SetItemsProcessed(state.iterations() * swatches);
+    state.counters["draw_calls_per_frame"] = benchmark::Counter((double)drawCalls / state.iterations());
+
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_SceneStartup(benchmark::State& state)
+{
+    // First frame of a prebuilt spirograph of `segments` hairline segments: stroking the path
+    // into a draw list and submitting it (0), against loading the recorded scene file, whose
+    // vertex block goes to the GPU straight from the mapping, and replaying it (1).
+    const int segments = (int)state.range(0);
+    const bool fromScene = state.range(1) != 0;
+    const char* scenePath = "spiro_bench_scene.bin";
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_pen_config_t pen_config = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 10.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &pen_config);
+    sp_path_t* path = sp_create_path(canvas);
+    for (int i = 0; i <= segments; ++i) {
+        const double t = 20.0 * 3.14159265358979 * i / segments;
+        const float x = (float)(960.0 + 150.0 * std::cos(t) + 350.0 * std::cos(7.0 / 3.0 * t));
+        const float y = (float)(540.0 + 150.0 * std::sin(t) - 350.0 * std::sin(7.0 / 3.0 * t));
+        if (i == 0) sp_path_move_to(path, x, y);
+        else sp_path_line_to(path, x, y);
+    }
+    sp_draw_list_t* list = sp_create_draw_list(canvas);
+    auto record = [&] {
+        sp_begin_draw_list(canvas, list);
+        sp_set_pen(canvas, pen);
+        sp_set_color(canvas, {0.1f, 0.2f, 0.7f, 1.0f});
+        sp_stroke_path(canvas, path);
+        sp_end_draw_list(canvas);
+    };
+    if (fromScene) {
+        record();
+        if (!sp_record_scene_file(canvas, &list, 1, scenePath)) state.SkipWithError("Recording the scene file failed");
+    }
+
+    uint64_t vertices = 0;
+    for (auto _ : state) {
+        sp_scene_t* scene = nullptr;
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        if (fromScene) {
+            scene = sp_load_scene_file(canvas, scenePath);
+            sp_replay(canvas, scene);
+        } else {
+            record();
+            sp_submit_draw_lists(canvas, &list, 1);
+        }
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        if (sp_get_frame_stats(canvas, &stats)) vertices += stats.vertices;
+        if (fromScene && !scene) {
+            state.SkipWithError("Loading the scene file failed");
+            break;
+        }
+        sp_destroy_scene(scene);
+    }
+
+    state.SetItemsProcessed(state.iterations() * segments);
+    if (state.iterations() > 0) state.counters["vertices"] = (double)vertices / state.iterations();
+    std::remove(scenePath);
+
+    sp_destroy_draw_list(list);
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+    std::remove(scenePath);
+}
+
+void BM_LoadThumbnails(benchmark::State& state)
+{
+    // Startup cost of 256 distinct 128x128 thumbnails: sp_load_image one after another (0)
+    // against sp_load_image_async plus sp_finish_image_loads (1).
+    const bool async = state.range(0) != 0;
+    const int thumbnails = 256;
+    sp_initialize();
+    sp_offscreen_config_t config = {128, 128, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    std::vector<std::string> paths;
+    for (int i = 0; i < thumbnails; ++i) {
+        paths.push_back("spiro_bench_thumbnail_" + std::to_string(i) + ".png");
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {(float)(i % 7) / 6.0f, (float)(i % 5) / 4.0f, 1.0f, 1.0f});
+        sp_set_color(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_fill_rect(canvas, (float)(i % 100), 10.0f, 20.0f, 100.0f);
+        sp_end_frame(canvas);
+        sp_save_png(canvas, paths.back().c_str());
+    }
+
+    for (auto _ : state) {
+        std::vector<sp_image_t*> images;
+        for (const std::string& path : paths)
+            images.push_back(async ? sp_load_image_async(canvas, path.c_str()) : sp_load_image(canvas, path.c_str()));
+        if (async) sp_finish_image_loads(canvas);
+        for (sp_image_t* image : images) sp_destroy_image(image);
+    }
+
+    state.SetItemsProcessed(state.iterations() * thumbnails);
+    for (const std::string& path : paths) std::remove(path.c_str());
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+void BM_FigureWindows(benchmark::State& state)
+{
+    // Opening 16 figures that each load the same font and four icons and draw one frame, as
+    // separate canvases (0) against canvases on one device (1), which compile the shaders once
+    // and share one font atlas and one upload of each icon.
+    const bool shared = state.range(0) != 0;
+    const int figures = 16, icons = 4;
+    const char* fontPath = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+    sp_initialize();
+    sp_offscreen_config_t config = {640, 480, 1};
+    sp_canvas_t* scratch = sp_create_offscreen_canvas(&config);
+    const sp_device_config_t deviceConfig = {true};
+    sp_device_t* device = shared && scratch ? sp_create_device(&deviceConfig) : nullptr;
+    if (!scratch || (shared && !device)) {
+        if (scratch) sp_destroy_canvas(scratch);
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    std::vector<std::string> paths;
+    for (int i = 0; i < icons; ++i) {
+        paths.push_back("spiro_bench_icon_" + std::to_string(i) + ".png");
+        sp_begin_frame(scratch);
+        sp_clear(scratch, {(float)i / icons, 0.5f, 1.0f, 1.0f});
+        sp_end_frame(scratch);
+        sp_save_png(scratch, paths.back().c_str());
+    }
+    sp_destroy_canvas(scratch);
+
+    for (auto _ : state) {
+        std::vector<sp_canvas_t*> canvases;
+        std::vector<sp_font_t*> fonts;
+        std::vector<sp_image_t*> images;
+        for (int f = 0; f < figures; ++f) {
+            sp_canvas_t* canvas = shared ? sp_create_device_offscreen_canvas(device, &config) : sp_create_offscreen_canvas(&config);
+            canvases.push_back(canvas);
+            fonts.push_back(sp_load_font(canvas, fontPath));
+            sp_begin_frame(canvas);
+            sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+            for (int i = 0; i < icons; ++i) {
+                images.push_back(sp_load_image(canvas, paths[i].c_str()));
+                sp_draw_image_rect(canvas, images.back(), {0, 0, 640, 480}, {(float)i * 40, 0, 32, 32});
+            }
+            if (fonts.back()) {
+                sp_set_font(canvas, fonts.back(), 14.0f);
+                sp_set_color(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+                sp_draw_text(canvas, "Figure 1: spirograph, 1000000 samples", 10, 60);
+            }
+            sp_end_frame(canvas);
+        }
+        for (sp_image_t* image : images) sp_destroy_image(image);
+        for (sp_font_t* font : fonts) sp_destroy_font(font);
+        for (sp_canvas_t* canvas : canvases) sp_destroy_canvas(canvas);
+    }
+
+    state.SetItemsProcessed(state.iterations() * figures);
+    for (const std::string& path : paths) std::remove(path.c_str());
+    if (device) sp_destroy_device(device);
+    sp_terminate();
+}
+
+void BM_DashboardDrawLists(benchmark::State& state)
+{
+    // 64 panels of thick round-joined series, one draw list each, recorded by `threads` workers
+    // and submitted together. Real time, since the point is the wall clock of the whole frame.
+    const int threads = (int)state.range(0), panels = 64, samples = 2000;
+    sp_initialize();
+    sp_offscreen_config_t config = {1920, 1080, 0};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+    sp_pen_config_t pen_config = {3.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_ROUND, 10.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &pen_config);
+    std::vector<sp_path_t*> paths;
+    std::vector<sp_draw_list_t*> lists;
+    for (int p = 0; p < panels; ++p) {
+        sp_path_t* path = sp_create_path(canvas);
+        sp_path_move_to(path, 0.0f, 60.0f);
+        for (int i = 1; i < samples; ++i)
+            sp_path_line_to(path, 240.0f * i / samples, 60.0f + 50.0f * std::sin(i * 0.05f + p));
+        paths.push_back(path);
+        lists.push_back(sp_create_draw_list(canvas));
+    }
+    auto record = [&](int worker) {
+        for (int p = worker; p < panels; p += threads) {
+            sp_begin_draw_list(canvas, lists[p]);
+            sp_translate(canvas, (float)(p % 8 * 240), (float)(p / 8 * 135));
+            sp_set_pen(canvas, pen);
+            sp_set_color(canvas, {0.2f, 0.4f, 0.8f, 1.0f});
+            sp_stroke_path(canvas, paths[p]);
+            sp_end_draw_list(canvas);
+        }
+    };
+
+    for (auto _ : state) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        std::vector<std::thread> workers;
+        for (int w = 1; w < threads; ++w) workers.emplace_back(record, w);
+        record(0);
+        for (std::thread& worker : workers) worker.join();
+        sp_submit_draw_lists(canvas, lists.data(), lists.size());
+        sp_end_frame(canvas);
+    }
+
+    state.SetItemsProcessed(state.iterations() * panels);
+    for (sp_draw_list_t* list : lists) sp_destroy_draw_list(list);
+    for (sp_path_t* path : paths) sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
+
+}
+
+BENCHMARK(BM_StrokeTimeSeries)->Args({500000, 1})->Args({20000000, 1})->Args({500000, 0})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DashboardDrawLists)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_IconScatter)->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScatterMarkers)->Args({1000000, 0})->Args({1000000, 1})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SoftwareSpirograph)->Args({1000000, 1})->Args({1000000, 2})->Args({1000000, 4})->Args({1000000, 8})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LiveSeries)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FillPolygons)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CurveSpirograph)->Arg(1)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FillRects)->Arg(10000)->Arg(200000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TextLayout)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PanelTransforms)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BlendModes)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SceneStartup)->Args({2500000, 0})->Args({2500000, 1})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadThumbnails)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FigureWindows)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
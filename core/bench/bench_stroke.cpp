@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include "stroke_kernel.hpp"
+
+#include <cmath>
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+void BM_StrokeKernel(benchmark::State& state, SimdLevel level)
+{
+    StrokeKernel kernel = strokeKernel(level);
+    if (!kernel) {
+        state.SkipWithError("Variant not available on this CPU");
+        return;
+    }
+    const size_t segments = (size_t)state.range(0);
+    std::vector<sp_vec2_t> points(segments + 1);
+    for (size_t i = 0; i <= segments; ++i) points[i] = {(float)i * 0.01f, 400.0f * std::sin((float)i * 0.001f)};
+    std::vector<Vertex> out(segments * VERTICES_PER_QUAD);
+    const StrokeParams params{0.5f, {2.0f, 0.0f, 0.0f, -1.0f, 10.0f, 540.0f}, 0xFF0000FFu};
+
+    for (auto _ : state) {
+        kernel(points.data(), segments, params, out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)segments);
+    state.SetLabel(simdLevelName(level));
+}
+
+}
+
+BENCHMARK_CAPTURE(BM_StrokeKernel, scalar, SimdLevel::Scalar)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_CAPTURE(BM_StrokeKernel, sse2, SimdLevel::SSE2)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_CAPTURE(BM_StrokeKernel, avx2, SimdLevel::AVX2)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_CAPTURE(BM_StrokeKernel, neon, SimdLevel::NEON)->Arg(1 << 12)->Arg(1 << 20);
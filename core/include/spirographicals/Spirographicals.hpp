@@ -64,6 +64,39 @@ class Image;
 class Font;
 class Gradient;
 class Shader;
+class Mesh;
+class Scene;
+
+// Shared by the canvases created on it; fonts and images loaded through any of them are
+// cached by content. Canvases, fonts and images keep it alive, so it may go first.
+class Device {
+public:
+    explicit Device(bool offscreen = false) {
+        sp_device_config_t config = {offscreen};
+        handle_ = sp_create_device(&config);
+        if (!handle_) { throw std::runtime_error("Failed to create Spirographicals device"); }
+    }
+    ~Device() { sp_destroy_device(handle_); }
+    Device(const Device&) = delete;
+    Device& operator=(const Device&) = delete;
+    Device(Device&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    Device& operator=(Device&& other) noexcept {
+        if (this != &other) {
+            sp_destroy_device(handle_);
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    [[nodiscard]] sp_device_stats_t getStats() const {
+        sp_device_stats_t stats = {};
+        sp_get_device_stats(handle_, &stats);
+        return stats;
+    }
+    sp_device_t* getHandle() const { return handle_; }
+private:
+    sp_device_t* handle_ = nullptr;
+};
 
 class Canvas {
 public:
@@ -76,6 +109,18 @@ public:
         handle_ = sp_create_canvas(&config);
         if (!handle_) { throw std::runtime_error("Failed to create Spirographicals canvas"); }
     }
+    explicit Canvas(const sp_offscreen_config_t& config) {
+        handle_ = sp_create_offscreen_canvas(&config);
+        if (!handle_) { throw std::runtime_error("Failed to create Spirographicals offscreen canvas"); }
+    }
+    Canvas(Device& device, const sp_window_config_t& config) {
+        handle_ = sp_create_device_canvas(device.getHandle(), &config);
+        if (!handle_) { throw std::runtime_error("Failed to create Spirographicals canvas"); }
+    }
+    Canvas(Device& device, const sp_offscreen_config_t& config) {
+        handle_ = sp_create_device_offscreen_canvas(device.getHandle(), &config);
+        if (!handle_) { throw std::runtime_error("Failed to create Spirographicals offscreen canvas"); }
+    }
     ~Canvas() { sp_destroy_canvas(handle_); }
 
     Canvas(const Canvas&) = delete;
@@ -91,14 +136,25 @@ public:
     }
 
     [[nodiscard]] bool shouldClose() const { return sp_canvas_should_close(handle_); }
+    [[nodiscard]] bool isOffscreen() const { return sp_canvas_is_offscreen(handle_); }
     void beginFrame() { sp_begin_frame(handle_); }
     void endFrame() { sp_end_frame(handle_); }
+    bool waitEvents(double timeoutSeconds = -1.0) { return sp_wait_events(handle_, timeoutSeconds); }
+    [[nodiscard]] bool needsRedraw() const { return sp_canvas_needs_redraw(handle_); }
+    void invalidate() { sp_invalidate(handle_); }
+    void invalidateRect(float x, float y, float w, float h) { sp_invalidate_rect(handle_, x, y, w, h); }
     void clear(const Color& color) { sp_clear(handle_, {color.r, color.g, color.b, color.a}); }
     [[nodiscard]] Vec2 getSize() const { 
         sp_vec2_t s = sp_get_canvas_size(handle_);
         return {s.x, s.y};
     }
 
+    bool readPixels(uint8_t* rgba, size_t size) { return sp_read_pixels(handle_, rgba, size); }
+    [[nodiscard]] uint64_t requestReadback() { return sp_request_readback(handle_); }
+    [[nodiscard]] sp_readback_status_t pollReadback(uint64_t ticket) { return sp_poll_readback(handle_, ticket); }
+    bool fetchReadback(uint64_t ticket, uint8_t* rgba, size_t size) { return sp_fetch_readback(handle_, ticket, rgba, size); }
+    bool savePng(const std::string& path) { return sp_save_png(handle_, path.c_str()); }
+
     void saveState() { sp_save_state(handle_); }
     void restoreState() { sp_restore_state(handle_); }
 
@@ -109,10 +165,17 @@ public:
 
     void setPen(const Pen& pen);
     void setColor(const Color& color) { sp_set_color(handle_, {color.r, color.g, color.b, color.a}); }
+    void setBlendMode(BlendMode mode) { sp_set_blend_mode(handle_, static_cast<sp_blend_mode_t>(mode)); }
 
     void strokePath(const Path& path);
     void fillPath(const Path& path);
 
+    bool beginMesh() { return sp_begin_mesh(handle_); }
+    Mesh endMesh();
+    void drawMesh(const Mesh& mesh);
+    Scene loadScene(const std::string& path);
+    void replay(const Scene& scene);
+
     void drawLine(float x1, float y1, float x2, float y2) { sp_draw_line(handle_, x1, y1, x2, y2); }
     void drawRect(float x, float y, float w, float h) { sp_draw_rect(handle_, x, y, w, h); }
     void drawCircle(float cx, float cy, float radius) { sp_draw_circle(handle_, cx, cy, radius); }
@@ -175,6 +238,10 @@ public:
         handle_ = sp_load_font(canvas.getHandle(), path.c_str());
         if (!handle_) { throw std::runtime_error("Failed to load font from: " + path); }
     }
+    explicit Font(Device& device, const std::string& path) {
+        handle_ = sp_device_load_font(device.getHandle(), path.c_str());
+        if (!handle_) { throw std::runtime_error("Failed to load font from: " + path); }
+    }
     ~Font() { sp_destroy_font(handle_); }
     Font(const Font&) = delete;
     Font& operator=(const Font&) = delete;
@@ -189,6 +256,10 @@ public:
         handle_ = sp_load_image(canvas.getHandle(), path.c_str());
         if (!handle_) { throw std::runtime_error("Failed to load image from: " + path); }
     }
+    explicit Image(Device& device, const std::string& path) {
+        handle_ = sp_device_load_image(device.getHandle(), path.c_str());
+        if (!handle_) { throw std::runtime_error("Failed to load image from: " + path); }
+    }
     ~Image() { sp_destroy_image(handle_); }
     Image(const Image&) = delete;
     Image& operator=(const Image&) = delete;
@@ -197,6 +268,55 @@ private:
     sp_image_t* handle_ = nullptr;
 };
 
+class Mesh {
+public:
+    explicit Mesh(sp_mesh_t* handle) : handle_(handle) {
+        if (!handle_) { throw std::runtime_error("Failed to build Spirographicals mesh"); }
+    }
+    ~Mesh() { sp_destroy_mesh(handle_); }
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    Mesh& operator=(Mesh&& other) noexcept {
+        if (this != &other) {
+            sp_destroy_mesh(handle_);
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    [[nodiscard]] size_t vertexCount() const { return sp_mesh_vertex_count(handle_); }
+    sp_mesh_t* getHandle() const { return handle_; }
+private:
+    sp_mesh_t* handle_ = nullptr;
+};
+
+class Scene {
+public:
+    explicit Scene(sp_scene_t* handle) : handle_(handle) {
+        if (!handle_) { throw std::runtime_error("Failed to load Spirographicals scene"); }
+    }
+    ~Scene() { sp_destroy_scene(handle_); }
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+    Scene(Scene&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    Scene& operator=(Scene&& other) noexcept {
+        if (this != &other) {
+            sp_destroy_scene(handle_);
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    sp_scene_t* getHandle() const { return handle_; }
+private:
+    sp_scene_t* handle_ = nullptr;
+};
+
+inline Mesh Canvas::endMesh() { return Mesh(sp_end_mesh(handle_)); }
+inline void Canvas::drawMesh(const Mesh& mesh) { sp_draw_mesh(handle_, mesh.getHandle()); }
+inline Scene Canvas::loadScene(const std::string& path) { return Scene(sp_load_scene_file(handle_, path.c_str())); }
+inline void Canvas::replay(const Scene& scene) { sp_replay(handle_, scene.getHandle()); }
 inline void Canvas::strokePath(const Path& path) { sp_stroke_path(handle_, path.getHandle()); }
 inline void Canvas::fillPath(const Path& path) { sp_fill_path(handle_, path.getHandle()); }
 inline void Canvas::setFont(const Font& font, float size) { sp_set_font(handle_, font.getHandle(), size); }
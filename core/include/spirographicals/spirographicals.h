@@ -10,12 +10,17 @@ extern "C" {
 #include <stdbool.h>
 
 typedef struct sp_canvas_t sp_canvas_t;
+typedef struct sp_device_t sp_device_t;
 typedef struct sp_pen_t sp_pen_t;
 typedef struct sp_path_t sp_path_t;
 typedef struct sp_image_t sp_image_t;
 typedef struct sp_font_t sp_font_t;
 typedef struct sp_gradient_t sp_gradient_t;
 typedef struct sp_shader_t sp_shader_t;
+typedef struct sp_mesh_t sp_mesh_t;
+typedef struct sp_draw_list_t sp_draw_list_t;
+typedef struct sp_series_t sp_series_t;
+typedef struct sp_scene_t sp_scene_t;
 
 typedef enum {
     SP_LOG_LEVEL_DEBUG,
@@ -44,6 +49,11 @@ typedef enum {
     SP_LINE_JOIN_BEVEL
 } sp_line_join_t;
 
+typedef enum {
+    SP_FILL_RULE_NONZERO,
+    SP_FILL_RULE_EVEN_ODD
+} sp_fill_rule_t;
+
 typedef enum {
     SP_BLEND_MODE_NORMAL,
     SP_BLEND_MODE_ADD,
@@ -74,6 +84,34 @@ typedef struct { float r; float g; float b; float a; } sp_color_rgba_t;
 typedef struct { float x; float y; float w; float h; } sp_rect_t;
 typedef struct { sp_color_rgba_t color; float position; } sp_gradient_stop_t;
 
+typedef enum {
+    SP_READBACK_PENDING,
+    SP_READBACK_READY,
+    SP_READBACK_INVALID
+} sp_readback_status_t;
+
+typedef enum {
+    SP_IMAGE_LOADING,
+    SP_IMAGE_READY,
+    SP_IMAGE_FAILED
+} sp_image_status_t;
+
+typedef enum {
+    SP_MARKER_CIRCLE,
+    SP_MARKER_SQUARE,
+    SP_MARKER_TRIANGLE,
+    SP_MARKER_CROSS,
+    SP_MARKER_PLUS
+} sp_marker_shape_t;
+
+typedef struct {
+    float x;
+    float y;
+    float size;
+    uint32_t color;
+    sp_marker_shape_t shape;
+} sp_marker_t;
+
 typedef struct {
     int width;
     int height;
@@ -82,6 +120,24 @@ typedef struct {
     bool vsync;
 } sp_window_config_t;
 
+typedef struct {
+    int width;
+    int height;
+    int readback_buffers;
+} sp_offscreen_config_t;
+
+typedef struct {
+    bool offscreen;
+} sp_device_config_t;
+
+typedef struct {
+    int width;
+    int height;
+    uint8_t* pixels;
+    size_t stride;
+    int threads;
+} sp_software_config_t;
+
 typedef struct {
     float line_width;
     sp_line_cap_t line_cap;
@@ -89,6 +145,27 @@ typedef struct {
     float miter_limit;
 } sp_pen_config_t;
 
+typedef struct {
+    uint64_t frame;
+    uint32_t flushes;
+    uint32_t draw_calls;
+    uint32_t texture_evictions;
+    uint64_t vertices;
+    uint64_t upload_bytes;
+    double cpu_frame_ms;
+    double begin_frame_ms;
+    double end_frame_ms;
+    double stroke_ms;
+    double gpu_ms;
+} sp_frame_stats_t;
+
+typedef struct {
+    uint32_t canvases;
+    uint32_t fonts;
+    uint32_t images;
+    uint32_t atlas_pages;
+} sp_device_stats_t;
+
 typedef void (*sp_error_callback_t)(int error_code, const char* description);
 typedef void (*sp_key_callback_t)(sp_canvas_t* canvas, int key, int scancode, int action, int mods);
 typedef void (*sp_mouse_button_callback_t)(sp_canvas_t* canvas, int button, int action, int mods);
@@ -98,14 +175,37 @@ void sp_initialize();
 void sp_terminate();
 void sp_set_error_callback(sp_error_callback_t callback);
 void sp_set_log_level(sp_log_level_t level);
+bool sp_trace_begin(const char* path);
+bool sp_trace_end();
 
 sp_canvas_t* sp_create_canvas(const sp_window_config_t* config);
+sp_canvas_t* sp_create_offscreen_canvas(const sp_offscreen_config_t* config);
+sp_canvas_t* sp_create_software_canvas(const sp_software_config_t* config);
 void sp_destroy_canvas(sp_canvas_t* canvas);
+sp_device_t* sp_create_device(const sp_device_config_t* config);
+void sp_destroy_device(sp_device_t* device);
+sp_canvas_t* sp_create_device_canvas(sp_device_t* device, const sp_window_config_t* config);
+sp_canvas_t* sp_create_device_offscreen_canvas(sp_device_t* device, const sp_offscreen_config_t* config);
+sp_font_t* sp_device_load_font(sp_device_t* device, const char* path_to_ttf);
+sp_image_t* sp_device_load_image(sp_device_t* device, const char* path_to_image);
+bool sp_get_device_stats(sp_device_t* device, sp_device_stats_t* stats);
+bool sp_canvas_is_offscreen(sp_canvas_t* canvas);
 bool sp_canvas_should_close(sp_canvas_t* canvas);
 void sp_begin_frame(sp_canvas_t* canvas);
 void sp_end_frame(sp_canvas_t* canvas);
+bool sp_wait_events(sp_canvas_t* canvas, double timeout_seconds);
+bool sp_canvas_needs_redraw(sp_canvas_t* canvas);
+void sp_invalidate(sp_canvas_t* canvas);
+void sp_invalidate_rect(sp_canvas_t* canvas, float x, float y, float width, float height);
 void sp_clear(sp_canvas_t* canvas, sp_color_rgba_t color);
 sp_vec2_t sp_get_canvas_size(sp_canvas_t* canvas);
+bool sp_get_frame_stats(sp_canvas_t* canvas, sp_frame_stats_t* stats);
+
+bool sp_read_pixels(sp_canvas_t* canvas, uint8_t* rgba, size_t size);
+uint64_t sp_request_readback(sp_canvas_t* canvas);
+sp_readback_status_t sp_poll_readback(sp_canvas_t* canvas, uint64_t ticket);
+bool sp_fetch_readback(sp_canvas_t* canvas, uint64_t ticket, uint8_t* rgba, size_t size);
+bool sp_save_png(sp_canvas_t* canvas, const char* path);
 
 void sp_save_state(sp_canvas_t* canvas);
 void sp_restore_state(sp_canvas_t* canvas);
@@ -115,26 +215,60 @@ void sp_rotate(sp_canvas_t* canvas, float angle_radians);
 void sp_scale(sp_canvas_t* canvas, float x, float y);
 
 sp_pen_t* sp_create_pen(sp_canvas_t* canvas, const sp_pen_config_t* config);
+sp_pen_t* sp_create_frame_pen(sp_canvas_t* canvas, const sp_pen_config_t* config);
 void sp_destroy_pen(sp_pen_t* pen);
 void sp_set_pen(sp_canvas_t* canvas, sp_pen_t* pen);
 void sp_set_color(sp_canvas_t* canvas, sp_color_rgba_t color);
+void sp_set_fill_rule(sp_canvas_t* canvas, sp_fill_rule_t rule);
+void sp_set_blend_mode(sp_canvas_t* canvas, sp_blend_mode_t mode);
+uint32_t sp_pack_color(sp_color_rgba_t color);
 
 sp_path_t* sp_create_path(sp_canvas_t* canvas);
+sp_path_t* sp_create_frame_path(sp_canvas_t* canvas);
 void sp_destroy_path(sp_path_t* path);
+void sp_path_reserve(sp_path_t* path, size_t n);
 void sp_path_move_to(sp_path_t* path, float x, float y);
 void sp_path_line_to(sp_path_t* path, float x, float y);
+void sp_path_set_points(sp_path_t* path, const float* xy, size_t n, size_t stride);
 void sp_path_arc_to(sp_path_t* path, float x1, float y1, float x2, float y2, float radius);
 void sp_path_cubic_bezier_to(sp_path_t* path, float c1x, float c1y, float c2x, float c2y, float x, float y);
 void sp_path_close(sp_path_t* path);
 void sp_stroke_path(sp_canvas_t* canvas, sp_path_t* path);
 void sp_fill_path(sp_canvas_t* canvas, sp_path_t* path);
 
+sp_series_t* sp_create_series(sp_canvas_t* canvas, size_t capacity);
+void sp_destroy_series(sp_series_t* series);
+void sp_series_append(sp_series_t* series, const float* xs, const float* ys, size_t n);
+void sp_series_clear(sp_series_t* series);
+size_t sp_series_size(sp_series_t* series);
+void sp_draw_series(sp_canvas_t* canvas, sp_series_t* series);
+
+bool sp_begin_mesh(sp_canvas_t* canvas);
+sp_mesh_t* sp_end_mesh(sp_canvas_t* canvas);
+void sp_destroy_mesh(sp_mesh_t* mesh);
+size_t sp_mesh_vertex_count(sp_mesh_t* mesh);
+void sp_draw_mesh(sp_canvas_t* canvas, sp_mesh_t* mesh);
+
+sp_draw_list_t* sp_create_draw_list(sp_canvas_t* canvas);
+void sp_destroy_draw_list(sp_draw_list_t* list);
+bool sp_begin_draw_list(sp_canvas_t* canvas, sp_draw_list_t* list);
+void sp_end_draw_list(sp_canvas_t* canvas);
+void sp_submit_draw_lists(sp_canvas_t* canvas, sp_draw_list_t* const* lists, size_t count);
+
+size_t sp_record_scene(sp_canvas_t* canvas, sp_draw_list_t* const* lists, size_t count, void* buffer, size_t size);
+bool sp_record_scene_file(sp_canvas_t* canvas, sp_draw_list_t* const* lists, size_t count, const char* path);
+sp_scene_t* sp_load_scene(sp_canvas_t* canvas, const void* data, size_t size);
+sp_scene_t* sp_load_scene_file(sp_canvas_t* canvas, const char* path);
+void sp_destroy_scene(sp_scene_t* scene);
+void sp_replay(sp_canvas_t* canvas, sp_scene_t* scene);
+
 void sp_draw_line(sp_canvas_t* canvas, float x1, float y1, float x2, float y2);
 void sp_draw_rect(sp_canvas_t* canvas, float x, float y, float w, float h);
 void sp_draw_circle(sp_canvas_t* canvas, float cx, float cy, float radius);
 void sp_draw_ellipse(sp_canvas_t* canvas, float cx, float cy, float rx, float ry);
 void sp_fill_rect(sp_canvas_t* canvas, float x, float y, float w, float h);
 void sp_fill_circle(sp_canvas_t* canvas, float cx, float cy, float radius);
+void sp_draw_markers(sp_canvas_t* canvas, const sp_marker_t* markers, size_t count);
 
 sp_font_t* sp_load_font(sp_canvas_t* canvas, const char* path_to_ttf);
 void sp_destroy_font(sp_font_t* font);
@@ -143,6 +277,9 @@ void sp_draw_text(sp_canvas_t* canvas, const char* utf8_text, float x, float y);
 sp_rect_t sp_measure_text(sp_canvas_t* canvas, const char* utf8_text);
 
 sp_image_t* sp_load_image(sp_canvas_t* canvas, const char* path_to_image);
+sp_image_t* sp_load_image_async(sp_canvas_t* canvas, const char* path_to_image);
+sp_image_status_t sp_get_image_status(sp_image_t* image);
+void sp_finish_image_loads(sp_canvas_t* canvas);
 void sp_destroy_image(sp_image_t* image);
 void sp_draw_image(sp_canvas_t* canvas, sp_image_t* image, float x, float y);
 void sp_draw_image_rect(sp_canvas_t* canvas, sp_image_t* image, sp_rect_t source_rect, sp_rect_t dest_rect);
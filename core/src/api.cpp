@@ -1,123 +1,1556 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-#define STB_TRUETYPE_IMPLEMENTATION
-#include <stb_truetype.h>
-
 #include <spirographicals/spirographicals.h>
 
+#include "curve.hpp"
+#include "frame_pool.hpp"
+#include "gl_ext.hpp"
+#include "glyph_atlas.hpp"
+#include "gpu_timer.hpp"
+#include "image_atlas.hpp"
+#include "image_loader.hpp"
+#include "lod.hpp"
+#include "log.hpp"
+#include "mapped_file.hpp"
+#include "marker_renderer.hpp"
+#include "png_writer.hpp"
+#include "polygon.hpp"
+#include "scene_format.hpp"
+#include "software_rasterizer.hpp"
+#include "software_texture.hpp"
+#include "stream_buffer.hpp"
+#include "stroke_kernel.hpp"
+#include "stroker.hpp"
+#include "trace.hpp"
+#include "vertex.hpp"
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#ifdef SPIRO_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <iostream>
 #include <stdexcept>
 #include <vector>
 #include <string>
 #include <map>
 #include <memory>
 #include <stack>
+#include <unordered_map>
+#include <variant>
+#include <deque>
 #include <fstream>
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cmath>
+#include <cstring>
 
 namespace spiro::internal {
 
-struct Vertex { glm::vec2 position; glm::vec4 color; glm::vec2 texCoord; float texId; };
-struct Path { std::vector<sp_vec2_t> points; };
-struct Pen { sp_pen_config_t config; };
-struct Image { GLuint textureId = 0; int width = 0; int height = 0; };
-struct Font { std::vector<unsigned char> ttf_buffer; GLuint font_texture = 0; stbtt_bakedchar cdata[96]; };
-struct State { glm::mat4 transform; sp_color_rgba_t color; sp_pen_t* pen; sp_font_t* font; float font_size; };
+struct Path {
+    // Shared with the meshes that captured a stroke of the path (Path::share), and copied before
+    // an edit while any of them still holds it.
+    std::shared_ptr<std::vector<sp_vec2_t>> points = std::make_shared<std::vector<sp_vec2_t>>(); bool closed = false;
+    // Owned by the canvas's frame pool (sp_create_frame_path) rather than the caller.
+    bool frameScoped = false;
+    // Packed caller memory from sp_path_set_points, read in place until the path is next edited.
+    const sp_vec2_t* borrowed = nullptr; size_t borrowedCount = 0;
+    // Built on the first stroke of a large open path and dropped whenever the path is edited.
+    std::shared_ptr<const LodPyramid> lod; bool lodChecked = false;
+    // Curved edges between points, in order; each ends at one of the points above.
+    std::vector<PathCurve> curves;
+    // The curves flattened for the scale bucket flatBucket, kept until the path is edited or
+    // drawn at a scale outside that bucket.
+    std::vector<sp_vec2_t> flat; int flatBucket = NO_FLAT_BUCKET;
+    static constexpr int NO_FLAT_BUCKET = -(1 << 30);
+    const sp_vec2_t* data() const { return borrowed ? borrowed : points->data(); }
+    size_t size() const { return borrowed ? borrowedCount : points->size(); }
+    // Editable points; copies borrowed memory in first so appends keep what was set.
+    std::vector<sp_vec2_t>& owned() {
+        if (points.use_count() > 1) points = std::make_shared<std::vector<sp_vec2_t>>(*points);
+        if (borrowed) { points->assign(borrowed, borrowed + borrowedCount); borrowed = nullptr; borrowedCount = 0; }
+        return *points;
+    }
+    // The points for a mesh to keep. Borrowed memory may not outlive the path, so it is copied
+    // into the path's own storage once and shared from there.
+    std::shared_ptr<const std::vector<sp_vec2_t>> share() { if (borrowed) owned(); return points; }
+    void edited() { lod.reset(); lodChecked = false; flatBucket = NO_FLAT_BUCKET; }
+    // Empties the path but keeps its storage for the next points, unless a mesh shares it.
+    void reset() {
+        if (points.use_count() > 1) points = std::make_shared<std::vector<sp_vec2_t>>(); else points->clear();
+        curves.clear(); borrowed = nullptr; borrowedCount = 0; closed = false; edited();
+    }
+    // Curved paths are never decimated: their points are not the samples that get drawn.
+    const LodPyramid* pyramid() {
+        if (!lodChecked) { lodChecked = true; if (!closed && curves.empty() && size() >= LodPyramid::MIN_POINTS) lod = LodPyramid::build(data(), size()); }
+        return lod.get();
+    }
+    // What to draw at `scale` device pixels per unit. Curves are flattened for the top of the
+    // half-octave the scale falls in, so they stay within tolerance anywhere in it and a
+    // steady or slowly changing zoom reuses the same points frame after frame.
+    void outline(float scale, const sp_vec2_t*& out, size_t& count) {
+        out = data(); count = size();
+        if (curves.empty()) return;
+        const int bucket = (int)std::ceil(2.0f * std::log2(std::clamp(scale, 1e-6f, 1e6f)));
+        if (bucket != flatBucket) { flattenPath(data(), size(), curves.data(), curves.size(), std::exp2(0.5f * (float)bucket), CURVE_TOLERANCE, flat); flatBucket = bucket; }
+        out = flat.data(); count = flat.size();
+    }
+};
+struct Pen { sp_pen_config_t config; bool frameScoped = false; };
+struct DeviceImage;
+struct Image {
+    // No atlas on software canvases, whose images are software textures of their own.
+    LoadedImage loaded; ImageAtlas* atlas = nullptr;
+    // Set for sp_load_image_async; its pixels count once the render thread has uploaded them.
+    std::shared_ptr<PendingImage> pending;
+    // Set for images cached on a device, which releases the pixels with the last handle.
+    std::shared_ptr<const DeviceImage> shared;
+    // Null while an async load is in flight or after it failed.
+    const LoadedImage* get() const {
+        if (!pending) return &loaded;
+        return pending->state.load(std::memory_order_acquire) == PendingImage::READY ? &pending->loaded : nullptr;
+    }
+};
+// Texture coordinates of the normalized sub-rectangle (u0, v0)-(u1, v1), kept inside the image.
+static glm::vec4 imageTexCoords(const LoadedImage& image, float u0, float v0, float u1, float v1) {
+    const ImageRegion& r = image.region;
+    auto s = [&](float u) { return r.s0 + std::clamp(u, 0.0f, 1.0f) * (r.s1 - r.s0); };
+    auto t = [&](float v) { return r.t0 + std::clamp(v, 0.0f, 1.0f) * (r.t1 - r.t0); };
+    return {s(u0), t(v0), s(u1), t(v1)};
+}
+// Drawn in the destination rectangle of an image that is still loading: 25% mid grey.
+static const uint32_t IMAGE_PLACEHOLDER_COLOR = 0x40808080u;
+// Handles to fonts cached on a device share one atlas.
+struct Font { std::shared_ptr<GlyphAtlas> atlas; };
+// A large x-sorted stroke captured into a mesh. How it lands on screen is only known when the
+// mesh is drawn, so it shares the path's samples and LOD pyramid rather than keeping quads and
+// is decimated and stroked again at every draw, after the mesh's first firstQuad quads.
+struct MeshStroke { size_t firstQuad; std::shared_ptr<const std::vector<sp_vec2_t>> points; std::shared_ptr<const LodPyramid> lod; glm::mat4 transform; sp_pen_config_t pen; uint32_t color; };
+// GL meshes live in their VAO/VBO; backends without GL keep the vertices instead.
+struct Mesh { GLuint vao = 0, vbo = 0; GLsizei vertexCount = 0, indexCount = 0; std::vector<GLuint> textures; std::vector<Vertex> vertices; std::vector<MeshStroke> strokes; };
+struct State { glm::mat4 transform; sp_color_rgba_t color; sp_pen_t* pen = nullptr; sp_font_t* font = nullptr; float font_size = 16.0f; sp_fill_rule_t fill_rule = SP_FILL_RULE_NONZERO; sp_blend_mode_t blend_mode = SP_BLEND_MODE_NORMAL; };
+// Vector-backed so save/restore reuses one allocation instead of a deque's blocks.
+using StateStack = std::stack<State, std::vector<State>>;
+
+// baseOffset is the byte offset of the first vertex in the bound GL_ARRAY_BUFFER.
+static void configureVertexLayout(size_t baseOffset = 0) {
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(baseOffset + offsetof(Vertex, position))); glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (const void*)(baseOffset + offsetof(Vertex, color))); glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Vertex), (const void*)(baseOffset + offsetof(Vertex, texCoord))); glEnableVertexAttribArray(2);
+    // texSlot and texMode are adjacent bytes read as one uvec2.
+    glVertexAttribIPointer(3, 2, GL_UNSIGNED_BYTE, sizeof(Vertex), (const void*)(baseOffset + offsetof(Vertex, texSlot))); glEnableVertexAttribArray(3);
+}
 
-class Renderer {
-private:
-    GLuint m_vao = 0, m_vbo = 0, m_shaderProgram = 0;
-    std::vector<Vertex> m_vertices;
-    std::vector<GLuint> m_textureSlots;
-    static const size_t MAX_VERTICES = 60000;
+static void destroyMesh(Mesh* mesh) {
+    if (!mesh) return;
+    if (mesh->vao) { glDeleteBuffers(1, &mesh->vbo); glDeleteVertexArrays(1, &mesh->vao); }
+    delete mesh;
+}
+
+// A live trace keeping its newest `capacity` segments (sp_series_t). Samples sit in a ring on
+// the CPU; their stroke quads sit in a ring mesh, segment k-1..k in slot (k-1) % capacity, and
+// each draw tessellates and uploads only what was appended since the last one. The quads have
+// the transform's linear part applied but not its translation, so scrolling costs nothing; a
+// change of scale, rotation, width or color re-tessellates the window.
+struct Series {
+    size_t capacity = 0; std::vector<sp_vec2_t> samples; uint64_t total = 0;
+    Mesh* mesh = nullptr; uint64_t tessellated = 0; StrokeParams params{};
+    // Samples still in the window: the newest capacity + 1.
+    size_t size() const { return (size_t)std::min<uint64_t>(total, samples.size()); }
+    const sp_vec2_t& sample(uint64_t i) const { return samples[i % samples.size()]; }
+    ~Series() { destroyMesh(mesh); }
+};
+
+// A recorded scene loaded for replay (sp_scene_t). Vertex blocks became meshes uploaded
+// straight from the loaded buffer, which is not needed afterwards; text, markers and fill
+// outlines are small and kept as copies.
+struct Scene {
+    struct Entry { SceneCommand command; Mesh* mesh = nullptr; std::string text; std::vector<sp_marker_t> markers; std::vector<sp_vec2_t> points; };
+    std::vector<Entry> entries; std::vector<GLuint> textures; std::vector<std::unique_ptr<Font>> fonts;
+    ~Scene() {
+        for (Entry& e : entries) destroyMesh(e.mesh);
+        for (GLuint t : textures) {
+            if (isSoftwareTexture(t)) releaseSoftwareTexture(t);
+            else if (t) glDeleteTextures(1, &t);
+        }
+    }
+};
+static glm::mat4 sceneTransform(const float t[6]) {
+    glm::mat4 m(1.0f); m[0][0] = t[0]; m[0][1] = t[1]; m[1][0] = t[2]; m[1][1] = t[3]; m[3][0] = t[4]; m[3][1] = t[5]; return m;
+}
+static void setSceneTransform(SceneCommand& c, const glm::mat4& m) {
+    const float t[6] = {m[0][0], m[0][1], m[1][0], m[1][1], m[3][0], m[3][1]}; std::copy(t, t + 6, c.transform);
+}
+
+// Scratch for filling paths on the CPU, kept per renderer and per draw list so recording
+// threads never share it.
+struct FillScratch { std::vector<sp_vec2_t> outline; EarClipper clipper; };
+
+class Renderer;
+
+// Drawing recorded by one thread for the render thread to submit later (sp_draw_list_t).
+// Geometry is tessellated and transformed at record time into final device-space vertices;
+// each geometry run carries its own texture table, since batch slots are only assigned on
+// submission. Text, meshes, markers, clears and fills the CPU cannot triangulate are kept as
+// commands because they touch GL objects or state that belong to the render thread. Every
+// drawing item keeps the blend mode it was recorded under.
+struct DrawList {
+    // Matches the batch shader's sampler array.
     static const size_t MAX_TEXTURES = 16;
-    
+    struct Geometry { size_t first = 0, count = 0; std::vector<GLuint> textures; sp_blend_mode_t blend = SP_BLEND_MODE_NORMAL; };
+    struct Text { Font* font; std::string text; float size, x, y; uint32_t color; glm::mat4 transform; sp_blend_mode_t blend; };
+    struct MeshDraw { const Mesh* mesh; glm::mat4 transform; sp_blend_mode_t blend; };
+    struct Markers { std::vector<sp_marker_t> markers; glm::mat4 transform; sp_blend_mode_t blend; };
+    struct Clear { sp_color_rgba_t color; };
+    // The outline in device space.
+    struct Fill { std::vector<sp_vec2_t> points; sp_fill_rule_t rule; uint32_t color; sp_blend_mode_t blend; };
+    using Item = std::variant<Geometry, Text, MeshDraw, Markers, Clear, Fill>;
+
+    Renderer* renderer = nullptr;
+    std::vector<Vertex> vertices; std::vector<Item> items;
+    // Lists start from the default state rather than the canvas's, which another thread owns.
+    StateStack states; std::vector<sp_vec2_t> lodPoints; FillScratch fill;
+    // Only stroke_ms and texture_evictions are recorded here; submission adds them to the frame.
+    sp_frame_stats_t stats{};
+
+    void reset() {
+        vertices.clear(); items.clear(); lodPoints.clear(); stats = {};
+        while (!states.empty()) states.pop();
+        State initialState; initialState.transform = glm::mat4(1.0f); initialState.color = {1,1,1,1}; states.push(initialState);
+    }
+    // The run being recorded into, or a new one if something else came last or the blend mode changed.
+    Geometry& geometry() {
+        const sp_blend_mode_t blend = states.top().blend_mode;
+        Geometry* last = items.empty() ? nullptr : std::get_if<Geometry>(&items.back());
+        if (!last || last->blend != blend) { Geometry g; g.first = vertices.size(); g.blend = blend; items.push_back(std::move(g)); }
+        return std::get<Geometry>(items.back());
+    }
+    Vertex* allocateQuads(size_t quads) {
+        Geometry& g = geometry(); const size_t count = quads * VERTICES_PER_QUAD;
+        vertices.resize(vertices.size() + count); g.count += count;
+        return &vertices[vertices.size() - count];
+    }
+    // A run that runs out of slots ends there; the next one starts with an empty table.
+    uint8_t textureSlot(GLuint textureId) {
+        Geometry* g = &geometry();
+        for (size_t i=0; i<g->textures.size(); ++i) if (g->textures[i] == textureId) return (uint8_t)i;
+        if (g->textures.size() >= MAX_TEXTURES) {
+            stats.texture_evictions++; Geometry next; next.first = vertices.size(); next.blend = g->blend; items.push_back(std::move(next));
+            g = &std::get<Geometry>(items.back());
+        }
+        g->textures.push_back(textureId); return (uint8_t)(g->textures.size() - 1);
+    }
+};
+
+// The list the calling thread is recording into, if any (sp_begin_draw_list).
+static thread_local DrawList* t_recording = nullptr;
+
+// Even segment count for an ellipse whose larger radius spans `radius` pixels, keeping each
+// chord within a quarter pixel of the curve.
+static constexpr float ARC_TOLERANCE = 0.25f, TWO_PI = 6.28318530717959f;
+static size_t ellipseSegments(float radius) {
+    if (radius <= ARC_TOLERANCE) return 8;
+    const size_t n = (size_t)std::ceil(TWO_PI / (2.0f * std::acos(1.0f - ARC_TOLERANCE / radius)));
+    return std::clamp<size_t>((n + 1) & ~(size_t)1, 8, 4096);
+}
+
+// Batches are drawn as ranges of quads grouped by blend mode, each group one draw in the order
+// given. See Renderer::groupRuns.
+struct BatchRange { uint32_t firstQuad, quads; };
+struct BatchGroup { sp_blend_mode_t blend; size_t firstRange, rangeCount; };
+
+// Where the renderer's batches end up. The renderer owns tessellation, batching, texture slots
+// and stats; a backend only turns finished batches, meshes, markers and clears into pixels.
+// Texture handles are GL names, or software texture names (software_texture.hpp) for pixels
+// kept on the CPU; each backend draws only its own kind.
+class Backend {
 public:
-    std::stack<State> stateStack;
-    Renderer() {
-        m_vertices.reserve(MAX_VERTICES);
-        m_textureSlots.reserve(MAX_TEXTURES);
+    static const size_t MAX_VERTICES = 60000;
+    virtual ~Backend() = default;
+    virtual void beginFrame(int width, int height) = 0;
+    virtual void endFrame() {}
+    // Room for MAX_VERTICES vertices, valid until the next drawBatch. Null if none is available.
+    virtual Vertex* mapBatch() = 0;
+    virtual void drawBatch(size_t vertexCount, const std::vector<GLuint>& textures, const std::vector<BatchRange>& ranges, const std::vector<BatchGroup>& groups) = 0;
+    // Takes the vertices if it keeps them; adds whatever it uploads to uploadBytes.
+    virtual Mesh* createMesh(std::vector<Vertex>& vertices, std::vector<GLuint> textures, uint64_t& uploadBytes) = 0;
+    // Uploads straight from caller memory, which need not outlive the call.
+    virtual Mesh* createMesh(const Vertex* vertices, size_t count, std::vector<GLuint> textures, uint64_t& uploadBytes) = 0;
+    // Copies a mesh's vertices back out, for sp_record_scene.
+    virtual void readMesh(const Mesh& mesh, std::vector<Vertex>& out) = 0;
+    // A texture's pixels as tightly packed rows of `channels` bytes (1 for R8, else 4). False
+    // when the backend has no textures to read.
+    virtual bool readTexture(GLuint texture, uint32_t& width, uint32_t& height, uint32_t& channels, std::vector<uint8_t>& pixels) { return false; }
+    // A linear, edge-clamped texture holding such pixels; 0 when the backend has no textures.
+    virtual GLuint createTexture(uint32_t width, uint32_t height, uint32_t channels, const uint8_t* pixels, uint64_t& uploadBytes) { return 0; }
+    // The texture to sample a glyph atlas page from, current with every glyph laid out so far.
+    virtual GLuint glyphTexture(GlyphAtlas& atlas, uint32_t page) = 0;
+    // Draws quads [firstQuad, firstQuad + quadCount) of the mesh. Returns the number of draw calls.
+    virtual size_t drawMesh(const Mesh& mesh, size_t firstQuad, size_t quadCount, const glm::mat4& transform, sp_blend_mode_t blend) = 0;
+    // An empty mesh with room for vertexCapacity vertices, filled in place by updateMesh. The
+    // caller sets its vertex and index counts to the part to draw.
+    virtual Mesh* createStreamingMesh(size_t vertexCapacity, uint64_t& uploadBytes) = 0;
+    virtual void updateMesh(Mesh& mesh, size_t firstVertex, const Vertex* vertices, size_t count, uint64_t& uploadBytes) = 0;
+    // Returns the number of draw calls, 0 if markers cannot be drawn.
+    virtual size_t drawMarkers(const sp_marker_t* markers, size_t count, const glm::mat4& transform, sp_blend_mode_t blend) = 0;
+    // Fills a device-space outline of any shape under the rule. Returns the number of draw calls.
+    virtual size_t fillPath(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, uint32_t color, sp_blend_mode_t blend, uint64_t& uploadBytes) = 0;
+    virtual void clear(sp_color_rgba_t color) = 0;
+    // Time spent drawing some recent frame, once one is known.
+    virtual bool pollDrawTime(double& milliseconds) { return false; }
+};
+
+// The batch shader and the 16-bit quad indices every batch draws with. Both can be shared
+// between contexts, so the canvases of one device (sp_device_t) use a single copy; the owning
+// share group must have a context current when the last reference goes.
+struct BatchProgram {
+    GLuint program = 0, quadIndices = 0;
+    GLint viewProjectionLoc = -1;
+    // The backend whose projection the uniform holds, so interleaved canvases each restore theirs.
+    mutable const void* projectionOwner = nullptr;
+    ~BatchProgram() { glDeleteProgram(program); glDeleteBuffers(1, &quadIndices); }
+    // Throws std::runtime_error if the shaders do not link.
+    static std::shared_ptr<BatchProgram> create() {
         const char* vs_src = R"glsl(#version 330 core
             layout (location = 0) in vec2 a_Pos; layout (location = 1) in vec4 a_Color;
-            layout (location = 2) in vec2 a_TexCoord; layout (location = 3) in float a_TexId;
-            out vec4 v_Color; out vec2 v_TexCoord; out float v_TexId;
+            layout (location = 2) in vec2 a_TexCoord; layout (location = 3) in uvec2 a_TexInfo;
+            out vec4 v_Color; out vec2 v_TexCoord; flat out uint v_TexSlot; flat out uint v_TexMode;
             uniform mat4 u_ViewProjection;
             void main() {
-                v_Color = a_Color; v_TexCoord = a_TexCoord; v_TexId = a_TexId;
+                v_Color = a_Color; v_TexCoord = a_TexCoord; v_TexSlot = a_TexInfo.x; v_TexMode = a_TexInfo.y;
                 gl_Position = u_ViewProjection * vec4(a_Pos, 0.0, 1.0);
             })glsl";
         const char* fs_src = R"glsl(#version 330 core
             out vec4 FragColor;
-            in vec4 v_Color; in vec2 v_TexCoord; in float v_TexId;
+            in vec4 v_Color; in vec2 v_TexCoord; flat in uint v_TexSlot; flat in uint v_TexMode;
             uniform sampler2D u_Textures[16];
+            vec4 sampleSlot(int tid, vec2 uv) {
+                // GLSL 3.30 only allows constant sampler-array indices.
+                switch (tid) {
+                    case 0: return texture(u_Textures[0], uv);   case 1: return texture(u_Textures[1], uv);
+                    case 2: return texture(u_Textures[2], uv);   case 3: return texture(u_Textures[3], uv);
+                    case 4: return texture(u_Textures[4], uv);   case 5: return texture(u_Textures[5], uv);
+                    case 6: return texture(u_Textures[6], uv);   case 7: return texture(u_Textures[7], uv);
+                    case 8: return texture(u_Textures[8], uv);   case 9: return texture(u_Textures[9], uv);
+                    case 10: return texture(u_Textures[10], uv); case 11: return texture(u_Textures[11], uv);
+                    case 12: return texture(u_Textures[12], uv); case 13: return texture(u_Textures[13], uv);
+                    case 14: return texture(u_Textures[14], uv); default: return texture(u_Textures[15], uv);
+                }
+            }
             void main() {
-                if (v_TexId > -0.5) {
-                    int tid = int(round(v_TexId));
-                    vec4 texColor = texture(u_Textures[tid], v_TexCoord);
-                    FragColor = v_Color * vec4(1.0, 1.0, 1.0, texColor.r);
-                } else { FragColor = v_Color; }
+                if (v_TexSlot != 255u && v_TexMode == 2u) {
+                    vec4 texel = sampleSlot(int(v_TexSlot), v_TexCoord) * v_Color;
+                    FragColor = vec4(texel.rgb * texel.a, texel.a);
+                } else if (v_TexSlot != 255u) {
+                    float coverage = sampleSlot(int(v_TexSlot), v_TexCoord).r;
+                    if (v_TexMode == 1u) {
+                        // Distance field: the outline is at 0.5 and fwidth keeps the edge ramp
+                        // about one screen pixel wide at any text size.
+                        float w = max(fwidth(coverage) * 0.5, 1e-4);
+                        coverage = smoothstep(0.5 - w, 0.5 + w, coverage);
+                    }
+                    FragColor = vec4(v_Color.rgb * (v_Color.a * coverage), v_Color.a * coverage);
+                } else { FragColor = vec4(v_Color.rgb * v_Color.a, v_Color.a); }
             })glsl";
 
+        auto p = std::make_shared<BatchProgram>();
         GLuint vs = glCreateShader(GL_VERTEX_SHADER); glShaderSource(vs, 1, &vs_src, nullptr); glCompileShader(vs);
         GLuint fs = glCreateShader(GL_FRAGMENT_SHADER); glShaderSource(fs, 1, &fs_src, nullptr); glCompileShader(fs);
-        m_shaderProgram = glCreateProgram(); glAttachShader(m_shaderProgram, vs); glAttachShader(m_shaderProgram, fs); glLinkProgram(m_shaderProgram);
+        p->program = glCreateProgram(); glAttachShader(p->program, vs); glAttachShader(p->program, fs); glLinkProgram(p->program);
         glDeleteShader(vs); glDeleteShader(fs);
+        GLint linked = GL_FALSE; glGetProgramiv(p->program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char log[1024] = {}; glGetProgramInfoLog(p->program, sizeof(log), nullptr, log);
+            throw std::runtime_error(std::string("shader program failed to link: ") + log);
+        }
+        glUseProgram(p->program);
+        p->viewProjectionLoc = glGetUniformLocation(p->program, "u_ViewProjection");
+        int samplers[MAX_TEXTURES]; for (int i = 0; i < (int)MAX_TEXTURES; ++i) samplers[i] = i;
+        glUniform1iv(glGetUniformLocation(p->program, "u_Textures"), MAX_TEXTURES, samplers);
+        const size_t quads = Backend::MAX_VERTICES / VERTICES_PER_QUAD;
+        std::vector<uint16_t> indices(quads * INDICES_PER_QUAD); appendQuadIndices(indices.data(), 0, quads);
+        glGenBuffers(1, &p->quadIndices); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, p->quadIndices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+        return p;
+    }
+    static const size_t MAX_TEXTURES = 16;
+};
+
+// Draws with the canvas's OpenGL 3.3 context, which must be current on every call.
+class GlBackend : public Backend {
+private:
+    std::shared_ptr<const BatchProgram> m_program;
+    GLuint m_vao = 0, m_meshIbo = 0;
+    size_t m_meshIboQuads = 0;
+    // Batched geometry is transformed on the CPU, so the batch only needs the projection.
+    glm::mat4 m_projection = glm::mat4(1.0f);
+    // The batch is written straight into the mapped stream window; there is no CPU-side copy.
+    std::unique_ptr<StreamBuffer> m_stream;
+    glm::vec2 m_viewport{0.0f};
+    // Created with the first markers; stays null if the context cannot instance.
+    std::unique_ptr<MarkerRenderer> m_markers; bool m_markersUnavailable = false;
+    GpuTimer m_gpuTimer;
+    static const size_t MAX_QUADS = MAX_VERTICES / VERTICES_PER_QUAD;
+    static const size_t MAX_TEXTURES = 16;
+    static const size_t STREAM_WINDOWS = 3;
+    // Meshes larger than a stream batch are drawn a batch at a time, each draw flushed so the
+    // driver works on one while the next is issued, as the stream's fenced windows let it. One
+    // huge draw keeps a software rasterizer's threads idle until every vertex is processed.
+    static const size_t MESH_DRAW_INDICES = MAX_QUADS * INDICES_PER_QUAD;
+
+    // Meshes can exceed the 16-bit streaming range, so they share a 32-bit quad index buffer
+    // that grows to the largest mesh. Must be called with the mesh's VAO bound.
+    void bindMeshIndices(size_t quads, uint64_t& uploadBytes) {
+        if (!m_meshIbo) glGenBuffers(1, &m_meshIbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_meshIbo);
+        if (quads <= m_meshIboQuads) return;
+        m_meshIboQuads = std::max(quads, m_meshIboQuads * 2);
+        std::vector<uint32_t> indices(m_meshIboQuads * INDICES_PER_QUAD);
+        appendQuadIndices(indices.data(), 0, m_meshIboQuads);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+        uploadBytes += indices.size() * sizeof(uint32_t);
+    }
+    void bindTextures(const std::vector<GLuint>& textures) {
+        for (uint32_t i=0; i<textures.size(); ++i) { glActiveTexture(GL_TEXTURE0+i); glBindTexture(GL_TEXTURE_2D, textures[i]); }
+    }
+    // Both shaders write premultiplied color, which lets every mode but overlay be a blend
+    // function. Alpha always accumulates as in source-over. Overlay depends on the destination
+    // in a way fixed-function blending cannot express and is drawn as normal.
+    bool m_overlayWarned = false;
+    void enableBlend(sp_blend_mode_t blend) {
+        glEnable(GL_BLEND);
+        switch (blend) {
+        case SP_BLEND_MODE_ADD: glBlendFuncSeparate(GL_ONE, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+        case SP_BLEND_MODE_MULTIPLY: glBlendFuncSeparate(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+        case SP_BLEND_MODE_SCREEN: glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_COLOR, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+        case SP_BLEND_MODE_OVERLAY:
+            if (!m_overlayWarned) { m_overlayWarned = true; logMessage(SP_LOG_LEVEL_WARN, "Overlay blending is not supported by the GL backend; drawing as normal"); }
+            [[fallthrough]];
+        default: glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+        }
+    }
+    std::vector<GLsizei> m_rangeCounts; std::vector<const void*> m_rangeOffsets;
+    // Outline edges per fan in the stencil pass of a fill.
+    static const size_t FILL_FAN_EDGES = 64;
+    std::vector<sp_vec2_t> m_fillLevels[2]; std::vector<GLint> m_fanFirsts; std::vector<GLsizei> m_fanCounts;
+    // Adds the winding of a closed outline to the stencil. One fan around the first point would
+    // do, but on jagged data every triangle then reaches back across the plot and the fill rate
+    // explodes. Instead each run of FILL_FAN_EDGES edges is fanned around its own first point,
+    // and the outline through those run ends, whose edges cancel each run's closing edge, is
+    // stencilled the same way until it has fewer than three points. Returns the draw calls.
+    size_t stencilOutline(const sp_vec2_t* points, size_t count, uint64_t& uploadBytes) {
+        size_t draws = 0;
+        for (int depth = 0; count >= 3; ++depth) {
+            std::vector<sp_vec2_t>& ends = m_fillLevels[depth % 2]; ends.clear();
+            Vertex* out = nullptr; size_t used = 0;
+            auto submit = [&] {
+                if (used == 0) return;
+                configureVertexLayout(m_stream->commit(used * sizeof(Vertex)));
+                glMultiDrawArrays(GL_TRIANGLE_FAN, m_fanFirsts.data(), m_fanCounts.data(), (GLsizei)m_fanCounts.size());
+                m_stream->retire(); uploadBytes += used * sizeof(Vertex); draws++;
+                out = nullptr; used = 0; m_fanFirsts.clear(); m_fanCounts.clear();
+            };
+            for (size_t start = 0; start < count; start += FILL_FAN_EDGES) {
+                ends.push_back(points[start]);
+                // Position `count` is the first point again, closing the outline.
+                const size_t end = std::min(start + FILL_FAN_EDGES, count), n = end - start + 1;
+                if (n < 3) continue;
+                if (used + n > MAX_VERTICES) submit();
+                if (!out && !(out = static_cast<Vertex*>(m_stream->map()))) return draws;
+                m_fanFirsts.push_back((GLint)used); m_fanCounts.push_back((GLsizei)n);
+                for (size_t i = start; i <= end; ++i) out[used++] = makeVertex({points[i % count].x, points[i % count].y}, 0, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+            }
+            submit();
+            points = ends.data(); count = ends.size();
+        }
+        return draws;
+    }
+
+public:
+    explicit GlBackend(std::shared_ptr<const BatchProgram> program = nullptr) : m_program(program ? std::move(program) : BatchProgram::create()) {
         glGenVertexArrays(1, &m_vao); glBindVertexArray(m_vao);
-        glGenBuffers(1, &m_vbo); glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferData(GL_ARRAY_BUFFER, MAX_VERTICES * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, position)); glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, color)); glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, texCoord)); glEnableVertexAttribArray(2);
-        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, texId)); glEnableVertexAttribArray(3);
-        State initialState; initialState.transform = glm::mat4(1.0f); initialState.color = {1,1,1,1}; stateStack.push(initialState);
-    }
-    ~Renderer() { glDeleteProgram(m_shaderProgram); glDeleteBuffers(1, &m_vbo); glDeleteVertexArrays(1, &m_vao); }
-    void beginFrame(int width, int height) {
-        m_vertices.clear(); m_textureSlots.clear();
-        glUseProgram(m_shaderProgram);
-        glm::mat4 projection = glm::ortho(0.0f, (float)width, (float)height, 0.0f, -1.0f, 1.0f);
-        glm::mat4 view = stateStack.top().transform;
-        glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "u_ViewProjection"), 1, GL_FALSE, glm::value_ptr(projection * view));
-        int samplers[MAX_TEXTURES]; for(int i=0; i<MAX_TEXTURES; ++i) samplers[i]=i;
-        glUniform1iv(glGetUniformLocation(m_shaderProgram, "u_Textures"), MAX_TEXTURES, samplers);
+        m_stream = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, MAX_VERTICES * sizeof(Vertex), STREAM_WINDOWS);
+        configureVertexLayout();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_program->quadIndices);
     }
-    void flush() {
-        if (m_vertices.empty()) return;
-        for (uint32_t i=0; i<m_textureSlots.size(); ++i) { glActiveTexture(GL_TEXTURE0+i); glBindTexture(GL_TEXTURE_2D, m_textureSlots[i]); }
-        glBindVertexArray(m_vao); glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(Vertex), m_vertices.data());
-        glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glDrawArrays(GL_TRIANGLES, 0, m_vertices.size());
+    ~GlBackend() override { if (m_program->projectionOwner == this) m_program->projectionOwner = nullptr; m_stream.reset(); glDeleteBuffers(1, &m_meshIbo); glDeleteVertexArrays(1, &m_vao); }
+    // Other canvases sharing the program may have left their own projection in it.
+    void useProgram() {
+        glUseProgram(m_program->program);
+        if (m_program->projectionOwner == this) return;
+        glUniformMatrix4fv(m_program->viewProjectionLoc, 1, GL_FALSE, glm::value_ptr(m_projection)); m_program->projectionOwner = this;
+    }
+    void beginFrame(int width, int height) override {
+        m_projection = glm::ortho(0.0f, (float)width, (float)height, 0.0f, -1.0f, 1.0f); m_viewport = {(float)width, (float)height};
+        m_program->projectionOwner = nullptr; useProgram();
+    }
+    void endFrame() override { m_gpuTimer.endFrame(); }
+    bool pollDrawTime(double& milliseconds) override { return m_gpuTimer.poll(milliseconds); }
+    Vertex* mapBatch() override { return static_cast<Vertex*>(m_stream->map()); }
+    // One draw per group: the blend function changes between groups and nothing else does.
+    void drawBatch(size_t vertexCount, const std::vector<GLuint>& textures, const std::vector<BatchRange>& ranges, const std::vector<BatchGroup>& groups) override {
+        useProgram(); bindTextures(textures);
+        glBindVertexArray(m_vao);
+        // The static indices count from zero, so the attributes are re-pointed at the window.
+        configureVertexLayout(m_stream->commit(vertexCount * sizeof(Vertex)));
+        m_gpuTimer.begin();
+        for (const BatchGroup& group : groups) {
+            enableBlend(group.blend);
+            m_rangeCounts.clear(); m_rangeOffsets.clear();
+            for (size_t i = group.firstRange; i < group.firstRange + group.rangeCount; ++i) {
+                m_rangeCounts.push_back((GLsizei)(ranges[i].quads * INDICES_PER_QUAD));
+                m_rangeOffsets.push_back((const void*)((size_t)ranges[i].firstQuad * INDICES_PER_QUAD * sizeof(uint16_t)));
+            }
+            if (m_rangeCounts.size() == 1) glDrawElements(GL_TRIANGLES, m_rangeCounts[0], GL_UNSIGNED_SHORT, m_rangeOffsets[0]);
+            else glMultiDrawElements(GL_TRIANGLES, m_rangeCounts.data(), GL_UNSIGNED_SHORT, m_rangeOffsets.data(), (GLsizei)m_rangeCounts.size());
+        }
+        m_gpuTimer.end();
+        glDisable(GL_BLEND);
+        m_stream->retire();
+    }
+    Mesh* createMesh(std::vector<Vertex>& vertices, std::vector<GLuint> textures, uint64_t& uploadBytes) override {
+        return createMesh(vertices.data(), vertices.size(), std::move(textures), uploadBytes);
+    }
+    Mesh* createMesh(const Vertex* vertices, size_t count, std::vector<GLuint> textures, uint64_t& uploadBytes) override {
+        auto mesh = new Mesh(); mesh->vertexCount = (GLsizei)count; mesh->textures = std::move(textures);
+        const size_t quads = count / VERTICES_PER_QUAD; mesh->indexCount = (GLsizei)(quads * INDICES_PER_QUAD);
+        glGenVertexArrays(1, &mesh->vao); glBindVertexArray(mesh->vao);
+        glGenBuffers(1, &mesh->vbo); glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+        uploadBytes += count * sizeof(Vertex);
+        configureVertexLayout();
+        bindMeshIndices(quads, uploadBytes);
+        glBindVertexArray(m_vao); glBindBuffer(GL_ARRAY_BUFFER, m_stream->handle());
+        return mesh;
+    }
+    void readMesh(const Mesh& mesh, std::vector<Vertex>& out) override {
+        out.resize((size_t)mesh.vertexCount);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, out.size() * sizeof(Vertex), out.data());
+        glBindBuffer(GL_ARRAY_BUFFER, m_stream->handle());
+    }
+    bool readTexture(GLuint texture, uint32_t& width, uint32_t& height, uint32_t& channels, std::vector<uint8_t>& pixels) override {
+        GLint w = 0, h = 0, format = 0;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w); glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+        if (w <= 0 || h <= 0) return false;
+        width = (uint32_t)w; height = (uint32_t)h; channels = format == GL_R8 ? 1 : 4;
+        pixels.resize((size_t)width * height * channels);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, channels == 1 ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        return true;
+    }
+    GLuint createTexture(uint32_t width, uint32_t height, uint32_t channels, const uint8_t* pixels, uint64_t& uploadBytes) override {
+        GLuint texture = 0; glGenTextures(1, &texture); glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, channels == 1 ? GL_R8 : GL_RGBA8, (GLsizei)width, (GLsizei)height, 0, channels == 1 ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        uploadBytes += (size_t)width * height * channels;
+        return texture;
+    }
+    GLuint glyphTexture(GlyphAtlas& atlas, uint32_t page) override { return atlas.pageTexture(page); }
+    Mesh* createStreamingMesh(size_t vertexCapacity, uint64_t& uploadBytes) override {
+        auto mesh = new Mesh();
+        glGenVertexArrays(1, &mesh->vao); glBindVertexArray(mesh->vao);
+        glGenBuffers(1, &mesh->vbo); glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+        configureVertexLayout();
+        bindMeshIndices(vertexCapacity / VERTICES_PER_QUAD, uploadBytes);
+        glBindVertexArray(m_vao); glBindBuffer(GL_ARRAY_BUFFER, m_stream->handle());
+        return mesh;
+    }
+    // The mesh is still being read by earlier draws, so writing it from the CPU would wait for
+    // them. Instead the vertices go into the stream's fenced windows and are copied into place
+    // on the GPU, queued behind those draws. Without copy support the write stalls as before.
+    // Nothing else may be mapped in the stream, so pending batches must be flushed first.
+    void updateMesh(Mesh& mesh, size_t firstVertex, const Vertex* vertices, size_t count, uint64_t& uploadBytes) override {
+        uploadBytes += count * sizeof(Vertex);
+        if (!g_glCaps.copyBuffer) {
+            glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, firstVertex * sizeof(Vertex), count * sizeof(Vertex), vertices);
+            glBindBuffer(GL_ARRAY_BUFFER, m_stream->handle());
+            return;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.vbo);
+        for (size_t done = 0; done < count;) {
+            Vertex* out = static_cast<Vertex*>(m_stream->map()); if (!out) break;
+            const size_t n = std::min(count - done, (size_t)MAX_VERTICES);
+            std::copy(vertices + done, vertices + done + n, out);
+            const size_t offset = m_stream->commit(n * sizeof(Vertex));
+            glCopyBufferSubData(GL_ARRAY_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLintptr)((firstVertex + done) * sizeof(Vertex)), (GLsizeiptr)(n * sizeof(Vertex)));
+            m_stream->retire(); done += n;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    size_t drawMesh(const Mesh& mesh, size_t firstQuad, size_t quadCount, const glm::mat4& transform, sp_blend_mode_t blend) override {
+        useProgram();
+        glUniformMatrix4fv(m_program->viewProjectionLoc, 1, GL_FALSE, glm::value_ptr(m_projection * transform));
+        bindTextures(mesh.textures);
+        glBindVertexArray(mesh.vao);
+        enableBlend(blend);
+        m_gpuTimer.begin();
+        size_t draws = 0;
+        const size_t end = (firstQuad + quadCount) * INDICES_PER_QUAD;
+        for (size_t first = firstQuad * INDICES_PER_QUAD; first < end; first += MESH_DRAW_INDICES) {
+            glDrawElements(GL_TRIANGLES, (GLsizei)std::min(MESH_DRAW_INDICES, end - first), GL_UNSIGNED_INT, (const void*)(first * sizeof(uint32_t)));
+            if (quadCount * INDICES_PER_QUAD > MESH_DRAW_INDICES) glFlush();
+            draws++;
+        }
+        m_gpuTimer.end();
         glDisable(GL_BLEND);
+        glUniformMatrix4fv(m_program->viewProjectionLoc, 1, GL_FALSE, glm::value_ptr(m_projection));
+        return draws;
     }
-    float getTextureSlot(GLuint textureId) {
-        for (size_t i=0; i<m_textureSlots.size(); ++i) if(m_textureSlots[i] == textureId) return (float)i;
-        if (m_textureSlots.size() >= MAX_TEXTURES) { flush(); return getTextureSlot(textureId); }
+    size_t drawMarkers(const sp_marker_t* markers, size_t count, const glm::mat4& transform, sp_blend_mode_t blend) override {
+        if (!m_markers && !m_markersUnavailable) {
+            try { if (!g_glCaps.instancing) throw std::runtime_error("instanced arrays are not supported"); m_markers = std::make_unique<MarkerRenderer>(); }
+            catch (const std::exception& e) { m_markersUnavailable = true; logMessage(SP_LOG_LEVEL_ERROR, std::string("Markers unavailable: ") + e.what()); }
+        }
+        if (!m_markers) return 0;
+        m_gpuTimer.begin();
+        enableBlend(blend);
+        const size_t draws = m_markers->draw(markers, count, m_projection * transform, m_viewport);
+        glDisable(GL_BLEND);
+        m_gpuTimer.end();
+        glUseProgram(m_program->program);
+        return draws;
+    }
+    // Stencil, then cover. The outline goes into the stencil alone as triangle fans, each
+    // triangle adding or subtracting one by its facing (nonzero) or flipping the bits
+    // (even-odd), which leaves every pixel holding its winding number. One quad over the
+    // bounds then colors the pixels the rule puts inside and zeroes the stencil behind it.
+    // Windings wrap at 8 bits.
+    size_t fillPath(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, uint32_t color, sp_blend_mode_t blend, uint64_t& uploadBytes) override {
+        useProgram(); glBindVertexArray(m_vao);
+        glEnable(GL_STENCIL_TEST); glStencilMask(0xFF); glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        if (rule == SP_FILL_RULE_EVEN_ODD) glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
+        else { glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP); glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP); }
+        glm::vec2 lo(points[0].x, points[0].y), hi = lo;
+        for (size_t i = 1; i < count; ++i) { lo = glm::min(lo, glm::vec2(points[i].x, points[i].y)); hi = glm::max(hi, glm::vec2(points[i].x, points[i].y)); }
+        m_gpuTimer.begin();
+        size_t draws = stencilOutline(points, count, uploadBytes);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glStencilFunc(GL_NOTEQUAL, 0, 0xFF); glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+        if (Vertex* out = static_cast<Vertex*>(m_stream->map())) {
+            out[0] = makeVertex(lo, color, 0.0f, 0.0f, NO_TEXTURE_SLOT); out[1] = makeVertex({hi.x, lo.y}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+            out[2] = makeVertex(hi, color, 0.0f, 0.0f, NO_TEXTURE_SLOT); out[3] = makeVertex({lo.x, hi.y}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+            configureVertexLayout(m_stream->commit(VERTICES_PER_QUAD * sizeof(Vertex)));
+            enableBlend(blend);
+            glDrawElements(GL_TRIANGLES, INDICES_PER_QUAD, GL_UNSIGNED_SHORT, nullptr);
+            glDisable(GL_BLEND);
+            m_stream->retire(); uploadBytes += VERTICES_PER_QUAD * sizeof(Vertex); draws++;
+        }
+        m_gpuTimer.end();
+        glDisable(GL_STENCIL_TEST);
+        return draws;
+    }
+    void clear(sp_color_rgba_t color) override { glClearColor(color.r,color.g,color.b,color.a); glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); }
+};
+
+// Draws into a caller's RGBA8 buffer on the CPU. Batches are queued on the rasterizer and drawn
+// across its threads when the frame ends (or the pixels are read). Meshes keep their vertices
+// and markers are tessellated into quads. Textures are software textures, which the rasterizer
+// samples; GL textures cannot be read here, and geometry using one is skipped with a warning.
+class SoftwareBackend : public Backend {
+private:
+    SoftwareRasterizer m_rasterizer;
+    std::vector<Vertex> m_batch, m_scratch;
+    ScanlineFiller m_scanline; std::vector<FillSpan> m_spans;
+    std::vector<SoftwareTexture> m_textures; bool m_glTextureWarned = false;
+    double m_drawMs = -1.0;
+
+    // The pixels behind a draw's texture names, by slot.
+    const std::vector<SoftwareTexture>& resolveTextures(const std::vector<GLuint>& names) {
+        m_textures.assign(names.size(), SoftwareTexture{});
+        for (size_t i = 0; i < names.size(); ++i)
+            if (!findSoftwareTexture(names[i], m_textures[i]) && names[i] && !m_glTextureWarned) {
+                m_glTextureWarned = true; logMessage(SP_LOG_LEVEL_WARN, "A GL texture cannot be drawn on a software canvas; skipping the geometry that uses it");
+            }
+        return m_textures;
+    }
+
+    // Quads for one marker, centered on the device point c with radius r.
+    void tessellateMarker(const sp_marker_t& m, glm::vec2 c) {
+        const float r = m.size * 0.5f; const uint32_t color = m.color;
+        auto quad = [&](glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3) {
+            m_scratch.push_back(makeVertex(p0, color, 0.0f, 0.0f, NO_TEXTURE_SLOT)); m_scratch.push_back(makeVertex(p1, color, 0.0f, 0.0f, NO_TEXTURE_SLOT));
+            m_scratch.push_back(makeVertex(p2, color, 0.0f, 0.0f, NO_TEXTURE_SLOT)); m_scratch.push_back(makeVertex(p3, color, 0.0f, 0.0f, NO_TEXTURE_SLOT));
+        };
+        // Plus arms, as in the marker shader; the cross is the plus turned 45 degrees.
+        auto plus = [&](glm::vec2 u, glm::vec2 v) {
+            const float t = std::max(r * 0.2f, 0.5f);
+            quad(c - u*r - v*t, c + u*r - v*t, c + u*r + v*t, c - u*r + v*t);
+            quad(c - u*t - v*r, c + u*t - v*r, c + u*t - v*t, c - u*t - v*t);
+            quad(c - u*t + v*t, c + u*t + v*t, c + u*t + v*r, c - u*t + v*r);
+        };
+        switch (m.shape) {
+        case SP_MARKER_SQUARE: quad(c + glm::vec2(-r, -r), c + glm::vec2(r, -r), c + glm::vec2(r, r), c + glm::vec2(-r, r)); break;
+        case SP_MARKER_TRIANGLE: {
+            const float h = r * 0.8660254f;
+            quad(c + glm::vec2(0.0f, -r), c + glm::vec2(h, r * 0.5f), c + glm::vec2(-h, r * 0.5f), c + glm::vec2(-h, r * 0.5f)); break;
+        }
+        case SP_MARKER_CROSS: plus(glm::vec2(0.7071068f, 0.7071068f), glm::vec2(-0.7071068f, 0.7071068f)); break;
+        case SP_MARKER_PLUS: plus(glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 1.0f)); break;
+        default: {
+            const size_t n = ellipseSegments(r);
+            auto at = [&](size_t i) { const float angle = TWO_PI * (float)(i % n) / (float)n; return c + r * glm::vec2(std::cos(angle), std::sin(angle)); };
+            for (size_t i = 0; i < n; i += 2) quad(c, at(i), at(i + 1), at(i + 2));
+        }
+        }
+    }
+
+public:
+    explicit SoftwareBackend(unsigned threads) : m_rasterizer(threads), m_batch(MAX_VERTICES) {}
+    SoftwareRasterizer& rasterizer() { return m_rasterizer; }
+    void beginFrame(int width, int height) override {}
+    // The whole frame is drawn here, so its time stands in for the GPU time.
+    void endFrame() override {
+        const TraceClock::time_point start = TraceClock::now();
+        m_rasterizer.render();
+        m_drawMs = millisecondsBetween(start, TraceClock::now());
+    }
+    bool pollDrawTime(double& milliseconds) override { milliseconds = m_drawMs; return m_drawMs >= 0.0; }
+    Vertex* mapBatch() override { return m_batch.data(); }
+    void drawBatch(size_t vertexCount, const std::vector<GLuint>& textures, const std::vector<BatchRange>& ranges, const std::vector<BatchGroup>& groups) override {
+        const std::vector<SoftwareTexture>& sampled = resolveTextures(textures);
+        for (const BatchGroup& group : groups)
+            for (size_t i = group.firstRange; i < group.firstRange + group.rangeCount; ++i)
+                m_rasterizer.drawQuads(&m_batch[(size_t)ranges[i].firstQuad * VERTICES_PER_QUAD], ranges[i].quads, group.blend, sampled.data(), sampled.size());
+    }
+    Mesh* createMesh(std::vector<Vertex>& vertices, std::vector<GLuint> textures, uint64_t& uploadBytes) override {
+        auto mesh = new Mesh(); mesh->vertexCount = (GLsizei)vertices.size(); mesh->textures = std::move(textures);
+        mesh->indexCount = (GLsizei)(vertices.size() / VERTICES_PER_QUAD * INDICES_PER_QUAD); mesh->vertices = std::move(vertices);
+        return mesh;
+    }
+    Mesh* createMesh(const Vertex* vertices, size_t count, std::vector<GLuint> textures, uint64_t& uploadBytes) override {
+        std::vector<Vertex> copy(vertices, vertices + count); return createMesh(copy, std::move(textures), uploadBytes);
+    }
+    void readMesh(const Mesh& mesh, std::vector<Vertex>& out) override { out.assign(mesh.vertices.begin(), mesh.vertices.begin() + mesh.vertexCount); }
+    bool readTexture(GLuint texture, uint32_t& width, uint32_t& height, uint32_t& channels, std::vector<uint8_t>& pixels) override {
+        SoftwareTexture found; if (!findSoftwareTexture(texture, found)) return false;
+        width = found.width; height = found.height; channels = found.channels; pixels = *found.pixels; return true;
+    }
+    GLuint createTexture(uint32_t width, uint32_t height, uint32_t channels, const uint8_t* pixels, uint64_t& uploadBytes) override {
+        const size_t size = (size_t)width * height * (channels == 1 ? 1 : 4);
+        return registerSoftwareTexture({width, height, channels == 1 ? 1u : 4u, std::make_shared<const std::vector<uint8_t>>(pixels, pixels + size)});
+    }
+    GLuint glyphTexture(GlyphAtlas& atlas, uint32_t page) override { return atlas.softwarePageTexture(page); }
+    size_t drawMesh(const Mesh& mesh, size_t firstQuad, size_t quadCount, const glm::mat4& transform, sp_blend_mode_t blend) override {
+        const Affine2D t{transform[0][0], transform[0][1], transform[1][0], transform[1][1], transform[3][0], transform[3][1]};
+        const Vertex* vertices = &mesh.vertices[firstQuad * VERTICES_PER_QUAD];
+        m_scratch.resize(quadCount * VERTICES_PER_QUAD);
+        for (size_t i = 0; i < m_scratch.size(); ++i) { m_scratch[i] = vertices[i]; m_scratch[i].position = t.apply(vertices[i].position); }
+        const std::vector<SoftwareTexture>& sampled = resolveTextures(mesh.textures);
+        m_rasterizer.drawQuads(m_scratch.data(), m_scratch.size() / VERTICES_PER_QUAD, blend, sampled.data(), sampled.size());
+        return 1;
+    }
+    Mesh* createStreamingMesh(size_t vertexCapacity, uint64_t& uploadBytes) override {
+        auto mesh = new Mesh(); mesh->vertices.resize(vertexCapacity); return mesh;
+    }
+    void updateMesh(Mesh& mesh, size_t firstVertex, const Vertex* vertices, size_t count, uint64_t& uploadBytes) override {
+        std::copy(vertices, vertices + count, mesh.vertices.begin() + firstVertex);
+    }
+    size_t drawMarkers(const sp_marker_t* markers, size_t count, const glm::mat4& transform, sp_blend_mode_t blend) override {
+        m_scratch.clear();
+        for (size_t i = 0; i < count; ++i) {
+            tessellateMarker(markers[i], glm::vec2(transform * glm::vec4(markers[i].x, markers[i].y, 0.0f, 1.0f)));
+            if (m_scratch.size() >= MAX_VERTICES) { m_rasterizer.drawQuads(m_scratch.data(), m_scratch.size() / VERTICES_PER_QUAD, blend); m_scratch.clear(); }
+        }
+        m_rasterizer.drawQuads(m_scratch.data(), m_scratch.size() / VERTICES_PER_QUAD, blend);
+        return 1;
+    }
+    // One span per sample row, each a quad exactly one sample row tall, so fill edges get the
+    // same coverage as everything else the rasterizer draws.
+    size_t fillPath(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, uint32_t color, sp_blend_mode_t blend, uint64_t& uploadBytes) override {
+        m_scanline.fill(points, count, rule, m_rasterizer.height(), SoftwareRasterizer::SAMPLES, m_spans);
+        const float half = 0.5f / SoftwareRasterizer::SAMPLES;
+        m_scratch.clear();
+        for (const FillSpan& s : m_spans) {
+            m_scratch.push_back(makeVertex({s.x0, s.y - half}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT)); m_scratch.push_back(makeVertex({s.x1, s.y - half}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT));
+            m_scratch.push_back(makeVertex({s.x1, s.y + half}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT)); m_scratch.push_back(makeVertex({s.x0, s.y + half}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT));
+            if (m_scratch.size() >= MAX_VERTICES) { m_rasterizer.drawQuads(m_scratch.data(), m_scratch.size() / VERTICES_PER_QUAD, blend); m_scratch.clear(); }
+        }
+        m_rasterizer.drawQuads(m_scratch.data(), m_scratch.size() / VERTICES_PER_QUAD, blend);
+        return 1;
+    }
+    void clear(sp_color_rgba_t color) override { m_rasterizer.clear(packColor(color.r,color.g,color.b,color.a)); }
+};
+
+class Renderer {
+private:
+    // Geometry recorded between beginCapture/endCapture goes here instead of the streaming batch.
+    struct MeshCapture { std::vector<Vertex> vertices; std::vector<GLuint> textureSlots; std::vector<MeshStroke> strokes; bool overflowed = false; };
+    std::unique_ptr<Backend> m_backend;
+    Vertex* m_mapped = nullptr;
+    size_t m_vertexCount = 0;
+    std::vector<GLuint> m_textureSlots;
+    // Batch slot of every texture seen so far; an entry only counts while its batch is current.
+    struct SlotEntry { uint64_t batch; uint8_t slot; };
+    std::unordered_map<GLuint, SlotEntry> m_slotOf;
+    uint64_t m_batch = 1;
+    std::unique_ptr<MeshCapture> m_capture;
+    // Consecutive quads of the batch drawn under one blend mode, with their device-space bounds.
+    struct BatchRun { uint32_t firstQuad, quads; sp_blend_mode_t blend; glm::vec2 lo{INFINITY}, hi{-INFINITY}; };
+    std::vector<BatchRun> m_runs;
+    // The run whose bounds the quads being written grow; null outside the streaming batch.
+    BatchRun* m_bounding = nullptr;
+    std::vector<BatchRange> m_ranges;
+    std::vector<BatchGroup> m_groups;
+    std::vector<size_t> m_runGroup;
+    // Runs already grouped this flush, filed under every cell of a coarse grid their bounds
+    // touch, so a run is only tested against its neighbours.
+    struct PlacedRun { glm::vec2 lo, hi; size_t group; };
+    static const int GROUP_CELL_SIZE = 64;
+    std::vector<std::vector<PlacedRun>> m_cells;
+    int m_cellsX = 0, m_cellsY = 0;
+    StateStack m_states;
+    int m_viewportWidth = 0, m_viewportHeight = 0;
+    std::vector<sp_vec2_t> m_lodPoints, m_seriesPoints;
+    std::vector<Vertex> m_seriesVertices;
+    FillScratch m_fill;
+    // m_stats accumulates the frame in progress; m_lastStats is the last one sp_end_frame closed.
+    sp_frame_stats_t m_stats{}, m_lastStats{};
+    uint64_t m_frameCount = 0;
+    TraceClock::time_point m_frameStart;
+    double m_gpuMs = -1.0;
+    static const size_t MAX_VERTICES = Backend::MAX_VERTICES;
+    static const size_t MAX_TEXTURES = 16;
+    // Past this many remembered textures the slot table starts over at the next frame.
+    static const size_t MAX_SLOT_ENTRIES = 4096;
+
+    void resetTextureSlots() { m_textureSlots.clear(); m_batch++; }
+    uint8_t findTextureSlot(GLuint textureId) const {
+        auto found = m_slotOf.find(textureId);
+        return found != m_slotOf.end() && found->second.batch == m_batch ? found->second.slot : NO_TEXTURE_SLOT;
+    }
+
+    // Appends a recorded geometry run to the batch, renumbering its texture slots into the
+    // batch's. Flushes first whenever the run's textures or the next chunk would not fit.
+    void appendGeometry(const Vertex* vertices, size_t count, const std::vector<GLuint>& textures, sp_blend_mode_t blend) {
+        for (size_t done = 0; done < count;) {
+            if (m_vertexCount+VERTICES_PER_QUAD > MAX_VERTICES) flush();
+            size_t missing = 0;
+            for (GLuint t : textures) missing += findTextureSlot(t) == NO_TEXTURE_SLOT;
+            if (m_textureSlots.size() + missing > MAX_TEXTURES) { m_stats.texture_evictions++; flush(); }
+            uint8_t remap[DrawList::MAX_TEXTURES]; bool identity = true;
+            for (size_t i=0; i<textures.size(); ++i) { remap[i] = getTextureSlot(textures[i]); identity = identity && remap[i] == i; }
+            size_t quads = (count - done) / VERTICES_PER_QUAD; Vertex* out = allocateBatchQuads(quads, blend); if (!out) return;
+            const size_t n = quads * VERTICES_PER_QUAD;
+            std::memcpy(out, vertices + done, n * sizeof(Vertex));
+            for (size_t i=0; i<n; ++i) touch(vertices[done+i].position);
+            if (!identity) for (size_t i=0; i<n; ++i) if (out[i].texSlot != NO_TEXTURE_SLOT) out[i].texSlot = remap[out[i].texSlot];
+            done += n;
+        }
+    }
+    // Room for up to `quads` quads in the streaming batch, starting a new run if the blend mode
+    // changed. Bounds are taken from the positions as they are computed, since the stream may
+    // be write-only memory.
+    Vertex* allocateBatchQuads(size_t& quads, sp_blend_mode_t blend) {
+        if (m_vertexCount+VERTICES_PER_QUAD > MAX_VERTICES) flush();
+        if (!m_mapped && !(m_mapped = m_backend->mapBatch())) return nullptr;
+        quads = std::min(quads, (MAX_VERTICES - m_vertexCount) / VERTICES_PER_QUAD);
+        if (m_runs.empty() || m_runs.back().blend != blend) m_runs.push_back({(uint32_t)(m_vertexCount / VERTICES_PER_QUAD), 0, blend});
+        m_bounding = &m_runs.back(); m_bounding->quads += (uint32_t)quads;
+        Vertex* out = m_mapped + m_vertexCount; m_vertexCount += quads * VERTICES_PER_QUAD;
+        return out;
+    }
+    void touch(glm::vec2 p) { if (m_bounding) { m_bounding->lo = glm::min(m_bounding->lo, p); m_bounding->hi = glm::max(m_bounding->hi, p); } }
+    // Turns the batch's runs into one draw per group. A run joins the latest group with its
+    // blend mode unless it overlaps a run of a later group, which would then be drawn before
+    // it; anything a run could cover or be covered by keeps its painter's order. Bounds are
+    // clipped to the viewport, and a run without bounds covers all of it.
+    void groupRuns() {
+        m_groups.clear(); m_runGroup.clear();
+        if (m_runs.size() == 1) { m_groups.push_back({m_runs[0].blend, 0, 1}); m_ranges.assign(1, {m_runs[0].firstQuad, m_runs[0].quads}); return; }
+        const glm::vec2 viewport((float)std::max(m_viewportWidth, 1), (float)std::max(m_viewportHeight, 1));
+        m_cellsX = (int)viewport.x / GROUP_CELL_SIZE + 1; m_cellsY = (int)viewport.y / GROUP_CELL_SIZE + 1;
+        m_cells.resize((size_t)m_cellsX * m_cellsY); for (auto& cell : m_cells) cell.clear();
+        for (const BatchRun& run : m_runs) {
+            glm::vec2 lo = run.lo, hi = run.hi;
+            if (!(lo.x <= hi.x)) { lo = glm::vec2(0.0f); hi = viewport; }
+            lo = glm::min(glm::max(lo, glm::vec2(0.0f)), viewport); hi = glm::min(glm::max(hi, glm::vec2(0.0f)), viewport);
+            // A pixel of slack covers antialiased edges that reach past the vertices.
+            const glm::vec2 reachLo = lo - 1.0f, reachHi = hi + 1.0f;
+            const int cx0 = std::max((int)reachLo.x / GROUP_CELL_SIZE, 0), cx1 = std::min((int)reachHi.x / GROUP_CELL_SIZE, m_cellsX - 1);
+            const int cy0 = std::max((int)reachLo.y / GROUP_CELL_SIZE, 0), cy1 = std::min((int)reachHi.y / GROUP_CELL_SIZE, m_cellsY - 1);
+            size_t target = m_groups.size();
+            for (size_t g = m_groups.size(); g-- > 0;) if (m_groups[g].blend == run.blend) { target = g; break; }
+            for (int cy = cy0; cy <= cy1 && target + 1 < m_groups.size(); ++cy)
+                for (int cx = cx0; cx <= cx1 && target + 1 < m_groups.size(); ++cx)
+                    for (const PlacedRun& placed : m_cells[(size_t)cy * m_cellsX + cx])
+                        if (placed.group > target && placed.lo.x <= reachHi.x && reachLo.x <= placed.hi.x && placed.lo.y <= reachHi.y && reachLo.y <= placed.hi.y) { target = m_groups.size(); break; }
+            if (target == m_groups.size()) m_groups.push_back({run.blend, 0, 0});
+            for (int cy = cy0; cy <= cy1; ++cy) for (int cx = cx0; cx <= cx1; ++cx) m_cells[(size_t)cy * m_cellsX + cx].push_back({lo, hi, target});
+            m_groups[target].rangeCount++; m_runGroup.push_back(target);
+        }
+        size_t first = 0;
+        for (BatchGroup& group : m_groups) { group.firstRange = first; first += group.rangeCount; group.rangeCount = 0; }
+        m_ranges.resize(m_runs.size());
+        for (size_t i = 0; i < m_runs.size(); ++i) {
+            BatchGroup& group = m_groups[m_runGroup[i]];
+            m_ranges[group.firstRange + group.rangeCount++] = {m_runs[i].firstQuad, m_runs[i].quads};
+        }
+    }
+    
+public:
+    // Drawing calls from a thread recording a draw list for this renderer go to the list.
+    DrawList* recording() const { return t_recording && t_recording->renderer == this ? t_recording : nullptr; }
+    StateStack& states() { if (DrawList* list = recording()) return list->states; return m_states; }
+    explicit Renderer(std::unique_ptr<Backend> backend) : m_backend(std::move(backend)) {
+        m_textureSlots.reserve(MAX_TEXTURES);
+        State initialState; initialState.transform = glm::mat4(1.0f); initialState.color = {1,1,1,1}; m_states.push(initialState);
+    }
+    void beginFrame(int width, int height, TraceClock::time_point start) {
+        m_vertexCount = 0; m_runs.clear(); m_bounding = nullptr; resetTextureSlots(); if (m_slotOf.size() > MAX_SLOT_ENTRIES) m_slotOf.clear();
+        m_stats = {}; m_stats.frame = ++m_frameCount; m_frameStart = start;
+        m_viewportWidth = width; m_viewportHeight = height; m_backend->beginFrame(width, height);
+    }
+    // Publishes the frame's stats. GPU time comes from the newest frame whose timer queries
+    // have finished, typically a couple of frames back, and stays -1 until one has.
+    void endFrame() {
+        m_backend->endFrame();
+        double gpuMs = 0.0; const bool gpuArrived = m_backend->pollDrawTime(gpuMs); if (gpuArrived) m_gpuMs = gpuMs;
+        const TraceClock::time_point now = TraceClock::now();
+        m_stats.gpu_ms = m_gpuMs; m_stats.cpu_frame_ms = millisecondsBetween(m_frameStart, now); m_lastStats = m_stats;
+        if (tracing()) {
+            traceComplete("frame", m_frameStart, now);
+            traceCounter("batch", {{"flushes", (double)m_stats.flushes}, {"draw_calls", (double)m_stats.draw_calls}, {"texture_evictions", (double)m_stats.texture_evictions}});
+            traceCounter("vertices", {{"vertices", (double)m_stats.vertices}, {"upload_bytes", (double)m_stats.upload_bytes}});
+            if (gpuArrived) traceCounter("gpu_ms", {{"gpu_ms", gpuMs}});
+        }
+        if (logEnabled(SP_LOG_LEVEL_DEBUG)) {
+            char line[256];
+            std::snprintf(line, sizeof(line), "frame %llu: %.3f ms cpu, %.3f ms gpu, %u flushes, %u draws, %llu vertices, %llu bytes uploaded, %u texture evictions",
+                          (unsigned long long)m_stats.frame, m_stats.cpu_frame_ms, m_stats.gpu_ms, m_stats.flushes, m_stats.draw_calls,
+                          (unsigned long long)m_stats.vertices, (unsigned long long)m_stats.upload_bytes, m_stats.texture_evictions);
+            logMessage(SP_LOG_LEVEL_DEBUG, line);
+        }
+    }
+    sp_frame_stats_t& stats() { if (DrawList* list = recording()) return list->stats; return m_stats; }
+    Backend& backend() { return *m_backend; }
+    bool lastFrameStats(sp_frame_stats_t& out) const { out = m_lastStats; return m_lastStats.frame != 0; }
+    void flush() {
+        if (m_vertexCount == 0) { m_runs.clear(); m_bounding = nullptr; resetTextureSlots(); return; }
+        ScopedTimer timer("flush");
+        groupRuns();
+        m_stats.flushes++; m_stats.draw_calls += (uint32_t)m_groups.size(); m_stats.vertices += m_vertexCount; m_stats.upload_bytes += m_vertexCount * sizeof(Vertex);
+        m_backend->drawBatch(m_vertexCount, m_textureSlots, m_ranges, m_groups); m_mapped = nullptr;
+        m_vertexCount = 0; m_runs.clear(); m_bounding = nullptr; resetTextureSlots();
+    }
+    uint8_t getTextureSlot(GLuint textureId) {
+        if (DrawList* list = recording()) return list->textureSlot(textureId);
+        if (m_capture) {
+            auto& slots = m_capture->textureSlots;
+            for (size_t i=0; i<slots.size(); ++i) if (slots[i] == textureId) return (uint8_t)i;
+            if (slots.size() >= MAX_TEXTURES) { m_capture->overflowed = true; return NO_TEXTURE_SLOT; }
+            slots.push_back(textureId); return (uint8_t)(slots.size() - 1);
+        }
+        const uint8_t slot = findTextureSlot(textureId); if (slot != NO_TEXTURE_SLOT) return slot;
+        if (m_textureSlots.size() >= MAX_TEXTURES) { m_stats.texture_evictions++; flush(); }
         m_textureSlots.push_back(textureId);
-        return (float)m_textureSlots.size() - 1.0f;
+        const uint8_t added = (uint8_t)(m_textureSlots.size() - 1); m_slotOf[textureId] = {m_batch, added};
+        return added;
     }
-    void addQuad(const glm::vec4& p1, const glm::vec4& p2, const glm::vec4& p3, const glm::vec4& p4, const glm::vec4& color, float texId, const glm::vec4& texCoords) {
-        if (m_vertices.size()+6 > MAX_VERTICES) flush();
-        m_vertices.push_back({{p1.x,p1.y},color,{texCoords.x,texCoords.y},texId}); m_vertices.push_back({{p2.x,p2.y},color,{texCoords.z,texCoords.y},texId});
-        m_vertices.push_back({{p3.x,p3.y},color,{texCoords.z,texCoords.w},texId}); m_vertices.push_back({{p1.x,p1.y},color,{texCoords.x,texCoords.y},texId});
-        m_vertices.push_back({{p3.x,p3.y},color,{texCoords.z,texCoords.w},texId}); m_vertices.push_back({{p4.x,p4.y},color,{texCoords.x,texCoords.w},texId});
+    // Meshes are recorded in local coordinates and transformed when drawn.
+    Affine2D currentTransform() {
+        if (isCapturing()) return {};
+        const glm::mat4& t = states().top().transform;
+        return {t[0][0], t[0][1], t[1][0], t[1][1], t[3][0], t[3][1]};
+    }
+    // Device pixels per unit along the transform's most stretched direction, so that anything
+    // flattened for it is within tolerance in every direction.
+    float maxScale() {
+        const Affine2D t = currentTransform();
+        const float sum = t.a*t.a + t.b*t.b + t.c*t.c + t.d*t.d, det = t.a*t.d - t.b*t.c;
+        return std::sqrt(0.5f * (sum + std::sqrt(std::max(sum*sum - 4.0f*det*det, 0.0f))));
+    }
+    // Room for up to `quads` quads (at least one, fewer if the batch fills up) in the current batch
+    // capture or draw list. Returns null only if the stream window could not be mapped.
+    Vertex* allocateQuads(size_t& quads) {
+        if (DrawList* list = recording()) { m_bounding = nullptr; return list->allocateQuads(quads); }
+        if (m_capture) {
+            m_bounding = nullptr;
+            auto& vertices = m_capture->vertices; vertices.resize(vertices.size() + quads * VERTICES_PER_QUAD);
+            return &vertices[vertices.size() - quads * VERTICES_PER_QUAD];
+        }
+        return allocateBatchQuads(quads, m_states.top().blend_mode);
+    }
+    // Emits the 4 corners only; triangles come from the shared quad index buffer.
+    void addQuad(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec2 p4, uint32_t color, uint8_t texSlot, const glm::vec4& texCoords, uint8_t texMode = TEXTURE_MODE_ALPHA) {
+        size_t quads = 1; Vertex* out = allocateQuads(quads); if (!out) return;
+        const Affine2D t = currentTransform(); const glm::vec2 a = t.apply(p1), b = t.apply(p2), c = t.apply(p3), d = t.apply(p4);
+        out[0] = makeVertex(a,color,texCoords.x,texCoords.y,texSlot,texMode); out[1] = makeVertex(b,color,texCoords.z,texCoords.y,texSlot,texMode);
+        out[2] = makeVertex(c,color,texCoords.z,texCoords.w,texSlot,texMode); out[3] = makeVertex(d,color,texCoords.x,texCoords.w,texSlot,texMode);
+        touch(a); touch(b); touch(c); touch(d);
+    }
+    // A cached glyph run with its pen origin at (x, y) on the baseline.
+    void drawText(GlyphAtlas& atlas, const TextLayout& layout, float x, float y, uint32_t color) {
+        for (const GlyphQuad& q : layout.quads) {
+            const uint8_t slot = getTextureSlot(m_backend->glyphTexture(atlas, q.page));
+            addQuad({x+q.x0,y+q.y0},{x+q.x1,y+q.y0},{x+q.x1,y+q.y1},{x+q.x0,y+q.y1},color,slot,{q.s0,q.t0,q.s1,q.t1},TEXTURE_MODE_SDF);
+        }
+    }
+    // The visible part of a large x-sorted path, at most 4 points per device column. Only valid
+    // while x maps straight onto columns (no rotation/shear) and outside mesh capture, where the
+    // final transform is not known yet; captured strokes get here when their mesh is drawn.
+    // Returns null when the path must be drawn as is.
+    const std::vector<sp_vec2_t>* decimate(const LodPyramid* lod, const sp_vec2_t* points, size_t pointCount) {
+        const Affine2D t = currentTransform(); DrawList* list = recording();
+        if (!lod || isCapturing() || m_viewportWidth <= 0 || t.b != 0.0f || t.c != 0.0f || t.a == 0.0f) return nullptr;
+        std::vector<sp_vec2_t>& out = list ? list->lodPoints : m_lodPoints;
+        lod->decimate(points, pointCount, t.a, t.e, m_viewportWidth, out);
+        return &out;
+    }
+    static constexpr float HAIRLINE_WIDTH = 1.0f;
+    // Joined, capped ribbon for a path. Strokes at most a pixel wide on screen cannot show their
+    // joins or caps, so they take the SIMD per-segment path instead.
+    void strokePath(const sp_vec2_t* points, size_t pointCount, bool closed, const sp_pen_config_t& pen, uint32_t color) {
+        const Affine2D t = currentTransform();
+        const float pixelScale = std::sqrt(std::abs(t.a * t.d - t.b * t.c)), halfWidth = pen.line_width / 2.0f;
+        if (pen.line_width * pixelScale <= HAIRLINE_WIDTH && !closed) { strokePolyline(points, pointCount, halfWidth, color); return; }
+        auto emit = [&](glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d) {
+            size_t quads = 1; Vertex* out = allocateQuads(quads); if (!out) return;
+            const glm::vec2 p[4] = {t.apply(a), t.apply(b), t.apply(c), t.apply(d)};
+            for (int i = 0; i < 4; ++i) { out[i] = makeVertex(p[i], color, 0.0f, 0.0f, NO_TEXTURE_SLOT); touch(p[i]); }
+        };
+        Stroker<decltype(emit)> stroker({halfWidth, pen.line_cap, pen.line_join, pen.miter_limit}, pixelScale, emit);
+        stroker.stroke(points, pointCount, closed);
+    }
+    // One quad per segment, written by the SIMD kernel straight into the batch in batch-sized runs.
+    void strokePolyline(const sp_vec2_t* points, size_t pointCount, float halfWidth, uint32_t color) {
+        if (pointCount < 2) return;
+        const StrokeParams params{halfWidth, currentTransform(), color};
+        for (size_t first = 0, remaining = pointCount - 1; remaining > 0;) {
+            size_t quads = remaining; Vertex* out = allocateQuads(quads); if (!out) return;
+            strokeSegments(points + first, quads, params, out);
+            if (m_bounding) touchPoints(points + first, quads + 1, halfWidth);
+            first += quads; remaining -= quads;
+        }
+    }
+    // Grows the bounds by the corners of the points' local box, padded by the stroke's reach.
+    void touchPoints(const sp_vec2_t* points, size_t count, float halfWidth) {
+        glm::vec2 lo(points[0].x, points[0].y), hi = lo;
+        for (size_t i = 1; i < count; ++i) { lo = glm::min(lo, glm::vec2(points[i].x, points[i].y)); hi = glm::max(hi, glm::vec2(points[i].x, points[i].y)); }
+        const Affine2D t = currentTransform(); const float pad = halfWidth * maxScale();
+        for (glm::vec2 p : {t.apply(lo), t.apply(hi), t.apply({lo.x, hi.y}), t.apply({hi.x, lo.y})}) { touch(p - glm::vec2(pad)); touch(p + glm::vec2(pad)); }
+    }
+    std::vector<sp_vec2_t> ellipsePoints(glm::vec2 center, glm::vec2 radii) {
+        const Affine2D t = currentTransform();
+        const float pixelScale = std::sqrt(std::abs(t.a * t.d - t.b * t.c));
+        const size_t n = ellipseSegments(std::max(std::abs(radii.x), std::abs(radii.y)) * pixelScale);
+        std::vector<sp_vec2_t> points(n + 1);
+        for (size_t i = 0; i < n; ++i) {
+            const float angle = TWO_PI * (float)i / (float)n;
+            points[i] = {center.x + radii.x * std::cos(angle), center.y + radii.y * std::sin(angle)};
+        }
+        points[n] = points[0]; return points;
+    }
+    // A fan around the center, two triangles per quad: (c, p0, p1) and (c, p1, p2).
+    void fillEllipse(glm::vec2 center, glm::vec2 radii, uint32_t color) {
+        const std::vector<sp_vec2_t> points = ellipsePoints(center, radii); const Affine2D t = currentTransform();
+        const glm::vec2 c = t.apply(center);
+        auto corner = [&](size_t i) { const glm::vec2 p = t.apply({points[i].x, points[i].y}); touch(p); return makeVertex(p, color, 0.0f, 0.0f, NO_TEXTURE_SLOT); };
+        for (size_t first = 0, remaining = (points.size() - 1) / 2; remaining > 0;) {
+            size_t quads = remaining; Vertex* out = allocateQuads(quads); if (!out) return;
+            for (size_t q = 0; q < quads; ++q, first += 2) {
+                out[q*4] = makeVertex(c, color, 0.0f, 0.0f, NO_TEXTURE_SLOT); out[q*4+1] = corner(first); out[q*4+2] = corner(first+1); out[q*4+3] = corner(first+2);
+            }
+            remaining -= quads;
+        }
+    }
+    static const size_t MAX_EAR_CLIP_POINTS = 256;
+    // Outlines the CPU can triangulate join the batch like any other geometry: convex ones as a
+    // fan, small simple ones by ear clipping. The rest are drawn by the backend on their own
+    // (flushing first to keep painter's order) and are left out of captured meshes, which
+    // only hold triangles.
+    void fillPath(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, uint32_t color) {
+        DrawList* list = recording(); FillScratch& scratch = list ? list->fill : m_fill;
+        std::vector<sp_vec2_t>& outline = scratch.outline; outline.clear();
+        const Affine2D t = currentTransform();
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec2 p = t.apply({points[i].x, points[i].y});
+            if (outline.empty() || p.x != outline.back().x || p.y != outline.back().y) outline.push_back({p.x, p.y});
+        }
+        while (outline.size() > 1 && outline.back().x == outline.front().x && outline.back().y == outline.front().y) outline.pop_back();
+        if (outline.size() < 3) return;
+        auto corner = [&](size_t i) { touch({outline[i].x, outline[i].y}); return makeVertex({outline[i].x, outline[i].y}, color, 0.0f, 0.0f, NO_TEXTURE_SLOT); };
+        if (isConvex(outline.data(), outline.size())) {
+            // Quad q covers (p0, pk, pk+1) and (p0, pk+1, pk+2) for k = 2q + 1.
+            const size_t last = outline.size() - 1;
+            for (size_t k = 1, remaining = (outline.size() - 1) / 2; remaining > 0;) {
+                size_t quads = remaining; Vertex* out = allocateQuads(quads); if (!out) return;
+                for (size_t q = 0; q < quads; ++q, k += 2) { out[q*4] = corner(0); out[q*4+1] = corner(k); out[q*4+2] = corner(k+1); out[q*4+3] = corner(std::min(k+2, last)); }
+                remaining -= quads;
+            }
+            return;
+        }
+        if (outline.size() <= MAX_EAR_CLIP_POINTS && isSimple(outline.data(), outline.size()) && scratch.clipper.triangulate(outline.data(), outline.size())) {
+            // One triangle per quad, its last corner repeated.
+            const std::vector<uint32_t>& triangles = scratch.clipper.triangles();
+            for (size_t first = 0, remaining = triangles.size() / 3; remaining > 0;) {
+                size_t quads = remaining; Vertex* out = allocateQuads(quads); if (!out) return;
+                for (size_t q = 0; q < quads; ++q, first += 3) {
+                    out[q*4] = corner(triangles[first]); out[q*4+1] = corner(triangles[first+1]); out[q*4+2] = out[q*4+3] = corner(triangles[first+2]);
+                }
+                remaining -= quads;
+            }
+            return;
+        }
+        if (isCapturing()) return;
+        const sp_blend_mode_t blend = states().top().blend_mode;
+        if (list) { list->items.push_back(DrawList::Fill{outline, rule, color, blend}); return; }
+        drawFill(outline.data(), outline.size(), rule, color, blend);
+    }
+    void drawFill(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, uint32_t color, sp_blend_mode_t blend) {
+        if (count < 3 || m_viewportWidth <= 0 || m_viewportHeight <= 0) return;
+        flush();
+        m_stats.draw_calls += (uint32_t)m_backend->fillPath(points, count, rule, color, blend, m_stats.upload_bytes);
+        m_stats.vertices += count + VERTICES_PER_QUAD;
+    }
+    bool isCapturing() const { return !recording() && m_capture != nullptr; }
+    bool beginCapture() {
+        if (recording() || m_capture) return false;
+        m_capture = std::make_unique<MeshCapture>(); return true;
+    }
+    Mesh* endCapture() {
+        if (!m_capture) return nullptr;
+        std::unique_ptr<MeshCapture> capture = std::move(m_capture);
+        if (capture->overflowed) return nullptr;
+        Mesh* mesh = m_backend->createMesh(capture->vertices, std::move(capture->textureSlots), m_stats.upload_bytes);
+        mesh->strokes = std::move(capture->strokes); return mesh;
+    }
+    // Takes a stroke of a large x-sorted path into the mesh being captured as a MeshStroke.
+    void captureStroke(std::shared_ptr<const std::vector<sp_vec2_t>> points, std::shared_ptr<const LodPyramid> lod, const sp_pen_config_t& pen, uint32_t color) {
+        const size_t firstQuad = m_capture->vertices.size() / VERTICES_PER_QUAD;
+        m_capture->strokes.push_back({firstQuad, std::move(points), std::move(lod), m_states.top().transform, pen, color});
+    }
+    // Retained geometry keeps its own VBO, so a redraw is one draw call with no CPU tessellation.
+    // The pending batch is flushed first to keep painter's order. Captured strokes are
+    // decimated for this draw's transform and viewport and go through the batch in between.
+    void drawMesh(const Mesh& mesh, const glm::mat4& transform, sp_blend_mode_t blend) {
+        size_t quad = 0;
+        for (const MeshStroke& stroke : mesh.strokes) {
+            drawMeshQuads(mesh, quad, stroke.firstQuad - quad, transform, blend);
+            State& state = m_states.top(); const State saved = state; state.transform = transform * stroke.transform; state.blend_mode = blend;
+            const sp_vec2_t* points = stroke.points->data(); size_t count = stroke.points->size();
+            if (auto decimated = decimate(stroke.lod.get(), points, count)) { points = decimated->data(); count = decimated->size(); }
+            if (count > 0) strokePath(points, count, false, stroke.pen, stroke.color);
+            state = saved; quad = stroke.firstQuad;
+        }
+        drawMeshQuads(mesh, quad, (size_t)mesh.vertexCount / VERTICES_PER_QUAD - quad, transform, blend);
+    }
+    void drawMeshQuads(const Mesh& mesh, size_t firstQuad, size_t quadCount, const glm::mat4& transform, sp_blend_mode_t blend) {
+        if (quadCount == 0) return;
+        flush();
+        m_stats.draw_calls += (uint32_t)m_backend->drawMesh(mesh, firstQuad, quadCount, transform, blend); m_stats.vertices += (uint64_t)(quadCount * VERTICES_PER_QUAD);
+    }
+    // A captured stroke tessellated in full, as drawn under the identity transform.
+    void tessellateStroke(const MeshStroke& stroke, std::vector<Vertex>& out) {
+        std::unique_ptr<MeshCapture> outer = std::move(m_capture); m_capture = std::make_unique<MeshCapture>();
+        State& state = m_states.top(); const State saved = state; state.transform = stroke.transform;
+        strokePath(stroke.points->data(), stroke.points->size(), false, stroke.pen, stroke.color);
+        out = std::move(m_capture->vertices); m_capture = std::move(outer); state = saved;
+    }
+    // The series' window as per-segment quads through the batch, for draw lists and meshes.
+    // The ring holds it in at most two runs; the segment joining them is stroked on its own.
+    void strokeSeries(const Series& series, float halfWidth, uint32_t color) {
+        const size_t window = series.size(), ring = series.samples.size(); if (window < 2) return;
+        const size_t start = (size_t)((series.total - window) % ring), head = std::min(window, ring - start);
+        const sp_vec2_t* samples = series.samples.data();
+        strokePolyline(samples + start, head, halfWidth, color);
+        if (head == window) return;
+        const sp_vec2_t bridge[2] = {samples[ring - 1], samples[0]};
+        strokePolyline(bridge, 2, halfWidth, color);
+        strokePolyline(samples, window - head, halfWidth, color);
+    }
+    // Brings the series' ring mesh up to date with the samples appended since its last draw,
+    // then draws the whole window as one mesh translated into place.
+    void drawSeries(Series& series, float halfWidth, uint32_t color, sp_blend_mode_t blend) {
+        const size_t window = series.size(); if (window < 2) return;
+        const Affine2D t = currentTransform();
+        const StrokeParams params{halfWidth, {t.a, t.b, t.c, t.d, 0.0f, 0.0f}, color};
+        const StrokeParams& old = series.params; const Affine2D& o = old.transform;
+        if (old.halfWidth != params.halfWidth || old.color != params.color || o.a != t.a || o.b != t.b || o.c != t.c || o.d != t.d) { series.params = params; series.tessellated = 0; }
+        // The update may stage through the batch stream, so the pending batch goes first.
+        flush();
+        if (!series.mesh) series.mesh = m_backend->createStreamingMesh(series.capacity * VERTICES_PER_QUAD, m_stats.upload_bytes);
+        // New segments start at the last tessellated sample, or at the oldest one in the window.
+        const uint64_t first = series.total - window, from = series.tessellated > first ? series.tessellated - 1 : first;
+        if (series.total - from >= 2) {
+            const size_t segments = (size_t)(series.total - from - 1);
+            m_seriesPoints.resize(segments + 1); for (size_t i = 0; i <= segments; ++i) m_seriesPoints[i] = series.sample(from + i);
+            m_seriesVertices.resize(segments * VERTICES_PER_QUAD);
+            strokeSegments(m_seriesPoints.data(), segments, params, m_seriesVertices.data());
+            for (size_t done = 0; done < segments;) {
+                const size_t slot = (size_t)((from + done) % series.capacity), n = std::min(segments - done, series.capacity - slot);
+                m_backend->updateMesh(*series.mesh, slot * VERTICES_PER_QUAD, &m_seriesVertices[done * VERTICES_PER_QUAD], n * VERTICES_PER_QUAD, m_stats.upload_bytes);
+                done += n;
+            }
+        }
+        series.tessellated = series.total;
+        series.mesh->vertexCount = (GLsizei)((window - 1) * VERTICES_PER_QUAD); series.mesh->indexCount = (GLsizei)((window - 1) * INDICES_PER_QUAD);
+        drawMesh(*series.mesh, glm::translate(glm::mat4(1.0f), glm::vec3(t.e, t.f, 0.0f)), blend);
+    }
+    // Markers go through their own instanced pipeline: one draw for the whole array, with the
+    // centers transformed on the GPU. The pending batch is flushed first to keep painter's order.
+    void drawMarkers(const sp_marker_t* markers, size_t count, const glm::mat4& transform, sp_blend_mode_t blend) {
+        if (count == 0 || m_viewportWidth <= 0 || m_viewportHeight <= 0) return;
+        flush();
+        const size_t draws = m_backend->drawMarkers(markers, count, transform, blend); if (draws == 0) return;
+        m_stats.draw_calls += (uint32_t)draws; m_stats.vertices += count * 4; m_stats.upload_bytes += count * sizeof(sp_marker_t);
+    }
+    // Clears are not batched, so whatever is pending is drawn first.
+    void clear(sp_color_rgba_t color) { flush(); m_backend->clear(color); }
+    // Replays a recorded list in order on the render thread. Consecutive geometry from any
+    // number of lists shares the batch, so submitting many lists costs one copy into the
+    // stream and only the draws their textures and commands require.
+    void submit(const DrawList& list) {
+        ScopedTimer timer("submit_draw_list");
+        for (const DrawList::Item& item : list.items) {
+            if (auto g = std::get_if<DrawList::Geometry>(&item)) appendGeometry(list.vertices.data() + g->first, g->count, g->textures, g->blend);
+            else if (auto t = std::get_if<DrawList::Text>(&item)) {
+                State& state = m_states.top(); const State saved = state; state.transform = t->transform; state.blend_mode = t->blend;
+                drawText(*t->font->atlas, t->font->atlas->layout(t->text.c_str(), t->size), t->x, t->y, t->color);
+                state = saved;
+            }
+            else if (auto m = std::get_if<DrawList::MeshDraw>(&item)) drawMesh(*m->mesh, m->transform, m->blend);
+            else if (auto k = std::get_if<DrawList::Markers>(&item)) drawMarkers(k->markers.data(), k->markers.size(), k->transform, k->blend);
+            else if (auto c = std::get_if<DrawList::Clear>(&item)) clear(c->color);
+            else if (auto f = std::get_if<DrawList::Fill>(&item)) drawFill(f->points.data(), f->points.size(), f->rule, f->color, f->blend);
+        }
+        m_stats.stroke_ms += list.stats.stroke_ms; m_stats.texture_evictions += list.stats.texture_evictions;
+    }
+};
+
+class Framebuffer {
+private:
+    struct Readback { GLuint pbo = 0; GLsync fence = nullptr; uint64_t ticket = 0; };
+    GLuint m_fbo = 0, m_colorTexture = 0, m_depthStencil = 0;
+    int m_width = 0, m_height = 0;
+    std::vector<Readback> m_readbacks;
+    uint64_t m_nextTicket = 1;
+
+    size_t byteSize() const { return (size_t)m_width * m_height * 4; }
+    Readback* findReadback(uint64_t ticket) {
+        if (ticket == 0) return nullptr;
+        for (auto& rb : m_readbacks) if (rb.ticket == ticket) return &rb;
+        return nullptr;
+    }
+    void releaseReadback(Readback& rb) { if (rb.fence) glDeleteSync(rb.fence); rb.fence = nullptr; rb.ticket = 0; }
+    void allocate() {
+        glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        // Path fills count windings in the stencil. Only packed depth-stencil is guaranteed
+        // renderable on every 3.3 driver; the depth half goes unused.
+        glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencil);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        if (m_fbo) clearStencil();
+        for (auto& rb : m_readbacks) {
+            releaseReadback(rb);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.pbo); glBufferData(GL_PIXEL_PACK_BUFFER, byteSize(), nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    // Fills leave the stencil at zero behind them, so it only needs clearing when storage is new.
+    void clearStencil() {
+        GLint previous = 0; glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo); glStencilMask(0xFF); glClearStencil(0); glClear(GL_STENCIL_BUFFER_BIT);
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previous);
+    }
+    // GL rows run bottom-up; the public API hands out top-down RGBA rows.
+    void copyFlipped(const uint8_t* src, uint8_t* dst) const {
+        const size_t stride = (size_t)m_width * 4;
+        for (int y = 0; y < m_height; ++y) std::copy_n(src + (size_t)(m_height - 1 - y) * stride, stride, dst + (size_t)y * stride);
+    }
+
+public:
+    Framebuffer(int width, int height, int readbackBuffers) : m_width(std::max(width, 1)), m_height(std::max(height, 1)), m_readbacks(std::max(readbackBuffers, 1)) {
+        glGenTextures(1, &m_colorTexture); glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        for (auto& rb : m_readbacks) glGenBuffers(1, &rb.pbo);
+        glGenRenderbuffers(1, &m_depthStencil);
+        allocate();
+        glGenFramebuffers(1, &m_fbo); glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthStencil);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) throw std::runtime_error("offscreen framebuffer is incomplete");
+        clearStencil();
+    }
+    ~Framebuffer() {
+        for (auto& rb : m_readbacks) { releaseReadback(rb); glDeleteBuffers(1, &rb.pbo); }
+        glDeleteFramebuffers(1, &m_fbo); glDeleteRenderbuffers(1, &m_depthStencil); glDeleteTextures(1, &m_colorTexture);
+    }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    void resize(int width, int height) {
+        if (width <= 0 || height <= 0 || (width == m_width && height == m_height)) return;
+        m_width = width; m_height = height; allocate();
+    }
+    void bind() { glBindFramebuffer(GL_FRAMEBUFFER, m_fbo); }
+    void blitToDefault(int width, int height) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo); glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    bool readPixels(uint8_t* rgba, size_t size) {
+        if (!rgba || size < byteSize()) return false;
+        std::vector<uint8_t> pixels(byteSize());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo); glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        copyFlipped(pixels.data(), rgba);
+        return true;
+    }
+    uint64_t requestReadback() {
+        auto slot = std::find_if(m_readbacks.begin(), m_readbacks.end(), [](const Readback& rb) { return rb.ticket == 0; });
+        if (slot == m_readbacks.end()) return 0;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo); glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+        glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (g_glCaps.sync) slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        slot->ticket = m_nextTicket++;
+        return slot->ticket;
+    }
+    sp_readback_status_t pollReadback(uint64_t ticket) {
+        Readback* rb = findReadback(ticket);
+        if (!rb) return SP_READBACK_INVALID;
+        if (!rb->fence) return SP_READBACK_READY;
+        GLenum result = glClientWaitSync(rb->fence, 0, 0);
+        return (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) ? SP_READBACK_READY : SP_READBACK_PENDING;
+    }
+    bool fetchReadback(uint64_t ticket, uint8_t* rgba, size_t size) {
+        Readback* rb = findReadback(ticket);
+        if (!rb || !rgba || size < byteSize()) return false;
+        if (rb->fence) {
+            GLenum result;
+            do { result = glClientWaitSync(rb->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull); } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo);
+        auto mapped = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, byteSize(), GL_MAP_READ_BIT));
+        if (mapped) { copyFlipped(mapped, rgba); glUnmapBuffer(GL_PIXEL_PACK_BUFFER); }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        releaseReadback(*rb);
+        return mapped != nullptr;
     }
 };
 
+#ifdef SPIRO_HAS_EGL
+static EGLDisplay g_eglDisplay = EGL_NO_DISPLAY;
+
+// Prefers Mesa's surfaceless platform so no X11/Wayland server is needed, then falls back to
+// whatever the default display is (e.g. a vendor driver exposing EGL_KHR_surfaceless_context).
+static EGLDisplay acquireEglDisplay() {
+    if (g_eglDisplay != EGL_NO_DISPLAY) return g_eglDisplay;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay candidates[2] = {
+        getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY,
+        eglGetDisplay(EGL_DEFAULT_DISPLAY)};
+    for (EGLDisplay dpy : candidates) {
+        if (dpy != EGL_NO_DISPLAY && eglInitialize(dpy, nullptr, nullptr)) { g_eglDisplay = dpy; break; }
+    }
+    return g_eglDisplay;
+}
+
+static void releaseEglDisplay() {
+    if (g_eglDisplay == EGL_NO_DISPLAY) return;
+    eglTerminate(g_eglDisplay); g_eglDisplay = EGL_NO_DISPLAY;
+}
+
+// A surfaceless 3.3 core context, current on return, sharing objects with `share` unless that
+// is EGL_NO_CONTEXT. EGL_NO_CONTEXT if there is no display or the driver refuses.
+static EGLContext createEglContext(EGLContext share) {
+    EGLDisplay dpy = acquireEglDisplay();
+    if (dpy == EGL_NO_DISPLAY || !eglBindAPI(EGL_OPENGL_API)) return EGL_NO_CONTEXT;
+    const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig eglConfig; EGLint numConfigs = 0;
+    if (!eglChooseConfig(dpy, configAttribs, &eglConfig, 1, &numConfigs) || numConfigs == 0) return EGL_NO_CONTEXT;
+    const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                     EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+    EGLContext context = eglCreateContext(dpy, eglConfig, share, contextAttribs);
+    if (context == EGL_NO_CONTEXT) return EGL_NO_CONTEXT;
+    if (!eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) { eglDestroyContext(dpy, context); return EGL_NO_CONTEXT; }
+    return context;
+}
+
+static void destroyEglContext(EGLContext& context) {
+    if (context == EGL_NO_CONTEXT) return;
+    eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(g_eglDisplay, context); context = EGL_NO_CONTEXT;
+}
+#endif
+
+// A hidden 1x1 window whose context only ever renders into framebuffer objects, current on
+// return and sharing objects with `share` if given. Null if GLFW cannot create one.
+static GLFWwindow* createHiddenWindow(GLFWwindow* share) {
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1, 1, "", nullptr, share);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (window) { glfwMakeContextCurrent(window); glfwSwapInterval(0); }
+    return window;
+}
+
+// Whatever context is current on this thread, to go back to after working in another.
+struct CurrentContext {
+#ifdef SPIRO_HAS_EGL
+    EGLContext egl = eglGetCurrentContext();
+#endif
+    GLFWwindow* window = glfwGetCurrentContext();
+    void restore() const {
+#ifdef SPIRO_HAS_EGL
+        if (egl != EGL_NO_CONTEXT) { eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, egl); return; }
+#endif
+        if (window) glfwMakeContextCurrent(window);
+    }
+};
+
+// Resources shared by the canvases created on it (sp_device_t). Every canvas context shares
+// objects with the device's own windowless one, so the batch program, the quad indices and the
+// textures behind fonts and synchronously loaded images exist once however many canvases draw
+// with them. Fonts and images loaded from files are cached by the hash and size of their bytes:
+// ten windows loading the same font get one glyph atlas. Canvases, fonts and images keep the
+// device alive, so it goes with the last of them and the caller's handle. Its canvases share
+// the program's uniforms and must be drawn from one thread, though their draws may interleave.
+struct Device {
+    // Hidden-window devices can share with window canvases; EGL ones only with offscreen ones.
+    GLFWwindow* window = nullptr;
+#ifdef SPIRO_HAS_EGL
+    EGLContext eglContext = EGL_NO_CONTEXT;
+#endif
+    std::shared_ptr<BatchProgram> program; std::unique_ptr<ImageAtlas> images;
+    using ContentKey = std::pair<uint64_t, uint64_t>;
+    std::map<ContentKey, std::weak_ptr<GlyphAtlas>> fonts; std::map<ContentKey, std::weak_ptr<DeviceImage>> cachedImages;
+    size_t canvases = 0;
+
+    // Makes the device's context current for its lifetime, then puts back the previous one.
+    struct Scope {
+        CurrentContext previous; explicit Scope(Device& device) { device.makeCurrent(); } ~Scope() { previous.restore(); }
+    };
+    explicit Device(bool offscreen) {
+        const CurrentContext previous;
+        try {
+            GLADloadproc loader = nullptr;
+#ifdef SPIRO_HAS_EGL
+            if (offscreen && (eglContext = createEglContext(EGL_NO_CONTEXT)) != EGL_NO_CONTEXT) loader = (GLADloadproc)eglGetProcAddress;
+#endif
+            if (!loader) {
+                if (!(window = createHiddenWindow(nullptr))) throw std::runtime_error("glfwCreateWindow failed");
+                loader = (GLADloadproc)glfwGetProcAddress;
+            }
+            if (!gladLoadGLLoader(loader)) throw std::runtime_error("gladLoadGLLoader failed");
+            loadGLExtensions(loader);
+            program = BatchProgram::create(); images = std::make_unique<ImageAtlas>();
+        } catch (...) { program.reset(); destroyContext(); previous.restore(); throw; }
+        previous.restore();
+    }
+    ~Device() {
+        const CurrentContext previous; const bool wasCurrent = isCurrent(previous);
+        makeCurrent(); images.reset(); program.reset(); destroyContext();
+        if (!wasCurrent) previous.restore();
+    }
+    void makeCurrent() {
+#ifdef SPIRO_HAS_EGL
+        if (eglContext != EGL_NO_CONTEXT) { eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext); return; }
+#endif
+        if (glfwGetCurrentContext() != window) glfwMakeContextCurrent(window);
+    }
+    // Drops cache entries whose font or image has gone, so they do not pile up.
+    template <typename Cache> static void prune(Cache& cache) {
+        for (auto it = cache.begin(); it != cache.end();) it = it->second.expired() ? cache.erase(it) : std::next(it);
+    }
+
+private:
+    bool isCurrent(const CurrentContext& c) const {
+#ifdef SPIRO_HAS_EGL
+        if (eglContext != EGL_NO_CONTEXT) return c.egl == eglContext;
+#endif
+        return window && c.window == window;
+    }
+    void destroyContext() {
+#ifdef SPIRO_HAS_EGL
+        destroyEglContext(eglContext);
+#endif
+        if (window) { glfwDestroyWindow(window); window = nullptr; }
+    }
+};
+
+// A decoded image in the device's atlas, shared by every handle loaded from the same bytes.
+struct DeviceImage {
+    LoadedImage loaded; std::shared_ptr<Device> device;
+    ~DeviceImage() { Device::Scope scope(*device); device->images->release(loaded.region); }
+};
+
+// FNV-1a over the bytes, eight at a time, keying the device's font and image caches together
+// with the size.
+static uint64_t contentHash(const unsigned char* data, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ull; size_t i = 0;
+    for (; i + 8 <= size; i += 8) { uint64_t word; std::memcpy(&word, data + i, 8); h = (h ^ word) * 0x100000001b3ull; }
+    for (; i < size; ++i) h = (h ^ data[i]) * 0x100000001b3ull;
+    return h;
+}
+
+static std::shared_ptr<GlyphAtlas> loadDeviceFont(const std::shared_ptr<Device>& device, const char* path) {
+    MappedFile file(path); if (!file.data()) return nullptr;
+    const Device::ContentKey key{contentHash(file.data(), file.size()), file.size()};
+    if (auto atlas = device->fonts[key].lock()) return atlas;
+    auto atlas = GlyphAtlas::create(std::vector<unsigned char>(file.data(), file.data() + file.size())); if (!atlas) return nullptr;
+    // The glyph pages are textures in the device's share group.
+    std::shared_ptr<GlyphAtlas> shared(atlas.release(), [device](GlyphAtlas* a) { Device::Scope scope(*device); delete a; });
+    Device::prune(device->fonts); device->fonts[key] = shared;
+    return shared;
+}
+
+static std::shared_ptr<const DeviceImage> loadDeviceImage(const std::shared_ptr<Device>& device, const char* path) {
+    MappedFile file(path); if (!file.data() || file.size() > (size_t)INT32_MAX) return nullptr;
+    const Device::ContentKey key{contentHash(file.data(), file.size()), file.size()};
+    if (auto image = device->cachedImages[key].lock()) return image;
+    int w, h, chans; unsigned char* data = stbi_load_from_memory(file.data(), (int)file.size(), &w, &h, &chans, 4); if (!data) return nullptr;
+    auto image = std::make_shared<DeviceImage>(); image->device = device;
+    { Device::Scope scope(*device); image->loaded = {device->images->add(data, w, h), w, h}; }
+    stbi_image_free(data);
+    Device::prune(device->cachedImages); device->cachedImages[key] = image;
+    return image;
+}
+
 class Canvas {
 public:
-    GLFWwindow* m_window = nullptr; std::unique_ptr<Renderer> m_renderer;
+    // Declared first so it outlives everything below that lives in its share group.
+    std::shared_ptr<Device> m_device;
+    GLFWwindow* m_window = nullptr; std::unique_ptr<Renderer> m_renderer; std::unique_ptr<Framebuffer> m_framebuffer; std::unique_ptr<ImageAtlas> m_images; std::unique_ptr<ImageLoader> m_loader;
+#ifdef SPIRO_HAS_EGL
+    EGLContext m_eglContext = EGL_NO_CONTEXT;
+#endif
+    bool m_offscreen = false;
+    // Set on software canvases, which have no GL context, framebuffer or image atlas.
+    SoftwareRasterizer* m_software = nullptr; std::vector<uint8_t> m_ownedPixels;
+    // Transient paths and pens for the frame in progress; taken back by sp_begin_frame.
+    FramePool<Path> m_framePaths; FramePool<Pen> m_framePens;
     sp_key_callback_t key_cb=nullptr; sp_mouse_button_callback_t mouse_btn_cb=nullptr; sp_cursor_pos_callback_t cursor_pos_cb=nullptr;
-    Canvas(const sp_window_config_t& config) {
+    // What the next frame must redraw, in canvas pixels: everything, the box lo-hi, or nothing
+    // (an empty box). A frame begun with nothing invalidated redraws everything anyway.
+    bool m_damageAll = true; glm::vec2 m_damageLo{INFINITY}, m_damageHi{-INFINITY};
+    // Set when the window system asks for the window to be repainted.
+    bool m_refresh = false;
+    Canvas(const sp_window_config_t& config, std::shared_ptr<Device> device = nullptr) : m_device(std::move(device)) {
+        if (m_device && !m_device->window) throw std::runtime_error("an offscreen device cannot share with windows");
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
         
@@ -126,137 +1559,659 @@ public:
             glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
         }
 
-        m_window = glfwCreateWindow(config.width, config.height, config.title, nullptr, nullptr);
+        m_window = glfwCreateWindow(config.width, config.height, config.title, nullptr, m_device ? m_device->window : nullptr);
         if (!m_window) { throw std::runtime_error("glfwCreateWindow failed"); }
         glfwMakeContextCurrent(m_window);
         if (config.vsync) glfwSwapInterval(1);
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) throw std::runtime_error("gladLoadGLLoader failed");
-        m_renderer = std::make_unique<Renderer>();
+        try {
+            // A device has loaded the entry points, which are the same for its whole share group.
+            if (!m_device) {
+                if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) throw std::runtime_error("gladLoadGLLoader failed");
+                loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+            }
+            int w, h; glfwGetFramebufferSize(m_window, &w, &h);
+            m_framebuffer = std::make_unique<Framebuffer>(w, h, 1);
+            m_renderer = std::make_unique<Renderer>(std::make_unique<GlBackend>(program())); m_images = std::make_unique<ImageAtlas>();
+        }
+        catch (...) { m_renderer.reset(); m_framebuffer.reset(); destroyContext(); throw; }
         glfwSetWindowUserPointer(m_window, this);
+        glfwSetFramebufferSizeCallback(m_window, [](GLFWwindow* w, int, int) { static_cast<Canvas*>(glfwGetWindowUserPointer(w))->invalidate(); });
+        glfwSetWindowRefreshCallback(m_window, [](GLFWwindow* w) { static_cast<Canvas*>(glfwGetWindowUserPointer(w))->m_refresh = true; });
+        if (m_device) m_device->canvases++;
+    }
+    Canvas(const sp_offscreen_config_t& config, std::shared_ptr<Device> device = nullptr) : m_device(std::move(device)), m_offscreen(true) {
+        if (config.width <= 0 || config.height <= 0) throw std::runtime_error("invalid offscreen canvas size");
+        GLADloadproc loader = nullptr;
+#ifdef SPIRO_HAS_EGL
+        // A device has either an EGL context or a hidden window, and canvases follow it.
+        if (!m_device || m_device->eglContext != EGL_NO_CONTEXT) {
+            m_eglContext = createEglContext(m_device ? m_device->eglContext : EGL_NO_CONTEXT);
+            if (m_eglContext != EGL_NO_CONTEXT) loader = (GLADloadproc)eglGetProcAddress;
+            else if (m_device) throw std::runtime_error("eglCreateContext failed");
+        }
+#endif
+        if (!loader) {
+            // No EGL: fall back to a hidden 1x1 window whose context only ever renders into the FBO.
+            m_window = createHiddenWindow(m_device ? m_device->window : nullptr);
+            if (!m_window) { throw std::runtime_error("no EGL display and glfwCreateWindow failed"); }
+            loader = (GLADloadproc)glfwGetProcAddress;
+        }
+        if (!m_device) {
+            if (!gladLoadGLLoader(loader)) { destroyContext(); throw std::runtime_error("gladLoadGLLoader failed"); }
+            loadGLExtensions(loader);
+        }
+        int buffers = config.readback_buffers > 0 ? config.readback_buffers : 3;
+        try { m_framebuffer = std::make_unique<Framebuffer>(config.width, config.height, buffers); m_renderer = std::make_unique<Renderer>(std::make_unique<GlBackend>(program())); m_images = std::make_unique<ImageAtlas>(); }
+        catch (...) { m_renderer.reset(); m_framebuffer.reset(); destroyContext(); throw; }
+        if (m_device) m_device->canvases++;
+    }
+    Canvas(const sp_software_config_t& config) : m_offscreen(true) {
+        if (config.width <= 0 || config.height <= 0) throw std::runtime_error("invalid software canvas size");
+        const size_t stride = config.stride ? config.stride : (size_t)config.width * 4;
+        if (stride < (size_t)config.width * 4) throw std::runtime_error("software canvas stride is shorter than a row");
+        uint8_t* pixels = config.pixels;
+        if (!pixels) { m_ownedPixels.resize(stride * config.height); pixels = m_ownedPixels.data(); }
+        auto backend = std::make_unique<SoftwareBackend>(config.threads > 0 ? (unsigned)config.threads : 0u);
+        m_software = &backend->rasterizer(); m_software->setTarget(pixels, config.width, config.height, stride);
+        m_renderer = std::make_unique<Renderer>(std::move(backend));
+    }
+    bool damaged() const { return m_damageAll || (m_damageLo.x < m_damageHi.x && m_damageLo.y < m_damageHi.y); }
+    void invalidate() { m_damageAll = true; }
+    void invalidate(glm::vec2 lo, glm::vec2 hi) { m_damageLo = glm::min(m_damageLo, lo); m_damageHi = glm::max(m_damageHi, hi); }
+    // Starts a frame on the damage so far: only a partial damage box limits drawing, through
+    // the scissor. Later invalidations count towards the next frame.
+    void beginDamage(int w, int h) {
+        const bool partial = !m_damageAll && damaged() && !m_software;
+        if (partial) {
+            const int x0 = std::max((int)std::floor(m_damageLo.x), 0), x1 = std::min((int)std::ceil(m_damageHi.x), w);
+            const int y0 = std::max((int)std::floor(m_damageLo.y), 0), y1 = std::min((int)std::ceil(m_damageHi.y), h);
+            // Canvas rows run top-down, GL's bottom-up.
+            glEnable(GL_SCISSOR_TEST); glScissor(x0, h - std::max(y1, y0), std::max(x1 - x0, 0), std::max(y1 - y0, 0));
+        }
+        m_damageAll = false; m_damageLo = glm::vec2(INFINITY); m_damageHi = glm::vec2(-INFINITY);
+    }
+    // Shows the framebuffer's current contents in the window.
+    void present() { int w,h; glfwGetFramebufferSize(m_window,&w,&h); m_framebuffer->blitToDefault(w,h); glfwSwapBuffers(m_window); }
+    int width() const { return m_software ? m_software->width() : m_framebuffer->width(); }
+    int height() const { return m_software ? m_software->height() : m_framebuffer->height(); }
+    ~Canvas() { m_loader.reset(); makeCurrent(); m_images.reset(); m_renderer.reset(); m_framebuffer.reset(); destroyContext(); if (m_device) m_device->canvases--; }
+    void makeCurrent() {
+#ifdef SPIRO_HAS_EGL
+        if (m_eglContext != EGL_NO_CONTEXT) { if (eglGetCurrentContext() != m_eglContext) eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, m_eglContext); return; }
+#endif
+        if (m_window && glfwGetCurrentContext() != m_window) glfwMakeContextCurrent(m_window);
+    }
+
+private:
+    std::shared_ptr<const BatchProgram> program() const { return m_device ? m_device->program : nullptr; }
+    void destroyContext() {
+#ifdef SPIRO_HAS_EGL
+        destroyEglContext(m_eglContext);
+#endif
+        if (m_window) { glfwDestroyWindow(m_window); m_window = nullptr; }
     }
-    ~Canvas() { if (m_window) glfwDestroyWindow(m_window); }
 };
 }
 
 using namespace spiro::internal;
 
 static Canvas* as_canvas(sp_canvas_t* c) { return reinterpret_cast<Canvas*>(c); }
+static std::shared_ptr<Device>& as_device(sp_device_t* d) { return *reinterpret_cast<std::shared_ptr<Device>*>(d); }
 static Pen* as_pen(sp_pen_t* p) { return reinterpret_cast<Pen*>(p); }
 static Path* as_path(sp_path_t* p) { return reinterpret_cast<Path*>(p); }
 static Image* as_image(sp_image_t* i) { return reinterpret_cast<Image*>(i); }
 static Font* as_font(sp_font_t* f) { return reinterpret_cast<Font*>(f); }
+static Mesh* as_mesh(sp_mesh_t* m) { return reinterpret_cast<Mesh*>(m); }
+static Series* as_series(sp_series_t* s) { return reinterpret_cast<Series*>(s); }
+static DrawList* as_draw_list(sp_draw_list_t* l) { return reinterpret_cast<DrawList*>(l); }
+static Scene* as_scene(sp_scene_t* s) { return reinterpret_cast<Scene*>(s); }
+// The canvas's renderer for a draw call. Any draw may flush the batch, and canvases on one
+// device take turns with the GL context, so the canvas's own context is made current first;
+// draws recording into a draw list, possibly on another thread, leave it alone.
+static Renderer* as_drawing(sp_canvas_t* c) { auto cv=as_canvas(c); if (!cv->m_renderer->recording()) cv->makeCurrent(); return cv->m_renderer.get(); }
 
 void sp_initialize() { glfwInit(); }
-void sp_terminate() { glfwTerminate(); }
+void sp_terminate() {
+#ifdef SPIRO_HAS_EGL
+    releaseEglDisplay();
+#endif
+    glfwTerminate();
+}
 void sp_set_error_callback(sp_error_callback_t cb) { glfwSetErrorCallback(cb); }
-void sp_set_log_level(sp_log_level_t level) {}
+void sp_set_log_level(sp_log_level_t level) { setLogLevel(level); }
+bool sp_trace_begin(const char* path) { return traceBegin(path); }
+bool sp_trace_end() { return traceEnd(); }
 
 sp_canvas_t* sp_create_canvas(const sp_window_config_t* config) {
     if (!config) return nullptr;
     try { return reinterpret_cast<sp_canvas_t*>(new Canvas(*config)); }
-    catch (const std::exception& e) { std::cerr << "Canvas Creation Failed: " << e.what() << std::endl; return nullptr; }
+    catch (const std::exception& e) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Canvas Creation Failed: ") + e.what()); return nullptr; }
+}
+sp_canvas_t* sp_create_offscreen_canvas(const sp_offscreen_config_t* config) {
+    if (!config) return nullptr;
+    try { return reinterpret_cast<sp_canvas_t*>(new Canvas(*config)); }
+    catch (const std::exception& e) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Offscreen Canvas Creation Failed: ") + e.what()); return nullptr; }
+}
+sp_canvas_t* sp_create_software_canvas(const sp_software_config_t* config) {
+    if (!config) return nullptr;
+    try { return reinterpret_cast<sp_canvas_t*>(new Canvas(*config)); }
+    catch (const std::exception& e) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Software Canvas Creation Failed: ") + e.what()); return nullptr; }
 }
 void sp_destroy_canvas(sp_canvas_t* c) { delete as_canvas(c); }
-bool sp_canvas_should_close(sp_canvas_t* c) { return c ? glfwWindowShouldClose(as_canvas(c)->m_window) : true; }
-void sp_begin_frame(sp_canvas_t* c) { if (!c) return; glfwPollEvents(); int w,h; glfwGetFramebufferSize(as_canvas(c)->m_window,&w,&h); glViewport(0,0,w,h); as_canvas(c)->m_renderer->beginFrame(w,h); }
-void sp_end_frame(sp_canvas_t* c) { if (!c) return; as_canvas(c)->m_renderer->flush(); glfwSwapBuffers(as_canvas(c)->m_window); }
-void sp_clear(sp_canvas_t* c, sp_color_rgba_t color) { if (!c) return; glClearColor(color.r,color.g,color.b,color.a); glClear(GL_COLOR_BUFFER_BIT); }
-sp_vec2_t sp_get_canvas_size(sp_canvas_t* c) { if (!c) return {0,0}; int w,h; glfwGetWindowSize(as_canvas(c)->m_window,&w,&h); return {(float)w,(float)h}; }
-
-void sp_save_state(sp_canvas_t* c) { if (!c) return; as_canvas(c)->m_renderer->stateStack.push(as_canvas(c)->m_renderer->stateStack.top()); }
-void sp_restore_state(sp_canvas_t* c) { if (!c) return; if (as_canvas(c)->m_renderer->stateStack.size() > 1) as_canvas(c)->m_renderer->stateStack.pop(); }
-void sp_reset_transform(sp_canvas_t* c) { if (!c) return; as_canvas(c)->m_renderer->stateStack.top().transform = glm::mat4(1.0f); }
-void sp_translate(sp_canvas_t* c, float x, float y) { if (!c) return; auto& s=as_canvas(c)->m_renderer->stateStack; s.top().transform=glm::translate(s.top().transform,glm::vec3(x,y,0)); }
-void sp_rotate(sp_canvas_t* c, float angle_radians) { if (!c) return; auto& s=as_canvas(c)->m_renderer->stateStack; s.top().transform=glm::rotate(s.top().transform,angle_radians,glm::vec3(0,0,1)); }
-void sp_scale(sp_canvas_t* c, float x, float y) { if (!c) return; auto& s=as_canvas(c)->m_renderer->stateStack; s.top().transform=glm::scale(s.top().transform,glm::vec3(x,y,1)); }
+
+sp_device_t* sp_create_device(const sp_device_config_t* config) {
+    if (!config) return nullptr;
+    try { return reinterpret_cast<sp_device_t*>(new std::shared_ptr<Device>(std::make_shared<Device>(config->offscreen))); }
+    catch (const std::exception& e) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Device Creation Failed: ") + e.what()); return nullptr; }
+}
+// Canvases, fonts and images made on the device keep it alive after this.
+void sp_destroy_device(sp_device_t* d) { delete &as_device(d); }
+sp_canvas_t* sp_create_device_canvas(sp_device_t* d, const sp_window_config_t* config) {
+    if (!d || !config) return nullptr;
+    try { return reinterpret_cast<sp_canvas_t*>(new Canvas(*config, as_device(d))); }
+    catch (const std::exception& e) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Canvas Creation Failed: ") + e.what()); return nullptr; }
+}
+sp_canvas_t* sp_create_device_offscreen_canvas(sp_device_t* d, const sp_offscreen_config_t* config) {
+    if (!d || !config) return nullptr;
+    try { return reinterpret_cast<sp_canvas_t*>(new Canvas(*config, as_device(d))); }
+    catch (const std::exception& e) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Offscreen Canvas Creation Failed: ") + e.what()); return nullptr; }
+}
+sp_font_t* sp_device_load_font(sp_device_t* d, const char* path) {
+    if (!d || !path) return nullptr;
+    auto atlas = loadDeviceFont(as_device(d), path); if (!atlas) return nullptr;
+    return reinterpret_cast<sp_font_t*>(new Font{std::move(atlas)});
+}
+sp_image_t* sp_device_load_image(sp_device_t* d, const char* path) {
+    if (!d || !path) return nullptr;
+    auto shared = loadDeviceImage(as_device(d), path); if (!shared) return nullptr;
+    return reinterpret_cast<sp_image_t*>(new Image{shared->loaded, as_device(d)->images.get(), nullptr, shared});
+}
+bool sp_get_device_stats(sp_device_t* d, sp_device_stats_t* stats) {
+    if (!d || !stats) return false; const Device& device = *as_device(d);
+    auto live = [](const auto& cache) { return (uint32_t)std::count_if(cache.begin(), cache.end(), [](const auto& e) { return !e.second.expired(); }); };
+    *stats = {(uint32_t)device.canvases, live(device.fonts), live(device.cachedImages), (uint32_t)device.images->pageCount()};
+    return true;
+}
+bool sp_canvas_is_offscreen(sp_canvas_t* c) { return c ? as_canvas(c)->m_offscreen : false; }
+bool sp_canvas_should_close(sp_canvas_t* c) { if (!c) return true; auto cv=as_canvas(c); return cv->m_offscreen ? false : glfwWindowShouldClose(cv->m_window); }
+void sp_begin_frame(sp_canvas_t* c) {
+    if (!c) return; auto cv=as_canvas(c);
+    // beginFrame resets the stats before this timer adds to them on the way out.
+    ScopedTimer timer("sp_begin_frame", &cv->m_renderer->stats().begin_frame_ms); cv->makeCurrent();
+    cv->m_framePaths.reset(); cv->m_framePens.reset();
+    if (!cv->m_offscreen) {
+        glfwPollEvents(); int w,h; glfwGetFramebufferSize(cv->m_window,&w,&h);
+        if (w != cv->m_framebuffer->width() || h != cv->m_framebuffer->height()) cv->invalidate();
+        cv->m_framebuffer->resize(w,h); cv->m_refresh = false;
+    }
+    int w=cv->width(), h=cv->height();
+    if (cv->m_loader) cv->m_loader->upload(*cv->m_images, ImageLoader::FRAME_UPLOAD_BYTES);
+    if (!cv->m_software) { cv->m_framebuffer->bind(); glViewport(0,0,w,h); }
+    cv->beginDamage(w,h);
+    cv->m_renderer->beginFrame(w,h,timer.start());
+}
+void sp_end_frame(sp_canvas_t* c) {
+    if (!c) return; auto cv=as_canvas(c);
+    {
+        ScopedTimer timer("sp_end_frame", &cv->m_renderer->stats().end_frame_ms); cv->makeCurrent(); cv->m_renderer->flush();
+        if (!cv->m_software) glDisable(GL_SCISSOR_TEST);
+        if (cv->m_offscreen) { if (!cv->m_software) glFlush(); }
+        else cv->present();
+    }
+    cv->m_renderer->endFrame();
+}
+bool sp_canvas_needs_redraw(sp_canvas_t* c) { return c && as_canvas(c)->damaged(); }
+void sp_invalidate(sp_canvas_t* c) { if (c) as_canvas(c)->invalidate(); }
+void sp_invalidate_rect(sp_canvas_t* c, float x, float y, float w, float h) { if (c && w > 0.0f && h > 0.0f) as_canvas(c)->invalidate({x,y},{x+w,y+h}); }
+// Sleeps until the window system has events or `timeout` seconds pass (no limit if negative),
+// unless a redraw is already due. A repaint request with nothing invalidated is answered with
+// the last frame, which the framebuffer still holds.
+bool sp_wait_events(sp_canvas_t* c, double timeout) {
+    if (!c) return false; auto cv=as_canvas(c); if (cv->m_offscreen) return cv->damaged();
+    if (cv->damaged()) glfwPollEvents(); else if (timeout < 0.0) glfwWaitEvents(); else glfwWaitEventsTimeout(timeout);
+    if (cv->m_refresh && !cv->damaged()) { cv->makeCurrent(); cv->present(); }
+    cv->m_refresh = false;
+    return cv->damaged();
+}
+void sp_clear(sp_canvas_t* c, sp_color_rgba_t color) {
+    if (!c) return; if (auto list=as_canvas(c)->m_renderer->recording()) { list->items.push_back(DrawList::Clear{color}); return; }
+    as_canvas(c)->makeCurrent(); as_canvas(c)->m_renderer->clear(color); }
+sp_vec2_t sp_get_canvas_size(sp_canvas_t* c) {
+    if (!c) return {0,0}; auto cv=as_canvas(c);
+    if (cv->m_offscreen) return {(float)cv->width(),(float)cv->height()};
+    int w,h; glfwGetWindowSize(cv->m_window,&w,&h); return {(float)w,(float)h};
+}
+bool sp_get_frame_stats(sp_canvas_t* c, sp_frame_stats_t* stats) { if (!c || !stats) return false; return as_canvas(c)->m_renderer->lastFrameStats(*stats); }
+
+// Software canvases draw everything queued, then copy the target's rows out top-down.
+bool sp_read_pixels(sp_canvas_t* c, uint8_t* rgba, size_t size) {
+    if (!c) return false; auto cv=as_canvas(c); cv->makeCurrent(); cv->m_renderer->flush();
+    if (!cv->m_software) return cv->m_framebuffer->readPixels(rgba,size);
+    SoftwareRasterizer& sw=*cv->m_software; const size_t row=(size_t)sw.width()*4;
+    if (!rgba || size < row*sw.height()) return false;
+    sw.render(); for (int y=0; y<sw.height(); ++y) std::memcpy(rgba+y*row, sw.pixels()+y*sw.stride(), row);
+    return true;
+}
+// Software canvases have nothing to read back asynchronously; sp_read_pixels is already a copy.
+uint64_t sp_request_readback(sp_canvas_t* c) { if (!c || as_canvas(c)->m_software) return 0; auto cv=as_canvas(c); cv->makeCurrent(); cv->m_renderer->flush(); return cv->m_framebuffer->requestReadback(); }
+sp_readback_status_t sp_poll_readback(sp_canvas_t* c, uint64_t ticket) { if (!c || as_canvas(c)->m_software) return SP_READBACK_INVALID; as_canvas(c)->makeCurrent(); return as_canvas(c)->m_framebuffer->pollReadback(ticket); }
+bool sp_fetch_readback(sp_canvas_t* c, uint64_t ticket, uint8_t* rgba, size_t size) { if (!c || as_canvas(c)->m_software) return false; as_canvas(c)->makeCurrent(); return as_canvas(c)->m_framebuffer->fetchReadback(ticket,rgba,size); }
+bool sp_save_png(sp_canvas_t* c, const char* path) {
+    if (!c || !path) return false; const int w=as_canvas(c)->width(), h=as_canvas(c)->height();
+    std::vector<uint8_t> pixels((size_t)w*h*4);
+    return sp_read_pixels(c, pixels.data(), pixels.size()) && writePng(path, pixels.data(), w, h);
+}
+
+void sp_save_state(sp_canvas_t* c) { if (!c) return; as_canvas(c)->m_renderer->states().push(as_canvas(c)->m_renderer->states().top()); }
+void sp_restore_state(sp_canvas_t* c) { if (!c) return; if (as_canvas(c)->m_renderer->states().size() > 1) as_canvas(c)->m_renderer->states().pop(); }
+void sp_reset_transform(sp_canvas_t* c) { if (!c) return; as_canvas(c)->m_renderer->states().top().transform = glm::mat4(1.0f); }
+void sp_translate(sp_canvas_t* c, float x, float y) { if (!c) return; auto& s=as_canvas(c)->m_renderer->states(); s.top().transform=glm::translate(s.top().transform,glm::vec3(x,y,0)); }
+void sp_rotate(sp_canvas_t* c, float angle_radians) { if (!c) return; auto& s=as_canvas(c)->m_renderer->states(); s.top().transform=glm::rotate(s.top().transform,angle_radians,glm::vec3(0,0,1)); }
+void sp_scale(sp_canvas_t* c, float x, float y) { if (!c) return; auto& s=as_canvas(c)->m_renderer->states(); s.top().transform=glm::scale(s.top().transform,glm::vec3(x,y,1)); }
 
 sp_pen_t* sp_create_pen(sp_canvas_t* c, const sp_pen_config_t* config) { if (!c || !config) return nullptr; return reinterpret_cast<sp_pen_t*>(new Pen{*config}); }
-void sp_destroy_pen(sp_pen_t* p) { delete as_pen(p); }
-void sp_set_pen(sp_canvas_t* c, sp_pen_t* p) { if (!c || !p) return; as_canvas(c)->m_renderer->stateStack.top().pen = p; }
-void sp_set_color(sp_canvas_t* c, sp_color_rgba_t color) { if (!c) return; as_canvas(c)->m_renderer->stateStack.top().color = color; }
+// Frame pens stay valid until the next sp_begin_frame and are never destroyed by the caller.
+sp_pen_t* sp_create_frame_pen(sp_canvas_t* c, const sp_pen_config_t* config) {
+    if (!c || !config) return nullptr; Pen* pen=as_canvas(c)->m_framePens.acquire(); pen->config=*config; pen->frameScoped=true;
+    return reinterpret_cast<sp_pen_t*>(pen);
+}
+void sp_destroy_pen(sp_pen_t* p) { if (p && !as_pen(p)->frameScoped) delete as_pen(p); }
+void sp_set_pen(sp_canvas_t* c, sp_pen_t* p) { if (!c || !p) return; as_canvas(c)->m_renderer->states().top().pen = p; }
+void sp_set_color(sp_canvas_t* c, sp_color_rgba_t color) { if (!c) return; as_canvas(c)->m_renderer->states().top().color = color; }
+void sp_set_fill_rule(sp_canvas_t* c, sp_fill_rule_t rule) { if (!c) return; as_canvas(c)->m_renderer->states().top().fill_rule = rule; }
+void sp_set_blend_mode(sp_canvas_t* c, sp_blend_mode_t mode) { if (!c) return; as_canvas(c)->m_renderer->states().top().blend_mode = mode; }
+uint32_t sp_pack_color(sp_color_rgba_t color) { return packColor(color.r,color.g,color.b,color.a); }
 
 sp_path_t* sp_create_path(sp_canvas_t* c) { if (!c) return nullptr; return reinterpret_cast<sp_path_t*>(new Path()); }
-void sp_destroy_path(sp_path_t* p) { delete as_path(p); }
-void sp_path_move_to(sp_path_t* p, float x, float y) { if (!p) return; as_path(p)->points.clear(); as_path(p)->points.push_back({x,y}); }
-void sp_path_line_to(sp_path_t* p, float x, float y) { if (!p) return; as_path(p)->points.push_back({x,y}); }
-void sp_path_arc_to(sp_path_t* p, float x1, float y1, float x2, float y2, float r) {}
-void sp_path_cubic_bezier_to(sp_path_t* p, float c1x, float c1y, float c2x, float c2y, float x, float y) {}
-void sp_path_close(sp_path_t* p) { if (!p || as_path(p)->points.size()<2) return; as_path(p)->points.push_back(as_path(p)->points.front()); }
+// A path from the canvas's frame pool: empty, but with the storage it had in earlier frames.
+sp_path_t* sp_create_frame_path(sp_canvas_t* c) {
+    if (!c) return nullptr; Path* path=as_canvas(c)->m_framePaths.acquire(); path->reset(); path->frameScoped=true;
+    return reinterpret_cast<sp_path_t*>(path);
+}
+void sp_destroy_path(sp_path_t* p) { if (p && !as_path(p)->frameScoped) delete as_path(p); }
+void sp_path_reserve(sp_path_t* p, size_t n) { if (!p) return; as_path(p)->owned().reserve(n); }
+void sp_path_move_to(sp_path_t* p, float x, float y) { if (!p) return; as_path(p)->reset(); as_path(p)->owned().push_back({x,y}); }
+void sp_path_line_to(sp_path_t* p, float x, float y) { if (!p) return; as_path(p)->owned().push_back({x,y}); as_path(p)->closed=false; as_path(p)->edited(); }
+// Replaces the path with n points whose x, y floats start every `stride` bytes (0 means packed).
+// Packed input is borrowed, not copied: it must outlive every draw until the path is edited,
+// set again or destroyed. Other strides are gathered into the path's own storage.
+void sp_path_set_points(sp_path_t* p, const float* xy, size_t n, size_t stride) {
+    if (!p) return; auto path = as_path(p);
+    if (stride == 0) stride = sizeof(sp_vec2_t);
+    path->reset();
+    if (!xy || n == 0) return;
+    if (stride == sizeof(sp_vec2_t)) { path->borrowed = reinterpret_cast<const sp_vec2_t*>(xy); path->borrowedCount = n; return; }
+    auto& points = path->owned(); points.resize(n); auto bytes = reinterpret_cast<const unsigned char*>(xy);
+    for (size_t i = 0; i < n; ++i) std::memcpy(&points[i], bytes + i * stride, sizeof(sp_vec2_t));
+}
+// Curves are kept as curves and flattened when drawn (Path::outline). Without a current point
+// both start from their first control point, as in the HTML canvas.
+// The arc of radius r tangent to the lines from the current point to (x1, y1) and on to
+// (x2, y2), joined to the current point by a straight line. Degenerate corners get a line to (x1, y1).
+void sp_path_arc_to(sp_path_t* p, float x1, float y1, float x2, float y2, float r) {
+    if (!p) return; auto path=as_path(p); auto& points=path->owned(); path->closed=false; path->edited();
+    if (points.empty()) { points.push_back({x1,y1}); return; }
+    const glm::vec2 p0(points.back().x, points.back().y), p1(x1, y1), p2(x2, y2);
+    const glm::vec2 toStart = p0 - p1, toEnd = p2 - p1;
+    const float lenStart = glm::length(toStart), lenEnd = glm::length(toEnd);
+    const float turn = toStart.x * toEnd.y - toStart.y * toEnd.x;
+    if (!(r > 0.0f) || lenStart == 0.0f || lenEnd == 0.0f || turn == 0.0f) { points.push_back({x1,y1}); return; }
+    const glm::vec2 u0 = toStart / lenStart, u2 = toEnd / lenEnd;
+    const float half = std::acos(std::clamp(glm::dot(u0, u2), -1.0f, 1.0f)) * 0.5f, reach = r / std::tan(half);
+    const glm::vec2 t1 = p1 + u0 * reach, t2 = p1 + u2 * reach, center = p1 + glm::normalize(u0 + u2) * (r / std::sin(half));
+    if (t1 != p0) points.push_back({t1.x, t1.y});
+    // The arc turns the way the corner does, through pi minus the corner's angle.
+    const float sweep = (turn > 0.0f ? -1.0f : 1.0f) * (3.14159265f - 2.0f * half);
+    points.push_back({t2.x, t2.y});
+    path->curves.push_back({PathCurve::Kind::Arc, points.size() - 1, {center.x, center.y}, {0.0f, 0.0f}, r, sweep});
+}
+void sp_path_cubic_bezier_to(sp_path_t* p, float c1x, float c1y, float c2x, float c2y, float x, float y) {
+    if (!p) return; auto path=as_path(p); auto& points=path->owned(); path->closed=false; path->edited();
+    if (points.empty()) points.push_back({c1x,c1y});
+    points.push_back({x,y});
+    path->curves.push_back({PathCurve::Kind::Cubic, points.size() - 1, {c1x,c1y}, {c2x,c2y}, 0.0f, 0.0f});
+}
+void sp_path_close(sp_path_t* p) { if (!p || as_path(p)->size()<2) return; auto& points=as_path(p)->owned(); points.push_back(points.front()); as_path(p)->closed=true; as_path(p)->edited(); }
 void sp_stroke_path(sp_canvas_t* c, sp_path_t* p) {
-    if (!c || !p) return; auto path=as_path(p); auto renderer=as_canvas(c)->m_renderer.get();
-    auto pen = as_pen(renderer->stateStack.top().pen);
-    if (path->points.size()<2 || !pen) return;
-    auto& cs = renderer->stateStack.top().color; glm::vec4 color={cs.r,cs.g,cs.b,cs.a};
-    for (size_t i=0; i<path->points.size()-1; ++i) {
-        glm::vec4 p1={path->points[i].x,path->points[i].y,0,1},p2={path->points[i+1].x,path->points[i+1].y,0,1};
-        glm::vec2 dir=p2-p1; if(glm::length(dir)>0.0f) dir=glm::normalize(dir);
-        glm::vec2 n(-dir.y,dir.x); n*=pen->config.line_width/2.0f;
-        renderer->addQuad(p1-glm::vec4(n,0,0),p2-glm::vec4(n,0,0),p2+glm::vec4(n,0,0),p1+glm::vec4(n,0,0),color,-1.0f,{});
-    }
-}
-void sp_fill_path(sp_path_t* p, sp_path_t* path) {}
-
-void sp_draw_line(sp_canvas_t* c, float x1, float y1, float x2, float y2) { if (!c) return; auto r=as_canvas(c)->m_renderer.get(); auto& cs=r->stateStack.top().color; glm::vec4 color={cs.r,cs.g,cs.b,cs.a}; glm::vec4 p1={x1,y1,0,1},p2={x2,y2,0,1}; glm::vec2 dir=p2-p1; if(glm::length(dir)>0.0f) dir=glm::normalize(dir); glm::vec2 n(-dir.y,dir.x); r->addQuad(p1-glm::vec4(n,0,0),p2-glm::vec4(n,0,0),p2+glm::vec4(n,0,0),p1+glm::vec4(n,0,0),color,-1.0f,{});}
-void sp_fill_rect(sp_canvas_t* c, float x, float y, float w, float h) { if (!c) return; auto r=as_canvas(c)->m_renderer.get(); auto& cs=r->stateStack.top().color; glm::vec4 color={cs.r,cs.g,cs.b,cs.a}; r->addQuad({x,y,0,1},{x+w,y,0,1},{x+w,y+h,0,1},{x,y+h,0,1},color,-1.0f,{0,0,1,1});}
-void sp_draw_rect(sp_canvas_t* c, float x, float y, float w, float h) {}
-void sp_draw_circle(sp_canvas_t* c, float cx, float cy, float r) {}
-void sp_fill_circle(sp_canvas_t* c, float cx, float cy, float r) {}
-void sp_draw_ellipse(sp_canvas_t* c, float cx, float cy, float rx, float ry) {}
+    if (!c || !p) return; auto path=as_path(p); auto renderer=as_drawing(c);
+    auto pen = as_pen(renderer->states().top().pen);
+    if (path->size() == 0 || !pen) return;
+    ScopedTimer timer("sp_stroke_path", &renderer->stats().stroke_ms);
+    auto& cs = renderer->states().top().color;
+    const sp_vec2_t* points; size_t count; path->outline(renderer->maxScale(), points, count);
+    if (renderer->isCapturing() && path->pyramid()) { renderer->captureStroke(path->share(), path->lod, pen->config, packColor(cs.r,cs.g,cs.b,cs.a)); return; }
+    if (auto decimated = renderer->decimate(path->pyramid(), points, count)) { points = decimated->data(); count = decimated->size(); if (count == 0) return; }
+    renderer->strokePath(points, count, path->closed, pen->config, packColor(cs.r,cs.g,cs.b,cs.a));
+}
+// The path's outline is closed back to its first point whether or not sp_path_close was called.
+void sp_fill_path(sp_canvas_t* c, sp_path_t* p) {
+    if (!c || !p) return; auto path=as_path(p); auto renderer=as_drawing(c);
+    if (path->size() < 2) return;
+    ScopedTimer timer("sp_fill_path");
+    const State& state = renderer->states().top(); auto& cs = state.color;
+    const sp_vec2_t* points; size_t count; path->outline(renderer->maxScale(), points, count);
+    renderer->fillPath(points, count, state.fill_rule, packColor(cs.r,cs.g,cs.b,cs.a));
+}
+
+sp_series_t* sp_create_series(sp_canvas_t* c, size_t capacity) {
+    if (!c || capacity == 0) return nullptr;
+    auto series=new Series(); series->capacity=capacity; series->samples.resize(capacity + 1);
+    return reinterpret_cast<sp_series_t*>(series);
+}
+void sp_destroy_series(sp_series_t* s) { delete as_series(s); }
+// Past the capacity the oldest samples drop out of the window.
+void sp_series_append(sp_series_t* s, const float* xs, const float* ys, size_t n) {
+    if (!s || !xs || !ys) return; auto series=as_series(s);
+    const size_t keep = std::min(n, series->samples.size()); const size_t skip = n - keep; series->total += skip;
+    for (size_t i=skip; i<n; ++i) series->samples[series->total++ % series->samples.size()] = {xs[i], ys[i]};
+}
+void sp_series_clear(sp_series_t* s) { if (!s) return; as_series(s)->total = 0; as_series(s)->tessellated = 0; }
+size_t sp_series_size(sp_series_t* s) { return s ? as_series(s)->size() : 0; }
+// Series are hairline traces: each segment is its own quad of the current pen's width (or one
+// unit), and the pen's caps and joins are ignored. Draw lists and meshes get the same quads
+// straight from the ring.
+void sp_draw_series(sp_canvas_t* c, sp_series_t* s) {
+    if (!c || !s) return; auto r=as_drawing(c); auto series=as_series(s);
+    auto& state=r->states().top(); auto& cs=state.color; const uint32_t color=packColor(cs.r,cs.g,cs.b,cs.a);
+    const float halfWidth = (state.pen ? as_pen(state.pen)->config.line_width : 1.0f) / 2.0f;
+    if (r->recording() || r->isCapturing()) {
+        r->strokeSeries(*series, halfWidth, color); return;
+    }
+    ScopedTimer timer("sp_draw_series", &r->stats().stroke_ms);
+    r->drawSeries(*series, halfWidth, color, state.blend_mode);
+}
+
+bool sp_begin_mesh(sp_canvas_t* c) { if (!c) return false; return as_canvas(c)->m_renderer->beginCapture(); }
+sp_mesh_t* sp_end_mesh(sp_canvas_t* c) { if (!c || !as_canvas(c)->m_renderer->isCapturing()) return nullptr; as_canvas(c)->makeCurrent(); return reinterpret_cast<sp_mesh_t*>(as_canvas(c)->m_renderer->endCapture()); }
+void sp_destroy_mesh(sp_mesh_t* m) { destroyMesh(as_mesh(m)); }
+size_t sp_mesh_vertex_count(sp_mesh_t* m) { return m ? (size_t)as_mesh(m)->vertexCount : 0; }
+void sp_draw_mesh(sp_canvas_t* c, sp_mesh_t* m) {
+    if (!c || !m) return; auto r=as_drawing(c); if (r->isCapturing()) return;
+    const State& state = r->states().top();
+    if (auto list=r->recording()) { list->items.push_back(DrawList::MeshDraw{as_mesh(m), state.transform, state.blend_mode}); return; }
+    r->drawMesh(*as_mesh(m), state.transform, state.blend_mode);
+}
 
+sp_draw_list_t* sp_create_draw_list(sp_canvas_t* c) {
+    if (!c) return nullptr; auto list=new DrawList(); list->renderer=as_canvas(c)->m_renderer.get(); list->reset();
+    return reinterpret_cast<sp_draw_list_t*>(list);
+}
+void sp_destroy_draw_list(sp_draw_list_t* l) { if (t_recording == as_draw_list(l)) t_recording = nullptr; delete as_draw_list(l); }
+// Until sp_end_draw_list, drawing and state calls on `c` from this thread record into the list,
+// which starts out empty with the default state. Other threads keep drawing normally.
+bool sp_begin_draw_list(sp_canvas_t* c, sp_draw_list_t* l) {
+    if (!c || !l || t_recording || as_draw_list(l)->renderer != as_canvas(c)->m_renderer.get()) return false;
+    as_draw_list(l)->reset(); t_recording = as_draw_list(l); return true;
+}
+void sp_end_draw_list(sp_canvas_t* c) { if (c && as_canvas(c)->m_renderer->recording()) t_recording = nullptr; }
+void sp_submit_draw_lists(sp_canvas_t* c, sp_draw_list_t* const* lists, size_t count) {
+    if (!c || !lists) return; auto r=as_canvas(c)->m_renderer.get(); if (r->recording() || r->isCapturing()) return;
+    as_canvas(c)->makeCurrent();
+    for (size_t i=0; i<count; ++i) if (lists[i] && as_draw_list(lists[i])->renderer == r) r->submit(*as_draw_list(lists[i]));
+}
+
+// What sp_record_scene reads back from the GPU, kept until the scene is written. Each texture
+// and font is stored once however many commands use it.
+struct SceneRecording {
+    SceneWriter writer; std::deque<std::vector<Vertex>> meshes; std::deque<std::vector<uint8_t>> pixels;
+    std::unordered_map<GLuint, uint32_t> textures; std::unordered_map<const GlyphAtlas*, uint32_t> fonts;
+};
+static std::vector<uint32_t> recordTextures(Backend& backend, SceneRecording& out, const std::vector<GLuint>& textures) {
+    std::vector<uint32_t> indices;
+    for (GLuint t : textures) {
+        auto found = out.textures.find(t);
+        if (found == out.textures.end()) {
+            uint32_t w = 0, h = 0, channels = 4; std::vector<uint8_t>& pixels = out.pixels.emplace_back();
+            if (!backend.readTexture(t, w, h, channels, pixels)) { w = h = 0; channels = 4; }
+            found = out.textures.emplace(t, out.writer.addTexture(w, h, channels, pixels.data())).first;
+        }
+        indices.push_back(found->second);
+    }
+    return indices;
+}
+// Geometry is already in device space and keeps an identity transform. A mesh's captured strokes
+// are stored tessellated in full, since a scene may be replayed at any zoom.
+static void recordScene(Renderer& renderer, const DrawList& list, SceneRecording& out) {
+    Backend& backend = renderer.backend();
+    for (const DrawList::Item& item : list.items) {
+        SceneCommand cmd{}; setSceneTransform(cmd, glm::mat4(1.0f));
+        if (auto g = std::get_if<DrawList::Geometry>(&item)) {
+            cmd.type = SceneCommandType::Vertices; cmd.blend = g->blend;
+            out.writer.addCommand(cmd, list.vertices.data() + g->first, g->count * sizeof(Vertex), recordTextures(backend, out, g->textures));
+        }
+        else if (auto t = std::get_if<DrawList::Text>(&item)) {
+            auto found = out.fonts.find(t->font->atlas.get());
+            if (found == out.fonts.end()) { const auto& data = t->font->atlas->fontData(); found = out.fonts.emplace(t->font->atlas.get(), out.writer.addFont(data.data(), data.size())).first; }
+            cmd.type = SceneCommandType::Text; cmd.blend = t->blend; cmd.font = found->second; cmd.fontSize = t->size; cmd.x = t->x; cmd.y = t->y; cmd.color = t->color;
+            setSceneTransform(cmd, t->transform); out.writer.addCommand(cmd, t->text.data(), t->text.size());
+        }
+        else if (auto m = std::get_if<DrawList::MeshDraw>(&item)) {
+            std::vector<Vertex>& vertices = out.meshes.emplace_back(); backend.readMesh(*m->mesh, vertices);
+            cmd.type = SceneCommandType::Vertices; cmd.blend = m->blend; setSceneTransform(cmd, m->transform);
+            const std::vector<uint32_t> textures = recordTextures(backend, out, m->mesh->textures);
+            size_t vertex = 0;
+            for (const MeshStroke& stroke : m->mesh->strokes) {
+                const size_t end = stroke.firstQuad * VERTICES_PER_QUAD;
+                if (end > vertex) out.writer.addCommand(cmd, &vertices[vertex], (end - vertex) * sizeof(Vertex), textures);
+                std::vector<Vertex>& tessellated = out.meshes.emplace_back(); renderer.tessellateStroke(stroke, tessellated);
+                out.writer.addCommand(cmd, tessellated.data(), tessellated.size() * sizeof(Vertex), {});
+                vertex = end;
+            }
+            if (vertex < vertices.size() || m->mesh->strokes.empty()) out.writer.addCommand(cmd, vertices.data() + vertex, (vertices.size() - vertex) * sizeof(Vertex), textures);
+        }
+        else if (auto k = std::get_if<DrawList::Markers>(&item)) {
+            cmd.type = SceneCommandType::Markers; cmd.blend = k->blend; setSceneTransform(cmd, k->transform);
+            out.writer.addCommand(cmd, k->markers.data(), k->markers.size() * sizeof(sp_marker_t));
+        }
+        else if (auto c = std::get_if<DrawList::Clear>(&item)) { cmd.type = SceneCommandType::Clear; cmd.clearColor = c->color; out.writer.addCommand(cmd, nullptr, 0); }
+        else if (auto f = std::get_if<DrawList::Fill>(&item)) {
+            cmd.type = SceneCommandType::Fill; cmd.blend = f->blend; cmd.rule = f->rule; cmd.color = f->color;
+            out.writer.addCommand(cmd, f->points.data(), f->points.size() * sizeof(sp_vec2_t));
+        }
+    }
+}
+static bool recordScene(sp_canvas_t* c, sp_draw_list_t* const* lists, size_t count, SceneRecording& out) {
+    if (!c || (!lists && count)) return false; auto r=as_canvas(c)->m_renderer.get(); if (r->recording()) return false;
+    as_canvas(c)->makeCurrent();
+    for (size_t i=0; i<count; ++i) if (lists[i] && as_draw_list(lists[i])->renderer == r) recordScene(*r, *as_draw_list(lists[i]), out);
+    return true;
+}
+// Returns the scene's size in bytes and writes it only if `size` is enough, so a first call
+// with no buffer asks for the size. 0 if nothing can be recorded.
+size_t sp_record_scene(sp_canvas_t* c, sp_draw_list_t* const* lists, size_t count, void* buffer, size_t size) {
+    SceneRecording recording; if (!recordScene(c, lists, count, recording)) return 0;
+    const size_t needed = recording.writer.size();
+    if (buffer && size >= needed) recording.writer.write(static_cast<uint8_t*>(buffer));
+    return needed;
+}
+bool sp_record_scene_file(sp_canvas_t* c, sp_draw_list_t* const* lists, size_t count, const char* path) {
+    SceneRecording recording; if (!path || !recordScene(c, lists, count, recording)) return false;
+    std::vector<uint8_t> bytes(recording.writer.size()); recording.writer.write(bytes.data());
+    std::ofstream file(path, std::ios::binary); file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+    return (bool)file;
+}
+// Only the header and tables are checked; vertex blocks go to the backend as they lie in `data`,
+// which may be released once this returns.
+sp_scene_t* sp_load_scene(sp_canvas_t* c, const void* data, size_t size) {
+    if (!c) return nullptr; auto r=as_canvas(c)->m_renderer.get(); if (r->recording()) return nullptr;
+    SceneView view; std::string error;
+    if (!openScene(data, size, view, error)) { logMessage(SP_LOG_LEVEL_ERROR, "Scene Load Failed: " + error); return nullptr; }
+    ScopedTimer timer("sp_load_scene"); as_canvas(c)->makeCurrent();
+    Backend& backend = r->backend(); uint64_t& uploadBytes = r->stats().upload_bytes;
+    auto scene = std::make_unique<Scene>(); const SceneHeader& h = *view.header;
+    for (uint32_t i=0; i<h.textureCount; ++i) {
+        const SceneTexture& t = view.textures[i];
+        scene->textures.push_back(t.width && t.height ? backend.createTexture(t.width, t.height, t.channels, view.blob<uint8_t>(t.pixels), uploadBytes) : 0);
+    }
+    for (uint32_t i=0; i<h.fontCount; ++i) {
+        const uint8_t* bytes = view.blob<uint8_t>(view.fonts[i].data);
+        auto atlas = GlyphAtlas::create(std::vector<unsigned char>(bytes, bytes + view.fonts[i].data.size));
+        if (!atlas) { logMessage(SP_LOG_LEVEL_ERROR, "Scene Load Failed: font " + std::to_string(i) + " is not readable"); return nullptr; }
+        scene->fonts.push_back(std::make_unique<Font>(Font{std::move(atlas)}));
+    }
+    scene->entries.resize(h.commandCount);
+    for (uint32_t i=0; i<h.commandCount; ++i) {
+        Scene::Entry& e = scene->entries[i]; e.command = view.commands[i]; const SceneBlob& blob = e.command.data;
+        switch (e.command.type) {
+        case SceneCommandType::Vertices: {
+            if (blob.size == 0) break;
+            std::vector<GLuint> textures;
+            for (uint32_t t=0; t<e.command.textureCount; ++t) textures.push_back(scene->textures[view.textureRefs[e.command.firstTexture + t]]);
+            e.mesh = backend.createMesh(view.blob<Vertex>(blob), blob.size / sizeof(Vertex), std::move(textures), uploadBytes); break;
+        }
+        case SceneCommandType::Text: e.text.assign(view.blob<char>(blob), blob.size); break;
+        case SceneCommandType::Markers: e.markers.assign(view.blob<sp_marker_t>(blob), view.blob<sp_marker_t>(blob) + blob.size / sizeof(sp_marker_t)); break;
+        case SceneCommandType::Fill: e.points.assign(view.blob<sp_vec2_t>(blob), view.blob<sp_vec2_t>(blob) + blob.size / sizeof(sp_vec2_t)); break;
+        default: break;
+        }
+    }
+    return reinterpret_cast<sp_scene_t*>(scene.release());
+}
+sp_scene_t* sp_load_scene_file(sp_canvas_t* c, const char* path) {
+    if (!c || !path) return nullptr;
+    const MappedFile file(path);
+    if (!file.data()) { logMessage(SP_LOG_LEVEL_ERROR, std::string("Scene Load Failed: cannot read ") + path); return nullptr; }
+    return sp_load_scene(c, file.data(), file.size());
+}
+void sp_destroy_scene(sp_scene_t* s) { delete as_scene(s); }
+// Draws the scene under the current transform, each command with the blend mode it was recorded
+// under. It goes through the same calls as live drawing, so it also records into draw lists.
+void sp_replay(sp_canvas_t* c, sp_scene_t* s) {
+    if (!c || !s) return; auto r=as_canvas(c)->m_renderer.get(); auto scene=as_scene(s);
+    ScopedTimer timer("sp_replay"); if (!r->recording()) as_canvas(c)->makeCurrent();
+    State& state = r->states().top(); const State saved = state;
+    for (const Scene::Entry& e : scene->entries) {
+        const SceneCommand& cmd = e.command;
+        state = saved; state.blend_mode = (sp_blend_mode_t)cmd.blend; state.transform = saved.transform * sceneTransform(cmd.transform);
+        switch (cmd.type) {
+        case SceneCommandType::Vertices: sp_draw_mesh(c, reinterpret_cast<sp_mesh_t*>(e.mesh)); break;
+        case SceneCommandType::Text:
+            state.font = reinterpret_cast<sp_font_t*>(scene->fonts[cmd.font].get()); state.font_size = cmd.fontSize;
+            state.color = {(cmd.color & 0xFF) / 255.0f, (cmd.color >> 8 & 0xFF) / 255.0f, (cmd.color >> 16 & 0xFF) / 255.0f, (cmd.color >> 24) / 255.0f};
+            sp_draw_text(c, e.text.c_str(), cmd.x, cmd.y); break;
+        case SceneCommandType::Markers: sp_draw_markers(c, e.markers.data(), e.markers.size()); break;
+        case SceneCommandType::Fill: r->fillPath(e.points.data(), e.points.size(), (sp_fill_rule_t)cmd.rule, cmd.color); break;
+        case SceneCommandType::Clear: sp_clear(c, cmd.clearColor); break;
+        default: break;
+        }
+    }
+    state = saved;
+}
+
+void sp_draw_line(sp_canvas_t* c, float x1, float y1, float x2, float y2) { if (!c) return; auto r=as_drawing(c); auto& cs=r->states().top().color; sp_vec2_t points[2]={{x1,y1},{x2,y2}}; r->strokePolyline(points,2,1.0f,packColor(cs.r,cs.g,cs.b,cs.a));}
+void sp_fill_rect(sp_canvas_t* c, float x, float y, float w, float h) { if (!c) return; auto r=as_drawing(c); auto& cs=r->states().top().color; r->addQuad({x,y},{x+w,y},{x+w,y+h},{x,y+h},packColor(cs.r,cs.g,cs.b,cs.a),NO_TEXTURE_SLOT,{0,0,1,1});}
+// Shapes are outlined with the current pen, or a one-pixel mitered line without one.
+static sp_pen_config_t outlinePen(const State& state) { return state.pen ? as_pen(state.pen)->config : sp_pen_config_t{1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f}; }
+void sp_draw_rect(sp_canvas_t* c, float x, float y, float w, float h) {
+    if (!c) return; auto r=as_drawing(c); auto& state=r->states().top(); auto& cs=state.color;
+    const sp_vec2_t points[4] = {{x,y},{x+w,y},{x+w,y+h},{x,y+h}};
+    r->strokePath(points, 4, true, outlinePen(state), packColor(cs.r,cs.g,cs.b,cs.a));
+}
+void sp_draw_ellipse(sp_canvas_t* c, float cx, float cy, float rx, float ry) {
+    if (!c) return; auto r=as_drawing(c); auto& state=r->states().top(); auto& cs=state.color;
+    const sp_pen_config_t pen = outlinePen(state);
+    const std::vector<sp_vec2_t> points = r->ellipsePoints({cx,cy},{rx,ry});
+    r->strokePath(points.data(), points.size(), true, pen, packColor(cs.r,cs.g,cs.b,cs.a));
+}
+void sp_draw_circle(sp_canvas_t* c, float cx, float cy, float r) { sp_draw_ellipse(c, cx, cy, r, r); }
+void sp_fill_circle(sp_canvas_t* c, float cx, float cy, float r) { if (!c) return; auto rr=as_drawing(c); auto& cs=rr->states().top().color; rr->fillEllipse({cx,cy},{r,r},packColor(cs.r,cs.g,cs.b,cs.a)); }
+// Not captured into meshes: markers have no batch vertices to record.
+void sp_draw_markers(sp_canvas_t* c, const sp_marker_t* markers, size_t count) {
+    if (!c || !markers || count == 0) return; auto r=as_drawing(c); if (r->isCapturing()) return;
+    const State& state = r->states().top();
+    if (auto list=r->recording()) { list->items.push_back(DrawList::Markers{std::vector<sp_marker_t>(markers, markers + count), state.transform, state.blend_mode}); return; }
+    r->drawMarkers(markers, count, state.transform, state.blend_mode);
+}
+
+// Canvases on a device share its cache, so every figure loading the same font gets one atlas.
 sp_font_t* sp_load_font(sp_canvas_t* c, const char* path) {
     if (!c || !path) return nullptr;
+    if (as_canvas(c)->m_device) return sp_device_load_font(reinterpret_cast<sp_device_t*>(&as_canvas(c)->m_device), path);
     std::ifstream file(path, std::ios::binary | std::ios::ate); if (!file) return nullptr;
-    auto font = new Font(); font->ttf_buffer.resize(file.tellg()); file.seekg(0, std::ios::beg);
-    if (!file.read((char*)font->ttf_buffer.data(), font->ttf_buffer.size())) { delete font; return nullptr; }
-    unsigned char temp_bitmap[512*512];
-    stbtt_BakeFontBitmap(font->ttf_buffer.data(),0,32.0,temp_bitmap,512,512,32,96,font->cdata);
-    glGenTextures(1, &font->font_texture); glBindTexture(GL_TEXTURE_2D, font->font_texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 512, 512, 0, GL_RED, GL_UNSIGNED_BYTE, temp_bitmap);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    return reinterpret_cast<sp_font_t*>(font);
-}
-void sp_destroy_font(sp_font_t* f) { if(f) { glDeleteTextures(1, &as_font(f)->font_texture); delete as_font(f); } }
-void sp_set_font(sp_canvas_t* c, sp_font_t* f, float size) { if (!c||!f) return; auto& s=as_canvas(c)->m_renderer->stateStack.top(); s.font=f; s.font_size=size; }
+    std::vector<unsigned char> data((size_t)file.tellg()); file.seekg(0, std::ios::beg);
+    if (!file.read((char*)data.data(), (std::streamsize)data.size())) return nullptr;
+    auto atlas = GlyphAtlas::create(std::move(data)); if (!atlas) return nullptr;
+    return reinterpret_cast<sp_font_t*>(new Font{std::move(atlas)});
+}
+void sp_destroy_font(sp_font_t* f) { delete as_font(f); }
+void sp_set_font(sp_canvas_t* c, sp_font_t* f, float size) { if (!c||!f) return; auto& s=as_canvas(c)->m_renderer->states().top(); s.font=f; s.font_size=size; }
 void sp_draw_text(sp_canvas_t* c, const char* text, float x, float y) {
-    if (!c || !text) return;
-    auto& state = as_canvas(c)->m_renderer->stateStack.top(); auto font = as_font(state.font); if (!font) return;
-    auto color_s = state.color; glm::vec4 color = {color_s.r, color_s.g, color_s.b, color_s.a};
-    float tid = as_canvas(c)->m_renderer->getTextureSlot(font->font_texture);
-    for (const char* ptr=text; *ptr; ptr++) {
-        unsigned char c_char = (unsigned char)*ptr;
-        if (c_char >= 32 && c_char < 128) {
-            stbtt_aligned_quad q;
-            stbtt_GetBakedQuad(font->cdata, 512, 512, c_char-32, &x, &y, &q, 1);
-            as_canvas(c)->m_renderer->addQuad({q.x0,q.y0,0,1},{q.x1,q.y0,0,1},{q.x1,q.y1,0,1},{q.x0,q.y1,0,1},color,tid,{q.s0,q.t0,q.s1,q.t1});
-        }
-    }
+    if (!c || !text) return; auto r=as_drawing(c);
+    auto& state = r->states().top(); auto font = as_font(state.font); if (!font || state.font_size <= 0.0f) return;
+    auto& cs = state.color;
+    if (auto list=r->recording()) { list->items.push_back(DrawList::Text{font, text, state.font_size, x, y, packColor(cs.r,cs.g,cs.b,cs.a), state.transform, state.blend_mode}); return; }
+    r->drawText(*font->atlas, font->atlas->layout(text, state.font_size), x, y, packColor(cs.r,cs.g,cs.b,cs.a));
+}
+// The line box of the text drawn at (0, 0): from the ascent above the baseline to the descent below.
+sp_rect_t sp_measure_text(sp_canvas_t* c, const char* text) {
+    if (!c || !text) return {0,0,0,0};
+    auto r=as_canvas(c)->m_renderer.get(); auto& state = r->states().top(); auto font = as_font(state.font); if (!font) return {0,0,0,0};
+    // Off the render thread the run is measured without touching the atlas or its cache.
+    if (r->recording()) { const TextLayout layout = font->atlas->measure(text, state.font_size); return {0.0f, -layout.ascent, layout.advance, layout.ascent - layout.descent}; }
+    as_canvas(c)->makeCurrent();
+    const TextLayout& layout = font->atlas->layout(text, state.font_size);
+    return {0.0f, -layout.ascent, layout.advance, layout.ascent - layout.descent};
 }
-sp_rect_t sp_measure_text(sp_canvas_t* c, const char* text) { return {0,0,0,0}; }
 
+// Software canvases keep each image whole as a software texture of its own.
 sp_image_t* sp_load_image(sp_canvas_t* c, const char* path) {
-    if (!c || !path) return nullptr;
-    auto image=new Image(); int chans; unsigned char* data = stbi_load(path, &image->width, &image->height, &chans, 4);
-    if (!data) { delete image; return nullptr; }
-    glGenTextures(1, &image->textureId); glBindTexture(GL_TEXTURE_2D, image->textureId);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->width, image->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    if (!c || !path) return nullptr; auto cv=as_canvas(c);
+    if (cv->m_software) {
+        int w, h, chans; unsigned char* data = stbi_load(path, &w, &h, &chans, 4); if (!data) return nullptr;
+        auto pixels = std::make_shared<const std::vector<uint8_t>>(data, data + (size_t)w * h * 4); stbi_image_free(data);
+        ImageRegion region; region.texture = registerSoftwareTexture({(uint32_t)w, (uint32_t)h, 4, std::move(pixels)});
+        return reinterpret_cast<sp_image_t*>(new Image{{region, w, h}, nullptr});
+    }
+    if (cv->m_device) return sp_device_load_image(reinterpret_cast<sp_device_t*>(&cv->m_device), path);
+    int w, h, chans; unsigned char* data = stbi_load(path, &w, &h, &chans, 4); if (!data) return nullptr;
+    cv->makeCurrent(); auto image=new Image{{cv->m_images->add(data, w, h), w, h}, cv->m_images.get()};
     stbi_image_free(data); return reinterpret_cast<sp_image_t*>(image);
 }
-void sp_destroy_image(sp_image_t* i) { if(i) { glDeleteTextures(1, &as_image(i)->textureId); delete as_image(i); } }
+// Decoded on the loader's pool; uploaded a frame budget at a time by sp_begin_frame, or all at
+// once by sp_finish_image_loads. Until then the image draws a placeholder, sized from the file's
+// header by sp_draw_image (nothing if the header cannot be read). Software canvases
+// have no frames to spread uploads over and load the image before returning.
+sp_image_t* sp_load_image_async(sp_canvas_t* c, const char* path) {
+    if (!c || !path) return nullptr; auto cv=as_canvas(c);
+    if (cv->m_software) return sp_load_image(c, path);
+    if (!cv->m_loader) cv->m_loader = std::make_unique<ImageLoader>();
+    auto image=new Image(); image->atlas=cv->m_images.get(); image->pending=cv->m_loader->load(path);
+    return reinterpret_cast<sp_image_t*>(image);
+}
+sp_image_status_t sp_get_image_status(sp_image_t* i) {
+    if (!i) return SP_IMAGE_FAILED; auto& pending=as_image(i)->pending; if (!pending) return SP_IMAGE_READY;
+    switch (pending->state.load(std::memory_order_acquire)) { case PendingImage::READY: return SP_IMAGE_READY; case PendingImage::FAILED: return SP_IMAGE_FAILED; default: return SP_IMAGE_LOADING; }
+}
+void sp_finish_image_loads(sp_canvas_t* c) { if (!c || !as_canvas(c)->m_loader) return; as_canvas(c)->makeCurrent(); as_canvas(c)->m_loader->finish(*as_canvas(c)->m_images); }
+void sp_destroy_image(sp_image_t* i) {
+    if (!i) return; auto img=as_image(i);
+    // Shared images release their pixels when the last handle drops its reference.
+    if (img->pending) { img->pending->cancelled=true; if (img->pending->state.load() == PendingImage::READY) img->atlas->release(img->pending->loaded.region); }
+    else if (!img->atlas) releaseSoftwareTexture(img->loaded.region.texture);
+    else if (!img->shared) img->atlas->release(img->loaded.region);
+    delete img;
+}
 void sp_draw_image(sp_canvas_t* c, sp_image_t* i, float x, float y) {
-    if (!c||!i) return; auto img=as_image(i); float tid=as_canvas(c)->m_renderer->getTextureSlot(img->textureId);
-    as_canvas(c)->m_renderer->addQuad({x,y,0,1},{x+img->width,y,0,1},{x+img->width,y+img->height,0,1},{x,y+img->height,0,1},{1,1,1,1},tid,{0,0,1,1});
+    if (!c||!i) return; auto img=as_image(i)->get(); auto r=as_drawing(c);
+    if (!img) {
+        const PendingImage& p=*as_image(i)->pending; if (p.width <= 0 || p.height <= 0) return;
+        r->addQuad({x,y},{x+p.width,y},{x+p.width,y+p.height},{x,y+p.height},IMAGE_PLACEHOLDER_COLOR,NO_TEXTURE_SLOT,{0,0,1,1}); return;
+    }
+    uint8_t tid=r->getTextureSlot(img->region.texture);
+    r->addQuad({x,y},{x+img->width,y},{x+img->width,y+img->height},{x,y+img->height},0xFFFFFFFFu,tid,imageTexCoords(*img,0,0,1,1),TEXTURE_MODE_RGBA);
 }
 void sp_draw_image_rect(sp_canvas_t* c, sp_image_t* i, sp_rect_t src, sp_rect_t dest) {
-    if (!c||!i) return; auto img=as_image(i); float tid=as_canvas(c)->m_renderer->getTextureSlot(img->textureId);
-    glm::vec4 tc={src.x/(float)img->width,src.y/(float)img->height,(src.x+src.w)/(float)img->width,(src.y+src.h)/(float)img->height};
-    as_canvas(c)->m_renderer->addQuad({dest.x,dest.y,0,1},{dest.x+dest.w,dest.y,0,1},{dest.x+dest.w,dest.y+dest.h,0,1},{dest.x,dest.y+dest.h,0,1},{1,1,1,1},tid,tc);
+    if (!c||!i) return; auto img=as_image(i)->get(); auto r=as_drawing(c);
+    if (!img) { r->addQuad({dest.x,dest.y},{dest.x+dest.w,dest.y},{dest.x+dest.w,dest.y+dest.h},{dest.x,dest.y+dest.h},IMAGE_PLACEHOLDER_COLOR,NO_TEXTURE_SLOT,{0,0,1,1}); return; }
+    uint8_t tid=r->getTextureSlot(img->region.texture);
+    glm::vec4 tc=imageTexCoords(*img,src.x/(float)img->width,src.y/(float)img->height,(src.x+src.w)/(float)img->width,(src.y+src.h)/(float)img->height);
+    r->addQuad({dest.x,dest.y},{dest.x+dest.w,dest.y},{dest.x+dest.w,dest.y+dest.h},{dest.x,dest.y+dest.h},0xFFFFFFFFu,tid,tc,TEXTURE_MODE_RGBA);
 }
 
 static void internal_key_cb(GLFWwindow* w, int k, int s, int a, int m) { auto* c=static_cast<Canvas*>(glfwGetWindowUserPointer(w)); if(c&&c->key_cb) c->key_cb(reinterpret_cast<sp_canvas_t*>(c),k,s,a,m); }
 static void internal_mouse_btn_cb(GLFWwindow* w, int b, int a, int m) { auto* c=static_cast<Canvas*>(glfwGetWindowUserPointer(w)); if(c&&c->mouse_btn_cb) c->mouse_btn_cb(reinterpret_cast<sp_canvas_t*>(c),b,a,m); }
 static void internal_cursor_pos_cb(GLFWwindow* w, double x, double y) { auto* c=static_cast<Canvas*>(glfwGetWindowUserPointer(w)); if(c&&c->cursor_pos_cb) c->cursor_pos_cb(reinterpret_cast<sp_canvas_t*>(c),x,y); }
 
-void sp_set_key_callback(sp_canvas_t* c, sp_key_callback_t cb) { if(!c)return; auto* cv=as_canvas(c); cv->key_cb=cb; glfwSetKeyCallback(cv->m_window, cb?internal_key_cb:nullptr); }
-void sp_set_mouse_button_callback(sp_canvas_t* c, sp_mouse_button_callback_t cb) { if(!c)return; auto* cv=as_canvas(c); cv->mouse_btn_cb=cb; glfwSetMouseButtonCallback(cv->m_window, cb?internal_mouse_btn_cb:nullptr); }
-void sp_set_cursor_pos_callback(sp_canvas_t* c, sp_cursor_pos_callback_t cb) { if(!c)return; auto* cv=as_canvas(c); cv->cursor_pos_cb=cb; glfwSetCursorPosCallback(cv->m_window, cb?internal_cursor_pos_cb:nullptr); }
+void sp_set_key_callback(sp_canvas_t* c, sp_key_callback_t cb) { if(!c)return; auto* cv=as_canvas(c); cv->key_cb=cb; if(cv->m_offscreen)return; glfwSetKeyCallback(cv->m_window, cb?internal_key_cb:nullptr); }
+void sp_set_mouse_button_callback(sp_canvas_t* c, sp_mouse_button_callback_t cb) { if(!c)return; auto* cv=as_canvas(c); cv->mouse_btn_cb=cb; if(cv->m_offscreen)return; glfwSetMouseButtonCallback(cv->m_window, cb?internal_mouse_btn_cb:nullptr); }
+void sp_set_cursor_pos_callback(sp_canvas_t* c, sp_cursor_pos_callback_t cb) { if(!c)return; auto* cv=as_canvas(c); cv->cursor_pos_cb=cb; if(cv->m_offscreen)return; glfwSetCursorPosCallback(cv->m_window, cb?internal_cursor_pos_cb:nullptr); }
@@ -0,0 +1,87 @@
+#include "curve.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace spiro::internal {
+
+namespace {
+
+size_t clampSegments(float n)
+{
+    if (!(n >= 1.0f)) return 1;
+    return n >= (float)MAX_CURVE_SEGMENTS ? MAX_CURVE_SEGMENTS : (size_t)std::ceil(n);
+}
+
+}
+
+size_t cubicSegments(sp_vec2_t p0, sp_vec2_t c1, sp_vec2_t c2, sp_vec2_t p3, float scale, float tolerance)
+{
+    const float ax = p0.x - 2.0f * c1.x + c2.x, ay = p0.y - 2.0f * c1.y + c2.y;
+    const float bx = c1.x - 2.0f * c2.x + p3.x, by = c1.y - 2.0f * c2.y + p3.y;
+    const float m = std::max(std::sqrt(ax * ax + ay * ay), std::sqrt(bx * bx + by * by)) * scale;
+    // Wang's formula for degree 3: n = sqrt(3 * 2 / 8 * m / tolerance).
+    return clampSegments(std::sqrt(0.75f * m / tolerance));
+}
+
+size_t arcSegments(float radius, float sweep, float scale, float tolerance)
+{
+    const float r = std::abs(radius) * scale;
+    if (r <= tolerance) return 1;
+    return clampSegments(std::abs(sweep) / (2.0f * std::acos(1.0f - tolerance / r)));
+}
+
+void flattenCubic(sp_vec2_t p0, sp_vec2_t c1, sp_vec2_t c2, sp_vec2_t p3, size_t segments, std::vector<sp_vec2_t>& out)
+{
+    if (segments < 2) return;
+    // B(t) = a t^3 + b t^2 + c t + p0, stepped in double so long runs do not drift.
+    const double h = 1.0 / (double)segments, h2 = h * h, h3 = h2 * h;
+    const double ax = -p0.x + 3.0 * c1.x - 3.0 * c2.x + p3.x, ay = -p0.y + 3.0 * c1.y - 3.0 * c2.y + p3.y;
+    const double bx = 3.0 * p0.x - 6.0 * c1.x + 3.0 * c2.x, by = 3.0 * p0.y - 6.0 * c1.y + 3.0 * c2.y;
+    const double cx = 3.0 * (c1.x - p0.x), cy = 3.0 * (c1.y - p0.y);
+    double x = p0.x, y = p0.y;
+    double dx = ax * h3 + bx * h2 + cx * h, dy = ay * h3 + by * h2 + cy * h;
+    double ddx = 6.0 * ax * h3 + 2.0 * bx * h2, ddy = 6.0 * ay * h3 + 2.0 * by * h2;
+    const double dddx = 6.0 * ax * h3, dddy = 6.0 * ay * h3;
+    for (size_t i = 1; i < segments; ++i) {
+        x += dx; y += dy;
+        dx += ddx; dy += ddy;
+        ddx += dddx; ddy += dddy;
+        out.push_back({(float)x, (float)y});
+    }
+}
+
+void flattenArc(sp_vec2_t start, sp_vec2_t center, float sweep, size_t segments, std::vector<sp_vec2_t>& out)
+{
+    if (segments < 2) return;
+    const float rx = start.x - center.x, ry = start.y - center.y;
+    // Rotating the radius by a fixed step keeps one sin/cos pair for the whole arc.
+    const double step = (double)sweep / (double)segments, cs = std::cos(step), sn = std::sin(step);
+    double x = rx, y = ry;
+    for (size_t i = 1; i < segments; ++i) {
+        const double nx = x * cs - y * sn;
+        y = x * sn + y * cs;
+        x = nx;
+        out.push_back({center.x + (float)x, center.y + (float)y});
+    }
+}
+
+void flattenPath(const sp_vec2_t* points, size_t count, const PathCurve* curves, size_t curveCount, float scale,
+                 float tolerance, std::vector<sp_vec2_t>& out)
+{
+    out.clear();
+    const PathCurve* curve = curves, * lastCurve = curves + curveCount;
+    for (size_t i = 0; i < count; ++i) {
+        for (; curve != lastCurve && curve->end == i; ++curve) {
+            if (i == 0) continue;
+            const sp_vec2_t& from = points[i - 1], & to = points[i];
+            if (curve->kind == PathCurve::Kind::Cubic)
+                flattenCubic(from, curve->c1, curve->c2, to, cubicSegments(from, curve->c1, curve->c2, to, scale, tolerance), out);
+            else
+                flattenArc(from, curve->c1, curve->sweep, arcSegments(curve->radius, curve->sweep, scale, tolerance), out);
+        }
+        out.push_back(points[i]);
+    }
+}
+
+}
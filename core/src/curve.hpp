@@ -0,0 +1,43 @@
+#pragma once
+
+#include <spirographicals/spirographicals.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spiro::internal {
+
+// How far a flattened curve may stray from the true one, in device pixels.
+constexpr float CURVE_TOLERANCE = 0.25f;
+// Upper bound on the segments one curve flattens into, however far it is zoomed.
+constexpr size_t MAX_CURVE_SEGMENTS = 1 << 16;
+
+// A curved edge of a path, from the point before `end` to the point at `end`.
+struct PathCurve {
+    enum class Kind : uint8_t { Cubic, Arc };
+    Kind kind;
+    size_t end;
+    // Cubic: the two control points. Arc: c1 is the center and c2 is unused.
+    sp_vec2_t c1, c2;
+    // Arc only: the sweep from the start point's angle, in radians, positive clockwise on
+    // screen (y down).
+    float radius, sweep;
+};
+
+// Segment counts for the given device pixels per path unit. Cubics use Wang's formula, which
+// bounds the chord error of uniform steps by the control polygon's second differences; arcs
+// use the exact chord height. Both are at least 1 and at most MAX_CURVE_SEGMENTS.
+size_t cubicSegments(sp_vec2_t p0, sp_vec2_t c1, sp_vec2_t c2, sp_vec2_t p3, float scale, float tolerance);
+size_t arcSegments(float radius, float sweep, float scale, float tolerance);
+
+// Appends the points strictly between the curve's ends, `segments - 1` of them. Cubics are
+// stepped by forward differencing: three additions per point.
+void flattenCubic(sp_vec2_t p0, sp_vec2_t c1, sp_vec2_t c2, sp_vec2_t p3, size_t segments, std::vector<sp_vec2_t>& out);
+void flattenArc(sp_vec2_t start, sp_vec2_t center, float sweep, size_t segments, std::vector<sp_vec2_t>& out);
+
+// Replaces `out` with the path's points with every curve, sorted by end, flattened in between.
+void flattenPath(const sp_vec2_t* points, size_t count, const PathCurve* curves, size_t curveCount, float scale,
+                 float tolerance, std::vector<sp_vec2_t>& out);
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace spiro::internal {
+
+// Objects lent out for one frame and all taken back at once when the next begins. Nothing is
+// freed on reset and each object keeps whatever capacity it grew to, so once a scene's frames
+// look alike they reuse the same objects and allocate nothing. Callers clear an object's
+// contents when they acquire it.
+template <typename T>
+class FramePool {
+public:
+    T* acquire()
+    {
+        if (m_used == m_items.size()) m_items.push_back(std::make_unique<T>());
+        return m_items[m_used++].get();
+    }
+    void reset() { m_used = 0; }
+    size_t inUse() const { return m_used; }
+
+private:
+    std::vector<std::unique_ptr<T>> m_items;
+    size_t m_used = 0;
+};
+
+}
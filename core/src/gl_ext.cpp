@@ -0,0 +1,50 @@
+#include "gl_ext.hpp"
+
+#include <cstring>
+
+PFNSPIROGLFENCESYNCPROC spiro_glFenceSync = nullptr;
+PFNSPIROGLCLIENTWAITSYNCPROC spiro_glClientWaitSync = nullptr;
+PFNSPIROGLDELETESYNCPROC spiro_glDeleteSync = nullptr;
+PFNSPIROGLBUFFERSTORAGEPROC spiro_glBufferStorage = nullptr;
+PFNSPIROGLGETQUERYOBJECTUI64VPROC spiro_glGetQueryObjectui64v = nullptr;
+PFNSPIROGLDRAWARRAYSINSTANCEDPROC spiro_glDrawArraysInstanced = nullptr;
+PFNSPIROGLVERTEXATTRIBDIVISORPROC spiro_glVertexAttribDivisor = nullptr;
+PFNSPIROGLCOPYBUFFERSUBDATAPROC spiro_glCopyBufferSubData = nullptr;
+
+namespace spiro::internal {
+
+GLCaps g_glCaps;
+
+bool hasGLExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+        if (ext && std::strcmp(ext, name) == 0) return true;
+    }
+    return false;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+    spiro_glFenceSync = reinterpret_cast<PFNSPIROGLFENCESYNCPROC>(load("glFenceSync"));
+    spiro_glClientWaitSync = reinterpret_cast<PFNSPIROGLCLIENTWAITSYNCPROC>(load("glClientWaitSync"));
+    spiro_glDeleteSync = reinterpret_cast<PFNSPIROGLDELETESYNCPROC>(load("glDeleteSync"));
+    spiro_glBufferStorage = reinterpret_cast<PFNSPIROGLBUFFERSTORAGEPROC>(load("glBufferStorage"));
+    spiro_glGetQueryObjectui64v = reinterpret_cast<PFNSPIROGLGETQUERYOBJECTUI64VPROC>(load("glGetQueryObjectui64v"));
+    spiro_glDrawArraysInstanced = reinterpret_cast<PFNSPIROGLDRAWARRAYSINSTANCEDPROC>(load("glDrawArraysInstanced"));
+    spiro_glVertexAttribDivisor = reinterpret_cast<PFNSPIROGLVERTEXATTRIBDIVISORPROC>(load("glVertexAttribDivisor"));
+    spiro_glCopyBufferSubData = reinterpret_cast<PFNSPIROGLCOPYBUFFERSUBDATAPROC>(load("glCopyBufferSubData"));
+    g_glCaps.sync = spiro_glFenceSync && spiro_glClientWaitSync && spiro_glDeleteSync;
+    const bool core44 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+    g_glCaps.bufferStorage = spiro_glBufferStorage && (core44 || hasGLExtension("GL_ARB_buffer_storage"));
+    const bool core31 = GLVersion.major > 3 || (GLVersion.major == 3 && GLVersion.minor >= 1);
+    g_glCaps.copyBuffer = spiro_glCopyBufferSubData && (core31 || hasGLExtension("GL_ARB_copy_buffer"));
+    const bool core33 = GLVersion.major > 3 || (GLVersion.major == 3 && GLVersion.minor >= 3);
+    g_glCaps.timerQuery = spiro_glGetQueryObjectui64v && (core33 || hasGLExtension("GL_ARB_timer_query"));
+    g_glCaps.instancing = spiro_glDrawArraysInstanced && spiro_glVertexAttribDivisor &&
+                          (core33 || (hasGLExtension("GL_ARB_instanced_arrays") && hasGLExtension("GL_ARB_draw_instanced")));
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Entry points newer than the GL 3.0 core profile that third_party/glad was generated for.
+// They are resolved at context creation through the same loader as glad and are null when
+// the driver does not expose them, so callers check the matching capability flag first.
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+#ifndef GL_COPY_READ_BUFFER
+#define GL_COPY_READ_BUFFER 0x8F36
+#define GL_COPY_WRITE_BUFFER 0x8F37
+#endif
+
+typedef GLsync(APIENTRYP PFNSPIROGLFENCESYNCPROC)(GLenum condition, GLbitfield flags);
+typedef GLenum(APIENTRYP PFNSPIROGLCLIENTWAITSYNCPROC)(GLsync sync, GLbitfield flags,
+                                                      GLuint64 timeout);
+typedef void(APIENTRYP PFNSPIROGLDELETESYNCPROC)(GLsync sync);
+typedef void(APIENTRYP PFNSPIROGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data,
+                                                    GLbitfield flags);
+typedef void(APIENTRYP PFNSPIROGLGETQUERYOBJECTUI64VPROC)(GLuint id, GLenum pname, GLuint64* params);
+typedef void(APIENTRYP PFNSPIROGLDRAWARRAYSINSTANCEDPROC)(GLenum mode, GLint first, GLsizei count,
+                                                          GLsizei instanceCount);
+typedef void(APIENTRYP PFNSPIROGLVERTEXATTRIBDIVISORPROC)(GLuint index, GLuint divisor);
+typedef void(APIENTRYP PFNSPIROGLCOPYBUFFERSUBDATAPROC)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+                                                        GLintptr writeOffset, GLsizeiptr size);
+
+extern PFNSPIROGLFENCESYNCPROC spiro_glFenceSync;
+extern PFNSPIROGLCLIENTWAITSYNCPROC spiro_glClientWaitSync;
+extern PFNSPIROGLDELETESYNCPROC spiro_glDeleteSync;
+extern PFNSPIROGLBUFFERSTORAGEPROC spiro_glBufferStorage;
+extern PFNSPIROGLGETQUERYOBJECTUI64VPROC spiro_glGetQueryObjectui64v;
+extern PFNSPIROGLDRAWARRAYSINSTANCEDPROC spiro_glDrawArraysInstanced;
+extern PFNSPIROGLVERTEXATTRIBDIVISORPROC spiro_glVertexAttribDivisor;
+extern PFNSPIROGLCOPYBUFFERSUBDATAPROC spiro_glCopyBufferSubData;
+#define glFenceSync spiro_glFenceSync
+#define glClientWaitSync spiro_glClientWaitSync
+#define glDeleteSync spiro_glDeleteSync
+#define glBufferStorage spiro_glBufferStorage
+#define glGetQueryObjectui64v spiro_glGetQueryObjectui64v
+#define glDrawArraysInstanced spiro_glDrawArraysInstanced
+#define glVertexAttribDivisor spiro_glVertexAttribDivisor
+#define glCopyBufferSubData spiro_glCopyBufferSubData
+
+namespace spiro::internal {
+
+struct GLCaps {
+    bool sync = false;
+    // GL 4.4 or ARB_buffer_storage: immutable storage that can stay mapped while drawing.
+    bool bufferStorage = false;
+    // GL 3.3 or ARB_timer_query: GL_TIME_ELAPSED queries with 64-bit nanosecond results.
+    bool timerQuery = false;
+    // GL 3.3 or ARB_instanced_arrays + ARB_draw_instanced: per-instance vertex attributes.
+    bool instancing = false;
+    // GL 3.1 or ARB_copy_buffer: buffer-to-buffer copies queued on the GPU.
+    bool copyBuffer = false;
+};
+
+extern GLCaps g_glCaps;
+
+// Must be called with the new context current, after gladLoadGLLoader.
+void loadGLExtensions(GLADloadproc load);
+
+bool hasGLExtension(const char* name);
+
+}
@@ -0,0 +1,197 @@
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "glyph_atlas.hpp"
+
+#include "software_texture.hpp"
+#include "utf8.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace spiro::internal {
+
+namespace {
+
+// Field value on the outline; each atlas pixel away from it changes the value by
+// ON_EDGE / SDF_PADDING, so the padding spans the whole 0..255 range.
+constexpr unsigned char ON_EDGE = 128;
+// Empty texels between glyphs so linear filtering never picks up a neighbour.
+constexpr int GUTTER = 1;
+
+}
+
+size_t GlyphAtlas::LayoutKeyHash::operator()(const LayoutKey& key) const
+{
+    uint32_t sizeBits;
+    std::memcpy(&sizeBits, &key.size, sizeof(sizeBits));
+    return std::hash<std::string>()(key.text) ^ (std::hash<uint32_t>()(sizeBits) * 0x9E3779B9u);
+}
+
+std::unique_ptr<GlyphAtlas> GlyphAtlas::create(std::vector<unsigned char> fontData)
+{
+    if (fontData.empty()) return nullptr;
+    auto atlas = std::unique_ptr<GlyphAtlas>(new GlyphAtlas());
+    atlas->m_fontData = std::move(fontData);
+    const unsigned char* data = atlas->m_fontData.data();
+    const int offset = stbtt_GetFontOffsetForIndex(data, 0);
+    if (offset < 0 || !stbtt_InitFont(&atlas->m_info, data, offset)) return nullptr;
+    int ascent = 0, descent = 0, lineGap = 0;
+    stbtt_GetFontVMetrics(&atlas->m_info, &ascent, &descent, &lineGap);
+    atlas->m_scale = stbtt_ScaleForPixelHeight(&atlas->m_info, SDF_PIXEL_HEIGHT);
+    atlas->m_ascent = (float)ascent * atlas->m_scale;
+    atlas->m_descent = (float)descent * atlas->m_scale;
+    return atlas;
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    for (auto& page : m_pages) {
+        // Atlases only ever drawn by the software rasterizer made no GL objects.
+        if (page.texture) glDeleteTextures(1, &page.texture);
+        if (page.softwareTexture) releaseSoftwareTexture(page.softwareTexture);
+    }
+}
+
+void GlyphAtlas::addPage()
+{
+    Page page;
+    // Cleared so gutters read as "far outside".
+    page.pixels = std::make_shared<std::vector<unsigned char>>((size_t)PAGE_SIZE * PAGE_SIZE, 0);
+    m_pages.push_back(std::move(page));
+}
+
+GLuint GlyphAtlas::pageTexture(uint32_t page)
+{
+    Page& p = m_pages[page];
+    if (!p.texture) {
+        glGenTextures(1, &p.texture);
+        glBindTexture(GL_TEXTURE_2D, p.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, PAGE_SIZE, PAGE_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, p.pixels->data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    } else if (p.dirtyX0 < p.dirtyX1) {
+        glBindTexture(GL_TEXTURE_2D, p.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, PAGE_SIZE);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, p.dirtyX0, p.dirtyY0, p.dirtyX1 - p.dirtyX0, p.dirtyY1 - p.dirtyY0, GL_RED, GL_UNSIGNED_BYTE,
+                        p.pixels->data() + (size_t)p.dirtyY0 * PAGE_SIZE + p.dirtyX0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    p.dirtyX0 = p.dirtyX1 = 0;
+    return p.texture;
+}
+
+GLuint GlyphAtlas::softwarePageTexture(uint32_t page)
+{
+    Page& p = m_pages[page];
+    if (!p.softwareTexture) p.softwareTexture = registerSoftwareTexture({PAGE_SIZE, PAGE_SIZE, 1, p.pixels});
+    return p.softwareTexture;
+}
+
+// Shelf packing: glyphs fill rows left to right, and a row is as tall as its tallest glyph.
+bool GlyphAtlas::place(int width, int height, uint32_t& page, int& x, int& y)
+{
+    if (width > PAGE_SIZE || height > PAGE_SIZE) return false;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (m_pages.empty() || attempt == 1) addPage();
+        Page& p = m_pages.back();
+        if (p.shelfX + width > PAGE_SIZE) {
+            p.shelfY += p.shelfHeight + GUTTER;
+            p.shelfX = 0;
+            p.shelfHeight = 0;
+        }
+        if (p.shelfY + height <= PAGE_SIZE) {
+            page = (uint32_t)(m_pages.size() - 1);
+            x = p.shelfX;
+            y = p.shelfY;
+            p.shelfX += width + GUTTER;
+            p.shelfHeight = std::max(p.shelfHeight, height);
+            return true;
+        }
+    }
+    return false;
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::glyph(int index)
+{
+    auto found = m_glyphs.find(index);
+    if (found != m_glyphs.end()) return found->second;
+
+    Glyph g{};
+    int advance = 0, leftBearing = 0;
+    stbtt_GetGlyphHMetrics(&m_info, index, &advance, &leftBearing);
+    g.advance = (float)advance * m_scale;
+    int width = 0, height = 0, xoff = 0, yoff = 0;
+    unsigned char* field = stbtt_GetGlyphSDF(&m_info, m_scale, index, SDF_PADDING, ON_EDGE, (float)ON_EDGE / SDF_PADDING,
+                                             &width, &height, &xoff, &yoff);
+    // Blank glyphs such as spaces have no field and only advance the pen.
+    if (field && place(width, height, g.page, g.x, g.y)) {
+        Page& p = m_pages[g.page];
+        for (int row = 0; row < height; ++row)
+            std::memcpy(p.pixels->data() + (size_t)(g.y + row) * PAGE_SIZE + g.x, field + (size_t)row * width, (size_t)width);
+        const bool dirty = p.dirtyX0 < p.dirtyX1;
+        p.dirtyX0 = dirty ? std::min(p.dirtyX0, g.x) : g.x;
+        p.dirtyY0 = dirty ? std::min(p.dirtyY0, g.y) : g.y;
+        p.dirtyX1 = dirty ? std::max(p.dirtyX1, g.x + width) : g.x + width;
+        p.dirtyY1 = dirty ? std::max(p.dirtyY1, g.y + height) : g.y + height;
+        g.hasField = true;
+        g.width = width;
+        g.height = height;
+        g.xoff = (float)xoff;
+        g.yoff = (float)yoff;
+    }
+    if (field) stbtt_FreeSDF(field, nullptr);
+    return m_glyphs.emplace(index, g).first->second;
+}
+
+const TextLayout& GlyphAtlas::layout(const char* text, float size)
+{
+    LayoutKey key{text, size};
+    auto found = m_layouts.find(key);
+    if (found != m_layouts.end()) return found->second;
+    if (m_layouts.size() >= MAX_CACHED_LAYOUTS) m_layouts.clear();
+
+    const float k = size / SDF_PIXEL_HEIGHT, texel = 1.0f / PAGE_SIZE;
+    TextLayout run{{}, 0.0f, m_ascent * k, m_descent * k};
+    float pen = 0.0f;
+    int previous = -1;
+    for (const char* p = text; *p;) {
+        const int index = stbtt_FindGlyphIndex(&m_info, (int)decodeUtf8(p));
+        if (previous >= 0) pen += (float)stbtt_GetGlyphKernAdvance(&m_info, previous, index) * m_scale * k;
+        const Glyph& g = glyph(index);
+        if (g.hasField) {
+            run.quads.push_back({pen + g.xoff * k, g.yoff * k, pen + (g.xoff + (float)g.width) * k, (g.yoff + (float)g.height) * k,
+                                 (float)g.x * texel, (float)g.y * texel, (float)(g.x + g.width) * texel, (float)(g.y + g.height) * texel,
+                                 g.page});
+        }
+        pen += g.advance * k;
+        previous = index;
+    }
+    run.advance = pen;
+    return m_layouts.emplace(std::move(key), std::move(run)).first->second;
+}
+
+TextLayout GlyphAtlas::measure(const char* text, float size) const
+{
+    const float k = size / SDF_PIXEL_HEIGHT;
+    TextLayout run{{}, 0.0f, m_ascent * k, m_descent * k};
+    float pen = 0.0f;
+    int previous = -1;
+    for (const char* p = text; *p;) {
+        const int index = stbtt_FindGlyphIndex(&m_info, (int)decodeUtf8(p));
+        if (previous >= 0) pen += (float)stbtt_GetGlyphKernAdvance(&m_info, previous, index) * m_scale * k;
+        int advance = 0, leftBearing = 0;
+        stbtt_GetGlyphHMetrics(&m_info, index, &advance, &leftBearing);
+        pen += (float)advance * m_scale * k;
+        previous = index;
+    }
+    run.advance = pen;
+    return run;
+}
+
+}
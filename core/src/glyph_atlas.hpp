@@ -0,0 +1,105 @@
+#pragma once
+
+#include "gl_ext.hpp"
+
+#include <stb_truetype.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spiro::internal {
+
+// One glyph of a laid-out run, relative to the pen origin on the baseline with y down.
+// Texture coordinates are normalized within atlas page `page`.
+struct GlyphQuad {
+    float x0, y0, x1, y1;
+    float s0, t0, s1, t1;
+    uint32_t page;
+};
+
+struct TextLayout {
+    std::vector<GlyphQuad> quads;
+    // Pen advance of the whole run, and the font's ascent/descent (descent is negative).
+    float advance, ascent, descent;
+};
+
+// Size-independent glyph cache for one font. Each glyph is rasterized once, on first use, as
+// a signed distance field at SDF_PIXEL_HEIGHT and shelf-packed into fixed-size pages. A full
+// page is never resized; a new one is added instead, so glyphs never move and cached texture
+// coordinates stay valid. Every size samples the same field and the fragment shader rebuilds
+// the outline. Laid-out runs are cached per (text, size), so a repeated label costs one hash
+// lookup. Pages live on the CPU; the GL texture of a page is made from there when a GL
+// renderer first draws from it, and the software rasterizer samples the CPU copy directly.
+class GlyphAtlas {
+public:
+    static constexpr float SDF_PIXEL_HEIGHT = 32.0f;
+    // Distance range in atlas pixels on either side of the outline; also the bitmap margin.
+    static constexpr int SDF_PADDING = 4;
+    static constexpr int PAGE_SIZE = 1024;
+    // The run cache starts over once it holds this many entries.
+    static constexpr size_t MAX_CACHED_LAYOUTS = 8192;
+
+    // Null if the data is not a font stb_truetype can read. Takes ownership of the data.
+    static std::unique_ptr<GlyphAtlas> create(std::vector<unsigned char> fontData);
+    ~GlyphAtlas();
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    // Lays out UTF-8 text at `size` pixels per em-height, rasterizing missing glyphs into the
+    // CPU pages. Touches no GL state.
+    const TextLayout& layout(const char* text, float size);
+    // Advance and line metrics of `layout(text, size)`, without quads. Reads the font only and
+    // touches no cache or GL state, so any thread may call it.
+    TextLayout measure(const char* text, float size) const;
+    // The page as a GL texture, created or brought up to date with the glyphs added since. The
+    // owning context must be current.
+    GLuint pageTexture(uint32_t page);
+    // The page as a software texture (software_texture.hpp), which sees new glyphs as they come.
+    GLuint softwarePageTexture(uint32_t page);
+    size_t pageCount() const { return m_pages.size(); }
+    // The font file this atlas was created from.
+    const std::vector<unsigned char>& fontData() const { return m_fontData; }
+
+private:
+    // Metrics in atlas pixels at SDF_PIXEL_HEIGHT.
+    struct Glyph {
+        bool hasField;
+        uint32_t page;
+        int x, y, width, height;
+        float xoff, yoff, advance;
+    };
+    struct Page {
+        std::shared_ptr<std::vector<unsigned char>> pixels;
+        GLuint texture = 0, softwareTexture = 0;
+        // Texels written since the GL texture was last updated; none while x0 >= x1.
+        int dirtyX0 = 0, dirtyY0 = 0, dirtyX1 = 0, dirtyY1 = 0;
+        int shelfX = 0, shelfY = 0, shelfHeight = 0;
+    };
+    struct LayoutKey {
+        std::string text;
+        float size;
+        bool operator==(const LayoutKey& other) const { return size == other.size && text == other.text; }
+    };
+    struct LayoutKeyHash {
+        size_t operator()(const LayoutKey& key) const;
+    };
+
+    GlyphAtlas() = default;
+    const Glyph& glyph(int index);
+    bool place(int width, int height, uint32_t& page, int& x, int& y);
+    void addPage();
+
+    std::vector<unsigned char> m_fontData;
+    stbtt_fontinfo m_info{};
+    float m_scale = 0.0f, m_ascent = 0.0f, m_descent = 0.0f;
+    std::vector<Page> m_pages;
+    // Keyed by glyph index, so code points that map to the same glyph share one field.
+    std::unordered_map<int, Glyph> m_glyphs;
+    std::unordered_map<LayoutKey, TextLayout, LayoutKeyHash> m_layouts;
+};
+
+}
@@ -0,0 +1,72 @@
+#include "gpu_timer.hpp"
+
+namespace spiro::internal {
+
+GpuTimer::~GpuTimer()
+{
+    for (auto& frame : m_frames) m_free.insert(m_free.end(), frame.begin(), frame.end());
+    if (!m_free.empty()) glDeleteQueries((GLsizei)m_free.size(), m_free.data());
+}
+
+void GpuTimer::release(std::vector<GLuint>& frame)
+{
+    m_free.insert(m_free.end(), frame.begin(), frame.end());
+    frame.clear();
+}
+
+void GpuTimer::begin()
+{
+    if (!g_glCaps.timerQuery || m_running) return;
+    GLuint query = 0;
+    if (m_free.empty()) glGenQueries(1, &query);
+    else query = m_free.back(), m_free.pop_back();
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    current().push_back(query);
+    m_running = true;
+}
+
+void GpuTimer::end()
+{
+    if (!m_running) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m_running = false;
+}
+
+void GpuTimer::endFrame()
+{
+    if (!g_glCaps.timerQuery) return;
+    end();
+    m_pending++;
+    if (m_pending > MAX_PENDING_FRAMES) {
+        release(m_frames[m_oldest]);
+        m_oldest = (m_oldest + 1) % m_frames.size();
+        m_pending--;
+    }
+}
+
+bool GpuTimer::poll(double& milliseconds)
+{
+    bool collected = false;
+    while (m_pending > 0) {
+        auto& frame = m_frames[m_oldest];
+        for (GLuint query : frame) {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return collected;
+        }
+        GLuint64 total = 0;
+        for (GLuint query : frame) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            total += elapsed;
+        }
+        release(frame);
+        m_oldest = (m_oldest + 1) % m_frames.size();
+        m_pending--;
+        milliseconds = (double)total / 1.0e6;
+        collected = true;
+    }
+    return collected;
+}
+
+}
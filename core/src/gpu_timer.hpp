@@ -0,0 +1,46 @@
+#pragma once
+
+#include "gl_ext.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace spiro::internal {
+
+// GPU time per frame from GL_TIME_ELAPSED queries around each submitted workload. Results are
+// collected a few frames late without ever waiting on the GPU, so poll() reports the newest
+// frame that has finished rather than the one just submitted. Everything is a no-op when the
+// context has no timer queries.
+class GpuTimer {
+public:
+    GpuTimer() = default;
+    ~GpuTimer();
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // Brackets one workload. Elapsed-time queries cannot nest, so pairs must not overlap.
+    void begin();
+    void end();
+    // Closes the queries issued since the previous call as one frame.
+    void endFrame();
+    // Collects finished frames. Returns false if none finished since the last call, otherwise
+    // sets `milliseconds` to the GPU time of the newest one.
+    bool poll(double& milliseconds);
+
+private:
+    // Frames still in flight beyond this are dropped instead of piling up queries.
+    static constexpr size_t MAX_PENDING_FRAMES = 8;
+
+    // The frame being recorded sits in the slot after the pending ones. Slots keep their
+    // capacity, so steady-state frames allocate nothing.
+    std::vector<GLuint>& current() { return m_frames[(m_oldest + m_pending) % m_frames.size()]; }
+    void release(std::vector<GLuint>& frame);
+
+    std::vector<GLuint> m_free;
+    std::array<std::vector<GLuint>, MAX_PENDING_FRAMES + 1> m_frames;
+    size_t m_oldest = 0, m_pending = 0;
+    bool m_running = false;
+};
+
+}
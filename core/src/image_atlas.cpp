@@ -0,0 +1,137 @@
+#include "image_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace spiro::internal {
+
+namespace {
+
+// Repeated edge texels around each packed image, and the empty gap between neighbours.
+constexpr int BORDER = 1;
+
+void setSamplingParameters()
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+}
+
+ImageAtlas::~ImageAtlas()
+{
+    for (auto& page : m_pages) glDeleteTextures(1, &page.texture);
+}
+
+void ImageAtlas::addPage()
+{
+    Page page;
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    setSamplingParameters();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, PAGE_SIZE, PAGE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    m_pages.push_back(page);
+}
+
+// Shelf packing as in the glyph atlas, except that any page may take the image: pages emptied
+// by release() start over and are filled again before a new one is added.
+bool ImageAtlas::place(int width, int height, int& page, int& x, int& y)
+{
+    for (size_t i = 0; i <= m_pages.size(); ++i) {
+        if (i == m_pages.size()) addPage();
+        Page& p = m_pages[i];
+        int shelfX = p.shelfX, shelfY = p.shelfY, shelfHeight = p.shelfHeight;
+        if (shelfX + width > PAGE_SIZE) {
+            shelfY += shelfHeight + BORDER;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        if (shelfY + height > PAGE_SIZE) continue;
+        page = (int)i;
+        x = shelfX;
+        y = shelfY;
+        p.shelfX = shelfX + width + BORDER;
+        p.shelfY = shelfY;
+        p.shelfHeight = std::max(shelfHeight, height);
+        return true;
+    }
+    return false;
+}
+
+template <typename Write>
+void ImageAtlas::upload(GLuint texture, int x, int y, int width, int height, Write write)
+{
+    const size_t bytes = (size_t)width * height * 4;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (bytes <= STAGING_WINDOW_BYTES) {
+        if (!m_staging) m_staging = std::make_unique<StreamBuffer>(GL_PIXEL_UNPACK_BUFFER, STAGING_WINDOW_BYTES, STAGING_WINDOWS);
+        if (auto staged = static_cast<unsigned char*>(m_staging->map())) {
+            write(staged);
+            const size_t offset = m_staging->commit(bytes);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)offset);
+            m_staging->retire();
+            // Left bound, it would turn every later client-memory upload into a buffer offset.
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    std::vector<unsigned char> pixels(bytes);
+    write(pixels.data());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+ImageRegion ImageAtlas::add(const unsigned char* rgba, int width, int height)
+{
+    ImageRegion region;
+    const int paddedWidth = width + 2 * BORDER, paddedHeight = height + 2 * BORDER;
+    int x = 0, y = 0;
+    if (width > MAX_PACKED_SIZE || height > MAX_PACKED_SIZE || !place(paddedWidth, paddedHeight, region.page, x, y)) {
+        region.page = -1;
+        glGenTextures(1, &region.texture);
+        glBindTexture(GL_TEXTURE_2D, region.texture);
+        setSamplingParameters();
+        const size_t bytes = (size_t)width * height * 4;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes > STAGING_WINDOW_BYTES ? rgba : nullptr);
+        if (bytes <= STAGING_WINDOW_BYTES)
+            upload(region.texture, 0, 0, width, height, [&](unsigned char* out) { std::memcpy(out, rgba, bytes); });
+        return region;
+    }
+
+    Page& page = m_pages[region.page];
+    page.images++;
+    // The image with each edge row and column repeated once more outside it.
+    upload(page.texture, x, y, paddedWidth, paddedHeight, [&](unsigned char* padded) {
+        for (int py = 0; py < paddedHeight; ++py) {
+            const int sy = std::clamp(py - BORDER, 0, height - 1);
+            unsigned char* row = padded + (size_t)py * paddedWidth * 4;
+            std::memcpy(row + BORDER * 4, rgba + (size_t)sy * width * 4, (size_t)width * 4);
+            for (int b = 0; b < BORDER; ++b) {
+                std::memcpy(row + b * 4, row + BORDER * 4, 4);
+                std::memcpy(row + (size_t)(BORDER + width + b) * 4, row + (size_t)(BORDER + width - 1) * 4, 4);
+            }
+        }
+    });
+    const float texel = 1.0f / PAGE_SIZE;
+    region.texture = page.texture;
+    region.s0 = (float)(x + BORDER) * texel;
+    region.t0 = (float)(y + BORDER) * texel;
+    region.s1 = (float)(x + BORDER + width) * texel;
+    region.t1 = (float)(y + BORDER + height) * texel;
+    return region;
+}
+
+void ImageAtlas::release(const ImageRegion& region)
+{
+    if (region.page < 0) {
+        glDeleteTextures(1, &region.texture);
+        return;
+    }
+    Page& page = m_pages[region.page];
+    if (--page.images == 0) page.shelfX = page.shelfY = page.shelfHeight = 0;
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "gl_ext.hpp"
+#include "stream_buffer.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace spiro::internal {
+
+// Where an image's pixels live: a texture and the normalized rectangle within it.
+struct ImageRegion {
+    GLuint texture = 0;
+    float s0 = 0.0f, t0 = 0.0f, s1 = 1.0f, t1 = 1.0f;
+    // Atlas page the image is packed into, or -1 if it has a texture of its own.
+    int page = -1;
+};
+
+// Shared RGBA pages for small images, so a frame full of icons or thumbnails samples a couple
+// of textures instead of one per image and the batch is not flushed every 16 images. Images
+// are shelf-packed with a border of repeated edge texels, which keeps linear filtering from
+// reading a neighbour. A page whose images have all been released is reused from the top.
+// Pixels are staged through a ring of pixel-unpack buffers, so the texture copy is queued on
+// the GPU instead of being done on the calling thread.
+class ImageAtlas {
+public:
+    static constexpr int PAGE_SIZE = 1024;
+    // Larger images keep a texture of their own; packing them would waste most of a page.
+    static constexpr int MAX_PACKED_SIZE = 256;
+    // Uploads larger than one staging window go straight from client memory.
+    static constexpr size_t STAGING_WINDOW_BYTES = 1 << 20;
+    static constexpr size_t STAGING_WINDOWS = 4;
+
+    ImageAtlas() = default;
+    ~ImageAtlas();
+    ImageAtlas(const ImageAtlas&) = delete;
+    ImageAtlas& operator=(const ImageAtlas&) = delete;
+
+    // Uploads tightly packed RGBA8 rows. The owning context must be current.
+    ImageRegion add(const unsigned char* rgba, int width, int height);
+    void release(const ImageRegion& region);
+    size_t pageCount() const { return m_pages.size(); }
+
+private:
+    struct Page {
+        GLuint texture = 0;
+        int shelfX = 0, shelfY = 0, shelfHeight = 0;
+        size_t images = 0;
+    };
+
+    bool place(int width, int height, int& page, int& x, int& y);
+    void addPage();
+    // Fills width x height RGBA texels of `texture` at (x, y) with what `write` puts in a
+    // tightly packed buffer of that size.
+    template <typename Write>
+    void upload(GLuint texture, int x, int y, int width, int height, Write write);
+
+    std::vector<Page> m_pages;
+    std::unique_ptr<StreamBuffer> m_staging;
+};
+
+}
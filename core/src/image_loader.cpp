@@ -0,0 +1,119 @@
+#include "image_loader.hpp"
+#include "mapped_file.hpp"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <climits>
+
+namespace spiro::internal {
+
+namespace {
+
+void decode(PendingImage& image)
+{
+    const MappedFile file(image.path);
+    if (!file.data() || file.size() == 0 || file.size() > (size_t)INT_MAX) return;
+    int channels = 0;
+    image.pixels = stbi_load_from_memory(file.data(), (int)file.size(), &image.loaded.width, &image.loaded.height, &channels, 4);
+}
+
+}
+
+PendingImage::~PendingImage()
+{
+    if (pixels) stbi_image_free(pixels);
+}
+
+ImageLoader::~ImageLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+std::shared_ptr<PendingImage> ImageLoader::load(const char* path)
+{
+    auto image = std::make_shared<PendingImage>();
+    image->path = path;
+    int channels = 0;
+    if (!stbi_info(path, &image->width, &image->height, &channels)) image->width = image->height = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_threads.empty()) {
+            const unsigned count = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_THREADS);
+            for (unsigned i = 0; i < count; ++i) m_threads.emplace_back(&ImageLoader::run, this);
+        }
+        m_queue.push_back(image);
+        m_pending.push_back(image);
+    }
+    m_work.notify_one();
+    return image;
+}
+
+void ImageLoader::run()
+{
+    for (;;) {
+        std::shared_ptr<PendingImage> image;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            image = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        if (!image->cancelled.load()) decode(*image);
+        {
+            // Published under the lock so finish() cannot miss the wakeup.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            image->state.store(image->pixels ? PendingImage::DECODED : PendingImage::FAILED, std::memory_order_release);
+        }
+        m_decoded.notify_all();
+    }
+}
+
+size_t ImageLoader::upload(ImageAtlas& atlas, size_t byteBudget)
+{
+    std::vector<std::shared_ptr<PendingImage>> decoded;
+    size_t remaining = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t bytes = 0;
+        auto keep = m_pending.begin();
+        for (auto& image : m_pending) {
+            const int state = image->state.load(std::memory_order_acquire);
+            if (state == PendingImage::FAILED || image->cancelled.load()) continue;
+            if (state == PendingImage::DECODED && (byteBudget == 0 || bytes < byteBudget)) {
+                bytes += (size_t)image->loaded.width * image->loaded.height * 4;
+                decoded.push_back(std::move(image));
+                continue;
+            }
+            *keep++ = std::move(image);
+        }
+        m_pending.erase(keep, m_pending.end());
+        remaining = m_pending.size();
+    }
+    for (auto& image : decoded) {
+        image->loaded.region = atlas.add(image->pixels, image->loaded.width, image->loaded.height);
+        stbi_image_free(image->pixels);
+        image->pixels = nullptr;
+        image->state.store(PendingImage::READY, std::memory_order_release);
+    }
+    return remaining;
+}
+
+void ImageLoader::finish(ImageAtlas& atlas)
+{
+    while (upload(atlas, 0) > 0) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_decoded.wait(lock, [this] {
+            return std::any_of(m_pending.begin(), m_pending.end(),
+                               [](const std::shared_ptr<PendingImage>& image) { return image->state.load() != PendingImage::QUEUED; });
+        });
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "image_atlas.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace spiro::internal {
+
+// An image's pixels once they are on the GPU.
+struct LoadedImage {
+    ImageRegion region;
+    int width = 0, height = 0;
+};
+
+// One sp_load_image_async call. A pool thread fills in the pixels and size and moves it to
+// DECODED or FAILED; the render thread uploads it and moves it to READY. Once `state` reads
+// READY, `loaded` is final and may be read from any thread.
+struct PendingImage {
+    enum State { QUEUED, DECODED, FAILED, READY };
+
+    std::string path;
+    // From the file's header, read when the load starts; 0 if it could not be read. Lets the
+    // image take its place on screen before the pixels arrive.
+    int width = 0, height = 0;
+    std::atomic<int> state{QUEUED};
+    // Set when the image is destroyed before it was uploaded; the upload is skipped.
+    std::atomic<bool> cancelled{false};
+    unsigned char* pixels = nullptr;
+    LoadedImage loaded;
+
+    ~PendingImage();
+};
+
+// Decodes images on a small thread pool, reading each file through a memory map, and leaves
+// the uploads to the render thread, which takes them a budget at a time so a burst of loads
+// does not stall a frame. Threads start with the first load.
+class ImageLoader {
+public:
+    static constexpr unsigned MAX_THREADS = 8;
+    // Bytes of decoded pixels uploaded per sp_begin_frame.
+    static constexpr size_t FRAME_UPLOAD_BYTES = 16 << 20;
+
+    ImageLoader() = default;
+    ~ImageLoader();
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    std::shared_ptr<PendingImage> load(const char* path);
+    // Uploads decoded images into `atlas` until about `byteBudget` bytes went up (0 means no
+    // limit). The atlas's context must be current. Returns how many loads are still pending.
+    size_t upload(ImageAtlas& atlas, size_t byteBudget);
+    // Uploads everything queued so far, waiting for the pool as needed.
+    void finish(ImageAtlas& atlas);
+
+private:
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_work, m_decoded;
+    std::deque<std::shared_ptr<PendingImage>> m_queue;
+    // Every load not yet uploaded or dropped, in submission order.
+    std::vector<std::shared_ptr<PendingImage>> m_pending;
+    std::vector<std::thread> m_threads;
+    bool m_stopping = false;
+};
+
+}
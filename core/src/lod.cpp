@@ -0,0 +1,103 @@
+#include "lod.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace spiro::internal {
+
+LodPyramid::Extrema LodPyramid::emptyExtrema()
+{
+    return {std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), 0, 0};
+}
+
+std::unique_ptr<LodPyramid> LodPyramid::build(const sp_vec2_t* points, size_t count)
+{
+    if (count > std::numeric_limits<uint32_t>::max()) return nullptr;
+    for (size_t i = 1; i < count; ++i)
+        if (!(points[i].x >= points[i - 1].x)) return nullptr;
+
+    auto pyramid = std::unique_ptr<LodPyramid>(new LodPyramid());
+    std::vector<Extrema> level(count / BLOCK);
+    for (size_t b = 0; b < level.size(); ++b) {
+        Extrema e = emptyExtrema();
+        for (size_t i = b * BLOCK; i < (b + 1) * BLOCK; ++i) {
+            if (points[i].y < e.minY) e.minY = points[i].y, e.minIndex = (uint32_t)i;
+            if (points[i].y > e.maxY) e.maxY = points[i].y, e.maxIndex = (uint32_t)i;
+        }
+        level[b] = e;
+    }
+    while (!level.empty()) {
+        std::vector<Extrema> parent(level.size() / 2);
+        for (size_t i = 0; i < parent.size(); ++i) {
+            parent[i] = level[2 * i];
+            pyramid->merge(parent[i], level[2 * i + 1]);
+        }
+        pyramid->m_levels.push_back(std::move(level));
+        level = std::move(parent);
+    }
+    return pyramid;
+}
+
+// Ties keep the earlier sample so the chosen extremum does not depend on how a range splits.
+void LodPyramid::merge(Extrema& acc, const Extrema& node) const
+{
+    if (node.minY < acc.minY || (node.minY == acc.minY && node.minIndex < acc.minIndex))
+        acc.minY = node.minY, acc.minIndex = node.minIndex;
+    if (node.maxY > acc.maxY || (node.maxY == acc.maxY && node.maxIndex < acc.maxIndex))
+        acc.maxY = node.maxY, acc.maxIndex = node.maxIndex;
+}
+
+LodPyramid::Extrema LodPyramid::query(const sp_vec2_t* points, size_t begin, size_t end) const
+{
+    Extrema acc = emptyExtrema();
+    auto scan = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) merge(acc, {points[i].y, points[i].y, (uint32_t)i, (uint32_t)i});
+    };
+    size_t b0 = (begin + BLOCK - 1) / BLOCK, b1 = end / BLOCK;
+    if (b0 >= b1 || m_levels.empty()) {
+        scan(begin, end);
+        return acc;
+    }
+    scan(begin, b0 * BLOCK);
+    scan(b1 * BLOCK, end);
+    for (size_t k = 0; b0 < b1; ++k, b0 /= 2, b1 /= 2) {
+        if (b0 & 1) merge(acc, m_levels[k][b0++]);
+        if (b1 & 1) merge(acc, m_levels[k][--b1]);
+    }
+    return acc;
+}
+
+void LodPyramid::decimate(const sp_vec2_t* points, size_t count, float scale, float offset, int columns,
+                          std::vector<sp_vec2_t>& out) const
+{
+    out.clear();
+    if (count == 0 || columns <= 0 || scale == 0.0f) return;
+    float xmin = (0.0f - offset) / scale, xmax = ((float)columns - offset) / scale;
+    if (xmin > xmax) std::swap(xmin, xmax);
+    auto byX = [](const sp_vec2_t& p, float x) { return p.x < x; };
+    const size_t first = std::lower_bound(points, points + count, xmin, byX) - points;
+    const size_t last = std::upper_bound(points + first, points + count, xmax, [](float x, const sp_vec2_t& p) { return x < p.x; }) - points;
+    const size_t begin = first > 0 ? first - 1 : 0, end = std::min(last + 1, count);
+    if (end - begin <= (size_t)columns * 4) {
+        out.assign(points + begin, points + end);
+        return;
+    }
+
+    if (begin < first) out.push_back(points[begin]);
+    const float columnWidth = (xmax - xmin) / (float)columns;
+    size_t i0 = first;
+    for (int c = 0; c < columns && i0 < last; ++c) {
+        const float boundary = c + 1 == columns ? xmax : xmin + columnWidth * (float)(c + 1);
+        const size_t i1 = c + 1 == columns ? last : std::lower_bound(points + i0, points + last, boundary, byX) - points;
+        if (i1 == i0) continue;
+        const Extrema e = query(points, i0, i1);
+        // First, min, max and last in sample order, each at most once.
+        size_t picks[4] = {i0, std::min<size_t>(e.minIndex, e.maxIndex), std::max<size_t>(e.minIndex, e.maxIndex), i1 - 1};
+        for (int k = 0; k < 4; ++k)
+            if (k == 0 || picks[k] != picks[k - 1]) out.push_back(points[picks[k]]);
+        i0 = i1;
+    }
+    if (end > last) out.push_back(points[end - 1]);
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <spirographicals/spirographicals.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace spiro::internal {
+
+// Min/max pyramid over a polyline whose x never decreases (time series). Level 0 summarizes
+// blocks of BLOCK samples and each level above merges pairs, so any index range's extrema
+// come from O(log n) nodes plus at most two partial blocks. That keeps M4 decimation (first,
+// min, max and last sample of every pixel column) at O(columns * log n) for any zoom or pan,
+// and the pyramid costs about 32 bytes per BLOCK samples.
+class LodPyramid {
+public:
+    static constexpr size_t BLOCK = 64;
+    // Below this, stroking everything is cheaper than building and querying the pyramid.
+    static constexpr size_t MIN_POINTS = 4096;
+
+    // Null if the x coordinates ever decrease or the path is too large to index.
+    static std::unique_ptr<LodPyramid> build(const sp_vec2_t* points, size_t count);
+
+    // Replaces `out` with what needs stroking when x maps to device columns as
+    // scale * x + offset and the viewport spans [0, columns): the visible samples plus one
+    // neighbour on each side, reduced to at most 4 per column once there are more than that.
+    // Drawn as 1px-wide lines, the result rasterizes the same as the full series.
+    void decimate(const sp_vec2_t* points, size_t count, float scale, float offset, int columns,
+                  std::vector<sp_vec2_t>& out) const;
+
+private:
+    struct Extrema {
+        float minY, maxY;
+        uint32_t minIndex, maxIndex;
+    };
+
+    static Extrema emptyExtrema();
+    void merge(Extrema& acc, const Extrema& node) const;
+    Extrema query(const sp_vec2_t* points, size_t begin, size_t end) const;
+
+    // m_levels[k][i] covers samples [i * (BLOCK << k), (i + 1) * (BLOCK << k)).
+    std::vector<std::vector<Extrema>> m_levels;
+};
+
+}
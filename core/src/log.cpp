@@ -0,0 +1,41 @@
+#include "log.hpp"
+
+#include <atomic>
+#include <iostream>
+
+namespace spiro::internal {
+
+namespace {
+
+std::atomic<int> g_logLevel{SP_LOG_LEVEL_WARN};
+
+const char* levelName(sp_log_level_t level)
+{
+    switch (level) {
+    case SP_LOG_LEVEL_DEBUG: return "debug";
+    case SP_LOG_LEVEL_INFO: return "info";
+    case SP_LOG_LEVEL_WARN: return "warn";
+    case SP_LOG_LEVEL_ERROR: return "error";
+    default: return "fatal";
+    }
+}
+
+}
+
+void setLogLevel(sp_log_level_t level)
+{
+    g_logLevel.store(level, std::memory_order_relaxed);
+}
+
+bool logEnabled(sp_log_level_t level)
+{
+    return level >= g_logLevel.load(std::memory_order_relaxed);
+}
+
+void logMessage(sp_log_level_t level, const std::string& message)
+{
+    if (!logEnabled(level)) return;
+    std::cerr << "spirographicals [" << levelName(level) << "] " << message << std::endl;
+}
+
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <spirographicals/spirographicals.h>
+
+#include <string>
+
+namespace spiro::internal {
+
+// Messages below the level set with sp_set_log_level are dropped; SP_LOG_LEVEL_WARN by default.
+// Whatever passes goes to stderr, one line per message.
+void setLogLevel(sp_log_level_t level);
+bool logEnabled(sp_log_level_t level);
+void logMessage(sp_log_level_t level, const std::string& message);
+
+}
@@ -0,0 +1,45 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace spiro::internal {
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+    // Plain read; a mapping saves little next to what the callers do with the bytes.
+    std::ifstream file(path, std::ios::binary);
+    if (file) m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            m_data = static_cast<const unsigned char*>(mapped);
+            m_size = (size_t)info.st_size;
+        }
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+}
+
+}
@@ -0,0 +1,142 @@
+#include "marker_renderer.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace spiro::internal {
+
+namespace {
+
+static_assert(sizeof(sp_marker_t) == 20, "sp_marker_t is uploaded as the instance buffer as is");
+
+const char* VERTEX_SHADER = R"glsl(#version 330 core
+    layout (location = 0) in vec2 a_Corner;
+    layout (location = 1) in vec2 a_Center; layout (location = 2) in float a_Size;
+    layout (location = 3) in vec4 a_Color; layout (location = 4) in uint a_Shape;
+    out vec2 v_Local; out vec4 v_Color; flat out float v_Radius; flat out uint v_Shape;
+    uniform mat4 u_Transform; uniform vec2 u_Viewport;
+    void main() {
+        // One pixel past the radius leaves room for the antialiased edge.
+        float extent = a_Size * 0.5 + 1.0;
+        v_Local = a_Corner * extent; v_Color = a_Color; v_Radius = a_Size * 0.5; v_Shape = a_Shape;
+        vec4 center = u_Transform * vec4(a_Center, 0.0, 1.0);
+        // Local y points down the screen like the canvas; clip-space y points up.
+        gl_Position = center + vec4(v_Local * vec2(2.0, -2.0) / u_Viewport * center.w, 0.0, 0.0);
+    })glsl";
+
+// Signed distances in pixels, negative inside. Every shape fits the square of side 2r.
+const char* FRAGMENT_SHADER = R"glsl(#version 330 core
+    out vec4 FragColor;
+    in vec2 v_Local; in vec4 v_Color; flat in float v_Radius; flat in uint v_Shape;
+    float box(vec2 p, vec2 b) {
+        vec2 d = abs(p) - b;
+        return length(max(d, 0.0)) + min(max(d.x, d.y), 0.0);
+    }
+    // Equilateral triangle with its apex up and its circumcircle of radius r.
+    float triangle(vec2 p, float r) {
+        const float k = sqrt(3.0);
+        float h = r * k * 0.5;
+        p = vec2(abs(p.x) - h, -p.y + h / k);
+        if (p.x + k * p.y > 0.0) p = vec2(p.x - k * p.y, -k * p.x - p.y) * 0.5;
+        p.x -= clamp(p.x, -2.0 * h, 0.0);
+        return -length(p) * sign(p.y);
+    }
+    float plus(vec2 p, float r) {
+        float t = max(r * 0.2, 0.5);
+        return min(box(p, vec2(r, t)), box(p, vec2(t, r)));
+    }
+    void main() {
+        vec2 p = v_Local; float r = v_Radius, d;
+        if (v_Shape == 0u) d = length(p) - r;
+        else if (v_Shape == 1u) d = box(p, vec2(r));
+        else if (v_Shape == 2u) d = triangle(p, r);
+        else if (v_Shape == 3u) d = plus(vec2(p.x + p.y, p.y - p.x) * 0.7071068, r);
+        else d = plus(p, r);
+        float coverage = clamp(0.5 - d, 0.0, 1.0);
+        if (coverage <= 0.0) discard;
+        float a = v_Color.a * coverage;
+        FragColor = vec4(v_Color.rgb * a, a);
+    })glsl";
+
+GLuint compile(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+}
+
+MarkerRenderer::MarkerRenderer()
+{
+    GLuint vs = compile(GL_VERTEX_SHADER, VERTEX_SHADER), fs = compile(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[1024] = {};
+        glGetProgramInfoLog(m_program, sizeof(log), nullptr, log);
+        glDeleteProgram(m_program);
+        throw std::runtime_error(std::string("marker program failed to link: ") + log);
+    }
+    m_transformLoc = glGetUniformLocation(m_program, "u_Transform");
+    m_viewportLoc = glGetUniformLocation(m_program, "u_Viewport");
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    // Triangle strip over the corners of [-1, 1]^2.
+    const float corners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    glGenBuffers(1, &m_quad);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quad);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(0);
+    glGenBuffers(1, &m_instances);
+    for (GLuint attribute = 1; attribute <= 4; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+}
+
+MarkerRenderer::~MarkerRenderer()
+{
+    glDeleteBuffers(1, &m_instances);
+    glDeleteBuffers(1, &m_quad);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteProgram(m_program);
+}
+
+size_t MarkerRenderer::draw(const sp_marker_t* markers, size_t count, const glm::mat4& transform, glm::vec2 viewport)
+{
+    if (!markers || count == 0) return 0;
+    glUseProgram(m_program);
+    glUniformMatrix4fv(m_transformLoc, 1, GL_FALSE, glm::value_ptr(transform));
+    glUniform2f(m_viewportLoc, viewport.x, viewport.y);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instances);
+    size_t draws = 0;
+    for (size_t first = 0; first < count; first += MAX_INSTANCES_PER_DRAW) {
+        const size_t n = std::min(count - first, MAX_INSTANCES_PER_DRAW);
+        // Orphaned every call: the driver hands back fresh storage rather than waiting for
+        // the previous draw to finish reading.
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(n * sizeof(sp_marker_t)), markers + first, GL_STREAM_DRAW);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(sp_marker_t), (const void*)offsetof(sp_marker_t, x));
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(sp_marker_t), (const void*)offsetof(sp_marker_t, size));
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(sp_marker_t), (const void*)offsetof(sp_marker_t, color));
+        glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(sp_marker_t), (const void*)offsetof(sp_marker_t, shape));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)n);
+        draws++;
+    }
+    return draws;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "gl_ext.hpp"
+
+#include <spirographicals/spirographicals.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+namespace spiro::internal {
+
+// Scatter markers drawn as instances of one shared unit quad. The caller's sp_marker_t array
+// is the per-instance buffer as is (20 bytes per marker), and each shape is an analytic
+// distance function in the fragment shader, so a million markers are one upload and one
+// draw call instead of a tessellated fan each. Marker sizes are in device pixels and do not
+// follow the transform; only the centers do.
+class MarkerRenderer {
+public:
+    // Markers per draw call; larger arrays are split so the instance buffer stays bounded.
+    static constexpr size_t MAX_INSTANCES_PER_DRAW = 1 << 22;
+
+    // Throws std::runtime_error if the shaders do not link.
+    MarkerRenderer();
+    ~MarkerRenderer();
+    MarkerRenderer(const MarkerRenderer&) = delete;
+    MarkerRenderer& operator=(const MarkerRenderer&) = delete;
+
+    // Writes premultiplied color under whatever blending the caller has set and leaves its own
+    // program and vertex array bound. `transform` maps marker centers to clip space; `viewport`
+    // is the target size in pixels. Returns the number of draw calls issued.
+    size_t draw(const sp_marker_t* markers, size_t count, const glm::mat4& transform, glm::vec2 viewport);
+
+private:
+    GLuint m_program = 0, m_vao = 0, m_quad = 0, m_instances = 0;
+    GLint m_transformLoc = -1, m_viewportLoc = -1;
+};
+
+}
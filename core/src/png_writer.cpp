@@ -0,0 +1,231 @@
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace spiro::internal {
+
+namespace {
+
+constexpr int WINDOW_SIZE = 32768;
+constexpr int HASH_BITS = 15;
+constexpr int MIN_MATCH = 3;
+constexpr int MAX_MATCH = 258;
+
+constexpr uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                      31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DIST_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_out(out) {}
+    void bits(uint32_t value, int count)
+    {
+        m_acc |= value << m_count;
+        m_count += count;
+        while (m_count >= 8) {
+            m_out.push_back(uint8_t(m_acc & 0xFF));
+            m_acc >>= 8;
+            m_count -= 8;
+        }
+    }
+    // Huffman codes are packed most-significant bit first.
+    void code(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        bits(reversed, length);
+    }
+    void finish()
+    {
+        if (m_count > 0) m_out.push_back(uint8_t(m_acc & 0xFF));
+        m_acc = 0;
+        m_count = 0;
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+    uint32_t m_acc = 0;
+    int m_count = 0;
+};
+
+void writeSymbol(BitWriter& w, int symbol)
+{
+    if (symbol < 144) w.code(0x30 + symbol, 8);
+    else if (symbol < 256) w.code(0x190 + symbol - 144, 9);
+    else if (symbol < 280) w.code(symbol - 256, 7);
+    else w.code(0xC0 + symbol - 280, 8);
+}
+
+void writeMatch(BitWriter& w, int length, int distance)
+{
+    int li = 28;
+    while (LENGTH_BASE[li] > length) --li;
+    writeSymbol(w, 257 + li);
+    if (LENGTH_EXTRA[li]) w.bits(length - LENGTH_BASE[li], LENGTH_EXTRA[li]);
+    int di = 29;
+    while (DIST_BASE[di] > distance) --di;
+    w.code(di, 5);
+    if (DIST_EXTRA[di]) w.bits(distance - DIST_BASE[di], DIST_EXTRA[di]);
+}
+
+uint32_t hash3(const uint8_t* p)
+{
+    uint32_t v = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+std::vector<uint8_t> zlibCompress(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> out;
+    out.reserve(data.size() / 4 + 64);
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    BitWriter w(out);
+    w.bits(1, 1);
+    w.bits(1, 2);
+
+    std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+    std::vector<int32_t> prev(WINDOW_SIZE, -1);
+    const int n = int(data.size());
+    auto insert = [&](int pos) {
+        uint32_t h = hash3(&data[pos]);
+        prev[pos & (WINDOW_SIZE - 1)] = head[h];
+        head[h] = pos;
+    };
+
+    int i = 0;
+    while (i < n) {
+        int bestLen = 0, bestDist = 0;
+        if (i + MIN_MATCH <= n) {
+            int cand = head[hash3(&data[i])];
+            const int maxLen = std::min(MAX_MATCH, n - i);
+            for (int chain = 0; chain < 16 && cand >= 0 && i - cand <= WINDOW_SIZE; ++chain) {
+                int len = 0;
+                while (len < maxLen && data[cand + len] == data[i + len]) ++len;
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestDist = i - cand;
+                    if (len == maxLen) break;
+                }
+                cand = prev[cand & (WINDOW_SIZE - 1)];
+            }
+        }
+        if (bestLen >= MIN_MATCH) {
+            writeMatch(w, bestLen, bestDist);
+            const int next = i + bestLen;
+            for (int end = std::min(next, n - MIN_MATCH + 1); i < end; ++i) insert(i);
+            i = next;
+        } else {
+            writeSymbol(w, data[i]);
+            if (i + MIN_MATCH <= n) insert(i);
+            ++i;
+        }
+    }
+    writeSymbol(w, 256);
+    w.finish();
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int s = 24; s >= 0; s -= 8) out.push_back(uint8_t(adler >> s));
+    return out;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int s = 24; s >= 0; s -= 8) out.push_back(uint8_t(v >> s));
+}
+
+void writeChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& payload)
+{
+    putU32(out, uint32_t(payload.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+    putU32(out, crc32(&out[start], out.size() - start));
+}
+
+}
+
+std::vector<uint8_t> encodePng(const uint8_t* rgba, int width, int height)
+{
+    const size_t stride = size_t(width) * 4;
+    std::vector<uint8_t> filtered;
+    filtered.reserve((stride + 1) * height);
+
+    // Per-row filter selection (None/Sub/Up) by minimum sum of absolute residuals.
+    std::vector<uint8_t> candidates[3];
+    for (auto& c : candidates) c.resize(stride);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = rgba + y * stride;
+        const uint8_t* up = y > 0 ? row - stride : nullptr;
+        uint64_t best = UINT64_MAX;
+        int bestFilter = 0;
+        for (int f = 0; f < 3; ++f) {
+            if (f == 2 && !up) continue;
+            uint64_t sum = 0;
+            for (size_t x = 0; x < stride; ++x) {
+                uint8_t pred = f == 1 ? (x >= 4 ? row[x - 4] : 0) : f == 2 ? up[x] : 0;
+                uint8_t v = uint8_t(row[x] - pred);
+                candidates[f][x] = v;
+                sum += v < 128 ? v : 256 - v;
+            }
+            if (sum < best) {
+                best = sum;
+                bestFilter = f;
+            }
+        }
+        filtered.push_back(uint8_t(bestFilter));
+        filtered.insert(filtered.end(), candidates[bestFilter].begin(), candidates[bestFilter].end());
+    }
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> ihdr;
+    putU32(ihdr, uint32_t(width));
+    putU32(ihdr, uint32_t(height));
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});
+    writeChunk(png, "IHDR", ihdr);
+    writeChunk(png, "IDAT", zlibCompress(filtered));
+    writeChunk(png, "IEND", {});
+    return png;
+}
+
+bool writePng(const std::string& path, const uint8_t* rgba, int width, int height)
+{
+    if (!rgba || width <= 0 || height <= 0) return false;
+    std::vector<uint8_t> png = encodePng(rgba, width, height);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(png.data()), std::streamsize(png.size()));
+    return bool(file);
+}
+
+}
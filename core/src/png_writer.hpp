@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace spiro::internal {
+
+// Encodes tightly packed, top-down RGBA8 pixels as a PNG (fixed-Huffman deflate).
+std::vector<uint8_t> encodePng(const uint8_t* rgba, int width, int height);
+bool writePng(const std::string& path, const uint8_t* rgba, int width, int height);
+
+}
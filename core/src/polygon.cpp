@@ -0,0 +1,184 @@
+#include "polygon.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace spiro::internal {
+
+namespace {
+
+// Twice the signed area of (o, a, b); positive when the turn o -> a -> b is clockwise on
+// screen (y down), the same way sp_vec2_t coordinates are drawn.
+float cross(sp_vec2_t o, sp_vec2_t a, sp_vec2_t b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// p is already known to be on the line through a and b.
+bool within(sp_vec2_t a, sp_vec2_t b, sp_vec2_t p)
+{
+    return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+bool segmentsMeet(sp_vec2_t a, sp_vec2_t b, sp_vec2_t c, sp_vec2_t d)
+{
+    if (std::max(a.x, b.x) < std::min(c.x, d.x) || std::max(c.x, d.x) < std::min(a.x, b.x) ||
+        std::max(a.y, b.y) < std::min(c.y, d.y) || std::max(c.y, d.y) < std::min(a.y, b.y))
+        return false;
+    const float d1 = cross(c, d, a), d2 = cross(c, d, b), d3 = cross(a, b, c), d4 = cross(a, b, d);
+    if (((d1 > 0.0f && d2 < 0.0f) || (d1 < 0.0f && d2 > 0.0f)) && ((d3 > 0.0f && d4 < 0.0f) || (d3 < 0.0f && d4 > 0.0f)))
+        return true;
+    return (d1 == 0.0f && within(c, d, a)) || (d2 == 0.0f && within(c, d, b)) || (d3 == 0.0f && within(a, b, c)) ||
+           (d4 == 0.0f && within(a, b, d));
+}
+
+}
+
+bool isConvex(const sp_vec2_t* points, size_t count)
+{
+    if (count < 3) return false;
+    float turn = 0.0f, firstDx = 0.0f, lastDx = 0.0f;
+    int xFlips = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const sp_vec2_t& a = points[i], & b = points[(i + 1) % count], & c = points[(i + 2) % count];
+        const float t = cross(a, b, c);
+        if (t != 0.0f) {
+            if (turn == 0.0f) turn = t;
+            else if ((t > 0.0f) != (turn > 0.0f)) return false;
+        }
+        // Turning one way throughout still allows a star that winds twice; going around once
+        // means the x direction reverses exactly twice.
+        const float dx = b.x - a.x;
+        if (dx != 0.0f) {
+            if (lastDx != 0.0f && (dx > 0.0f) != (lastDx > 0.0f)) xFlips++;
+            if (firstDx == 0.0f) firstDx = dx;
+            lastDx = dx;
+        }
+    }
+    if (firstDx != 0.0f && (firstDx > 0.0f) != (lastDx > 0.0f)) xFlips++;
+    return turn != 0.0f && xFlips <= 2;
+}
+
+bool isSimple(const sp_vec2_t* points, size_t count)
+{
+    if (count < 3) return false;
+    for (size_t i = 0; i < count; ++i) {
+        const sp_vec2_t& a = points[i], & b = points[(i + 1) % count];
+        // Edge i's neighbours are i - 1 and i + 1; the last edge neighbours the first.
+        for (size_t j = i + 2; j < count; ++j) {
+            if (i == 0 && j == count - 1) continue;
+            if (segmentsMeet(a, b, points[j], points[(j + 1) % count])) return false;
+        }
+    }
+    return true;
+}
+
+bool EarClipper::triangulate(const sp_vec2_t* points, size_t count)
+{
+    m_triangles.clear();
+    if (count < 3) return false;
+    float area = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        const sp_vec2_t& a = points[i], & b = points[(i + 1) % count];
+        area += a.x * b.y - b.x * a.y;
+    }
+    if (area == 0.0f || !std::isfinite(area)) return false;
+    const float orientation = area > 0.0f ? 1.0f : -1.0f;
+    m_prev.resize(count);
+    m_next.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_prev[i] = (uint32_t)((i + count - 1) % count);
+        m_next[i] = (uint32_t)((i + 1) % count);
+    }
+
+    auto isEar = [&](uint32_t a, uint32_t b, uint32_t c) {
+        for (uint32_t v = m_next[c]; v != a; v = m_next[v]) {
+            const sp_vec2_t& p = points[v];
+            if (cross(points[a], points[b], p) * orientation >= 0.0f && cross(points[b], points[c], p) * orientation >= 0.0f &&
+                cross(points[c], points[a], p) * orientation >= 0.0f)
+                return false;
+        }
+        return true;
+    };
+
+    uint32_t vertex = 0;
+    size_t remaining = count, sinceClip = 0;
+    while (remaining > 3) {
+        // A full lap without an ear means the outline crosses itself.
+        if (sinceClip > remaining) return false;
+        const uint32_t a = m_prev[vertex], c = m_next[vertex];
+        const float turn = cross(points[a], points[vertex], points[c]) * orientation;
+        // A vertex with no turn covers no area and is dropped outright.
+        const bool clip = turn == 0.0f || (turn > 0.0f && isEar(a, vertex, c));
+        if (clip) {
+            if (turn != 0.0f) m_triangles.insert(m_triangles.end(), {a, vertex, c});
+            m_next[a] = c;
+            m_prev[c] = a;
+            remaining--;
+            sinceClip = 0;
+        } else {
+            sinceClip++;
+        }
+        vertex = c;
+    }
+    const uint32_t a = m_prev[vertex], c = m_next[vertex];
+    if (cross(points[a], points[vertex], points[c]) != 0.0f) m_triangles.insert(m_triangles.end(), {a, vertex, c});
+    return true;
+}
+
+void ScanlineFiller::fill(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, int height, int rowsPerPixel,
+                          std::vector<FillSpan>& spans)
+{
+    spans.clear();
+    m_edges.clear();
+    m_active.clear();
+    if (count < 3 || height <= 0 || rowsPerPixel <= 0) return;
+    for (size_t i = 0; i < count; ++i) {
+        const sp_vec2_t& a = points[i], & b = points[(i + 1) % count];
+        if (a.y == b.y) continue;
+        const sp_vec2_t& top = a.y < b.y ? a : b, & bottom = a.y < b.y ? b : a;
+        const Edge edge{top.y, bottom.y, top.x, (bottom.x - top.x) / (bottom.y - top.y), b.y > a.y ? 1 : -1};
+        if (std::isfinite(edge.y0) && std::isfinite(edge.y1) && std::isfinite(edge.x0) && std::isfinite(edge.slope))
+            m_edges.push_back(edge);
+    }
+    if (m_edges.empty()) return;
+    std::sort(m_edges.begin(), m_edges.end(), [](const Edge& a, const Edge& b) { return a.y0 < b.y0; });
+
+    const float step = 1.0f / (float)rowsPerPixel;
+    const long long rows = (long long)height * rowsPerPixel;
+    // The first row line at or below y, clamped to the target.
+    auto rowAt = [&](float y) { return std::clamp((long long)std::ceil(y * rowsPerPixel - 0.5f), 0LL, rows); };
+    size_t next = 0;
+    for (long long k = rowAt(m_edges.front().y0); k < rows;) {
+        const float y = ((float)k + 0.5f) * step;
+        // Edges cover [y0, y1), so a vertex shared by two edges is crossed once.
+        while (next < m_edges.size() && m_edges[next].y0 <= y) m_active.push_back(next++);
+        for (size_t i = 0; i < m_active.size();) {
+            if (m_edges[m_active[i]].y1 <= y) { m_active[i] = m_active.back(); m_active.pop_back(); }
+            else ++i;
+        }
+        if (m_active.empty()) {
+            if (next == m_edges.size()) break;
+            k = std::max(k + 1, rowAt(m_edges[next].y0));
+            continue;
+        }
+        m_crossings.clear();
+        for (size_t index : m_active) {
+            const Edge& e = m_edges[index];
+            m_crossings.push_back({e.x0 + (y - e.y0) * e.slope, e.winding});
+        }
+        std::sort(m_crossings.begin(), m_crossings.end(), [](const Crossing& a, const Crossing& b) { return a.x < b.x; });
+        int winding = 0;
+        float start = 0.0f;
+        for (const Crossing& crossing : m_crossings) {
+            const bool wasInside = rule == SP_FILL_RULE_EVEN_ODD ? (winding & 1) != 0 : winding != 0;
+            winding += crossing.winding;
+            const bool inside = rule == SP_FILL_RULE_EVEN_ODD ? (winding & 1) != 0 : winding != 0;
+            if (!wasInside && inside) start = crossing.x;
+            else if (wasInside && !inside && crossing.x > start) spans.push_back({y, start, crossing.x});
+        }
+        ++k;
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <spirographicals/spirographicals.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spiro::internal {
+
+// CPU-side filling of single-contour polygons. Points are the polygon's vertices in order,
+// without a closing copy of the first; the last vertex connects back to the first.
+
+// True if every turn goes the same way and the outline goes around only once, so a fan from
+// any vertex covers the polygon exactly. O(n).
+bool isConvex(const sp_vec2_t* points, size_t count);
+// True if no two edges cross or touch other than neighbours at their shared vertex. O(n^2),
+// meant for the small polygons ear clipping takes.
+bool isSimple(const sp_vec2_t* points, size_t count);
+
+// Ear clipping for simple polygons, O(n^2). Both fill rules agree on a simple polygon, so the
+// triangles serve either. The buffers are kept between calls.
+class EarClipper {
+public:
+    // Replaces triangles() with index triples into `points`. False if the polygon has no
+    // area or no ear could be found (it was not simple after all).
+    bool triangulate(const sp_vec2_t* points, size_t count);
+    const std::vector<uint32_t>& triangles() const { return m_triangles; }
+
+private:
+    std::vector<uint32_t> m_prev, m_next, m_triangles;
+};
+
+// A horizontal run inside the polygon along the line at height y.
+struct FillSpan {
+    float y, x0, x1;
+};
+
+// Scanline conversion for polygons of any shape. Each row walks the edges crossing it in x
+// order and keeps the runs the fill rule puts inside.
+class ScanlineFiller {
+public:
+    // Replaces `spans` with the runs along y = (k + 0.5) / rowsPerPixel for every k whose line
+    // falls inside [0, height).
+    void fill(const sp_vec2_t* points, size_t count, sp_fill_rule_t rule, int height, int rowsPerPixel,
+              std::vector<FillSpan>& spans);
+
+private:
+    struct Edge {
+        float y0, y1, x0, slope;
+        int winding;
+    };
+    struct Crossing {
+        float x;
+        int winding;
+    };
+
+    std::vector<Edge> m_edges;
+    std::vector<size_t> m_active;
+    std::vector<Crossing> m_crossings;
+};
+
+}
@@ -0,0 +1,196 @@
+#include "scene_format.hpp"
+
+#include <cstring>
+
+namespace spiro::internal {
+
+namespace {
+
+size_t alignUp(size_t n)
+{
+    return (n + SCENE_ALIGNMENT - 1) & ~(SCENE_ALIGNMENT - 1);
+}
+
+struct TableOffsets {
+    size_t commands, textures, fonts, textureRefs, end;
+};
+
+TableOffsets tableOffsets(size_t commands, size_t textures, size_t fonts, size_t textureRefs)
+{
+    TableOffsets t;
+    t.commands = alignUp(sizeof(SceneHeader));
+    t.textures = alignUp(t.commands + commands * sizeof(SceneCommand));
+    t.fonts = alignUp(t.textures + textures * sizeof(SceneTexture));
+    t.textureRefs = alignUp(t.fonts + fonts * sizeof(SceneFont));
+    t.end = alignUp(t.textureRefs + textureRefs * sizeof(uint32_t));
+    return t;
+}
+
+bool inBounds(uint64_t offset, uint64_t size, uint64_t total)
+{
+    return offset <= total && size <= total - offset;
+}
+
+bool validBlob(const SceneBlob& b, uint64_t total)
+{
+    return b.offset % SCENE_ALIGNMENT == 0 && inBounds(b.offset, b.size, total);
+}
+
+bool fail(std::string& error, const std::string& message)
+{
+    error = message;
+    return false;
+}
+
+}
+
+SceneBlob SceneWriter::addBlob(const void* data, size_t size)
+{
+    const SceneBlob blob{m_blobBytes, size};
+    m_blobs.push_back({data, size});
+    m_blobBytes = alignUp(m_blobBytes + size);
+    return blob;
+}
+
+size_t SceneWriter::blobBase() const
+{
+    return tableOffsets(m_commands.size(), m_textures.size(), m_fonts.size(), m_textureRefs.size()).end;
+}
+
+uint32_t SceneWriter::addTexture(uint32_t width, uint32_t height, uint32_t channels, const void* pixels)
+{
+    m_textures.push_back({width, height, channels, 0, addBlob(pixels, (size_t)width * height * channels)});
+    return (uint32_t)(m_textures.size() - 1);
+}
+
+uint32_t SceneWriter::addFont(const void* data, size_t size)
+{
+    m_fonts.push_back({addBlob(data, size)});
+    return (uint32_t)(m_fonts.size() - 1);
+}
+
+void SceneWriter::addCommand(SceneCommand command, const void* data, size_t size, const std::vector<uint32_t>& textures)
+{
+    command.data = addBlob(data, size);
+    command.firstTexture = (uint32_t)m_textureRefs.size();
+    command.textureCount = (uint32_t)textures.size();
+    m_textureRefs.insert(m_textureRefs.end(), textures.begin(), textures.end());
+    m_commands.push_back(command);
+}
+
+size_t SceneWriter::size() const
+{
+    return blobBase() + m_blobBytes;
+}
+
+void SceneWriter::write(uint8_t* out) const
+{
+    const TableOffsets t = tableOffsets(m_commands.size(), m_textures.size(), m_fonts.size(), m_textureRefs.size());
+    const size_t total = t.end + m_blobBytes;
+    std::memset(out, 0, total);
+
+    SceneHeader header{};
+    std::memcpy(header.magic, SCENE_MAGIC, sizeof(SCENE_MAGIC));
+    header.version = SCENE_VERSION;
+    header.byteOrder = SCENE_BYTE_ORDER;
+    header.vertexSize = sizeof(Vertex);
+    header.commandCount = (uint32_t)m_commands.size();
+    header.textureCount = (uint32_t)m_textures.size();
+    header.fontCount = (uint32_t)m_fonts.size();
+    header.textureRefCount = (uint32_t)m_textureRefs.size();
+    header.size = total;
+    header.commands = t.commands;
+    header.textures = t.textures;
+    header.fonts = t.fonts;
+    header.textureRefs = t.textureRefs;
+    std::memcpy(out, &header, sizeof(header));
+
+    // Blob offsets were relative to the blob area; they become absolute here.
+    auto rebase = [&](SceneBlob b) { b.offset += t.end; return b; };
+    for (size_t i = 0; i < m_commands.size(); ++i) {
+        SceneCommand c = m_commands[i];
+        c.data = rebase(c.data);
+        std::memcpy(out + t.commands + i * sizeof(SceneCommand), &c, sizeof(c));
+    }
+    for (size_t i = 0; i < m_textures.size(); ++i) {
+        SceneTexture texture = m_textures[i];
+        texture.pixels = rebase(texture.pixels);
+        std::memcpy(out + t.textures + i * sizeof(SceneTexture), &texture, sizeof(texture));
+    }
+    for (size_t i = 0; i < m_fonts.size(); ++i) {
+        const SceneFont font{rebase(m_fonts[i].data)};
+        std::memcpy(out + t.fonts + i * sizeof(SceneFont), &font, sizeof(font));
+    }
+    if (!m_textureRefs.empty()) std::memcpy(out + t.textureRefs, m_textureRefs.data(), m_textureRefs.size() * sizeof(uint32_t));
+
+    size_t offset = t.end;
+    for (const Pending& blob : m_blobs) {
+        if (blob.size) std::memcpy(out + offset, blob.data, blob.size);
+        offset = alignUp(offset + blob.size);
+    }
+}
+
+bool openScene(const void* data, size_t size, SceneView& view, std::string& error)
+{
+    const uint8_t* base = static_cast<const uint8_t*>(data);
+    if (!base || size < sizeof(SceneHeader)) return fail(error, "too small for a scene header");
+    if ((uintptr_t)base % alignof(SceneHeader) != 0) return fail(error, "buffer is not 8-byte aligned");
+    const SceneHeader& h = *reinterpret_cast<const SceneHeader*>(base);
+    if (std::memcmp(h.magic, SCENE_MAGIC, sizeof(SCENE_MAGIC)) != 0) return fail(error, "not a scene");
+    if (h.version != SCENE_VERSION) return fail(error, "unsupported scene version " + std::to_string(h.version));
+    if (h.byteOrder != SCENE_BYTE_ORDER) return fail(error, "scene was written with the other byte order");
+    if (h.vertexSize != sizeof(Vertex)) return fail(error, "scene has a different vertex layout");
+    if (h.size > size) return fail(error, "scene is truncated");
+
+    const uint64_t total = h.size;
+    auto table = [&](uint64_t offset, uint64_t count, size_t entry) {
+        return offset % SCENE_ALIGNMENT == 0 && count <= total / entry && inBounds(offset, count * entry, total);
+    };
+    if (!table(h.commands, h.commandCount, sizeof(SceneCommand)) || !table(h.textures, h.textureCount, sizeof(SceneTexture)) ||
+        !table(h.fonts, h.fontCount, sizeof(SceneFont)) || !table(h.textureRefs, h.textureRefCount, sizeof(uint32_t)))
+        return fail(error, "scene table out of bounds");
+
+    SceneView v;
+    v.base = base;
+    v.header = &h;
+    v.commands = reinterpret_cast<const SceneCommand*>(base + h.commands);
+    v.textures = reinterpret_cast<const SceneTexture*>(base + h.textures);
+    v.fonts = reinterpret_cast<const SceneFont*>(base + h.fonts);
+    v.textureRefs = reinterpret_cast<const uint32_t*>(base + h.textureRefs);
+
+    for (uint32_t i = 0; i < h.textureCount; ++i) {
+        const SceneTexture& t = v.textures[i];
+        if (t.channels != 1 && t.channels != 4) return fail(error, "texture " + std::to_string(i) + " has an unsupported format");
+        if (!validBlob(t.pixels, total) || t.pixels.size != (uint64_t)t.width * t.height * t.channels)
+            return fail(error, "texture " + std::to_string(i) + " is out of bounds");
+    }
+    for (uint32_t i = 0; i < h.fontCount; ++i)
+        if (!validBlob(v.fonts[i].data, total)) return fail(error, "font " + std::to_string(i) + " is out of bounds");
+    for (uint32_t i = 0; i < h.textureRefCount; ++i)
+        if (v.textureRefs[i] >= h.textureCount) return fail(error, "texture reference " + std::to_string(i) + " is out of range");
+
+    for (uint32_t i = 0; i < h.commandCount; ++i) {
+        const SceneCommand& c = v.commands[i];
+        const std::string which = "command " + std::to_string(i);
+        if (c.type >= SceneCommandType::Count) return fail(error, which + " has an unknown type");
+        if (c.blend > SP_BLEND_MODE_OVERLAY || c.rule > SP_FILL_RULE_EVEN_ODD) return fail(error, which + " has an unknown mode");
+        if (!validBlob(c.data, total)) return fail(error, which + " is out of bounds");
+        if (c.textureCount > SCENE_MAX_TEXTURES || c.firstTexture > h.textureRefCount || c.textureCount > h.textureRefCount - c.firstTexture)
+            return fail(error, which + " has too many textures");
+        bool sized = true;
+        switch (c.type) {
+        case SceneCommandType::Vertices:
+            sized = c.data.size % (sizeof(Vertex) * VERTICES_PER_QUAD) == 0 && c.data.size / sizeof(Vertex) <= (uint64_t)INT32_MAX;
+            break;
+        case SceneCommandType::Text: sized = c.font < h.fontCount; break;
+        case SceneCommandType::Markers: sized = c.data.size % sizeof(sp_marker_t) == 0; break;
+        case SceneCommandType::Fill: sized = c.data.size % sizeof(sp_vec2_t) == 0; break;
+        default: break;
+        }
+        if (!sized) return fail(error, which + " has malformed data");
+    }
+    view = v;
+    return true;
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <spirographicals/spirographicals.h>
+
+#include "vertex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace spiro::internal {
+
+// A recorded scene (sp_record_scene) is one flat buffer meant to be memory-mapped and used in
+// place: a header, fixed-size tables of commands, textures, fonts and texture references, then
+// the blobs they point at. Everything is in the writer's byte order and every blob starts on a
+// SCENE_ALIGNMENT boundary, so a reader checks the header and the tables' bounds and then hands
+// vertex blobs to the GPU as they lie in the mapping.
+constexpr char SCENE_MAGIC[8] = {'S', 'P', 'S', 'C', 'E', 'N', 'E', '1'};
+constexpr uint32_t SCENE_VERSION = 1;
+// Reads back as another value on a machine of the other endianness.
+constexpr uint32_t SCENE_BYTE_ORDER = 0x01020304u;
+constexpr size_t SCENE_ALIGNMENT = 16;
+// Textures one command may sample, as in the batch shader's sampler array.
+constexpr uint32_t SCENE_MAX_TEXTURES = 16;
+
+// Bytes [offset, offset + size) of the scene.
+struct SceneBlob {
+    uint64_t offset, size;
+};
+
+struct SceneHeader {
+    char magic[8];
+    uint32_t version, byteOrder;
+    // sizeof(Vertex) when written; a different layout is rejected rather than converted.
+    uint32_t vertexSize;
+    uint32_t commandCount, textureCount, fontCount, textureRefCount, reserved;
+    // Total bytes, then the byte offsets of the four tables.
+    uint64_t size, commands, textures, fonts, textureRefs;
+};
+static_assert(sizeof(SceneHeader) == 80, "scene header layout");
+
+// What a command's data blob holds:
+//   Vertices: Vertex quads drawn under `transform`, sampling textureRefs[firstTexture...].
+//   Text:     UTF-8 bytes, laid out with `font` at fontSize and drawn at (x, y).
+//   Markers:  sp_marker_t, centers transformed by `transform`.
+//   Fill:     a device-space outline, filled under `rule`.
+//   Clear:    nothing; clears to clearColor.
+enum class SceneCommandType : uint32_t { Vertices, Text, Markers, Fill, Clear, Count };
+
+struct SceneCommand {
+    SceneCommandType type;
+    uint32_t blend;
+    SceneBlob data;
+    uint32_t color, rule, firstTexture, textureCount;
+    uint32_t font;
+    float fontSize, x, y;
+    // The affine a, b, c, d, e, f mapping (x, y) to (a x + c y + e, b x + d y + f).
+    float transform[6];
+    sp_color_rgba_t clearColor;
+};
+static_assert(sizeof(SceneCommand) == 96, "scene command layout");
+
+// Pixels are tightly packed rows of `channels` bytes in the texture's own row order: 1 for
+// glyph pages, 4 for RGBA images. A 0x0 texture stands for one the recording canvas could not
+// read back.
+struct SceneTexture {
+    uint32_t width, height, channels, reserved;
+    SceneBlob pixels;
+};
+static_assert(sizeof(SceneTexture) == 32, "scene texture layout");
+
+// The font file's bytes.
+struct SceneFont {
+    SceneBlob data;
+};
+
+// Builds a scene. Blobs are referenced, not copied, and must stay valid until write().
+class SceneWriter {
+public:
+    uint32_t addTexture(uint32_t width, uint32_t height, uint32_t channels, const void* pixels);
+    uint32_t addFont(const void* data, size_t size);
+    // `textures` are indices returned by addTexture; the command's blob, texture and font
+    // fields are filled in here.
+    void addCommand(SceneCommand command, const void* data, size_t size, const std::vector<uint32_t>& textures = {});
+    size_t size() const;
+    // Writes size() bytes to `out`.
+    void write(uint8_t* out) const;
+
+private:
+    struct Pending {
+        const void* data;
+        size_t size;
+    };
+
+    // Relative to the start of the blob area until write() knows where that is.
+    SceneBlob addBlob(const void* data, size_t size);
+    size_t blobBase() const;
+
+    std::vector<SceneCommand> m_commands;
+    std::vector<SceneTexture> m_textures;
+    std::vector<SceneFont> m_fonts;
+    std::vector<uint32_t> m_textureRefs;
+    std::vector<Pending> m_blobs;
+    size_t m_blobBytes = 0;
+};
+
+// Pointers into a scene that openScene accepted. Nothing is copied.
+struct SceneView {
+    const uint8_t* base = nullptr;
+    const SceneHeader* header = nullptr;
+    const SceneCommand* commands = nullptr;
+    const SceneTexture* textures = nullptr;
+    const SceneFont* fonts = nullptr;
+    const uint32_t* textureRefs = nullptr;
+
+    template <typename T>
+    const T* blob(const SceneBlob& b) const { return reinterpret_cast<const T*>(base + b.offset); }
+};
+
+// Checks the header, that every table and blob lies inside the buffer and is aligned, and that
+// every index and blob size is consistent, without reading the blobs themselves. Vertex texture
+// slots are not checked: a bad one samples an unbound unit, which is harmless. `data` must be
+// 8-byte aligned, as a mapping or allocation is.
+bool openScene(const void* data, size_t size, SceneView& view, std::string& error);
+
+}
@@ -0,0 +1,519 @@
+#include "software_rasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPIRO_RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace spiro::internal {
+
+namespace {
+
+// The standard rotated-grid 4x pattern, in pixels from the pixel's top-left corner.
+constexpr float SAMPLE_X[SoftwareRasterizer::SAMPLES] = {0.375f, 0.875f, 0.125f, 0.625f};
+constexpr float SAMPLE_Y[SoftwareRasterizer::SAMPLES] = {0.125f, 0.375f, 0.625f, 0.875f};
+constexpr uint32_t CLEAR_BIT = 0x80000000u, BLEND_BIT = 0x40000000u;
+constexpr uint32_t NO_TEXTURE = 0xFFFFFFFFu, MISSING_TEXTURE = 0xFFFFFFFEu;
+
+// E(x, y) = a * x + b * y + c, positive inside. Samples exactly on the edge count as inside
+// only for the owning side, so a sample on an edge two triangles share is drawn once.
+struct Edge {
+    float a, b, c;
+    bool owner;
+};
+
+// The edge from p to q, computed from its endpoints in a fixed order: the same edge seen from
+// the neighbouring triangle comes out exactly negated, so the two always split its samples.
+Edge makeEdge(glm::vec2 p, glm::vec2 q)
+{
+    const bool swap = q.x < p.x || (q.x == p.x && q.y < p.y);
+    const glm::vec2 lo = swap ? q : p, hi = swap ? p : q;
+    Edge e{lo.y - hi.y, hi.x - lo.x, lo.x * hi.y - lo.y * hi.x, false};
+    if (swap) e = {-e.a, -e.b, -e.c, false};
+    return e;
+}
+
+struct Triangle {
+    Edge edges[3];
+    bool valid = false;
+};
+
+Triangle setupTriangle(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2)
+{
+    Triangle t{{makeEdge(p0, p1), makeEdge(p1, p2), makeEdge(p2, p0)}};
+    const float area = t.edges[0].a * p2.x + t.edges[0].b * p2.y + t.edges[0].c;
+    // Also rejects NaN.
+    if (!(area > 0.0f || area < 0.0f)) return t;
+    for (Edge& e : t.edges) {
+        if (area < 0.0f) e = {-e.a, -e.b, -e.c, false};
+        e.owner = e.a > 0.0f || (e.a == 0.0f && e.b > 0.0f);
+    }
+    t.valid = true;
+    return t;
+}
+
+// Per-row part of every edge function, b * y + c at each sample's y.
+struct RowTerms {
+    float values[2][3][SoftwareRasterizer::SAMPLES];
+};
+
+void computeRowTerms(const Triangle* triangles, float y, RowTerms& rows)
+{
+    for (int t = 0; t < 2; ++t)
+        for (int e = 0; e < 3; ++e)
+            for (int k = 0; k < SoftwareRasterizer::SAMPLES; ++k) {
+                const Edge& edge = triangles[t].edges[e];
+                rows.values[t][e][k] = edge.b * (y + SAMPLE_Y[k]) + edge.c;
+            }
+}
+
+// Bit k set if sample k of the pixel at column x is inside either triangle.
+unsigned coverage(const Triangle* triangles, const RowTerms& rows, float x)
+{
+    unsigned mask = 0;
+#ifdef SPIRO_RASTER_SSE2
+    const __m128 sx = _mm_add_ps(_mm_set1_ps(x), _mm_loadu_ps(SAMPLE_X)), zero = _mm_setzero_ps();
+    for (int t = 0; t < 2; ++t) {
+        if (!triangles[t].valid) continue;
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int e = 0; e < 3; ++e) {
+            const Edge& edge = triangles[t].edges[e];
+            const __m128 value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge.a), sx), _mm_loadu_ps(rows.values[t][e]));
+            inside = _mm_and_ps(inside, edge.owner ? _mm_cmpge_ps(value, zero) : _mm_cmpgt_ps(value, zero));
+        }
+        mask |= (unsigned)_mm_movemask_ps(inside);
+    }
+#else
+    for (int t = 0; t < 2; ++t) {
+        if (!triangles[t].valid) continue;
+        for (int k = 0; k < SoftwareRasterizer::SAMPLES; ++k) {
+            bool inside = true;
+            for (int e = 0; e < 3; ++e) {
+                const Edge& edge = triangles[t].edges[e];
+                const float value = edge.a * (x + SAMPLE_X[k]) + rows.values[t][e][k];
+                inside = inside && (edge.owner ? value >= 0.0f : value > 0.0f);
+            }
+            if (inside) mask |= 1u << k;
+        }
+    }
+#endif
+    return mask;
+}
+
+// Source-over blending of `color` into the samples in `mask`, with the same arithmetic as
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) on every channel, alpha included.
+void blend(uint32_t* samples, unsigned mask, uint32_t color)
+{
+    const unsigned alpha = color >> 24;
+    if (alpha == 255) {
+        for (int k = 0; k < SoftwareRasterizer::SAMPLES; ++k)
+            if (mask & (1u << k)) samples[k] = color;
+        return;
+    }
+#ifdef SPIRO_RASTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples));
+    const __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero), _mm_set1_epi16((short)alpha));
+    const __m128i inverse = _mm_set1_epi16((short)(255 - alpha)), half = _mm_set1_epi16(128);
+    auto mix = [&](__m128i d) {
+        // x / 255, rounded: (x + 128 + ((x + 128) >> 8)) >> 8 is exact for every x here.
+        const __m128i x = _mm_add_epi16(_mm_add_epi16(src, _mm_mullo_epi16(d, inverse)), half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+    const __m128i blended = _mm_packus_epi16(mix(_mm_unpacklo_epi8(dst, zero)), mix(_mm_unpackhi_epi8(dst, zero)));
+    const __m128i select = _mm_setr_epi32(mask & 1 ? -1 : 0, mask & 2 ? -1 : 0, mask & 4 ? -1 : 0, mask & 8 ? -1 : 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(samples), _mm_or_si128(_mm_and_si128(select, blended), _mm_andnot_si128(select, dst)));
+#else
+    for (int k = 0; k < SoftwareRasterizer::SAMPLES; ++k) {
+        if (!(mask & (1u << k))) continue;
+        uint32_t out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            const unsigned x = ((color >> shift) & 0xFF) * alpha + ((samples[k] >> shift) & 0xFF) * (255 - alpha) + 128;
+            out |= ((x + (x >> 8)) >> 8) << shift;
+        }
+        samples[k] = out;
+    }
+#endif
+}
+
+unsigned div255(unsigned x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// The modes other than normal, one channel at a time. Color channels follow the GL backend's
+// blend functions on premultiplied color; alpha accumulates as in source-over.
+void blendMode(uint32_t* samples, unsigned mask, uint32_t color, sp_blend_mode_t mode)
+{
+    const unsigned alpha = color >> 24;
+    for (int k = 0; k < SoftwareRasterizer::SAMPLES; ++k) {
+        if (!(mask & (1u << k))) continue;
+        const uint32_t dst = samples[k];
+        uint32_t out = div255(alpha * alpha + (dst >> 24) * (255 - alpha)) << 24;
+        for (int shift = 0; shift < 24; shift += 8) {
+            const unsigned s = (color >> shift) & 0xFF, d = (dst >> shift) & 0xFF, p = div255(s * alpha);
+            unsigned c;
+            switch (mode) {
+            case SP_BLEND_MODE_ADD: c = std::min(p + d, 255u); break;
+            case SP_BLEND_MODE_MULTIPLY: c = div255(p * d + d * (255 - alpha)); break;
+            case SP_BLEND_MODE_SCREEN: c = p + div255(d * (255 - p)); break;
+            default: {
+                const unsigned overlay = d < 128 ? div255(2 * s * d) : 255 - div255(2 * (255 - s) * (255 - d));
+                c = div255(overlay * alpha + d * (255 - alpha));
+            }
+            }
+            out |= c << shift;
+        }
+        samples[k] = out;
+    }
+}
+
+float channel(uint32_t color, int shift)
+{
+    return (float)((color >> shift) & 0xFF) * (1.0f / 255.0f);
+}
+
+// Bilinear filtering with clamped edges and texel centers at (i + 0.5) / size, like the GL
+// backend's GL_LINEAR, GL_CLAMP_TO_EDGE textures. One-channel textures read as (r, 0, 0, 1).
+glm::vec4 sampleTexture(const SoftwareTexture& texture, glm::vec2 uv)
+{
+    const float fx = uv.x * (float)texture.width - 0.5f, fy = uv.y * (float)texture.height - 0.5f;
+    const float bx = std::floor(fx), by = std::floor(fy), tx = fx - bx, ty = fy - by;
+    const int maxX = (int)texture.width - 1, maxY = (int)texture.height - 1;
+    const int x0 = std::clamp((int)bx, 0, maxX), x1 = std::clamp((int)bx + 1, 0, maxX);
+    const int y0 = std::clamp((int)by, 0, maxY), y1 = std::clamp((int)by + 1, 0, maxY);
+    const uint8_t* pixels = texture.pixels->data();
+    auto texel = [&](int x, int y, int c) {
+        return (float)pixels[((size_t)y * texture.width + x) * texture.channels + c];
+    };
+    glm::vec4 out(0.0f, 0.0f, 0.0f, 1.0f);
+    for (int c = 0; c < (int)std::min(texture.channels, 4u); ++c) {
+        const float top = texel(x0, y0, c) + (texel(x1, y0, c) - texel(x0, y0, c)) * tx;
+        const float bottom = texel(x0, y1, c) + (texel(x1, y1, c) - texel(x0, y1, c)) * tx;
+        out[c] = (top + (bottom - top) * ty) * (1.0f / 255.0f);
+    }
+    return out;
+}
+
+// A textured quad's per-pixel color. Texture coordinates are an affine function of position:
+// every textured quad the renderer emits is a transformed rectangle, so the mapping of one
+// of its triangles holds across the whole quad.
+struct TexturedQuad {
+    const SoftwareTexture* texture;
+    uint8_t mode;
+    uint32_t color;
+    glm::vec2 origin, uv, du, dv;
+
+    // From the triangle (a, b, c) at tile-relative positions (p0, p1, p2).
+    bool setup(const Vertex& a, const Vertex& b, const Vertex& c, glm::vec2 p0, glm::vec2 p1, glm::vec2 p2)
+    {
+        const glm::vec2 e1 = p1 - p0, e2 = p2 - p0;
+        const float det = e1.x * e2.y - e1.y * e2.x;
+        if (!(det > 0.0f || det < 0.0f)) return false;
+        auto uvOf = [](const Vertex& vertex) {
+            return glm::vec2(vertex.texCoord[0], vertex.texCoord[1]) * (1.0f / 65535.0f);
+        };
+        const glm::vec2 t0 = uvOf(a), t1 = uvOf(b) - t0, t2 = uvOf(c) - t0;
+        // Partial derivatives of uv along x and y.
+        du = (t1 * e2.y - t2 * e1.y) / det;
+        dv = (t2 * e1.x - t1 * e2.x) / det;
+        origin = p0;
+        uv = t0;
+        return true;
+    }
+
+    glm::vec2 at(float x, float y) const { return uv + du * (x - origin.x) + dv * (y - origin.y); }
+
+    // The straight-alpha color of the pixel whose center is (x, y), as the batch shader
+    // computes it.
+    uint32_t shade(float x, float y) const
+    {
+        const glm::vec4 texel = sampleTexture(*texture, at(x, y));
+        const float r = channel(color, 0), g = channel(color, 8), b = channel(color, 16), a = channel(color, 24);
+        if (mode == TEXTURE_MODE_RGBA) return packColor(texel.x * r, texel.y * g, texel.z * b, texel.w * a);
+        float coverage = texel.x;
+        if (mode == TEXTURE_MODE_SDF) {
+            // fwidth() from the neighbouring pixels, as the GPU's derivatives would take it.
+            const float right = sampleTexture(*texture, at(x + 1.0f, y)).x;
+            const float below = sampleTexture(*texture, at(x, y + 1.0f)).x;
+            const float w = std::max((std::abs(right - coverage) + std::abs(below - coverage)) * 0.5f, 1e-4f);
+            const float t = std::clamp((coverage - (0.5f - w)) / (2.0f * w), 0.0f, 1.0f);
+            coverage = t * t * (3.0f - 2.0f * t);
+        }
+        return packColor(r, g, b, a * coverage);
+    }
+};
+
+uint32_t resolve(const uint32_t* samples)
+{
+#ifdef SPIRO_RASTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i all = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples));
+    __m128i sum = _mm_add_epi16(_mm_unpacklo_epi8(all, zero), _mm_unpackhi_epi8(all, zero));
+    sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+    return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(sum, zero));
+#else
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        unsigned sum = 2;
+        for (int k = 0; k < SoftwareRasterizer::SAMPLES; ++k) sum += (samples[k] >> shift) & 0xFF;
+        out |= (sum >> 2) << shift;
+    }
+    return out;
+#endif
+}
+
+}
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned threads) : m_samples((size_t)TILE_SIZE * TILE_SIZE * SAMPLES)
+{
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned i = 1; i < threads; ++i) m_threads.emplace_back(&SoftwareRasterizer::run, this);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+void SoftwareRasterizer::setTarget(uint8_t* pixels, int width, int height, size_t stride)
+{
+    m_pixels = pixels;
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_stride = stride;
+    m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    m_bins.assign((size_t)m_tilesX * m_tilesY, {});
+}
+
+void SoftwareRasterizer::clear(uint32_t color)
+{
+    m_commands.push_back(CLEAR_BIT | (uint32_t)m_clearColors.size());
+    m_clearColors.push_back(color);
+}
+
+void SoftwareRasterizer::drawQuads(const Vertex* vertices, size_t quadCount, sp_blend_mode_t blend,
+                                   const SoftwareTexture* textures, size_t textureCount)
+{
+    if (quadCount > 0 && blend != m_blend) {
+        m_commands.push_back(BLEND_BIT | (uint32_t)blend);
+        m_blend = blend;
+    }
+    // Textures are indexed per call; a render() partway through drops them, so they are
+    // queued again whenever that happens below.
+    size_t firstTexture = m_textures.size();
+    auto queueTextures = [&] {
+        firstTexture = m_textures.size();
+        m_textures.insert(m_textures.end(), textures, textures + textureCount);
+    };
+    queueTextures();
+    while (quadCount > 0) {
+        if (m_vertices.size() / VERTICES_PER_QUAD >= MAX_QUEUED_QUADS) {
+            render();
+            queueTextures();
+        }
+        const size_t queued = m_vertices.size() / VERTICES_PER_QUAD;
+        const size_t n = std::min(quadCount, MAX_QUEUED_QUADS - queued);
+        m_vertices.insert(m_vertices.end(), vertices, vertices + n * VERTICES_PER_QUAD);
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t slot = vertices[i * VERTICES_PER_QUAD].texSlot;
+            uint32_t texture = NO_TEXTURE;
+            if (slot != NO_TEXTURE_SLOT) {
+                const bool present = slot < textureCount && textures[slot].pixels && textures[slot].width > 0 &&
+                                     textures[slot].height > 0 && textures[slot].channels > 0;
+                texture = present ? (uint32_t)(firstTexture + slot) : MISSING_TEXTURE;
+            }
+            m_quadTextures.push_back(texture);
+            m_commands.push_back((uint32_t)(queued + i));
+        }
+        vertices += n * VERTICES_PER_QUAD;
+        quadCount -= n;
+    }
+}
+
+void SoftwareRasterizer::bin()
+{
+    m_binBlend.assign(m_bins.size(), (uint8_t)m_renderBlend);
+    uint8_t blend = (uint8_t)m_renderBlend;
+    for (uint32_t command : m_commands) {
+        if (command & BLEND_BIT) {
+            blend = (uint8_t)(command & ~BLEND_BIT);
+            continue;
+        }
+        if (command & CLEAR_BIT) {
+            // Nothing drawn earlier in a tile survives a clear.
+            for (auto& bin : m_bins) {
+                bin.clear();
+                bin.push_back(command);
+            }
+            continue;
+        }
+        const Vertex* v = &m_vertices[(size_t)command * VERTICES_PER_QUAD];
+        if (m_quadTextures[command] == MISSING_TEXTURE || (v[0].color >> 24) == 0) continue;
+        float minX = v[0].position.x, maxX = minX, minY = v[0].position.y, maxY = minY;
+        for (size_t i = 1; i < VERTICES_PER_QUAD; ++i) {
+            minX = std::min(minX, v[i].position.x); maxX = std::max(maxX, v[i].position.x);
+            minY = std::min(minY, v[i].position.y); maxY = std::max(maxY, v[i].position.y);
+        }
+        if (!(std::isfinite(minX) && std::isfinite(maxX) && std::isfinite(minY) && std::isfinite(maxY))) continue;
+        if (maxX < 0.0f || maxY < 0.0f || minX >= (float)m_width || minY >= (float)m_height) continue;
+        const int tx0 = (int)std::max(minX, 0.0f) / TILE_SIZE, tx1 = (int)std::min(maxX, (float)(m_width - 1)) / TILE_SIZE;
+        const int ty0 = (int)std::max(minY, 0.0f) / TILE_SIZE, ty1 = (int)std::min(maxY, (float)(m_height - 1)) / TILE_SIZE;
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                const size_t tile = (size_t)ty * m_tilesX + tx;
+                if (m_binBlend[tile] != blend) {
+                    m_bins[tile].push_back(BLEND_BIT | blend);
+                    m_binBlend[tile] = blend;
+                }
+                m_bins[tile].push_back(command);
+            }
+    }
+}
+
+void SoftwareRasterizer::render()
+{
+    if (m_commands.empty()) return;
+    if (m_pixels && !m_bins.empty()) {
+        bin();
+        m_nextTile.store(0);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_generation++;
+            m_working = m_threads.size();
+        }
+        m_work.notify_all();
+        rasterizeTiles(m_samples.data());
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_working == 0; });
+    }
+    m_vertices.clear();
+    m_quadTextures.clear();
+    m_textures.clear();
+    m_clearColors.clear();
+    m_commands.clear();
+    for (auto& bin : m_bins) bin.clear();
+    m_renderBlend = m_blend;
+}
+
+void SoftwareRasterizer::run()
+{
+    std::vector<uint32_t> samples((size_t)TILE_SIZE * TILE_SIZE * SAMPLES);
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping) return;
+            seen = m_generation;
+        }
+        rasterizeTiles(samples.data());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_working--;
+        }
+        m_done.notify_one();
+    }
+}
+
+void SoftwareRasterizer::rasterizeTiles(uint32_t* samples)
+{
+    for (size_t tile; (tile = m_nextTile.fetch_add(1)) < m_bins.size();)
+        if (!m_bins[tile].empty()) rasterizeTile(tile, samples);
+}
+
+void SoftwareRasterizer::rasterizeTile(size_t tile, uint32_t* samples)
+{
+    const std::vector<uint32_t>& bin = m_bins[tile];
+    const int x0 = (int)(tile % m_tilesX) * TILE_SIZE, y0 = (int)(tile / m_tilesX) * TILE_SIZE;
+    const int width = std::min(TILE_SIZE, m_width - x0), height = std::min(TILE_SIZE, m_height - y0);
+    auto row = [&](int y) { return m_pixels + (size_t)(y0 + y) * m_stride + (size_t)x0 * 4; };
+    auto pixelSamples = [&](int x, int y) { return samples + ((size_t)y * TILE_SIZE + x) * SAMPLES; };
+
+    // Drawing blends over the target as it was, unless the tile starts with a clear.
+    if (!(bin.front() & CLEAR_BIT)) {
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* src = row(y);
+            for (int x = 0; x < width; ++x) {
+                uint32_t pixel;
+                std::memcpy(&pixel, src + x * 4, 4);
+                std::fill_n(pixelSamples(x, y), SAMPLES, pixel);
+            }
+        }
+    }
+
+    const glm::vec2 origin((float)x0, (float)y0);
+    RowTerms rows;
+    sp_blend_mode_t mode = m_renderBlend;
+    for (uint32_t command : bin) {
+        if (command & BLEND_BIT) {
+            mode = (sp_blend_mode_t)(command & ~BLEND_BIT);
+            continue;
+        }
+        if (command & CLEAR_BIT) {
+            const uint32_t color = m_clearColors[command & ~CLEAR_BIT];
+            for (int y = 0; y < height; ++y) std::fill_n(pixelSamples(0, y), (size_t)width * SAMPLES, color);
+            continue;
+        }
+        // Tile-relative coordinates keep the edge functions small and exact enough.
+        const Vertex* v = &m_vertices[(size_t)command * VERTICES_PER_QUAD];
+        const glm::vec2 p0 = v[0].position - origin, p1 = v[1].position - origin;
+        const glm::vec2 p2 = v[2].position - origin, p3 = v[3].position - origin;
+        const Triangle triangles[2] = {setupTriangle(p0, p1, p2), setupTriangle(p0, p2, p3)};
+        if (!triangles[0].valid && !triangles[1].valid) continue;
+        const float minX = std::min({p0.x, p1.x, p2.x, p3.x}), maxX = std::max({p0.x, p1.x, p2.x, p3.x});
+        const float minY = std::min({p0.y, p1.y, p2.y, p3.y}), maxY = std::max({p0.y, p1.y, p2.y, p3.y});
+        const int px0 = (int)std::floor(std::max(minX, 0.0f)), px1 = (int)std::ceil(std::min(maxX, (float)width));
+        const int py0 = (int)std::floor(std::max(minY, 0.0f)), py1 = (int)std::ceil(std::min(maxY, (float)height));
+        const uint32_t textureIndex = m_quadTextures[command];
+        TexturedQuad textured{};
+        if (textureIndex != NO_TEXTURE) {
+            textured.texture = &m_textures[textureIndex];
+            textured.mode = v[0].texMode;
+            textured.color = v[0].color;
+            if (!textured.setup(v[0], v[1], v[2], p0, p1, p2) && !textured.setup(v[0], v[2], v[3], p0, p2, p3)) continue;
+        }
+        const uint32_t color = v[0].color;
+        for (int y = py0; y < py1; ++y) {
+            computeRowTerms(triangles, (float)y, rows);
+            if (textured.texture) {
+                for (int x = px0; x < px1; ++x) {
+                    const unsigned mask = coverage(triangles, rows, (float)x);
+                    if (!mask) continue;
+                    const uint32_t shaded = textured.shade((float)x + 0.5f, (float)y + 0.5f);
+                    if ((shaded >> 24) == 0) continue;
+                    if (mode == SP_BLEND_MODE_NORMAL) blend(pixelSamples(x, y), mask, shaded);
+                    else blendMode(pixelSamples(x, y), mask, shaded, mode);
+                }
+            } else if (mode == SP_BLEND_MODE_NORMAL) {
+                for (int x = px0; x < px1; ++x)
+                    if (const unsigned mask = coverage(triangles, rows, (float)x)) blend(pixelSamples(x, y), mask, color);
+            } else {
+                for (int x = px0; x < px1; ++x)
+                    if (const unsigned mask = coverage(triangles, rows, (float)x)) blendMode(pixelSamples(x, y), mask, color, mode);
+            }
+        }
+    }
+
+    for (int y = 0; y < height; ++y) {
+        uint8_t* dst = row(y);
+        for (int x = 0; x < width; ++x) {
+            const uint32_t pixel = resolve(pixelSamples(x, y));
+            std::memcpy(dst + x * 4, &pixel, 4);
+        }
+    }
+}
+
+}
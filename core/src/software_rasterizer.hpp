@@ -0,0 +1,96 @@
+#pragma once
+
+#include "software_texture.hpp"
+#include "vertex.hpp"
+
+#include <spirographicals/spirographicals.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spiro::internal {
+
+// Draws the renderer's device-space quads into an RGBA8 buffer without a GPU. Everything
+// queued between render() calls is binned into square tiles, and a pool of threads takes the
+// tiles one at a time, so no two threads touch the same pixels and every pixel still sees its
+// quads in submission order. While a tile is in flight each pixel keeps 4 samples, evaluated
+// together in one SIMD vector; quads blend into the samples they cover and the tile is
+// averaged into the target at the end. That antialiases edges without the seams per-quad
+// coverage would leave where neighbouring quads meet. Quads are flat-shaded with their first
+// vertex's color, like everything the renderer emits. Textured quads (glyphs, images) are
+// shaded per pixel instead, with a bilinear sample taken at the pixel center and used as the
+// batch shader uses it for the quad's texture mode. Each draw blends under its own
+// sp_blend_mode_t, all five of them exactly.
+class SoftwareRasterizer {
+public:
+    static constexpr int TILE_SIZE = 64;
+    static constexpr int SAMPLES = 4;
+    // Past this many queued quads, drawQuads renders what it has so the queue stays bounded.
+    static constexpr size_t MAX_QUEUED_QUADS = 1 << 22;
+
+    // 0 threads means one per hardware thread. The thread calling render() is one of them.
+    explicit SoftwareRasterizer(unsigned threads);
+    ~SoftwareRasterizer();
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    // Top-down rows `stride` bytes apart. The buffer is read as well as written (drawing
+    // blends over what is there) and must stay valid until the next setTarget.
+    void setTarget(uint8_t* pixels, int width, int height, size_t stride);
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    const uint8_t* pixels() const { return m_pixels; }
+    size_t stride() const { return m_stride; }
+    unsigned threadCount() const { return (unsigned)m_threads.size() + 1; }
+
+    void clear(uint32_t color);
+    // Quads as 4 corners each, triangulated (0, 1, 2) and (0, 2, 3) like the index buffer.
+    // A textured quad samples textures[texSlot]; quads whose texture is missing or has no
+    // pixels are skipped.
+    void drawQuads(const Vertex* vertices, size_t quadCount, sp_blend_mode_t blend = SP_BLEND_MODE_NORMAL,
+                   const SoftwareTexture* textures = nullptr, size_t textureCount = 0);
+    // Draws everything queued since the last call into the target.
+    void render();
+
+private:
+    void bin();
+    void run();
+    // `samples` is the calling thread's tile buffer, TILE_SIZE^2 * SAMPLES values.
+    void rasterizeTiles(uint32_t* samples);
+    void rasterizeTile(size_t tile, uint32_t* samples);
+
+    uint8_t* m_pixels = nullptr;
+    int m_width = 0, m_height = 0, m_tilesX = 0, m_tilesY = 0;
+    size_t m_stride = 0;
+    std::vector<Vertex> m_vertices;
+    // Per queued quad, its texture in m_textures, NO_TEXTURE or MISSING_TEXTURE. The textures
+    // are held until render() so their pixels outlive a release in between.
+    std::vector<uint32_t> m_quadTextures;
+    std::vector<SoftwareTexture> m_textures;
+    std::vector<uint32_t> m_clearColors;
+    // Queued quads, clears and blend mode changes in order, as quad indices, CLEAR_BIT | clear
+    // index or BLEND_BIT | mode; bin() copies each entry to the tiles it touches, and a mode
+    // change only to the tiles that draw something under it.
+    std::vector<uint32_t> m_commands;
+    std::vector<std::vector<uint32_t>> m_bins;
+    // The mode of the last queued quads, and the one each tile starts from in render().
+    sp_blend_mode_t m_blend = SP_BLEND_MODE_NORMAL, m_renderBlend = SP_BLEND_MODE_NORMAL;
+    std::vector<uint8_t> m_binBlend;
+    // The render() caller's tile buffer; pool threads keep their own.
+    std::vector<uint32_t> m_samples;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_work, m_done;
+    uint64_t m_generation = 0;
+    size_t m_working = 0;
+    bool m_stopping = false;
+    std::atomic<size_t> m_nextTile{0};
+};
+
+}
@@ -0,0 +1,40 @@
+#include "software_texture.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace spiro::internal {
+
+namespace {
+
+std::mutex g_mutex;
+std::unordered_map<GLuint, SoftwareTexture> g_textures;
+GLuint g_nextName = 1;
+
+}
+
+GLuint registerSoftwareTexture(SoftwareTexture texture)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    const GLuint name = SOFTWARE_TEXTURE_BIT | g_nextName;
+    g_nextName = g_nextName + 1 < SOFTWARE_TEXTURE_BIT ? g_nextName + 1 : 1;
+    g_textures[name] = std::move(texture);
+    return name;
+}
+
+void releaseSoftwareTexture(GLuint name)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_textures.erase(name);
+}
+
+bool findSoftwareTexture(GLuint name, SoftwareTexture& out)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto found = g_textures.find(name);
+    if (found == g_textures.end()) return false;
+    out = found->second;
+    return true;
+}
+
+}
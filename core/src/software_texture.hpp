@@ -0,0 +1,31 @@
+#pragma once
+
+#include "gl_ext.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace spiro::internal {
+
+// Pixels the software rasterizer samples, named like GL textures so that glyph pages, images
+// and scene textures reach it through the renderer's texture slots unchanged. Names have the
+// top bit set, which GL never hands out, so a name tells which kind of texture it is. Rows are
+// tightly packed, 1 byte per texel (R8) or 4 (straight-alpha RGBA8). The pixels are shared, so
+// a texture still queued for drawing stays readable after it is released.
+struct SoftwareTexture {
+    uint32_t width = 0, height = 0, channels = 0;
+    std::shared_ptr<const std::vector<uint8_t>> pixels;
+};
+
+constexpr GLuint SOFTWARE_TEXTURE_BIT = 0x80000000u;
+
+inline bool isSoftwareTexture(GLuint name) { return (name & SOFTWARE_TEXTURE_BIT) != 0; }
+
+// Any thread may register, find and release textures.
+GLuint registerSoftwareTexture(SoftwareTexture texture);
+void releaseSoftwareTexture(GLuint name);
+// False if `name` is not a registered texture.
+bool findSoftwareTexture(GLuint name, SoftwareTexture& out);
+
+}
@@ -0,0 +1,102 @@
+#include "stream_buffer.hpp"
+
+namespace spiro::internal {
+
+namespace {
+
+constexpr GLuint64 WAIT_TIMEOUT_NS = 1000000000;
+
+}
+
+StreamBuffer::StreamBuffer(GLenum target, size_t windowBytes, size_t windowCount)
+    : m_target(target), m_windowBytes(windowBytes), m_capacity(windowBytes * (windowCount ? windowCount : 1))
+{
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(m_target, m_buffer);
+    m_persistent = g_glCaps.bufferStorage && g_glCaps.sync;
+    if (m_persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(m_target, (GLsizeiptr)m_capacity, nullptr, flags);
+        m_persistentBase = static_cast<uint8_t*>(glMapBufferRange(m_target, 0, (GLsizeiptr)m_capacity, flags));
+        m_persistent = m_persistentBase != nullptr;
+    }
+    if (!m_persistent) {
+        // Storage from glBufferStorage is immutable, so start over with a fresh buffer.
+        glDeleteBuffers(1, &m_buffer);
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(m_target, m_buffer);
+        glBufferData(m_target, (GLsizeiptr)m_capacity, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (auto& pending : m_pending) glDeleteSync(pending.fence);
+    glDeleteBuffers(1, &m_buffer);
+}
+
+void StreamBuffer::waitForRange(size_t begin, size_t end)
+{
+    // Fences signal in submission order, so waiting on the newest overlapping range
+    // releases everything queued before it as well.
+    size_t last = m_pending.size();
+    for (size_t i = 0; i < m_pending.size(); ++i)
+        if (m_pending[i].begin < end && begin < m_pending[i].end) last = i;
+    if (last == m_pending.size()) return;
+    GLenum status;
+    do {
+        status = glClientWaitSync(m_pending[last].fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    for (size_t i = 0; i <= last; ++i) glDeleteSync(m_pending[i].fence);
+    m_pending.erase(m_pending.begin(), m_pending.begin() + last + 1);
+}
+
+void* StreamBuffer::map()
+{
+    if (m_window) return m_window;
+    bool wrapped = false;
+    if (m_cursor + m_windowBytes > m_capacity) {
+        m_cursor = 0;
+        wrapped = true;
+    }
+    glBindBuffer(m_target, m_buffer);
+    if (m_persistent) {
+        waitForRange(m_cursor, m_cursor + m_windowBytes);
+        m_window = m_persistentBase + m_cursor;
+        return m_window;
+    }
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    if (wrapped) {
+        glBufferData(m_target, (GLsizeiptr)m_capacity, nullptr, GL_STREAM_DRAW);
+    } else {
+        // Everything before the cursor was written once since the last orphan and is never
+        // touched again in this storage, so the GPU can keep reading it while we map.
+        access |= GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    }
+    m_window = glMapBufferRange(m_target, (GLintptr)m_cursor, (GLsizeiptr)m_windowBytes, access);
+    return m_window;
+}
+
+size_t StreamBuffer::commit(size_t bytes)
+{
+    m_committedBegin = m_committedEnd = m_cursor;
+    if (!m_window) return m_cursor;
+    glBindBuffer(m_target, m_buffer);
+    if (!m_persistent) {
+        if (bytes) glFlushMappedBufferRange(m_target, 0, (GLsizeiptr)bytes);
+        glUnmapBuffer(m_target);
+    }
+    m_window = nullptr;
+    m_committedEnd = m_cursor + bytes;
+    m_cursor = m_committedEnd;
+    return m_committedBegin;
+}
+
+void StreamBuffer::retire()
+{
+    if (!m_persistent || m_committedEnd == m_committedBegin) return;
+    m_pending.push_back({m_committedBegin, m_committedEnd, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    m_committedBegin = m_committedEnd;
+}
+
+}
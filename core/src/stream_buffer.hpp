@@ -0,0 +1,55 @@
+#pragma once
+
+#include "gl_ext.hpp"
+
+#include <cstddef>
+#include <deque>
+
+namespace spiro::internal {
+
+// Ring-buffered GL buffer for geometry that is rewritten every batch. Each batch maps a
+// fixed-size window at the ring cursor, the caller writes straight into it, and commit()
+// returns the byte offset to draw from.
+//
+// With buffer storage and sync objects the whole ring stays persistently mapped and every
+// committed range is fenced, so a window is only waited on if the GPU still reads it a full
+// lap later. Otherwise each window is mapped unsynchronized, and the buffer is orphaned
+// when the cursor wraps so the driver hands back fresh storage instead of stalling.
+class StreamBuffer {
+public:
+    StreamBuffer(GLenum target, size_t windowBytes, size_t windowCount);
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    GLuint handle() const { return m_buffer; }
+    bool persistent() const { return m_persistent; }
+    bool mapped() const { return m_window != nullptr; }
+
+    // Returns windowBytes of writable memory. Leaves the buffer bound to its target.
+    void* map();
+    // Ends the window after `bytes` were written and returns their offset in the buffer.
+    // The buffer stays bound; the range must be drawn before the next map().
+    size_t commit(size_t bytes);
+    // Fences the last committed range. Call after the draws that read it were issued.
+    void retire();
+
+private:
+    struct Pending {
+        size_t begin, end;
+        GLsync fence;
+    };
+
+    void waitForRange(size_t begin, size_t end);
+
+    GLenum m_target;
+    GLuint m_buffer = 0;
+    size_t m_windowBytes, m_capacity;
+    size_t m_cursor = 0, m_committedBegin = 0, m_committedEnd = 0;
+    bool m_persistent = false;
+    uint8_t* m_persistentBase = nullptr;
+    void* m_window = nullptr;
+    std::deque<Pending> m_pending;
+};
+
+}
@@ -0,0 +1,210 @@
+#include "stroke_kernel.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SPIRO_KERNEL_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SPIRO_KERNEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && SPIRO_KERNEL_SSE2
+#include <intrin.h>
+#endif
+
+namespace spiro::internal {
+
+static_assert(offsetof(Vertex, color) == 8 && offsetof(Vertex, texCoord) == 12 && offsetof(Vertex, texSlot) == 16,
+              "SIMD stroke kernels store vertices as {x, y, color, texcoords} plus the slot word");
+
+#ifdef SPIRO_HAS_AVX2_KERNEL
+// Lives in stroke_kernel_avx2.cpp, the only translation unit built with AVX2 enabled.
+void strokeSegmentsAVX2(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out);
+#endif
+
+// The reference every SIMD variant must match bit for bit: the same operations in the same
+// order, with no fused multiply-add (kernel sources build with -ffp-contract=off).
+void strokeSegmentsScalar(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out)
+{
+    const Affine2D& t = params.transform;
+    const Vertex base = makeVertex({0.0f, 0.0f}, params.color, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+    for (size_t i = 0; i < segments; ++i, out += VERTICES_PER_QUAD) {
+        const float x1 = points[i].x, y1 = points[i].y, x2 = points[i + 1].x, y2 = points[i + 1].y;
+        const float dx = x2 - x1, dy = y2 - y1;
+        const float len = std::sqrt(dx * dx + dy * dy);
+        const float s = len > 0.0f ? params.halfWidth / len : 0.0f;
+        const float ox = -dy * s, oy = dx * s;
+        const float lx = t.a * ox + t.c * oy, ly = t.b * ox + t.d * oy;
+        const float tx1 = t.a * x1 + t.c * y1 + t.e, ty1 = t.b * x1 + t.d * y1 + t.f;
+        const float tx2 = t.a * x2 + t.c * y2 + t.e, ty2 = t.b * x2 + t.d * y2 + t.f;
+        out[0] = out[1] = out[2] = out[3] = base;
+        out[0].position = {tx1 - lx, ty1 - ly};
+        out[1].position = {tx2 - lx, ty2 - ly};
+        out[2].position = {tx2 + lx, ty2 + ly};
+        out[3].position = {tx1 + lx, ty1 + ly};
+    }
+}
+
+#if SPIRO_KERNEL_SSE2
+// Vertex is {x, y, color, texcoords} in its first 16 bytes and the slot word in the last 4, so
+// each vertex goes out as one 16-byte and one 4-byte store instead of a template copy plus patch.
+static __m128 vertexTail(const Vertex& base)
+{
+    return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&base.color)));
+}
+
+static void storeVertex(Vertex* out, __m128 xyColorTex, uint32_t slot)
+{
+    _mm_storeu_ps(&out->position.x, xyColorTex);
+    std::memcpy(&out->texSlot, &slot, sizeof(slot));
+}
+
+static void strokeSegmentsSSE2(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out)
+{
+    const Affine2D& t = params.transform;
+    const Vertex base = makeVertex({0.0f, 0.0f}, params.color, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+    const __m128 tail = vertexTail(base);
+    uint32_t slot;
+    std::memcpy(&slot, &base.texSlot, sizeof(slot));
+    const __m128 a = _mm_set1_ps(t.a), b = _mm_set1_ps(t.b), c = _mm_set1_ps(t.c), d = _mm_set1_ps(t.d);
+    const __m128 e = _mm_set1_ps(t.e), f = _mm_set1_ps(t.f), hw = _mm_set1_ps(params.halfWidth);
+    const __m128 zero = _mm_setzero_ps(), sign = _mm_set1_ps(-0.0f);
+    const float* p = &points[0].x;
+    size_t i = 0;
+    for (; i + 4 <= segments; i += 4, out += 4 * VERTICES_PER_QUAD) {
+        // Points i..i+3 and i+1..i+4, deinterleaved into x and y lanes.
+        const __m128 a0 = _mm_loadu_ps(p + 2 * i), a1 = _mm_loadu_ps(p + 2 * i + 4);
+        const __m128 b0 = _mm_loadu_ps(p + 2 * i + 2), b1 = _mm_loadu_ps(p + 2 * i + 6);
+        const __m128 x1 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)), y1 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 x2 = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)), y2 = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 dx = _mm_sub_ps(x2, x1), dy = _mm_sub_ps(y2, y1);
+        const __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        const __m128 s = _mm_and_ps(_mm_cmpgt_ps(len, zero), _mm_div_ps(hw, len));
+        const __m128 ox = _mm_mul_ps(_mm_xor_ps(dy, sign), s), oy = _mm_mul_ps(dx, s);
+        const __m128 lx = _mm_add_ps(_mm_mul_ps(a, ox), _mm_mul_ps(c, oy)), ly = _mm_add_ps(_mm_mul_ps(b, ox), _mm_mul_ps(d, oy));
+        const __m128 tx1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x1), _mm_mul_ps(c, y1)), e);
+        const __m128 ty1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b, x1), _mm_mul_ps(d, y1)), f);
+        const __m128 tx2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x2), _mm_mul_ps(c, y2)), e);
+        const __m128 ty2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b, x2), _mm_mul_ps(d, y2)), f);
+        const __m128 cx[4] = {_mm_sub_ps(tx1, lx), _mm_sub_ps(tx2, lx), _mm_add_ps(tx2, lx), _mm_add_ps(tx1, lx)};
+        const __m128 cy[4] = {_mm_sub_ps(ty1, ly), _mm_sub_ps(ty2, ly), _mm_add_ps(ty2, ly), _mm_add_ps(ty1, ly)};
+        for (size_t k = 0; k < VERTICES_PER_QUAD; ++k) {
+            const __m128 lo = _mm_unpacklo_ps(cx[k], cy[k]), hi = _mm_unpackhi_ps(cx[k], cy[k]);
+            storeVertex(out + 0 * VERTICES_PER_QUAD + k, _mm_movelh_ps(lo, tail), slot);
+            storeVertex(out + 1 * VERTICES_PER_QUAD + k, _mm_shuffle_ps(lo, tail, _MM_SHUFFLE(1, 0, 3, 2)), slot);
+            storeVertex(out + 2 * VERTICES_PER_QUAD + k, _mm_movelh_ps(hi, tail), slot);
+            storeVertex(out + 3 * VERTICES_PER_QUAD + k, _mm_shuffle_ps(hi, tail, _MM_SHUFFLE(1, 0, 3, 2)), slot);
+        }
+    }
+    strokeSegmentsScalar(points + i, segments - i, params, out);
+}
+#endif
+
+#if SPIRO_KERNEL_NEON
+static void strokeSegmentsNEON(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out)
+{
+    const Affine2D& t = params.transform;
+    const Vertex base = makeVertex({0.0f, 0.0f}, params.color, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+    const float32x4_t a = vdupq_n_f32(t.a), b = vdupq_n_f32(t.b), c = vdupq_n_f32(t.c), d = vdupq_n_f32(t.d);
+    const float32x4_t e = vdupq_n_f32(t.e), f = vdupq_n_f32(t.f), hw = vdupq_n_f32(params.halfWidth);
+    const float32x2_t tail = vreinterpret_f32_u32(vld1_u32(reinterpret_cast<const uint32_t*>(&base.color)));
+    uint32_t slot;
+    std::memcpy(&slot, &base.texSlot, sizeof(slot));
+    const float* p = &points[0].x;
+    size_t i = 0;
+    for (; i + 4 <= segments; i += 4, out += 4 * VERTICES_PER_QUAD) {
+        const float32x4x2_t p1 = vld2q_f32(p + 2 * i), p2 = vld2q_f32(p + 2 * i + 2);
+        const float32x4_t x1 = p1.val[0], y1 = p1.val[1], x2 = p2.val[0], y2 = p2.val[1];
+        const float32x4_t dx = vsubq_f32(x2, x1), dy = vsubq_f32(y2, y1);
+        const float32x4_t len = vsqrtq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)));
+        const uint32x4_t nonzero = vcgtq_f32(len, vdupq_n_f32(0.0f));
+        const float32x4_t s = vreinterpretq_f32_u32(vandq_u32(nonzero, vreinterpretq_u32_f32(vdivq_f32(hw, len))));
+        const float32x4_t ox = vmulq_f32(vnegq_f32(dy), s), oy = vmulq_f32(dx, s);
+        const float32x4_t lx = vaddq_f32(vmulq_f32(a, ox), vmulq_f32(c, oy)), ly = vaddq_f32(vmulq_f32(b, ox), vmulq_f32(d, oy));
+        const float32x4_t tx1 = vaddq_f32(vaddq_f32(vmulq_f32(a, x1), vmulq_f32(c, y1)), e);
+        const float32x4_t ty1 = vaddq_f32(vaddq_f32(vmulq_f32(b, x1), vmulq_f32(d, y1)), f);
+        const float32x4_t tx2 = vaddq_f32(vaddq_f32(vmulq_f32(a, x2), vmulq_f32(c, y2)), e);
+        const float32x4_t ty2 = vaddq_f32(vaddq_f32(vmulq_f32(b, x2), vmulq_f32(d, y2)), f);
+        const float32x4_t cx[4] = {vsubq_f32(tx1, lx), vsubq_f32(tx2, lx), vaddq_f32(tx2, lx), vaddq_f32(tx1, lx)};
+        const float32x4_t cy[4] = {vsubq_f32(ty1, ly), vsubq_f32(ty2, ly), vaddq_f32(ty2, ly), vaddq_f32(ty1, ly)};
+        for (size_t k = 0; k < VERTICES_PER_QUAD; ++k) {
+            const float32x4x2_t xy = vzipq_f32(cx[k], cy[k]);
+            const float32x2_t pairs[4] = {vget_low_f32(xy.val[0]), vget_high_f32(xy.val[0]), vget_low_f32(xy.val[1]), vget_high_f32(xy.val[1])};
+            for (size_t q = 0; q < 4; ++q) {
+                Vertex* v = out + q * VERTICES_PER_QUAD + k;
+                vst1q_f32(&v->position.x, vcombine_f32(pairs[q], tail));
+                std::memcpy(&v->texSlot, &slot, sizeof(slot));
+            }
+        }
+    }
+    strokeSegmentsScalar(points + i, segments - i, params, out);
+}
+#endif
+
+static bool cpuHasAVX2()
+{
+#if defined(SPIRO_HAS_AVX2_KERNEL) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(SPIRO_HAS_AVX2_KERNEL) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 0, 0);
+    if (info[0] < 7) return false;
+    __cpuidex(info, 1, 0);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    __cpuidex(info, 7, 0);
+    return osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    return false;
+#endif
+}
+
+SimdLevel detectSimdLevel()
+{
+    if (cpuHasAVX2()) return SimdLevel::AVX2;
+#if SPIRO_KERNEL_SSE2
+    return SimdLevel::SSE2;
+#elif SPIRO_KERNEL_NEON
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+StrokeKernel strokeKernel(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Scalar: return strokeSegmentsScalar;
+#if SPIRO_KERNEL_SSE2
+    case SimdLevel::SSE2: return strokeSegmentsSSE2;
+#endif
+#ifdef SPIRO_HAS_AVX2_KERNEL
+    case SimdLevel::AVX2: return cpuHasAVX2() ? strokeSegmentsAVX2 : nullptr;
+#endif
+#if SPIRO_KERNEL_NEON
+    case SimdLevel::NEON: return strokeSegmentsNEON;
+#endif
+    default: return nullptr;
+    }
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::SSE2: return "sse2";
+    case SimdLevel::AVX2: return "avx2";
+    case SimdLevel::NEON: return "neon";
+    default: return "scalar";
+    }
+}
+
+void strokeSegments(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out)
+{
+    static const StrokeKernel kernel = strokeKernel(detectSimdLevel());
+    kernel(points, segments, params, out);
+}
+
+}
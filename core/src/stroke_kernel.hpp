@@ -0,0 +1,42 @@
+#pragma once
+
+#include "vertex.hpp"
+
+#include <spirographicals/spirographicals.h>
+
+#include <cstddef>
+
+namespace spiro::internal {
+
+// Row-major 2x3 affine: x' = a*x + c*y + e, y' = b*x + d*y + f.
+struct Affine2D {
+    float a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+    glm::vec2 apply(glm::vec2 p) const { return {a * p.x + c * p.y + e, b * p.x + d * p.y + f}; }
+    glm::vec2 applyLinear(glm::vec2 v) const { return {a * v.x + c * v.y, b * v.x + d * v.y}; }
+};
+
+struct StrokeParams {
+    float halfWidth;
+    Affine2D transform;
+    uint32_t color;
+};
+
+enum class SimdLevel { Scalar, SSE2, AVX2, NEON };
+
+// Writes one quad (4 vertices) per segment of the polyline points[0..segments]. Each quad is
+// the segment offset by +/- halfWidth along its normal in local space, then transformed.
+// Every variant produces bit-identical output to the scalar reference.
+using StrokeKernel = void (*)(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out);
+
+void strokeSegmentsScalar(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out);
+
+// Best level the running CPU supports among the variants compiled in.
+SimdLevel detectSimdLevel();
+// Null when the variant was not compiled for this target or the CPU lacks it.
+StrokeKernel strokeKernel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+// Dispatches to the best variant, chosen once on first use.
+void strokeSegments(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out);
+
+}
@@ -0,0 +1,64 @@
+#include "stroke_kernel.hpp"
+
+#include <immintrin.h>
+
+#include <cstring>
+
+namespace spiro::internal {
+
+// Same vertex store as the SSE2 variant: {x, y, color, texcoords} then the slot word.
+static void storeVertex(Vertex* out, __m128 xyColorTex, uint32_t slot)
+{
+    _mm_storeu_ps(&out->position.x, xyColorTex);
+    std::memcpy(&out->texSlot, &slot, sizeof(slot));
+}
+
+// Same operation order as strokeSegmentsScalar, eight segments per iteration. Built with AVX2
+// but without FMA so products are rounded exactly like the reference.
+void strokeSegmentsAVX2(const sp_vec2_t* points, size_t segments, const StrokeParams& params, Vertex* out)
+{
+    const Affine2D& t = params.transform;
+    const Vertex base = makeVertex({0.0f, 0.0f}, params.color, 0.0f, 0.0f, NO_TEXTURE_SLOT);
+    const __m256 a = _mm256_set1_ps(t.a), b = _mm256_set1_ps(t.b), c = _mm256_set1_ps(t.c), d = _mm256_set1_ps(t.d);
+    const __m256 e = _mm256_set1_ps(t.e), f = _mm256_set1_ps(t.f), hw = _mm256_set1_ps(params.halfWidth);
+    const __m256 zero = _mm256_setzero_ps(), sign = _mm256_set1_ps(-0.0f);
+    const __m128 tail = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&base.color)));
+    uint32_t slot;
+    std::memcpy(&slot, &base.texSlot, sizeof(slot));
+    const float* p = &points[0].x;
+    // In-lane shuffles leave x as 0 1 4 5 | 2 3 6 7; this qword permute restores 0..7.
+    auto deinterleave = [](__m256 lo, __m256 hi, __m256& x, __m256& y) {
+        x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+        y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+    };
+    size_t i = 0;
+    for (; i + 8 <= segments; i += 8, out += 8 * VERTICES_PER_QUAD) {
+        __m256 x1, y1, x2, y2;
+        deinterleave(_mm256_loadu_ps(p + 2 * i), _mm256_loadu_ps(p + 2 * i + 8), x1, y1);
+        deinterleave(_mm256_loadu_ps(p + 2 * i + 2), _mm256_loadu_ps(p + 2 * i + 10), x2, y2);
+        const __m256 dx = _mm256_sub_ps(x2, x1), dy = _mm256_sub_ps(y2, y1);
+        const __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        const __m256 s = _mm256_and_ps(_mm256_cmp_ps(len, zero, _CMP_GT_OQ), _mm256_div_ps(hw, len));
+        const __m256 ox = _mm256_mul_ps(_mm256_xor_ps(dy, sign), s), oy = _mm256_mul_ps(dx, s);
+        const __m256 lx = _mm256_add_ps(_mm256_mul_ps(a, ox), _mm256_mul_ps(c, oy));
+        const __m256 ly = _mm256_add_ps(_mm256_mul_ps(b, ox), _mm256_mul_ps(d, oy));
+        const __m256 tx1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, x1), _mm256_mul_ps(c, y1)), e);
+        const __m256 ty1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b, x1), _mm256_mul_ps(d, y1)), f);
+        const __m256 tx2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, x2), _mm256_mul_ps(c, y2)), e);
+        const __m256 ty2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b, x2), _mm256_mul_ps(d, y2)), f);
+        const __m256 cx[4] = {_mm256_sub_ps(tx1, lx), _mm256_sub_ps(tx2, lx), _mm256_add_ps(tx2, lx), _mm256_add_ps(tx1, lx)};
+        const __m256 cy[4] = {_mm256_sub_ps(ty1, ly), _mm256_sub_ps(ty2, ly), _mm256_add_ps(ty2, ly), _mm256_add_ps(ty1, ly)};
+        for (size_t k = 0; k < VERTICES_PER_QUAD; ++k) {
+            // unpacklo/hi interleave within 128-bit lanes: lo = segments 0 1 | 4 5, hi = 2 3 | 6 7.
+            const __m256 lo = _mm256_unpacklo_ps(cx[k], cy[k]), hi = _mm256_unpackhi_ps(cx[k], cy[k]);
+            const __m128 pairs[4] = {_mm256_castps256_ps128(lo), _mm256_castps256_ps128(hi), _mm256_extractf128_ps(lo, 1), _mm256_extractf128_ps(hi, 1)};
+            for (size_t q = 0; q < 4; ++q) {
+                storeVertex(out + (2 * q) * VERTICES_PER_QUAD + k, _mm_movelh_ps(pairs[q], tail), slot);
+                storeVertex(out + (2 * q + 1) * VERTICES_PER_QUAD + k, _mm_shuffle_ps(pairs[q], tail, _MM_SHUFFLE(1, 0, 3, 2)), slot);
+            }
+        }
+    }
+    strokeSegmentsScalar(points + i, segments - i, params, out);
+}
+
+}
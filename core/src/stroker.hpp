@@ -0,0 +1,211 @@
+#pragma once
+
+#include <spirographicals/spirographicals.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace spiro::internal {
+
+struct StrokeStyle {
+    float halfWidth;
+    sp_line_cap_t cap;
+    sp_line_join_t join;
+    float miterLimit;
+};
+
+// Turns a polyline into one ribbon of quads: consecutive segments share their joined edge, so
+// nothing overlaps along the path and there are no gaps at the vertices. Joins and caps add
+// fans/triangles on the outer side only. Quads are handed to `emit(a, b, c, d)` in local
+// coordinates and are drawn as triangles (a, b, c) and (a, c, d); triangles repeat their last
+// corner. Nothing is allocated and the path is walked once.
+//
+// pixelScale converts local lengths to device pixels and sets round join/cap density.
+template <typename Emit>
+class Stroker {
+public:
+    Stroker(const StrokeStyle& style, float pixelScale, Emit& emit) : m_style(style), m_emit(emit)
+    {
+        m_style.miterLimit = std::max(m_style.miterLimit, 1.0f);
+        const float radius = m_style.halfWidth * pixelScale;
+        // Largest angle whose chord stays within ARC_TOLERANCE pixels of the true arc.
+        m_arcStep = radius > ARC_TOLERANCE ? 2.0f * std::acos(1.0f - ARC_TOLERANCE / radius) : PI;
+    }
+
+    void stroke(const sp_vec2_t* points, size_t count, bool closed)
+    {
+        // sp_path_close repeats the first point; the closing segment is implied here.
+        if (closed)
+            while (count > 1 && same(points[count - 1], points[0])) --count;
+        const size_t second = next(points, count, 0);
+        if (second == count) {
+            if (count > 0) dot(toVec(points[0]));
+            return;
+        }
+        if (next(points, count, second) == count) closed = false;
+
+        const glm::vec2 first = toVec(points[0]);
+        glm::vec2 p = toVec(points[second]), dIn = p - first;
+        float lenIn = glm::length(dIn);
+        dIn /= lenIn;
+        Edge start, closing;
+        if (closed) {
+            // Join the closing segment onto the first one up front; its incoming edge ends the path.
+            glm::vec2 dLast = first - toVec(points[count - 1]);
+            const float lenLast = glm::length(dLast);
+            join(first, dLast / lenLast, dIn, lenLast, lenIn, closing, start);
+        } else {
+            start = cap(first, -dIn, true);
+        }
+        for (size_t i = second;;) {
+            const size_t j = next(points, count, i);
+            if (j == count && !closed) break;
+            const glm::vec2 target = j < count ? toVec(points[j]) : first;
+            glm::vec2 dOut = target - p;
+            const float lenOut = glm::length(dOut);
+            dOut /= lenOut;
+            Edge in, out;
+            join(p, dIn, dOut, lenIn, lenOut, in, out);
+            quad(start.left, in.left, in.right, start.right);
+            start = out;
+            if (j == count) {
+                quad(start.left, closing.left, closing.right, start.right);
+                return;
+            }
+            p = target; dIn = dOut; lenIn = lenOut; i = j;
+        }
+        const Edge end = cap(p, dIn, false);
+        quad(start.left, end.left, end.right, start.right);
+    }
+
+private:
+    static constexpr float PI = 3.14159265358979f;
+    static constexpr float ARC_TOLERANCE = 0.25f;
+    static constexpr int MAX_ARC_SEGMENTS = 128;
+
+    // The two corners where a segment starts or ends: left is along +normal, (-d.y, d.x).
+    struct Edge {
+        glm::vec2 left, right;
+    };
+
+    static bool same(const sp_vec2_t& a, const sp_vec2_t& b) { return a.x == b.x && a.y == b.y; }
+    static glm::vec2 toVec(const sp_vec2_t& p) { return {p.x, p.y}; }
+    static glm::vec2 normal(glm::vec2 d) { return {-d.y, d.x}; }
+    static glm::vec2 rotate(glm::vec2 v, float c, float s) { return {v.x * c - v.y * s, v.x * s + v.y * c}; }
+    // Next index whose point differs from points[i]; count if there is none.
+    static size_t next(const sp_vec2_t* points, size_t count, size_t i)
+    {
+        size_t j = i + 1;
+        while (j < count && same(points[j], points[i])) ++j;
+        return j;
+    }
+
+    void quad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d) { m_emit(a, b, c, d); }
+
+    int arcSegments(float angle) const
+    {
+        return std::clamp((int)std::ceil(angle / m_arcStep), 1, MAX_ARC_SEGMENTS);
+    }
+
+    // Fan around `center` from `from` (relative to center) through `angle` radians, pivoting on
+    // `pivot`. Two fan triangles go into each quad.
+    void fan(glm::vec2 pivot, glm::vec2 center, glm::vec2 from, float angle, glm::vec2 to)
+    {
+        const int segments = arcSegments(std::abs(angle));
+        const float step = angle / segments, c = std::cos(step), s = std::sin(step);
+        glm::vec2 v = from, a = center + from;
+        for (int k = 0; k < segments; k += 2) {
+            v = rotate(v, c, s);
+            const glm::vec2 b = k + 1 == segments ? center + to : center + v;
+            if (k + 1 == segments) {
+                quad(pivot, a, b, b);
+                return;
+            }
+            v = rotate(v, c, s);
+            const glm::vec2 d = k + 2 == segments ? center + to : center + v;
+            quad(pivot, a, b, d);
+            a = d;
+        }
+    }
+
+    // Cap at p where `outward` points away from the path. Returns the edge the path body
+    // starts (atStart) or ends on.
+    Edge cap(glm::vec2 p, glm::vec2 outward, bool atStart)
+    {
+        const float hw = m_style.halfWidth;
+        // Normal of the path direction, which is -outward at the start and outward at the end.
+        const glm::vec2 n = normal(atStart ? -outward : outward) * hw;
+        const glm::vec2 base = m_style.cap == SP_LINE_CAP_SQUARE ? p + outward * hw : p;
+        if (m_style.cap == SP_LINE_CAP_ROUND) {
+            // Half turn from one side to the other through the outward direction.
+            if (atStart) fan(p, p, n, PI, -n);
+            else fan(p, p, -n, PI, n);
+        }
+        return {base + n, base - n};
+    }
+
+    // Single point: round caps draw a dot, square caps a square, butt caps nothing.
+    void dot(glm::vec2 p)
+    {
+        const float hw = m_style.halfWidth;
+        if (m_style.cap == SP_LINE_CAP_ROUND) {
+            fan(p, p, {hw, 0.0f}, PI, {-hw, 0.0f});
+            fan(p, p, {-hw, 0.0f}, PI, {hw, 0.0f});
+        } else if (m_style.cap == SP_LINE_CAP_SQUARE) {
+            quad(p + glm::vec2(-hw, -hw), p + glm::vec2(hw, -hw), p + glm::vec2(hw, hw), p + glm::vec2(-hw, hw));
+        }
+    }
+
+    // Join at p between unit directions d0 (in) and d1 (out). Writes the edge the incoming
+    // segment ends on and the edge the outgoing one starts on, and emits the outer fill.
+    void join(glm::vec2 p, glm::vec2 d0, glm::vec2 d1, float len0, float len1, Edge& in, Edge& out)
+    {
+        const float hw = m_style.halfWidth;
+        const glm::vec2 n0 = normal(d0), n1 = normal(d1);
+        const float cross = d0.x * d1.y - d0.y * d1.x, cosTurn = glm::dot(d0, d1);
+        if (std::abs(cross) < 1e-6f && cosTurn > 0.0f) {
+            in = out = {p + n0 * hw, p - n0 * hw};
+            return;
+        }
+        // Outer side of the turn, as a sign on the left normal.
+        const float side = cross > 0.0f ? -1.0f : 1.0f;
+        const glm::vec2 m = n0 + n1;
+        const float m2 = glm::dot(m, m);
+        // Reaches the offset lines' intersection: |miter| = hw / cos(half the turn).
+        const glm::vec2 miter = m2 > 1e-12f ? m * (2.0f * hw / m2) : glm::vec2(0.0f);
+        const float along = std::abs(glm::dot(miter, d0));
+        const bool innerMeets = m2 > 1e-12f && along <= std::min(len0, len1);
+        const glm::vec2 innerIn = innerMeets ? p - side * miter : p - side * n0 * hw;
+        const glm::vec2 innerOut = innerMeets ? p - side * miter : p - side * n1 * hw;
+        const glm::vec2 pivot = innerMeets ? innerIn : p;
+        auto edge = [side](glm::vec2 outer, glm::vec2 inner) { return side > 0.0f ? Edge{outer, inner} : Edge{inner, outer}; };
+
+        // 1/cos(half turn) is the SVG miter ratio: miter length over stroke width.
+        const float ratio = m2 > 1e-12f ? 2.0f / std::sqrt(m2) : INFINITY;
+        if (m_style.join == SP_LINE_JOIN_MITER && ratio <= m_style.miterLimit) {
+            const glm::vec2 outer = p + side * miter;
+            in = edge(outer, innerIn);
+            out = edge(outer, innerOut);
+            if (!innerMeets) quad(outer, innerIn, p, innerOut);
+            return;
+        }
+        const glm::vec2 outer0 = p + side * n0 * hw, outer1 = p + side * n1 * hw;
+        in = edge(outer0, innerIn);
+        out = edge(outer1, innerOut);
+        if (m_style.join == SP_LINE_JOIN_ROUND) {
+            const float turn = std::acos(std::clamp(cosTurn, -1.0f, 1.0f));
+            fan(pivot, p, outer0 - p, cross < 0.0f ? -turn : turn, outer1 - p);
+        } else {
+            quad(pivot, outer0, outer1, outer1);
+        }
+    }
+
+    StrokeStyle m_style;
+    Emit& m_emit;
+    float m_arcStep;
+};
+
+}
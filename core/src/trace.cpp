@@ -0,0 +1,149 @@
+#include "trace.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace spiro::internal {
+
+namespace {
+
+// About 100 MB of events; anything past this is counted but not kept.
+constexpr size_t MAX_EVENTS = 1 << 20;
+
+struct TraceEvent {
+    const char* name;
+    char phase;
+    uint32_t thread;
+    double timestampUs, durationUs;
+    std::vector<std::pair<const char*, double>> args;
+};
+
+struct Trace {
+    std::mutex mutex;
+    std::atomic<bool> open{false};
+    std::ofstream file;
+    TraceClock::time_point epoch;
+    std::vector<TraceEvent> events;
+    size_t dropped = 0;
+};
+
+Trace& trace()
+{
+    static Trace instance;
+    return instance;
+}
+
+// Small stable ids read better in trace viewers than hashed std::thread::ids.
+uint32_t threadId()
+{
+    static std::atomic<uint32_t> next{1};
+    thread_local const uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+double microsecondsSince(TraceClock::time_point epoch, TraceClock::time_point t)
+{
+    return std::chrono::duration<double, std::micro>(t - epoch).count();
+}
+
+// Timestamps are taken relative to the epoch under the lock, so a trace restarting on another
+// thread cannot skew them.
+void record(const char* name, char phase, TraceClock::time_point start, TraceClock::time_point end,
+            std::vector<std::pair<const char*, double>> args)
+{
+    const uint32_t thread = threadId();
+    Trace& t = trace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (!t.open.load(std::memory_order_relaxed)) return;
+    if (t.events.size() >= MAX_EVENTS) {
+        ++t.dropped;
+        return;
+    }
+    t.events.push_back({name, phase, thread, microsecondsSince(t.epoch, start), microsecondsSince(start, end), std::move(args)});
+}
+
+}
+
+double millisecondsBetween(TraceClock::time_point start, TraceClock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool traceBegin(const char* path)
+{
+    if (!path) return false;
+    Trace& t = trace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (t.open.load(std::memory_order_relaxed)) return false;
+    t.file.open(path, std::ios::out | std::ios::trunc);
+    if (!t.file) {
+        t.file.clear();
+        return false;
+    }
+    t.epoch = TraceClock::now();
+    t.events.clear();
+    t.dropped = 0;
+    t.open.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool traceEnd()
+{
+    Trace& t = trace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (!t.open.load(std::memory_order_relaxed)) return false;
+    t.open.store(false, std::memory_order_relaxed);
+
+    std::ofstream& out = t.file;
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    for (size_t i = 0; i < t.events.size(); ++i) {
+        const TraceEvent& e = t.events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":\"" << e.name << "\",\"cat\":\"spiro\",\"ph\":\"" << e.phase
+            << "\",\"pid\":1,\"tid\":" << e.thread << ",\"ts\":" << e.timestampUs;
+        if (e.phase == 'X') out << ",\"dur\":" << e.durationUs;
+        if (!e.args.empty()) {
+            out << ",\"args\":{";
+            for (size_t k = 0; k < e.args.size(); ++k)
+                out << (k ? "," : "") << '"' << e.args[k].first << "\":" << e.args[k].second;
+            out << '}';
+        }
+        out << '}';
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << t.dropped << "}}\n";
+    const bool written = out.good();
+    out.close();
+    t.events.clear();
+    t.events.shrink_to_fit();
+    return written;
+}
+
+bool tracing()
+{
+    return trace().open.load(std::memory_order_relaxed);
+}
+
+void traceComplete(const char* name, TraceClock::time_point start, TraceClock::time_point end)
+{
+    if (!tracing()) return;
+    record(name, 'X', start, end, {});
+}
+
+void traceCounter(const char* name, std::initializer_list<std::pair<const char*, double>> values)
+{
+    if (!tracing()) return;
+    const TraceClock::time_point now = TraceClock::now();
+    record(name, 'C', now, now, values);
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    const TraceClock::time_point end = TraceClock::now();
+    if (m_totalMs) *m_totalMs += millisecondsBetween(m_start, end);
+    traceComplete(m_name, m_start, end);
+}
+
+}
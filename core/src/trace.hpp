@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <initializer_list>
+#include <utility>
+
+namespace spiro::internal {
+
+using TraceClock = std::chrono::steady_clock;
+
+double millisecondsBetween(TraceClock::time_point start, TraceClock::time_point end);
+
+// Chrome trace-event recorder, viewable in chrome://tracing or Perfetto. While a trace is
+// open, scoped timers record complete ("X") events and the renderer adds per-frame counter
+// ("C") events; traceEnd() writes them all as one JSON file. Recording is thread-safe and
+// costs one relaxed atomic load when no trace is open. Names must outlive the trace, which
+// in practice means string literals.
+bool traceBegin(const char* path);
+bool traceEnd();
+bool tracing();
+void traceComplete(const char* name, TraceClock::time_point start, TraceClock::time_point end);
+void traceCounter(const char* name, std::initializer_list<std::pair<const char*, double>> values);
+
+// Times its own scope: adds the duration to *totalMs when given and records it while tracing.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name, double* totalMs = nullptr)
+        : m_name(name), m_totalMs(totalMs), m_start(TraceClock::now()) {}
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    TraceClock::time_point start() const { return m_start; }
+
+private:
+    const char* m_name;
+    double* m_totalMs;
+    TraceClock::time_point m_start;
+};
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace spiro::internal {
+
+constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+// Decodes the code point at `p` and advances past it; `*p` must not be the terminating NUL.
+// Malformed, overlong, surrogate and out-of-range sequences decode to U+FFFD and consume a
+// single byte, so decoding resynchronizes on the next lead byte.
+inline uint32_t decodeUtf8(const char*& p)
+{
+    const auto* s = reinterpret_cast<const unsigned char*>(p);
+    if (s[0] < 0x80) {
+        ++p;
+        return s[0];
+    }
+    int length;
+    uint32_t codepoint, minimum;
+    if ((s[0] & 0xE0) == 0xC0) length = 2, codepoint = s[0] & 0x1F, minimum = 0x80;
+    else if ((s[0] & 0xF0) == 0xE0) length = 3, codepoint = s[0] & 0x0F, minimum = 0x800;
+    else if ((s[0] & 0xF8) == 0xF0) length = 4, codepoint = s[0] & 0x07, minimum = 0x10000;
+    else {
+        ++p;
+        return REPLACEMENT_CHARACTER;
+    }
+    // A NUL fails the continuation check, so truncated input never reads past the terminator.
+    for (int i = 1; i < length; ++i) {
+        if ((s[i] & 0xC0) != 0x80) {
+            ++p;
+            return REPLACEMENT_CHARACTER;
+        }
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
+    }
+    if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+        ++p;
+        return REPLACEMENT_CHARACTER;
+    }
+    p += length;
+    return codepoint;
+}
+
+}
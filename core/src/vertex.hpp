@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace spiro::internal {
+
+// Packed batch vertex: 20 bytes instead of the 36 of an all-float layout. Color is RGBA8
+// normalized, texcoords are unorm16 and the texture slot is a small integer, where
+// NO_TEXTURE_SLOT marks untextured geometry. texMode says how the sampled texel is used.
+struct Vertex {
+    glm::vec2 position;
+    uint32_t color;
+    uint16_t texCoord[2];
+    uint8_t texSlot;
+    uint8_t texMode;
+    uint8_t padding[2];
+};
+static_assert(sizeof(Vertex) == 20, "Vertex must stay tightly packed");
+
+constexpr uint8_t NO_TEXTURE_SLOT = 0xFF;
+// Red is coverage as-is (images, bitmaps).
+constexpr uint8_t TEXTURE_MODE_ALPHA = 0;
+// Red is a signed distance field with the outline at 0.5 (glyph atlas).
+constexpr uint8_t TEXTURE_MODE_SDF = 1;
+// The texel is a straight-alpha RGBA color, tinted by the vertex color (images).
+constexpr uint8_t TEXTURE_MODE_RGBA = 2;
+constexpr size_t VERTICES_PER_QUAD = 4;
+constexpr size_t INDICES_PER_QUAD = 6;
+
+inline uint8_t packUnorm8(float v)
+{
+    return (uint8_t)(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+inline uint16_t packUnorm16(float v)
+{
+    return (uint16_t)(std::clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+inline uint32_t packColor(float r, float g, float b, float a)
+{
+    return (uint32_t)packUnorm8(r) | ((uint32_t)packUnorm8(g) << 8) | ((uint32_t)packUnorm8(b) << 16) |
+           ((uint32_t)packUnorm8(a) << 24);
+}
+
+inline Vertex makeVertex(glm::vec2 position, uint32_t color, float u, float v, uint8_t texSlot,
+                         uint8_t texMode = TEXTURE_MODE_ALPHA)
+{
+    return {position, color, {packUnorm16(u), packUnorm16(v)}, texSlot, texMode, {0, 0}};
+}
+
+// Two triangles per quad over vertices (0,1,2,3): (0,1,2) and (0,2,3).
+template <typename Index>
+void appendQuadIndices(Index* out, size_t firstQuad, size_t quadCount)
+{
+    for (size_t q = firstQuad; q < firstQuad + quadCount; ++q) {
+        Index base = (Index)(q * VERTICES_PER_QUAD);
+        *out++ = base; *out++ = base + 1; *out++ = base + 2;
+        *out++ = base; *out++ = base + 2; *out++ = base + 3;
+    }
+}
+
+}
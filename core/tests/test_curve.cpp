@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "curve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+sp_vec2_t cubicAt(sp_vec2_t p0, sp_vec2_t c1, sp_vec2_t c2, sp_vec2_t p3, float t)
+{
+    const float u = 1.0f - t;
+    const float w0 = u * u * u, w1 = 3 * u * u * t, w2 = 3 * u * t * t, w3 = t * t * t;
+    return {w0 * p0.x + w1 * c1.x + w2 * c2.x + w3 * p3.x, w0 * p0.y + w1 * c1.y + w2 * c2.y + w3 * p3.y};
+}
+
+float distanceToSegment(sp_vec2_t p, sp_vec2_t a, sp_vec2_t b)
+{
+    const float dx = b.x - a.x, dy = b.y - a.y, length2 = dx * dx + dy * dy;
+    const float t = length2 > 0.0f ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / length2, 0.0f, 1.0f) : 0.0f;
+    return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+
+float distanceToPolyline(sp_vec2_t p, const std::vector<sp_vec2_t>& line)
+{
+    float best = INFINITY;
+    for (size_t i = 1; i < line.size(); ++i) best = std::min(best, distanceToSegment(p, line[i - 1], line[i]));
+    return best;
+}
+
+const sp_vec2_t P0 = {0, 0}, C1 = {30, 80}, C2 = {90, -60}, P3 = {120, 20};
+
+}
+
+TEST(SpirocoreCurveTest, CubicsStayWithinTheToleranceAtEveryScale) {
+    size_t previous = 0;
+    for (float scale : {0.25f, 1.0f, 4.0f, 16.0f}) {
+        const size_t segments = cubicSegments(P0, C1, C2, P3, scale, CURVE_TOLERANCE);
+        EXPECT_GE(segments, previous);
+        previous = segments;
+        std::vector<sp_vec2_t> line = {P0};
+        flattenCubic(P0, C1, C2, P3, segments, line);
+        ASSERT_EQ(line.size(), segments);
+        line.push_back(P3);
+        for (int i = 0; i <= 1000; ++i)
+            ASSERT_LE(distanceToPolyline(cubicAt(P0, C1, C2, P3, i / 1000.0f), line) * scale, CURVE_TOLERANCE) << "scale " << scale;
+    }
+    // Wang's bound grows with the square root of the zoom.
+    const size_t near = cubicSegments(P0, C1, C2, P3, 16.0f, CURVE_TOLERANCE), far = cubicSegments(P0, C1, C2, P3, 1.0f, CURVE_TOLERANCE);
+    EXPECT_NEAR((double)near / far, 4.0, 0.5);
+    EXPECT_EQ(cubicSegments(P0, {40, 0}, {80, 0}, P3, 1.0f, CURVE_TOLERANCE) < far, true);
+    EXPECT_EQ(cubicSegments(P0, C1, C2, P3, 1e9f, CURVE_TOLERANCE), MAX_CURVE_SEGMENTS);
+}
+
+TEST(SpirocoreCurveTest, ForwardDifferencingMatchesDirectEvaluation) {
+    std::vector<sp_vec2_t> line;
+    const size_t segments = 5000;
+    flattenCubic(P0, C1, C2, P3, segments, line);
+    ASSERT_EQ(line.size(), segments - 1);
+    for (size_t i = 0; i < line.size(); i += 37) {
+        const sp_vec2_t expected = cubicAt(P0, C1, C2, P3, (float)(i + 1) / segments);
+        ASSERT_NEAR(line[i].x, expected.x, 1e-3f);
+        ASSERT_NEAR(line[i].y, expected.y, 1e-3f);
+    }
+}
+
+TEST(SpirocoreCurveTest, ArcsStepEvenlyAroundTheCenter) {
+    const sp_vec2_t center = {10, 10}, start = {60, 10};
+    const float sweep = 1.5f;
+    const size_t far = arcSegments(50.0f, sweep, 1.0f, CURVE_TOLERANCE), near = arcSegments(50.0f, sweep, 100.0f, CURVE_TOLERANCE);
+    EXPECT_GT(near, far * 8);
+    EXPECT_EQ(arcSegments(50.0f, sweep, 0.001f, CURVE_TOLERANCE), 1u);
+    std::vector<sp_vec2_t> line;
+    flattenArc(start, center, sweep, far, line);
+    ASSERT_EQ(line.size(), far - 1);
+    for (size_t i = 0; i < line.size(); ++i) {
+        ASSERT_NEAR(std::hypot(line[i].x - center.x, line[i].y - center.y), 50.0f, 1e-3f);
+        ASSERT_NEAR(std::atan2(line[i].y - center.y, line[i].x - center.x), sweep * (i + 1) / far, 1e-4f);
+    }
+    // The chord's midpoint is the farthest from the circle.
+    const sp_vec2_t a = line[0], b = line[1], mid = {(a.x + b.x) / 2, (a.y + b.y) / 2};
+    EXPECT_LE(50.0f - std::hypot(mid.x - center.x, mid.y - center.y), CURVE_TOLERANCE);
+}
+
+TEST(SpirocoreCurveTest, PathsFlattenEachCurveBetweenItsPoints) {
+    const std::vector<sp_vec2_t> points = {P0, P3, {120, 100}, {20, 100}};
+    std::vector<PathCurve> curves = {
+        {PathCurve::Kind::Cubic, 1, C1, C2, 0.0f, 0.0f},
+        {PathCurve::Kind::Arc, 3, {70, 100}, {0, 0}, 50.0f, 3.14159265f},
+    };
+    std::vector<sp_vec2_t> out;
+    flattenPath(points.data(), points.size(), curves.data(), curves.size(), 1.0f, CURVE_TOLERANCE, out);
+    const size_t cubic = cubicSegments(P0, C1, C2, P3, 1.0f, CURVE_TOLERANCE), arc = arcSegments(50.0f, 3.14159265f, 1.0f, CURVE_TOLERANCE);
+    ASSERT_EQ(out.size(), points.size() + cubic - 1 + arc - 1);
+    EXPECT_EQ(out.front().x, P0.x);
+    EXPECT_EQ(out[cubic].x, P3.x);
+    EXPECT_EQ(out[cubic + 1].x, 120.0f);
+    EXPECT_EQ(out.back().x, 20.0f);
+    // The half turn runs clockwise on screen from (120, 100), so through (70, 150).
+    bool throughBottom = false;
+    for (size_t i = cubic + 2; i + 1 < out.size(); ++i) throughBottom = throughBottom || std::hypot(out[i].x - 70, out[i].y - 150) < 1.0f;
+    EXPECT_TRUE(throughBottom);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <spirographicals/spirographicals.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <dlfcn.h>
+#include <vector>
+
+// This file builds into its own executable (core-alloc-tests) that replaces the C allocator,
+// so every malloc in the process, from operator new, the library or the GL driver, passes
+// through here. Tests count the calls made while g_counting is set. glibc's allocator stays
+// underneath, which keeps memory from aligned allocations freeable here as well.
+//
+// The GL driver's own bookkeeping is not ours to remove (Mesa allocates a few dozen blocks
+// per frame), so calls made directly from GL libraries are counted apart.
+static std::atomic<bool> g_counting{false};
+static std::atomic<size_t> g_allocations{0}, g_driverAllocations{0};
+
+static bool calledFromGLDriver(void* caller)
+{
+    Dl_info info;
+    if (!dladdr(caller, &info) || !info.dli_fname) return false;
+    const char* slash = std::strrchr(info.dli_fname, '/');
+    const char* name = slash ? slash + 1 : info.dli_fname;
+    return std::strstr(name, "_dri") || std::strncmp(name, "libGL", 5) == 0 || std::strncmp(name, "libEGL", 6) == 0 ||
+           std::strncmp(name, "libgallium", 10) == 0 || std::strncmp(name, "libglapi", 8) == 0;
+}
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+
+static void countAllocation(void* caller)
+{
+    if (!g_counting.load(std::memory_order_relaxed)) return;
+    (calledFromGLDriver(caller) ? g_driverAllocations : g_allocations).fetch_add(1, std::memory_order_relaxed);
+}
+
+#define SPIRO_CALLER __builtin_return_address(0)
+void* malloc(size_t size) { countAllocation(SPIRO_CALLER); return __libc_malloc(size); }
+void* calloc(size_t count, size_t size) { countAllocation(SPIRO_CALLER); return __libc_calloc(count, size); }
+void* realloc(void* p, size_t size) { countAllocation(SPIRO_CALLER); return __libc_realloc(p, size); }
+void* aligned_alloc(size_t alignment, size_t size) { countAllocation(SPIRO_CALLER); return __libc_memalign(alignment, size); }
+int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1))) return EINVAL;
+    countAllocation(SPIRO_CALLER);
+    void* p = __libc_memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+void free(void* p) { __libc_free(p); }
+}
+
+namespace {
+
+// What a figure redraw does: a transient path and pen per artist, saved and restored state.
+void drawFigure(sp_canvas_t* canvas, const std::vector<float>& xy, int frame) {
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    for (int artist = 0; artist < 8; ++artist) {
+        sp_save_state(canvas);
+        sp_translate(canvas, 0.0f, 4.0f * artist);
+        sp_path_t* path = sp_create_frame_path(canvas);
+        sp_path_reserve(path, xy.size() / 2);
+        sp_path_move_to(path, xy[0], xy[1]);
+        for (size_t i = 2; i < xy.size(); i += 2) sp_path_line_to(path, xy[i], xy[i + 1] + (float)(frame % 3));
+        sp_pen_config_t config = {artist % 2 ? 3.0f : 1.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_ROUND, 10.0f};
+        sp_set_pen(canvas, sp_create_frame_pen(canvas, &config));
+        sp_set_color(canvas, {0.1f * artist, 0.2f, 0.8f, 1.0f});
+        sp_stroke_path(canvas, path);
+        sp_fill_rect(canvas, 2.0f * artist, 2.0f, 2.0f, 2.0f);
+        sp_restore_state(canvas);
+    }
+    sp_end_frame(canvas);
+}
+
+void expectSteadyStateFramesDoNotAllocate(sp_canvas_t* canvas) {
+    std::vector<float> xy;
+    for (int i = 0; i < 200; ++i) { xy.push_back(i * 1.25f); xy.push_back(20.0f + 10.0f * std::sin(i * 0.1f)); }
+    // The first frames grow the pools, batches, tile bins and GPU timer ring to what the scene
+    // needs (and let the GL driver compile its shader variants).
+    for (int frame = 0; frame < 12; ++frame) drawFigure(canvas, xy, frame);
+
+    g_allocations = 0;
+    g_driverAllocations = 0;
+    g_counting = true;
+    for (int frame = 12; frame < 20; ++frame) drawFigure(canvas, xy, frame);
+    g_counting = false;
+    EXPECT_EQ(g_allocations.load(), 0u) << "(another " << g_driverAllocations.load() << " came from the GL driver)";
+}
+
+}
+
+TEST(SpirocoreFramePoolTest, FrameObjectsAreRecycledNotDestroyed) {
+    sp_software_config_t config = {64, 32, nullptr, 0, 1};
+    sp_canvas_t* canvas = sp_create_software_canvas(&config);
+    ASSERT_NE(canvas, nullptr);
+    sp_begin_frame(canvas);
+    sp_path_t* path = sp_create_frame_path(canvas);
+    sp_path_move_to(path, 1.0f, 2.0f);
+    sp_path_line_to(path, 3.0f, 4.0f);
+    sp_pen_config_t penConfig = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_frame_pen(canvas, &penConfig);
+    // Callers never free frame objects; destroying one anyway leaves it with the pool.
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+    sp_end_frame(canvas);
+    sp_begin_frame(canvas);
+    EXPECT_EQ(sp_create_frame_path(canvas), path);
+    EXPECT_EQ(sp_create_frame_pen(canvas, &penConfig), pen);
+    EXPECT_NE(sp_create_frame_path(canvas), path);
+    sp_end_frame(canvas);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreFramePoolTest, SteadyStateFramesDoNotAllocate) {
+    sp_software_config_t config = {256, 64, nullptr, 0, 2};
+    sp_canvas_t* canvas = sp_create_software_canvas(&config);
+    ASSERT_NE(canvas, nullptr);
+    expectSteadyStateFramesDoNotAllocate(canvas);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreFramePoolTest, SteadyStateGlFramesDoNotAllocate) {
+    sp_initialize();
+    sp_offscreen_config_t config = {256, 64, 1};
+    sp_canvas_t* canvas = sp_create_offscreen_canvas(&config);
+    if (!canvas) {
+        sp_terminate();
+        GTEST_SKIP() << "No headless GL context (EGL or hidden window) available.";
+    }
+    expectSteadyStateFramesDoNotAllocate(canvas);
+    sp_destroy_canvas(canvas);
+    sp_terminate();
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "lod.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+std::vector<sp_vec2_t> randomWalk(size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> step(0.0f, 1.0f);
+    std::vector<sp_vec2_t> points(count);
+    float y = 0.0f;
+    for (size_t i = 0; i < count; ++i) points[i] = {(float)i * 0.5f, y += step(rng)};
+    return points;
+}
+
+}
+
+TEST(SpirocoreLodTest, RejectsSeriesWhoseXGoesBackwards) {
+    auto points = randomWalk(10000, 1);
+    EXPECT_NE(LodPyramid::build(points.data(), points.size()), nullptr);
+    std::swap(points[500], points[501]);
+    EXPECT_EQ(LodPyramid::build(points.data(), points.size()), nullptr);
+}
+
+TEST(SpirocoreLodTest, KeepsEveryColumnsExtremaWithFourPointsPerColumn) {
+    auto points = randomWalk(200000, 2);
+    auto lod = LodPyramid::build(points.data(), points.size());
+    ASSERT_NE(lod, nullptr);
+    // Zoomed to samples 30000..70000 (x 15000..35000) across 400 columns.
+    const int columns = 400;
+    const float scale = columns / 20000.0f, offset = -15000.0f * scale;
+    std::vector<sp_vec2_t> out;
+    lod->decimate(points.data(), points.size(), scale, offset, columns, out);
+    ASSERT_LE(out.size(), (size_t)columns * 4 + 2);
+    ASSERT_GT(out.size(), (size_t)columns);
+    for (size_t i = 1; i < out.size(); ++i) ASSERT_LE(out[i - 1].x, out[i].x);
+    // One neighbour outside the viewport on each side keeps the edge segments.
+    EXPECT_LT(out.front().x, 15000.0f);
+    EXPECT_GT(out.back().x, 35000.0f);
+
+    for (int c = 0; c < columns; ++c) {
+        auto inColumn = [&](const sp_vec2_t& p) { return std::floor(p.x * scale + offset) == (float)c; };
+        float lo = INFINITY, hi = -INFINITY, outLo = INFINITY, outHi = -INFINITY;
+        for (const auto& p : points) if (inColumn(p)) lo = std::min(lo, p.y), hi = std::max(hi, p.y);
+        for (const auto& p : out) if (inColumn(p)) outLo = std::min(outLo, p.y), outHi = std::max(outHi, p.y);
+        ASSERT_EQ(lo, outLo) << "column " << c;
+        ASSERT_EQ(hi, outHi) << "column " << c;
+    }
+}
+
+TEST(SpirocoreLodTest, SparseViewReturnsTheVisibleSamplesUnchanged) {
+    auto points = randomWalk(100000, 3);
+    auto lod = LodPyramid::build(points.data(), points.size());
+    std::vector<sp_vec2_t> out;
+    // 800 columns over x 1000..1100 show only ~200 samples.
+    lod->decimate(points.data(), points.size(), 8.0f, -8000.0f, 800, out);
+    ASSERT_EQ(out.size(), 203u);
+    EXPECT_EQ(out.front().x, points[1999].x);
+    EXPECT_EQ(out.back().x, points[2201].x);
+}
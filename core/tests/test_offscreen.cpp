@@ -0,0 +1,1242 @@
+#include <gtest/gtest.h>
+#include <spirographicals/spirographicals.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class SpirocoreOffscreenTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sp_initialize();
+        sp_offscreen_config_t config = {64, 32, 2};
+        canvas = sp_create_offscreen_canvas(&config);
+        if (!canvas) {
+            sp_terminate();
+            GTEST_SKIP() << "No headless GL context (EGL or hidden window) available.";
+        }
+    }
+    void TearDown() override {
+        if (canvas) {
+            sp_destroy_canvas(canvas);
+            sp_terminate();
+        }
+    }
+    void drawFrame(sp_color_rgba_t background) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, background);
+        sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+        sp_fill_rect(canvas, 0, 0, 16, 8);
+        sp_end_frame(canvas);
+    }
+    static const uint8_t* pixel(const std::vector<uint8_t>& rgba, int x, int y) { return &rgba[(y * 64 + x) * 4]; }
+
+    sp_canvas_t* canvas = nullptr;
+};
+
+TEST(SpirocoreOffscreenAPITest, NullCanvasIsHandledGracefully) {
+    uint8_t pixel[4];
+    ASSERT_EQ(sp_create_offscreen_canvas(nullptr), nullptr);
+    ASSERT_FALSE(sp_canvas_is_offscreen(nullptr));
+    ASSERT_FALSE(sp_read_pixels(nullptr, pixel, sizeof(pixel)));
+    ASSERT_EQ(sp_request_readback(nullptr), 0u);
+    ASSERT_EQ(sp_poll_readback(nullptr, 1), SP_READBACK_INVALID);
+    ASSERT_FALSE(sp_fetch_readback(nullptr, 1, pixel, sizeof(pixel)));
+    ASSERT_FALSE(sp_save_png(nullptr, "unused.png"));
+}
+
+TEST_F(SpirocoreOffscreenTest, ReportsSizeAndNeverCloses) {
+    ASSERT_TRUE(sp_canvas_is_offscreen(canvas));
+    ASSERT_FALSE(sp_canvas_should_close(canvas));
+    sp_vec2_t size = sp_get_canvas_size(canvas);
+    ASSERT_EQ(size.x, 64.0f);
+    ASSERT_EQ(size.y, 32.0f);
+}
+
+TEST_F(SpirocoreOffscreenTest, ReadPixelsReturnsTopDownRows) {
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_FALSE(sp_read_pixels(canvas, rgba.data(), rgba.size() - 1));
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 2, 2)[1], 255);
+    EXPECT_EQ(pixel(rgba, 2, 2)[0], 0);
+    EXPECT_EQ(pixel(rgba, 40, 20)[0], 255);
+    EXPECT_EQ(pixel(rgba, 40, 20)[1], 0);
+}
+
+TEST_F(SpirocoreOffscreenTest, AsyncReadbackRingAppliesBackpressure) {
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    uint64_t first = sp_request_readback(canvas);
+    drawFrame({0.0f, 0.0f, 1.0f, 1.0f});
+    uint64_t second = sp_request_readback(canvas);
+    ASSERT_NE(first, 0u);
+    ASSERT_NE(second, 0u);
+    ASSERT_EQ(sp_request_readback(canvas), 0u);
+
+    ASSERT_NE(sp_poll_readback(canvas, first), SP_READBACK_INVALID);
+    ASSERT_TRUE(sp_fetch_readback(canvas, first, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 40, 20)[0], 255);
+    ASSERT_EQ(sp_poll_readback(canvas, first), SP_READBACK_INVALID);
+    ASSERT_FALSE(sp_fetch_readback(canvas, first, rgba.data(), rgba.size()));
+
+    ASSERT_TRUE(sp_fetch_readback(canvas, second, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 40, 20)[2], 255);
+    EXPECT_EQ(pixel(rgba, 2, 2)[1], 255);
+}
+
+TEST_F(SpirocoreOffscreenTest, SavePngWritesSignature) {
+    drawFrame({0.2f, 0.2f, 0.2f, 1.0f});
+    const char* path = "spiro_offscreen_test.png";
+    ASSERT_TRUE(sp_save_png(canvas, path));
+    std::ifstream file(path, std::ios::binary);
+    char signature[8] = {};
+    file.read(signature, sizeof(signature));
+    EXPECT_EQ(std::string(signature + 1, 3), "PNG");
+    file.close();
+    std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, RetainedMeshRedrawsUnderCurrentTransform) {
+    ASSERT_TRUE(sp_begin_mesh(canvas));
+    ASSERT_FALSE(sp_begin_mesh(canvas));
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 0, 0, 16, 8);
+    sp_mesh_t* mesh = sp_end_mesh(canvas);
+    ASSERT_NE(mesh, nullptr);
+    ASSERT_EQ(sp_mesh_vertex_count(mesh), 4u);
+    ASSERT_EQ(sp_end_mesh(canvas), nullptr);
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    for (int frame = 0; frame < 2; ++frame) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 0.0f, 0.0f, 1.0f});
+        sp_save_state(canvas);
+        sp_translate(canvas, 32.0f * frame, 16.0f * frame);
+        sp_draw_mesh(canvas, mesh);
+        sp_restore_state(canvas);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+        EXPECT_EQ(pixel(rgba, 2 + 32 * frame, 2 + 16 * frame)[1], 255);
+        EXPECT_EQ(pixel(rgba, 2 + 32 * (1 - frame), 2 + 16 * (1 - frame))[0], 255);
+    }
+    sp_destroy_mesh(mesh);
+}
+
+TEST_F(SpirocoreOffscreenTest, CapturedLargeSeriesIsDecimatedWhenDrawn) {
+    // As the Python show() path does it: each line captured into a mesh before the first frame,
+    // from a frame path borrowing the caller's samples, then only the mesh is drawn.
+    const size_t count = 200000;
+    std::vector<float> xy(count * 2);
+    for (size_t i = 0; i < count; ++i) { xy[2 * i] = 64.0f * i / count; xy[2 * i + 1] = 16.0f + 12.0f * std::sin(0.01f * i); }
+    sp_pen_config_t penConfig = {1.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_ROUND, 10.0f};
+    ASSERT_TRUE(sp_begin_mesh(canvas));
+    sp_path_t* framePath = sp_create_frame_path(canvas);
+    sp_path_set_points(framePath, xy.data(), count, 2 * sizeof(float));
+    sp_set_pen(canvas, sp_create_frame_pen(canvas, &penConfig));
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    sp_stroke_path(canvas, framePath);
+    sp_mesh_t* mesh = sp_end_mesh(canvas);
+    ASSERT_NE(mesh, nullptr);
+
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_set_points(path, xy.data(), count, 2 * sizeof(float));
+    sp_pen_t* pen = sp_create_pen(canvas, &penConfig);
+    std::vector<uint8_t> drawn(64 * 32 * 4), reference(64 * 32 * 4);
+    // The view changes between frames: the mesh is decimated again for each zoom.
+    for (float zoom : {1.0f, 4.0f, 0.5f}) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_save_state(canvas);
+        sp_scale(canvas, zoom, 1.0f);
+        sp_draw_mesh(canvas, mesh);
+        sp_restore_state(canvas);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, drawn.data(), drawn.size()));
+        sp_frame_stats_t stats;
+        ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+        // At most 4 samples per column plus a neighbour each side. Each is one quad as a
+        // hairline, a few more with round joins once the zoom widens the pen past a pixel;
+        // all 200000 samples would be 800000 vertices.
+        EXPECT_GT(stats.vertices, 0u) << zoom;
+        EXPECT_LE(stats.vertices, (64u * 4u + 2u) * (zoom > 1.0f ? 16u : 4u)) << zoom;
+
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_set_pen(canvas, pen);
+        sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_save_state(canvas);
+        sp_scale(canvas, zoom, 1.0f);
+        sp_stroke_path(canvas, path);
+        sp_restore_state(canvas);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, reference.data(), reference.size()));
+        EXPECT_EQ(drawn, reference) << zoom;
+    }
+    sp_destroy_pen(pen);
+    sp_destroy_path(path);
+    sp_destroy_mesh(mesh);
+}
+
+TEST_F(SpirocoreOffscreenTest, CapturedStrokeKeepsItsSamplesWhenThePathChanges) {
+    // The mesh shares the path's points, so editing or refilling the path must not reach it.
+    const size_t count = 8192;
+    std::vector<float> xy(count * 2);
+    for (size_t i = 0; i < count; ++i) { xy[2 * i] = 64.0f * i / count; xy[2 * i + 1] = 16.0f + 12.0f * std::sin(0.003f * i); }
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_set_points(path, xy.data(), count, 0);
+    sp_pen_config_t penConfig = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &penConfig);
+    sp_set_pen(canvas, pen);
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    ASSERT_TRUE(sp_begin_mesh(canvas));
+    sp_stroke_path(canvas, path);
+    sp_mesh_t* mesh = sp_end_mesh(canvas);
+    ASSERT_NE(mesh, nullptr);
+
+    std::vector<uint8_t> before(64 * 32 * 4), after(64 * 32 * 4);
+    auto drawMesh = [&](std::vector<uint8_t>& out) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_draw_mesh(canvas, mesh);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, out.data(), out.size()));
+    };
+    drawMesh(before);
+    sp_path_line_to(path, 0.0f, 0.0f);
+    drawMesh(after);
+    EXPECT_EQ(before, after);
+    for (size_t i = 0; i < count; ++i) xy[2 * i + 1] = 4.0f;
+    sp_path_set_points(path, xy.data(), count, 2 * sizeof(float));
+    drawMesh(after);
+    EXPECT_EQ(before, after);
+    sp_destroy_pen(pen);
+    sp_destroy_path(path);
+    sp_destroy_mesh(mesh);
+}
+
+TEST_F(SpirocoreOffscreenTest, SeriesUploadsOnlyNewSamplesAndMatchesAPath) {
+    // 16 segments 4 pixels apart fill the canvas width; the view scrolls to keep the newest in view.
+    sp_series_t* series = sp_create_series(canvas, 16);
+    ASSERT_NE(series, nullptr);
+    sp_pen_config_t penConfig = {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &penConfig);
+    sp_set_pen(canvas, pen);
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    std::vector<float> xs, ys;
+    std::vector<uint8_t> streamed(64 * 32 * 4), reference(64 * 32 * 4);
+    for (int frame = 0; frame < 8; ++frame) {
+        const size_t first = xs.size();
+        for (int i = 0; i < 5; ++i) { xs.push_back(4.0f * xs.size()); ys.push_back(16.0f + 10.0f * std::sin(0.7f * ys.size())); }
+        sp_series_append(series, xs.data() + first, ys.data() + first, 5);
+        const size_t window = std::min<size_t>(xs.size(), 17), oldest = xs.size() - window;
+        ASSERT_EQ(sp_series_size(series), window);
+
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_save_state(canvas);
+        sp_translate(canvas, -xs[oldest], 0.0f);
+        sp_draw_series(canvas, series);
+        sp_restore_state(canvas);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, streamed.data(), streamed.size()));
+        sp_frame_stats_t stats;
+        ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+        // After the first frame only the 5 new segments are uploaded.
+        if (frame > 0) {
+            EXPECT_EQ(stats.upload_bytes, 5u * 4u * 20u) << "frame " << frame;
+        }
+        EXPECT_EQ(stats.draw_calls, 1u);
+
+        sp_path_t* path = sp_create_path(canvas);
+        sp_path_move_to(path, xs[oldest], ys[oldest]);
+        for (size_t i = oldest + 1; i < xs.size(); ++i) sp_path_line_to(path, xs[i], ys[i]);
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_save_state(canvas);
+        sp_translate(canvas, -xs[oldest], 0.0f);
+        sp_stroke_path(canvas, path);
+        sp_restore_state(canvas);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, reference.data(), reference.size()));
+        sp_destroy_path(path);
+        ASSERT_EQ(streamed, reference) << "frame " << frame;
+    }
+    sp_series_clear(series);
+    ASSERT_EQ(sp_series_size(series), 0u);
+    sp_destroy_series(series);
+    sp_destroy_pen(pen);
+}
+
+TEST_F(SpirocoreOffscreenTest, CapturedSeriesMatchesTheLiveOneWhenTheRingWraps) {
+    // 40 samples through a 17-sample ring: the window starts mid-ring and wraps to its start.
+    sp_series_t* series = sp_create_series(canvas, 16);
+    ASSERT_NE(series, nullptr);
+    std::vector<float> xs, ys;
+    for (int i = 0; i < 40; ++i) { xs.push_back(4.0f * (i - 23)); ys.push_back(16.0f + 10.0f * std::sin(0.7f * i)); }
+    sp_series_append(series, xs.data(), ys.data(), xs.size());
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    ASSERT_TRUE(sp_begin_mesh(canvas));
+    sp_draw_series(canvas, series);
+    sp_mesh_t* mesh = sp_end_mesh(canvas);
+    ASSERT_NE(mesh, nullptr);
+    EXPECT_EQ(sp_mesh_vertex_count(mesh), 16u * 4u);
+
+    std::vector<uint8_t> live(64 * 32 * 4), captured(64 * 32 * 4);
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_series(canvas, series);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, live.data(), live.size()));
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_mesh(canvas, mesh);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, captured.data(), captured.size()));
+    EXPECT_EQ(captured, live);
+    sp_destroy_mesh(mesh);
+    sp_destroy_series(series);
+}
+
+TEST_F(SpirocoreOffscreenTest, StreamingBatchSurvivesMidFrameFlushesAndWraps) {
+    // Far more quads than one batch holds, over enough frames to cycle the whole stream ring.
+    const int quads = 50000;
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    for (int frame = 0; frame < 4; ++frame) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {1.0f, 0.0f, 0.0f, 1.0f});
+        sp_set_color(canvas, {0.0f, frame % 2 ? 1.0f : 0.0f, frame % 2 ? 0.0f : 1.0f, 1.0f});
+        for (int i = 0; i < quads; ++i) sp_fill_rect(canvas, (float)(i % 64), (float)((i / 64) % 32), 1, 1);
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+        for (int y = 0; y < 32; ++y) {
+            for (int x = 0; x < 64; ++x) {
+                ASSERT_EQ(pixel(rgba, x, y)[0], 0) << "frame " << frame << " at " << x << "," << y;
+                ASSERT_EQ(pixel(rgba, x, y)[frame % 2 ? 1 : 2], 255) << "frame " << frame << " at " << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST_F(SpirocoreOffscreenTest, ThickStrokeFillsTheMiterCorner) {
+    sp_pen_config_t config = {8.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &config);
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_move_to(path, 10, 24);
+    sp_path_line_to(path, 40, 24);
+    sp_path_line_to(path, 40, 4);
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {1.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_pen(canvas, pen);
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_stroke_path(canvas, path);
+    sp_end_frame(canvas);
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    // Disjoint per-segment rectangles leave the outer corner (43, 27) empty.
+    EXPECT_EQ(pixel(rgba, 42, 26)[1], 255);
+    EXPECT_EQ(pixel(rgba, 20, 24)[1], 255);
+    EXPECT_EQ(pixel(rgba, 20, 30)[0], 255);
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+}
+
+TEST_F(SpirocoreOffscreenTest, SetPointsMatchesPerPointPathBuilding) {
+    sp_pen_config_t config = {4.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &config);
+    auto render = [&](sp_path_t* path) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_set_pen(canvas, pen);
+        sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+        sp_stroke_path(canvas, path);
+        sp_end_frame(canvas);
+        std::vector<uint8_t> rgba(64 * 32 * 4);
+        EXPECT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+        return rgba;
+    };
+
+    sp_path_t* reference = sp_create_path(canvas);
+    sp_path_move_to(reference, 4, 4);
+    sp_path_line_to(reference, 30, 28);
+    sp_path_line_to(reference, 60, 6);
+    const std::vector<uint8_t> expected = render(reference);
+
+    // Packed input is borrowed; appending afterwards must keep the borrowed points.
+    const float packed[] = {4, 4, 30, 28};
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_set_points(path, packed, 2, 0);
+    sp_path_line_to(path, 60, 6);
+    EXPECT_EQ(render(path), expected);
+
+    // Rows of {x, y, unused} as from a column slice of a wider array.
+    const float strided[] = {4, 4, -1, 30, 28, -1, 60, 6, -1};
+    sp_path_set_points(path, strided, 3, 3 * sizeof(float));
+    EXPECT_EQ(render(path), expected);
+
+    sp_destroy_path(path);
+    sp_destroy_path(reference);
+    sp_destroy_pen(pen);
+}
+
+TEST_F(SpirocoreOffscreenTest, DrawListsRecordedOnThreadsMatchDirectDrawing) {
+    // Two distinct images, drawn in a different order by alternate panels so that each list's
+    // texture slots have to be renumbered into the shared batch.
+    const char* paths[2] = {"spiro_draw_list_a.png", "spiro_draw_list_b.png"};
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, paths[0]));
+    drawFrame({0.0f, 0.0f, 1.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, paths[1]));
+    sp_image_t* images[2] = {sp_load_image(canvas, paths[0]), sp_load_image(canvas, paths[1])};
+    ASSERT_TRUE(images[0] && images[1]);
+    sp_pen_config_t config = {2.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_ROUND, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &config);
+
+    const int panels = 8;
+    auto drawPanel = [&](int i) {
+        if (i == 0) sp_clear(canvas, {0.1f, 0.1f, 0.1f, 1.0f});
+        sp_translate(canvas, (float)(i * 8), 0.0f);
+        sp_set_color(canvas, {i / 8.0f, 1.0f - i / 8.0f, 0.5f, 1.0f});
+        sp_fill_rect(canvas, 0, 0, 8, 10);
+        sp_draw_image_rect(canvas, images[i % 2], {0, 0, 64, 32}, {0, 12, 8, 4});
+        sp_draw_image_rect(canvas, images[1 - i % 2], {0, 0, 64, 32}, {0, 16, 8, 4});
+        sp_path_t* path = sp_create_path(canvas);
+        sp_path_move_to(path, 1, 22);
+        sp_path_line_to(path, 4, 30);
+        sp_path_line_to(path, 7, 22);
+        sp_set_pen(canvas, pen);
+        sp_stroke_path(canvas, path);
+        sp_destroy_path(path);
+    };
+    auto readBack = [&] {
+        std::vector<uint8_t> rgba(64 * 32 * 4);
+        EXPECT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+        return rgba;
+    };
+
+    sp_begin_frame(canvas);
+    for (int i = 0; i < panels; ++i) {
+        sp_save_state(canvas);
+        drawPanel(i);
+        sp_restore_state(canvas);
+    }
+    sp_end_frame(canvas);
+    const std::vector<uint8_t> expected = readBack();
+
+    std::vector<sp_draw_list_t*> lists;
+    for (int i = 0; i < panels; ++i) lists.push_back(sp_create_draw_list(canvas));
+    sp_begin_frame(canvas);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < panels; ++i) {
+        workers.emplace_back([&, i] {
+            ASSERT_TRUE(sp_begin_draw_list(canvas, lists[i]));
+            EXPECT_FALSE(sp_begin_draw_list(canvas, lists[i]));
+            drawPanel(i);
+            sp_end_draw_list(canvas);
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    sp_submit_draw_lists(canvas, lists.data(), lists.size());
+    sp_end_frame(canvas);
+    EXPECT_EQ(readBack(), expected);
+
+    // Everything fits one batch, so all eight lists go up in a single draw.
+    sp_frame_stats_t stats;
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 1u);
+
+    for (sp_draw_list_t* list : lists) sp_destroy_draw_list(list);
+    sp_destroy_pen(pen);
+    for (sp_image_t* image : images) sp_destroy_image(image);
+    for (const char* path : paths) std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, FrameStatsDescribeTheLastFrame) {
+    sp_frame_stats_t stats;
+    EXPECT_FALSE(sp_get_frame_stats(canvas, &stats));
+    drawFrame({0.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.frame, 1u);
+    EXPECT_EQ(stats.flushes, 1u);
+    EXPECT_EQ(stats.draw_calls, 1u);
+    EXPECT_EQ(stats.vertices, 4u);
+    EXPECT_EQ(stats.upload_bytes, 4u * 20u);
+    EXPECT_EQ(stats.texture_evictions, 0u);
+    EXPECT_GE(stats.cpu_frame_ms, stats.end_frame_ms);
+    EXPECT_TRUE(stats.gpu_ms == -1.0 || stats.gpu_ms >= 0.0);
+
+    // A 17th texture in one batch evicts the other 16 with an extra flush. The images are too
+    // large for the image atlas, so each one keeps a texture of its own.
+    const char* path = "spiro_stats_test.png";
+    sp_offscreen_config_t large = {300, 8, 1};
+    sp_canvas_t* source = sp_create_offscreen_canvas(&large);
+    ASSERT_NE(source, nullptr);
+    ASSERT_TRUE(sp_save_png(source, path));
+    sp_destroy_canvas(source);
+    std::vector<sp_image_t*> images;
+    for (int i = 0; i < 17; ++i) images.push_back(sp_load_image(canvas, path));
+    sp_begin_frame(canvas);
+    for (sp_image_t* image : images) sp_draw_image(canvas, image, 0, 0);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.frame, 2u);
+    EXPECT_EQ(stats.texture_evictions, 1u);
+    EXPECT_EQ(stats.flushes, 2u);
+    EXPECT_EQ(stats.vertices, 17u * 4u);
+    for (sp_image_t* image : images) sp_destroy_image(image);
+    std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, SmallImagesShareAtlasPagesAndOneDraw) {
+    // Before packing, 32 distinct images cost a flush for every 16.
+    const char* paths[2] = {"spiro_atlas_red.png", "spiro_atlas_blue.png"};
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, paths[0]));
+    drawFrame({0.0f, 0.0f, 1.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, paths[1]));
+    std::vector<sp_image_t*> images;
+    for (int i = 0; i < 32; ++i) images.push_back(sp_load_image(canvas, paths[i % 2]));
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    for (int i = 0; i < 32; ++i) sp_draw_image_rect(canvas, images[i], {0, 0, 64, 32}, {(float)i * 2, 0, 2, 4});
+    // The right quarter of the first red and blue images, magnified 2x so the outermost columns
+    // filter across the image edge into whatever is packed next to it: the other colour. The
+    // border texels keep each half its own pure colour.
+    sp_draw_image_rect(canvas, images[0], {48, 0, 16, 32}, {0, 8, 32, 24});
+    sp_draw_image_rect(canvas, images[1], {48, 0, 16, 32}, {32, 8, 32, 24});
+    sp_end_frame(canvas);
+    sp_frame_stats_t stats;
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 1u);
+    EXPECT_EQ(stats.texture_evictions, 0u);
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    auto expectColor = [&](int x, int y, uint8_t r, uint8_t g, uint8_t b) {
+        const uint8_t* p = pixel(rgba, x, y);
+        EXPECT_EQ(p[0], r) << x << "," << y;
+        EXPECT_EQ(p[1], g) << x << "," << y;
+        EXPECT_EQ(p[2], b) << x << "," << y;
+    };
+    for (int y : {16, 31}) {
+        expectColor(0, y, 255, 0, 0);
+        expectColor(31, y, 255, 0, 0);
+        expectColor(32, y, 0, 0, 255);
+        expectColor(63, y, 0, 0, 255);
+    }
+    // The small copies alternate between the two images' own colours.
+    expectColor(0, 1, 255, 0, 0);
+    expectColor(3, 1, 0, 0, 255);
+
+    for (sp_image_t* image : images) sp_destroy_image(image);
+    for (const char* path : paths) std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, MarkersAreOneInstancedDrawWithPixelSizes) {
+    const uint32_t red = sp_pack_color({1, 0, 0, 1}), green = sp_pack_color({0, 1, 0, 1}), blue = sp_pack_color({0, 0, 1, 1});
+    const sp_marker_t markers[] = {
+        {8.5f, 16.5f, 14.0f, red, SP_MARKER_CIRCLE},
+        {24.5f, 16.5f, 14.0f, green, SP_MARKER_SQUARE},
+        {40.5f, 16.5f, 14.0f, blue, SP_MARKER_TRIANGLE},
+        {56.5f, 16.5f, 14.0f, red | green, SP_MARKER_PLUS},
+    };
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_markers(canvas, markers, 4);
+    sp_end_frame(canvas);
+    sp_frame_stats_t stats;
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 1u);
+    EXPECT_EQ(stats.upload_bytes, 4u * sizeof(sp_marker_t));
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    // The circle leaves the corners of its square clear.
+    EXPECT_EQ(pixel(rgba, 8, 16)[0], 255);
+    EXPECT_EQ(pixel(rgba, 2, 10)[0], 0);
+    EXPECT_EQ(pixel(rgba, 18, 10)[1], 255);
+    // The triangle points up: wide at the bottom, narrow at the top.
+    EXPECT_EQ(pixel(rgba, 40, 18)[2], 255);
+    EXPECT_EQ(pixel(rgba, 37, 18)[2], 255);
+    EXPECT_EQ(pixel(rgba, 37, 12)[2], 0);
+    EXPECT_EQ(pixel(rgba, 40, 21)[2], 0);
+    EXPECT_EQ(pixel(rgba, 61, 16)[1], 255);
+    EXPECT_EQ(pixel(rgba, 61, 21)[1], 0);
+
+    // Centers follow the transform; sizes stay in pixels.
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_translate(canvas, 4, 0);
+    sp_scale(canvas, 2, 2);
+    const sp_marker_t scaled = {4.25f, 8.25f, 6.0f, red, SP_MARKER_CIRCLE};
+    sp_draw_markers(canvas, &scaled, 1);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 12, 16)[0], 255);
+    EXPECT_EQ(pixel(rgba, 16, 16)[0], 0);
+    EXPECT_EQ(pixel(rgba, 8, 16)[0], 0);
+}
+
+TEST_F(SpirocoreOffscreenTest, CirclesFillAndStroke) {
+    sp_pen_config_t config = {2.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &config);
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    sp_set_pen(canvas, pen);
+    sp_fill_circle(canvas, 16, 16, 12);
+    sp_draw_circle(canvas, 48, 16, 12);
+    sp_end_frame(canvas);
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 16, 16)[0], 255);
+    EXPECT_EQ(pixel(rgba, 26, 16)[0], 255);
+    EXPECT_EQ(pixel(rgba, 16, 5)[0], 255);
+    EXPECT_EQ(pixel(rgba, 25, 25)[0], 0);
+    EXPECT_EQ(pixel(rgba, 59, 16)[0], 255);
+    EXPECT_EQ(pixel(rgba, 48, 4)[0], 255);
+    EXPECT_EQ(pixel(rgba, 48, 16)[0], 0);
+    EXPECT_EQ(pixel(rgba, 57, 16)[0], 0);
+    sp_destroy_pen(pen);
+}
+
+TEST_F(SpirocoreOffscreenTest, RectsAreOutlinedWithThePen) {
+    // A 2-pixel mitered outline of the 32x16 rectangle at (8, 8): each edge covers the two
+    // pixel rows or columns either side of it, including the corners.
+    sp_pen_config_t config = {2.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &config);
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    sp_set_pen(canvas, pen);
+    sp_draw_rect(canvas, 8, 8, 32, 16);
+    sp_end_frame(canvas);
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    for (int x : {7, 24, 40}) {
+        EXPECT_EQ(pixel(rgba, x, 7)[0], 255) << x;
+        EXPECT_EQ(pixel(rgba, x, 24)[0], 255) << x;
+    }
+    for (int y : {7, 16, 24}) {
+        EXPECT_EQ(pixel(rgba, 7, y)[0], 255) << y;
+        EXPECT_EQ(pixel(rgba, 40, y)[0], 255) << y;
+    }
+    EXPECT_EQ(pixel(rgba, 24, 16)[0], 0);
+    EXPECT_EQ(pixel(rgba, 24, 5)[0], 0);
+    EXPECT_EQ(pixel(rgba, 5, 16)[0], 0);
+    EXPECT_EQ(pixel(rgba, 42, 26)[0], 0);
+    sp_destroy_pen(pen);
+}
+
+TEST_F(SpirocoreOffscreenTest, AsyncImagesMatchSynchronousLoads) {
+    const char* path = "spiro_async_image.png";
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, path));
+    sp_image_t* reference = sp_load_image(canvas, path);
+    EXPECT_EQ(sp_get_image_status(reference), SP_IMAGE_READY);
+
+    std::vector<sp_image_t*> images;
+    for (int i = 0; i < 40; ++i) images.push_back(sp_load_image_async(canvas, path));
+    sp_image_t* missing = sp_load_image_async(canvas, "spiro_no_such_image.png");
+    // Uploads only happen on the render thread, so nothing can be ready yet.
+    for (sp_image_t* image : images) EXPECT_EQ(sp_get_image_status(image), SP_IMAGE_LOADING);
+    // Destroyed while still queued or decoding; its upload must be dropped.
+    sp_destroy_image(images.back());
+    images.pop_back();
+    sp_finish_image_loads(canvas);
+    for (sp_image_t* image : images) EXPECT_EQ(sp_get_image_status(image), SP_IMAGE_READY);
+    EXPECT_EQ(sp_get_image_status(missing), SP_IMAGE_FAILED);
+
+    auto render = [&](sp_image_t* image) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_draw_image_rect(canvas, image, {0, 0, 64, 32}, {8, 4, 48, 24});
+        sp_end_frame(canvas);
+        std::vector<uint8_t> rgba(64 * 32 * 4);
+        EXPECT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+        return rgba;
+    };
+    const std::vector<uint8_t> expected = render(reference);
+    // The image's own colours: red with the green rectangle in its top left corner.
+    EXPECT_EQ(pixel(expected, 32, 20)[0], 255);
+    EXPECT_EQ(pixel(expected, 32, 20)[1], 0);
+    EXPECT_EQ(pixel(expected, 12, 6)[0], 0);
+    EXPECT_EQ(pixel(expected, 12, 6)[1], 255);
+    EXPECT_EQ(render(images[0]), expected);
+    EXPECT_EQ(render(images[38]), expected);
+    // An image that never arrives keeps drawing its placeholder.
+    const std::vector<uint8_t> placeholder = render(missing);
+    EXPECT_GT(pixel(placeholder, 32, 16)[0], 0);
+    EXPECT_EQ(pixel(placeholder, 0, 0)[0], 0);
+
+    for (sp_image_t* image : images) sp_destroy_image(image);
+    sp_destroy_image(missing);
+    sp_destroy_image(reference);
+    std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, AsyncImageDrawsAPlaceholderOfItsSize) {
+    const char* path = "spiro_placeholder_image.png";
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, path));
+
+    // Loaded inside a frame, so nothing uploads it before the frame ends.
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_image_t* image = sp_load_image_async(canvas, path);
+    sp_draw_image(canvas, image, 16.0f, 8.0f);
+    sp_end_frame(canvas);
+    EXPECT_EQ(sp_get_image_status(image), SP_IMAGE_LOADING);
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    // 25% mid grey over black across the image's 64x32, clipped by the canvas.
+    for (auto [x, y] : {std::pair{16, 8}, std::pair{40, 20}, std::pair{63, 31}}) {
+        EXPECT_EQ(pixel(rgba, x, y)[0], 32) << x << "," << y;
+        EXPECT_EQ(pixel(rgba, x, y)[0], pixel(rgba, x, y)[2]);
+    }
+    EXPECT_EQ(pixel(rgba, 15, 20)[0], 0);
+    EXPECT_EQ(pixel(rgba, 40, 7)[0], 0);
+
+    sp_finish_image_loads(canvas);
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_image(canvas, image, 16.0f, 8.0f);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 40, 20)[0], 255);
+    EXPECT_EQ(pixel(rgba, 15, 20)[0], 0);
+
+    // A file with no readable header has no size to hold, and draws nothing.
+    sp_image_t* missing = sp_load_image_async(canvas, "spiro_no_such_image.png");
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_image(canvas, missing, 0.0f, 0.0f);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 32, 16)[0], 0);
+
+    sp_destroy_image(missing);
+    sp_destroy_image(image);
+    std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, TraceWritesChromeTraceEvents) {
+    const char* path = "spiro_trace_test.json";
+    ASSERT_TRUE(sp_trace_begin(path));
+    EXPECT_FALSE(sp_trace_begin(path));
+    drawFrame({0.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_trace_end());
+    EXPECT_FALSE(sp_trace_end());
+
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"sp_end_frame\",\"cat\":\"spiro\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"batch\",\"cat\":\"spiro\",\"ph\":\"C\""), std::string::npos);
+    std::remove(path);
+}
+
+TEST_F(SpirocoreOffscreenTest, TextScalesWithFontSizeAndDecodesUtf8) {
+    sp_font_t* font = sp_load_font(canvas, "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+    if (!font) GTEST_SKIP() << "DejaVu Sans is not installed.";
+
+    sp_set_font(canvas, font, 10.0f);
+    const sp_rect_t small = sp_measure_text(canvas, "Tick 10");
+    sp_set_font(canvas, font, 20.0f);
+    const sp_rect_t large = sp_measure_text(canvas, "Tick 10");
+    EXPECT_GT(small.w, 0.0f);
+    EXPECT_NEAR(large.w, 2.0f * small.w, 1e-3f);
+    EXPECT_NEAR(large.h, 2.0f * small.h, 1e-3f);
+    EXPECT_LT(large.y, 0.0f);
+    // Two-byte U+00E9 is one glyph; DejaVu gives it the advance of a plain "e".
+    EXPECT_FLOAT_EQ(sp_measure_text(canvas, "\xC3\xA9").w, sp_measure_text(canvas, "e").w);
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    sp_set_font(canvas, font, 28.0f);
+    sp_draw_text(canvas, "\xE2\x96\xA0", 4, 28);
+    sp_end_frame(canvas);
+
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    // U+25A0 BLACK SQUARE is solid in the middle and leaves the far corner untouched.
+    const sp_rect_t box = sp_measure_text(canvas, "\xE2\x96\xA0");
+    EXPECT_EQ(pixel(rgba, 4 + (int)(box.w / 2), 20)[0], 255);
+    EXPECT_EQ(pixel(rgba, 63, 0)[0], 0);
+    sp_destroy_font(font);
+}
+
+TEST_F(SpirocoreOffscreenTest, FillPathTriangulatesSimpleOutlinesAndStencilsTheRest) {
+    sp_path_t* star = sp_create_path(canvas);
+    for (int i = 0; i < 5; ++i) {
+        const float angle = -1.5707963f + i * 2.5132741f;
+        if (i == 0) sp_path_move_to(star, 16.5f + 15.0f * std::cos(angle), 16.5f + 15.0f * std::sin(angle));
+        else sp_path_line_to(star, 16.5f + 15.0f * std::cos(angle), 16.5f + 15.0f * std::sin(angle));
+    }
+    sp_path_close(star);
+    sp_path_t* ell = sp_create_path(canvas);
+    const float outline[] = {36, 4, 60, 4, 60, 12, 44, 12, 44, 28, 36, 28};
+    sp_path_set_points(ell, outline, 6, 0);
+    auto draw = [&](sp_fill_rule_t rule) {
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_set_fill_rule(canvas, rule);
+        sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+        sp_fill_path(canvas, star);
+        sp_set_color(canvas, {1.0f, 0.0f, 0.0f, 1.0f});
+        sp_fill_path(canvas, ell);
+    };
+    auto render = [&](sp_fill_rule_t rule) {
+        sp_begin_frame(canvas);
+        draw(rule);
+        sp_end_frame(canvas);
+        std::vector<uint8_t> rgba(64 * 32 * 4);
+        EXPECT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+        return rgba;
+    };
+
+    const std::vector<uint8_t> nonzero = render(SP_FILL_RULE_NONZERO);
+    EXPECT_EQ(pixel(nonzero, 16, 16)[1], 255);
+    EXPECT_EQ(pixel(nonzero, 16, 8)[1], 255);
+    EXPECT_EQ(pixel(nonzero, 2, 30)[1], 0);
+    EXPECT_EQ(pixel(nonzero, 40, 20)[0], 255);
+    EXPECT_EQ(pixel(nonzero, 52, 20)[0], 0);
+    // The star is a fan into the stencil plus a cover quad; the L joins the batch.
+    sp_frame_stats_t stats;
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 3u);
+
+    // The inner pentagon winds twice, so even-odd leaves it empty.
+    const std::vector<uint8_t> evenOdd = render(SP_FILL_RULE_EVEN_ODD);
+    EXPECT_EQ(pixel(evenOdd, 16, 16)[1], 0);
+    EXPECT_EQ(pixel(evenOdd, 16, 8)[1], 255);
+    EXPECT_EQ(pixel(evenOdd, 40, 20)[0], 255);
+
+    // The stencil pass leaves no residue for the next frame or fill.
+    EXPECT_EQ(render(SP_FILL_RULE_NONZERO), nonzero);
+
+    // Recorded fills keep their rule and order.
+    sp_draw_list_t* list = sp_create_draw_list(canvas);
+    sp_begin_frame(canvas);
+    std::thread([&] {
+        ASSERT_TRUE(sp_begin_draw_list(canvas, list));
+        draw(SP_FILL_RULE_EVEN_ODD);
+        sp_end_draw_list(canvas);
+    }).join();
+    sp_submit_draw_lists(canvas, &list, 1);
+    sp_end_frame(canvas);
+    std::vector<uint8_t> recorded(64 * 32 * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, recorded.data(), recorded.size()));
+    EXPECT_EQ(recorded, evenOdd);
+
+    // Meshes only hold what the CPU triangulated.
+    ASSERT_TRUE(sp_begin_mesh(canvas));
+    sp_fill_path(canvas, star);
+    sp_fill_path(canvas, ell);
+    sp_mesh_t* mesh = sp_end_mesh(canvas);
+    ASSERT_NE(mesh, nullptr);
+    EXPECT_EQ(sp_mesh_vertex_count(mesh), 4u * 4u);
+    sp_destroy_mesh(mesh);
+
+    sp_destroy_draw_list(list);
+    sp_destroy_path(ell);
+    sp_destroy_path(star);
+}
+
+TEST_F(SpirocoreOffscreenTest, PanelTransformsStayInOneBatch) {
+    // Eight 16x16 panels, each under its own translate, rotate and scale. Drawn directly they
+    // are transformed on the CPU into one batch; as meshes each one flushes and draws with its
+    // transform as a uniform, which is the flush-per-transform reference.
+    sp_path_t* triangle = sp_create_path(canvas);
+    sp_path_move_to(triangle, -5, 4);
+    sp_path_line_to(triangle, 5, 4);
+    sp_path_line_to(triangle, 0, -5);
+    sp_path_close(triangle);
+    auto drawPanel = [&](int panel) {
+        sp_set_color(canvas, {1.0f, 0.5f * (panel % 3), 0.0f, 1.0f});
+        sp_fill_rect(canvas, -6, -6, 12, 4);
+        sp_set_color(canvas, {0.0f, 0.25f * (panel % 5), 1.0f, 1.0f});
+        sp_fill_path(canvas, triangle);
+    };
+    auto panelTransform = [&](int panel) {
+        sp_translate(canvas, 8.0f + 16.0f * (panel % 4), 8.0f + 16.0f * (panel / 4));
+        sp_rotate(canvas, 0.4f * panel);
+        sp_scale(canvas, 0.8f + 0.05f * panel, 1.0f - 0.05f * panel);
+    };
+
+    std::vector<uint8_t> batched(64 * 32 * 4), reference(64 * 32 * 4);
+    sp_frame_stats_t stats;
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    for (int panel = 0; panel < 8; ++panel) {
+        sp_save_state(canvas);
+        panelTransform(panel);
+        drawPanel(panel);
+        sp_restore_state(canvas);
+    }
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, batched.data(), batched.size()));
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 1u);
+
+    std::vector<sp_mesh_t*> meshes;
+    for (int panel = 0; panel < 8; ++panel) {
+        ASSERT_TRUE(sp_begin_mesh(canvas));
+        drawPanel(panel);
+        meshes.push_back(sp_end_mesh(canvas));
+        ASSERT_NE(meshes.back(), nullptr);
+    }
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    for (int panel = 0; panel < 8; ++panel) {
+        sp_save_state(canvas);
+        panelTransform(panel);
+        sp_draw_mesh(canvas, meshes[panel]);
+        sp_restore_state(canvas);
+    }
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, reference.data(), reference.size()));
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 8u);
+
+    // The GPU multiplies the matrices in a different order, so only edge pixels may differ.
+    int covered = 0, differing = 0;
+    for (size_t i = 0; i < batched.size(); i += 4) {
+        if (reference[i] || reference[i + 2]) covered++;
+        for (size_t c = 0; c < 3; ++c)
+            if (std::abs(batched[i + c] - reference[i + c]) > 64) { differing++; break; }
+    }
+    EXPECT_GT(covered, 400);
+    EXPECT_LE(differing, covered / 50);
+
+    for (sp_mesh_t* mesh : meshes) sp_destroy_mesh(mesh);
+    sp_destroy_path(triangle);
+}
+
+TEST_F(SpirocoreOffscreenTest, BlendModesGroupIntoOneDrawEachWhenNothingOverlaps) {
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    sp_frame_stats_t stats;
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.25f, 0.25f, 0.25f, 1.0f});
+    sp_set_blend_mode(canvas, SP_BLEND_MODE_ADD);
+    sp_set_color(canvas, {0.5f, 0.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 0, 0, 8, 8);
+    sp_set_blend_mode(canvas, SP_BLEND_MODE_MULTIPLY);
+    sp_set_color(canvas, {0.5f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 16, 0, 8, 8);
+    sp_set_blend_mode(canvas, SP_BLEND_MODE_SCREEN);
+    sp_set_color(canvas, {0.5f, 0.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 32, 0, 8, 8);
+    // Alternating modes in separate cells: each mode's quads share one draw.
+    for (int i = 0; i < 8; ++i) {
+        sp_set_blend_mode(canvas, i % 2 ? SP_BLEND_MODE_ADD : SP_BLEND_MODE_NORMAL);
+        sp_set_color(canvas, {0.0f, 0.0f, 0.5f, 1.0f});
+        sp_fill_rect(canvas, i * 8.0f, 16, 6, 6);
+    }
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    // One draw per mode: add, multiply, screen and normal.
+    EXPECT_EQ(stats.draw_calls, 4u);
+    auto expectColor = [&](int x, int y, int r, int g, int b) {
+        const uint8_t* p = pixel(rgba, x, y);
+        EXPECT_NEAR(p[0], r, 2) << x << "," << y; EXPECT_NEAR(p[1], g, 2) << x << "," << y; EXPECT_NEAR(p[2], b, 2) << x << "," << y;
+    };
+    expectColor(4, 4, 192, 64, 64);
+    expectColor(20, 4, 32, 64, 0);
+    expectColor(36, 4, 160, 64, 64);
+    expectColor(2, 18, 0, 0, 128);
+    expectColor(10, 18, 64, 64, 192);
+    expectColor(12, 4, 64, 64, 64);
+}
+
+TEST_F(SpirocoreOffscreenTest, OverlappingBlendModesKeepPaintersOrder) {
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    sp_frame_stats_t stats;
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {0.0f, 0.0f, 1.0f, 1.0f});
+    sp_fill_rect(canvas, 0, 0, 24, 16);
+    sp_set_blend_mode(canvas, SP_BLEND_MODE_ADD);
+    sp_set_color(canvas, {0.5f, 0.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 16, 0, 24, 16);
+    sp_set_blend_mode(canvas, SP_BLEND_MODE_NORMAL);
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 32, 0, 24, 16);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    // The last rect covers the added one, so it cannot join the first rect's draw.
+    EXPECT_EQ(stats.draw_calls, 3u);
+    const uint8_t* under = pixel(rgba, 20, 8);
+    EXPECT_NEAR(under[0], 128, 2); EXPECT_EQ(under[2], 255);
+    const uint8_t* over = pixel(rgba, 36, 8);
+    EXPECT_EQ(over[0], 0); EXPECT_EQ(over[1], 255);
+}
+
+TEST_F(SpirocoreOffscreenTest, DamagedRectIsTheOnlyPartRedrawn) {
+    std::vector<uint8_t> rgba(64 * 32 * 4);
+    EXPECT_TRUE(sp_canvas_needs_redraw(canvas));
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    EXPECT_FALSE(sp_canvas_needs_redraw(canvas));
+    EXPECT_FALSE(sp_wait_events(canvas, 10.0));
+
+    // Offscreen canvases never wait, they only report the damage.
+    sp_invalidate_rect(canvas, 24, 8, 16, 8);
+    EXPECT_TRUE(sp_wait_events(canvas, 10.0));
+    sp_begin_frame(canvas);
+    EXPECT_FALSE(sp_canvas_needs_redraw(canvas));
+    sp_clear(canvas, {0.0f, 0.0f, 1.0f, 1.0f});
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 0, 0, 32, 12);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 4, 4)[1], 255);
+    EXPECT_EQ(pixel(rgba, 4, 20)[0], 255);
+    EXPECT_EQ(pixel(rgba, 26, 10)[1], 255);
+    EXPECT_EQ(pixel(rgba, 34, 14)[2], 255);
+    EXPECT_EQ(pixel(rgba, 34, 20)[0], 255);
+    EXPECT_EQ(pixel(rgba, 50, 10)[0], 255);
+
+    // Without an invalidation the next frame redraws everything again.
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 1.0f, 1.0f});
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, rgba.data(), rgba.size()));
+    EXPECT_EQ(pixel(rgba, 4, 20)[2], 255);
+    EXPECT_EQ(pixel(rgba, 50, 10)[2], 255);
+
+    sp_invalidate(canvas);
+    EXPECT_TRUE(sp_canvas_needs_redraw(canvas));
+}
+
+TEST_F(SpirocoreOffscreenTest, RecordedScenesReplayWithoutTheirSources) {
+    const char* imagePath = "spiro_scene_image.png", * scenePath = "spiro_scene.bin";
+    drawFrame({1.0f, 0.0f, 0.0f, 1.0f});
+    ASSERT_TRUE(sp_save_png(canvas, imagePath));
+    sp_image_t* image = sp_load_image(canvas, imagePath);
+    sp_font_t* font = sp_load_font(canvas, "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+    ASSERT_TRUE(sp_begin_mesh(canvas));
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 0, 0, 8, 8);
+    sp_mesh_t* mesh = sp_end_mesh(canvas);
+    sp_path_t* star = sp_create_path(canvas);
+    for (int i = 0; i < 5; ++i) {
+        const float angle = -1.5707963f + i * 2.5132741f;
+        if (i == 0) sp_path_move_to(star, 48.5f + 12.0f * std::cos(angle), 16.5f + 12.0f * std::sin(angle));
+        else sp_path_line_to(star, 48.5f + 12.0f * std::cos(angle), 16.5f + 12.0f * std::sin(angle));
+    }
+    const sp_marker_t markers[] = {{6.5f, 24.5f, 8.0f, sp_pack_color({1, 0, 1, 1}), SP_MARKER_CIRCLE}};
+
+    // Every kind of recorded item: geometry with a texture, a mesh under its own transform and
+    // blend mode, markers, a stencilled fill, text and a clear.
+    sp_draw_list_t* list = sp_create_draw_list(canvas);
+    ASSERT_TRUE(sp_begin_draw_list(canvas, list));
+    sp_clear(canvas, {0.0f, 0.0f, 0.25f, 1.0f});
+    sp_set_color(canvas, {1.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 2, 2, 10, 6);
+    sp_draw_image_rect(canvas, image, {0, 0, 64, 32}, {16, 0, 16, 8});
+    sp_save_state(canvas);
+    sp_translate(canvas, 16, 12);
+    sp_set_blend_mode(canvas, SP_BLEND_MODE_ADD);
+    sp_draw_mesh(canvas, mesh);
+    sp_restore_state(canvas);
+    sp_draw_markers(canvas, markers, 1);
+    sp_set_color(canvas, {0.0f, 1.0f, 1.0f, 1.0f});
+    sp_fill_path(canvas, star);
+    if (font) { sp_set_font(canvas, font, 10.0f); sp_draw_text(canvas, "Ab", 18, 30); }
+    sp_end_draw_list(canvas);
+
+    std::vector<uint8_t> expected(64 * 32 * 4), replayed(expected.size());
+    sp_begin_frame(canvas);
+    sp_submit_draw_lists(canvas, &list, 1);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, expected.data(), expected.size()));
+
+    const size_t size = sp_record_scene(canvas, &list, 1, nullptr, 0);
+    ASSERT_GT(size, 0u);
+    std::vector<uint64_t> storage((size + 7) / 8);
+    EXPECT_EQ(sp_record_scene(canvas, &list, 1, storage.data(), size), size);
+    ASSERT_TRUE(sp_record_scene_file(canvas, &list, 1, scenePath));
+    // The scene holds everything it draws.
+    sp_destroy_draw_list(list);
+    sp_destroy_mesh(mesh);
+    sp_destroy_image(image);
+    sp_destroy_path(star);
+    if (font) sp_destroy_font(font);
+
+    sp_scene_t* scene = sp_load_scene_file(canvas, scenePath);
+    ASSERT_NE(scene, nullptr);
+    sp_begin_frame(canvas);
+    sp_replay(canvas, scene);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, replayed.data(), replayed.size()));
+    EXPECT_EQ(replayed, expected);
+    EXPECT_EQ(pixel(replayed, 20, 16)[1], 255);
+    EXPECT_EQ(pixel(replayed, 48, 16)[2], 255);
+
+    // Replay draws under the current transform and leaves the state as it found it.
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_translate(canvas, 0, 16);
+    sp_replay(canvas, scene);
+    sp_reset_transform(canvas);
+    sp_fill_rect(canvas, 60, 0, 4, 4);
+    sp_end_frame(canvas);
+    ASSERT_TRUE(sp_read_pixels(canvas, replayed.data(), replayed.size()));
+    EXPECT_EQ(pixel(replayed, 6, 20)[0], 255);
+    EXPECT_EQ(pixel(replayed, 6, 20)[1], 255);
+    EXPECT_EQ(pixel(replayed, 6, 4)[2], 64);
+    EXPECT_EQ(pixel(replayed, 62, 2)[0], 0);
+    EXPECT_EQ(pixel(replayed, 62, 2)[1], 255);
+    sp_destroy_scene(scene);
+
+    // Loading checks the header and bounds and nothing else.
+    scene = sp_load_scene(canvas, storage.data(), size);
+    EXPECT_NE(scene, nullptr);
+    sp_destroy_scene(scene);
+    EXPECT_EQ(sp_load_scene(canvas, storage.data(), size - 16), nullptr);
+    reinterpret_cast<uint32_t*>(storage.data())[2] = 99;
+    EXPECT_EQ(sp_load_scene(canvas, storage.data(), size), nullptr);
+    std::remove(scenePath);
+    std::remove(imagePath);
+}
+
+TEST(SpirocoreDeviceTest, CanvasesShareContentCachedFontsAndImages) {
+    sp_initialize();
+    const sp_device_config_t deviceConfig = {true};
+    sp_device_t* device = sp_create_device(&deviceConfig);
+    if (!device) {
+        sp_terminate();
+        GTEST_SKIP() << "No headless GL context (EGL or hidden window) available.";
+    }
+    const sp_offscreen_config_t wide = {64, 32, 1}, tall = {32, 64, 1};
+    sp_canvas_t* canvases[2] = {sp_create_device_offscreen_canvas(device, &wide), sp_create_device_offscreen_canvas(device, &tall)};
+    ASSERT_NE(canvases[0], nullptr);
+    ASSERT_NE(canvases[1], nullptr);
+    EXPECT_EQ(sp_create_device_offscreen_canvas(nullptr, &wide), nullptr);
+    EXPECT_EQ(sp_create_device_offscreen_canvas(device, nullptr), nullptr);
+
+    // The same red image under two names.
+    const char* paths[2] = {"spiro_device_a.png", "spiro_device_b.png"};
+    sp_begin_frame(canvases[0]);
+    sp_clear(canvases[0], {1.0f, 0.0f, 0.0f, 1.0f});
+    sp_end_frame(canvases[0]);
+    ASSERT_TRUE(sp_save_png(canvases[0], paths[0]));
+    {
+        std::ifstream in(paths[0], std::ios::binary);
+        std::ofstream out(paths[1], std::ios::binary);
+        out << in.rdbuf();
+    }
+    sp_image_t* images[3] = {sp_load_image(canvases[0], paths[0]), sp_load_image(canvases[1], paths[1]), sp_device_load_image(device, paths[0])};
+    for (sp_image_t* image : images) ASSERT_NE(image, nullptr);
+    sp_device_stats_t stats;
+    ASSERT_TRUE(sp_get_device_stats(device, &stats));
+    EXPECT_EQ(stats.canvases, 2u);
+    EXPECT_EQ(stats.images, 1u);
+    EXPECT_EQ(stats.atlas_pages, 1u);
+
+    const char* fontPath = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+    sp_font_t* fonts[2] = {sp_load_font(canvases[0], fontPath), sp_device_load_font(device, fontPath)};
+    const bool haveFont = fonts[0] != nullptr;
+    if (haveFont) {
+        ASSERT_NE(fonts[1], nullptr);
+        ASSERT_TRUE(sp_get_device_stats(device, &stats));
+        EXPECT_EQ(stats.fonts, 1u);
+    }
+
+    // Each canvas draws with the shared program under its own projection, whichever began a
+    // frame last, and samples an image loaded through the other.
+    std::vector<std::vector<uint8_t>> rgba(2, std::vector<uint8_t>(64 * 32 * 4));
+    for (int i : {0, 1, 0}) {
+        sp_canvas_t* canvas = canvases[i];
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_draw_image_rect(canvas, images[1 - i], {0, 0, 64, 32}, {0, 0, 16, 16});
+        sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+        sp_fill_rect(canvas, 16, 16, 16, 16);
+        if (haveFont) {
+            sp_set_font(canvas, fonts[i], 12.0f);
+            sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+            sp_draw_text(canvas, "W", 0, 30);
+        }
+        sp_end_frame(canvas);
+        ASSERT_TRUE(sp_read_pixels(canvas, rgba[i].data(), rgba[i].size()));
+    }
+    for (int i : {0, 1}) {
+        const int width = i == 0 ? 64 : 32;
+        auto at = [&](int x, int y) { return &rgba[i][(y * width + x) * 4]; };
+        EXPECT_EQ(at(8, 8)[0], 255) << i;
+        EXPECT_EQ(at(8, 8)[1], 0) << i;
+        EXPECT_EQ(at(24, 24)[1], 255) << i;
+        EXPECT_EQ(at(24, 8)[1], 0) << i;
+    }
+    if (haveFont) {
+        // Both canvases rasterized the glyph into the one atlas and drew it identically.
+        size_t lit = 0;
+        for (int y = 16; y < 32; ++y)
+            for (int x = 0; x < 16; ++x) {
+                EXPECT_EQ(rgba[0][(y * 64 + x) * 4], rgba[1][(y * 32 + x) * 4]) << x << "," << y;
+                lit += rgba[0][(y * 64 + x) * 4] > 128;
+            }
+        EXPECT_GT(lit, 0u);
+    }
+
+    // Both frames open at once with draws alternating between them. Each canvas queues more
+    // quads than one batch holds, so batches flush mid-frame right after the other canvas drew.
+    for (sp_canvas_t* canvas : canvases) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    }
+    for (int pass = 0; pass < 640; ++pass)
+        for (int row = 0; row < 32; ++row) {
+            sp_set_color(canvases[0], {1.0f, 0.0f, 0.0f, 1.0f});
+            sp_fill_rect(canvases[0], 0, (float)row, 64, 1);
+            sp_set_color(canvases[1], {0.0f, 0.0f, 1.0f, 1.0f});
+            sp_fill_rect(canvases[1], 0, (float)row * 2, 32, 2);
+            if (haveFont && pass == 0 && row == 0) {
+                sp_set_font(canvases[0], fonts[0], 12.0f);
+                sp_draw_text(canvases[0], "W", 0, 30);
+            }
+        }
+    for (sp_canvas_t* canvas : canvases) sp_end_frame(canvas);
+    for (int i : {0, 1}) {
+        ASSERT_TRUE(sp_read_pixels(canvases[i], rgba[i].data(), rgba[i].size()));
+        const int width = i == 0 ? 64 : 32, height = i == 0 ? 32 : 64;
+        for (int y = 0; y < height; y += 7)
+            for (int x = 0; x < width; x += 5) {
+                const uint8_t* p = &rgba[i][(y * width + x) * 4];
+                EXPECT_EQ(p[0], i == 0 ? 255 : 0) << i << ": " << x << "," << y;
+                EXPECT_EQ(p[2], i == 0 ? 0 : 255) << i << ": " << x << "," << y;
+            }
+    }
+
+    // The device lives on with its canvases and resources, which keep drawing after the
+    // handle is gone; the cache lets an entry go with its last handle.
+    sp_destroy_device(device);
+    sp_destroy_image(images[0]);
+    sp_destroy_image(images[2]);
+    sp_destroy_canvas(canvases[0]);
+    sp_begin_frame(canvases[1]);
+    sp_clear(canvases[1], {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_image_rect(canvases[1], images[1], {0, 0, 64, 32}, {0, 0, 16, 16});
+    sp_end_frame(canvases[1]);
+    ASSERT_TRUE(sp_read_pixels(canvases[1], rgba[1].data(), 32 * 64 * 4));
+    EXPECT_EQ(rgba[1][(8 * 32 + 8) * 4], 255);
+    sp_destroy_image(images[1]);
+    for (sp_font_t* font : fonts) sp_destroy_font(font);
+    sp_destroy_canvas(canvases[1]);
+    for (const char* path : paths) std::remove(path);
+    sp_terminate();
+}
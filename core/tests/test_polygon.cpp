@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "polygon.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+std::vector<sp_vec2_t> pentagram(float cx, float cy, float r)
+{
+    std::vector<sp_vec2_t> points;
+    for (int i = 0; i < 5; ++i) {
+        const float angle = -1.5707963f + i * 2.5132741f;
+        points.push_back({cx + r * std::cos(angle), cy + r * std::sin(angle)});
+    }
+    return points;
+}
+
+const std::vector<sp_vec2_t> L_SHAPE = {{0, 0}, {8, 0}, {8, 2}, {2, 2}, {2, 6}, {0, 6}};
+
+float triangleArea(const sp_vec2_t& a, const sp_vec2_t& b, const sp_vec2_t& c)
+{
+    return std::abs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) * 0.5f;
+}
+
+float shoelaceArea(const std::vector<sp_vec2_t>& points)
+{
+    float twice = 0.0f;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const sp_vec2_t& a = points[i], & b = points[(i + 1) % points.size()];
+        twice += a.x * b.y - b.x * a.y;
+    }
+    return std::abs(twice) * 0.5f;
+}
+
+// Covered length along each span line, summed and scaled back to area.
+float spanArea(const std::vector<FillSpan>& spans, int rowsPerPixel)
+{
+    float length = 0.0f;
+    for (const FillSpan& s : spans) length += s.x1 - s.x0;
+    return length / rowsPerPixel;
+}
+
+}
+
+TEST(SpirocorePolygonTest, ConvexityRejectsConcaveAndDoublyWoundOutlines) {
+    const std::vector<sp_vec2_t> square = {{0, 0}, {4, 0}, {4, 4}, {0, 4}};
+    EXPECT_TRUE(isConvex(square.data(), square.size()));
+    const std::vector<sp_vec2_t> reversed(square.rbegin(), square.rend());
+    EXPECT_TRUE(isConvex(reversed.data(), reversed.size()));
+    // A collinear extra point does not break convexity.
+    const std::vector<sp_vec2_t> withMidpoint = {{0, 0}, {2, 0}, {4, 0}, {4, 4}, {0, 4}};
+    EXPECT_TRUE(isConvex(withMidpoint.data(), withMidpoint.size()));
+    EXPECT_FALSE(isConvex(L_SHAPE.data(), L_SHAPE.size()));
+    // Every turn of a pentagram goes the same way, but it winds around twice.
+    const auto star = pentagram(0, 0, 10);
+    EXPECT_FALSE(isConvex(star.data(), star.size()));
+    const std::vector<sp_vec2_t> line = {{0, 0}, {1, 1}, {2, 2}};
+    EXPECT_FALSE(isConvex(line.data(), line.size()));
+}
+
+TEST(SpirocorePolygonTest, SimplicityFindsCrossingEdges) {
+    EXPECT_TRUE(isSimple(L_SHAPE.data(), L_SHAPE.size()));
+    const auto star = pentagram(0, 0, 10);
+    EXPECT_FALSE(isSimple(star.data(), star.size()));
+    const std::vector<sp_vec2_t> bowtie = {{0, 0}, {4, 4}, {4, 0}, {0, 4}};
+    EXPECT_FALSE(isSimple(bowtie.data(), bowtie.size()));
+    // Two lobes touching at one vertex.
+    const std::vector<sp_vec2_t> touching = {{0, 0}, {2, 2}, {4, 0}, {4, 4}, {2, 2}, {0, 4}};
+    EXPECT_FALSE(isSimple(touching.data(), touching.size()));
+}
+
+TEST(SpirocorePolygonTest, EarClippingCoversTheAreaExactly) {
+    EarClipper clipper;
+    ASSERT_TRUE(clipper.triangulate(L_SHAPE.data(), L_SHAPE.size()));
+    const auto& triangles = clipper.triangles();
+    ASSERT_EQ(triangles.size(), (L_SHAPE.size() - 2) * 3);
+    float area = 0.0f;
+    for (size_t i = 0; i < triangles.size(); i += 3) area += triangleArea(L_SHAPE[triangles[i]], L_SHAPE[triangles[i + 1]], L_SHAPE[triangles[i + 2]]);
+    EXPECT_FLOAT_EQ(area, shoelaceArea(L_SHAPE));
+
+    // A saw blade with deep notches, in both orientations.
+    std::vector<sp_vec2_t> saw = {{0, 0}};
+    for (int i = 0; i < 10; ++i) {
+        saw.push_back({i * 3.0f + 1, 10});
+        saw.push_back({i * 3.0f + 2, 10});
+        saw.push_back({i * 3.0f + 3, 0});
+    }
+    saw.push_back({30, 12});
+    saw.push_back({0, 12});
+    for (int pass = 0; pass < 2; ++pass) {
+        ASSERT_TRUE(clipper.triangulate(saw.data(), saw.size()));
+        float sawArea = 0.0f;
+        for (size_t i = 0; i < clipper.triangles().size(); i += 3)
+            sawArea += triangleArea(saw[clipper.triangles()[i]], saw[clipper.triangles()[i + 1]], saw[clipper.triangles()[i + 2]]);
+        EXPECT_NEAR(sawArea, shoelaceArea(saw), 1e-3f);
+        std::reverse(saw.begin(), saw.end());
+    }
+
+    const std::vector<sp_vec2_t> flat = {{0, 0}, {1, 0}, {2, 0}};
+    EXPECT_FALSE(clipper.triangulate(flat.data(), flat.size()));
+}
+
+TEST(SpirocorePolygonTest, ScanlinesApplyTheFillRule) {
+    ScanlineFiller filler;
+    std::vector<FillSpan> spans;
+    const std::vector<sp_vec2_t> square = {{2, 2}, {12, 2}, {12, 10}, {2, 10}};
+    filler.fill(square.data(), square.size(), SP_FILL_RULE_NONZERO, 16, 4, spans);
+    ASSERT_EQ(spans.size(), 8u * 4u);
+    EXPECT_FLOAT_EQ(spanArea(spans, 4), 80.0f);
+
+    // Rows outside the target are skipped.
+    filler.fill(square.data(), square.size(), SP_FILL_RULE_NONZERO, 6, 4, spans);
+    EXPECT_FLOAT_EQ(spanArea(spans, 4), 40.0f);
+
+    // The pentagram's inner pentagon winds twice: inside for nonzero, outside for even-odd.
+    const auto star = pentagram(50, 50, 40);
+    auto centerCovered = [&](sp_fill_rule_t rule) {
+        filler.fill(star.data(), star.size(), rule, 100, 1, spans);
+        for (const FillSpan& s : spans)
+            if (s.y == 50.5f && s.x0 <= 50.0f && 50.0f < s.x1) return true;
+        return false;
+    };
+    EXPECT_TRUE(centerCovered(SP_FILL_RULE_NONZERO));
+    EXPECT_FALSE(centerCovered(SP_FILL_RULE_EVEN_ODD));
+    filler.fill(star.data(), star.size(), SP_FILL_RULE_NONZERO, 100, 8, spans);
+    const float nonzero = spanArea(spans, 8);
+    filler.fill(star.data(), star.size(), SP_FILL_RULE_EVEN_ODD, 100, 8, spans);
+    const float evenOdd = spanArea(spans, 8);
+    EXPECT_GT(nonzero, evenOdd * 1.2f);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "scene_format.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+// A scene with one textured vertex block, one text command and one fill, in 8-byte aligned
+// storage as a mapping would be.
+struct Sample {
+    std::vector<Vertex> vertices = std::vector<Vertex>(8);
+    std::vector<uint8_t> pixels = std::vector<uint8_t>(4 * 2 * 4, 0xAB);
+    std::string font = "not really a font", text = "label";
+    std::vector<sp_vec2_t> outline = {{0, 0}, {4, 0}, {0, 4}};
+    std::vector<uint64_t> storage;
+    size_t size = 0;
+
+    Sample()
+    {
+        for (size_t i = 0; i < vertices.size(); ++i) vertices[i] = makeVertex({(float)i, 1.0f}, 0xFF00FF00u, 0.0f, 0.0f, 0);
+        SceneWriter writer;
+        const uint32_t texture = writer.addTexture(4, 2, 4, pixels.data());
+        writer.addCommand(command(SceneCommandType::Vertices), vertices.data(), vertices.size() * sizeof(Vertex), {texture, texture});
+        SceneCommand label = command(SceneCommandType::Text);
+        label.font = writer.addFont(font.data(), font.size());
+        label.fontSize = 12.0f;
+        writer.addCommand(label, text.data(), text.size());
+        writer.addCommand(command(SceneCommandType::Fill), outline.data(), outline.size() * sizeof(sp_vec2_t));
+        size = writer.size();
+        storage.resize((size + 7) / 8);
+        writer.write(bytes());
+    }
+    static SceneCommand command(SceneCommandType type)
+    {
+        SceneCommand c{};
+        c.type = type;
+        c.transform[0] = c.transform[3] = 1.0f;
+        return c;
+    }
+    uint8_t* bytes() { return reinterpret_cast<uint8_t*>(storage.data()); }
+    SceneHeader& header() { return *reinterpret_cast<SceneHeader*>(bytes()); }
+    SceneCommand& commandAt(size_t i) { return reinterpret_cast<SceneCommand*>(bytes() + header().commands)[i]; }
+    bool open(SceneView& view, std::string& error) { return openScene(bytes(), size, view, error); }
+};
+
+}
+
+TEST(SpirocoreSceneFormatTest, WrittenScenesOpenInPlace) {
+    Sample sample;
+    SceneView view;
+    std::string error;
+    ASSERT_TRUE(sample.open(view, error)) << error;
+    ASSERT_EQ(view.header->commandCount, 3u);
+    ASSERT_EQ(view.header->textureCount, 1u);
+    ASSERT_EQ(view.header->fontCount, 1u);
+    EXPECT_EQ(view.header->size, sample.size);
+
+    // Blobs are aligned and point into the buffer itself.
+    const SceneCommand& block = view.commands[0];
+    EXPECT_EQ(block.data.offset % SCENE_ALIGNMENT, 0u);
+    const Vertex* vertices = view.blob<Vertex>(block.data);
+    EXPECT_EQ((const void*)vertices, (const void*)(sample.bytes() + block.data.offset));
+    EXPECT_EQ(std::memcmp(vertices, sample.vertices.data(), block.data.size), 0);
+    EXPECT_EQ(block.textureCount, 2u);
+    EXPECT_EQ(view.textureRefs[block.firstTexture + 1], 0u);
+    EXPECT_EQ(view.blob<uint8_t>(view.textures[0].pixels)[7], 0xAB);
+
+    const SceneCommand& label = view.commands[1];
+    EXPECT_EQ(std::string(view.blob<char>(label.data), label.data.size), sample.text);
+    EXPECT_EQ(std::string(view.blob<char>(view.fonts[label.font].data), view.fonts[label.font].data.size), sample.font);
+    EXPECT_EQ(view.commands[2].data.size, 3 * sizeof(sp_vec2_t));
+
+    // Trailing bytes past the recorded size are ignored.
+    std::vector<uint64_t> padded = sample.storage;
+    padded.resize(padded.size() + 4, ~0ull);
+    EXPECT_TRUE(openScene(padded.data(), padded.size() * 8, view, error)) << error;
+}
+
+TEST(SpirocoreSceneFormatTest, OpeningRejectsDamagedScenes) {
+    SceneView view;
+    std::string error;
+    {
+        Sample sample;
+        EXPECT_FALSE(openScene(sample.bytes(), sample.size - 1, view, error));
+        EXPECT_FALSE(openScene(sample.bytes() + 4, sample.size - 4, view, error));
+        EXPECT_FALSE(openScene(nullptr, 0, view, error));
+    }
+    {
+        Sample sample;
+        sample.header().magic[0] = 'X';
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.header().vertexSize += 4;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.header().byteOrder = 0x04030201u;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.header().commandCount = 1u << 30;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.commandAt(0).data.offset += 4;
+        EXPECT_FALSE(sample.open(view, error));
+        EXPECT_NE(error.find("command 0"), std::string::npos);
+    }
+    {
+        // A vertex block must hold whole quads.
+        Sample sample;
+        sample.commandAt(0).data.size -= sizeof(Vertex);
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.commandAt(0).textureCount = 3;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.commandAt(1).font = 1;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        sample.commandAt(2).type = SceneCommandType::Count;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        reinterpret_cast<uint32_t*>(sample.bytes() + sample.header().textureRefs)[0] = 1;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+    {
+        Sample sample;
+        reinterpret_cast<SceneTexture*>(sample.bytes() + sample.header().textures)->height = 3;
+        EXPECT_FALSE(sample.open(view, error));
+    }
+}
@@ -0,0 +1,349 @@
+#include <gtest/gtest.h>
+#include <spirographicals/spirographicals.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int WIDTH = 160, HEIGHT = 96;
+
+sp_canvas_t* createCanvas(std::vector<uint8_t>& pixels, int threads, size_t stride = WIDTH * 4) {
+    pixels.assign(stride * HEIGHT, 0);
+    sp_software_config_t config = {WIDTH, HEIGHT, pixels.data(), stride, threads};
+    return sp_create_software_canvas(&config);
+}
+
+const uint8_t* pixel(const std::vector<uint8_t>& rgba, int x, int y, size_t stride = WIDTH * 4) { return &rgba[y * stride + x * 4]; }
+
+// Spans several tiles, with antialiased edges, overlapping translucent fills and a mid-frame clear.
+void drawScene(sp_canvas_t* canvas) {
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    sp_set_color(canvas, {1.0f, 0.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 10, 10, 50, 30);
+    sp_set_color(canvas, {0.0f, 0.0f, 1.0f, 0.5f});
+    sp_fill_circle(canvas, 70.3f, 50.7f, 33.0f);
+    sp_pen_config_t penConfig = {3.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_ROUND, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &penConfig);
+    sp_set_pen(canvas, pen);
+    sp_set_color(canvas, {0.0f, 0.5f, 0.0f, 0.75f});
+    sp_path_t* path = sp_create_path(canvas);
+    sp_path_move_to(path, 5.0f, 90.0f);
+    for (int i = 1; i < 40; ++i) sp_path_line_to(path, 5.0f + i * 4.0f, 90.0f - (i % 7) * 11.3f);
+    sp_stroke_path(canvas, path);
+    sp_end_frame(canvas);
+    sp_destroy_path(path);
+    sp_destroy_pen(pen);
+}
+
+}
+
+TEST(SpirocoreSoftwareTest, RejectsInvalidConfigs) {
+    ASSERT_EQ(sp_create_software_canvas(nullptr), nullptr);
+    sp_software_config_t empty = {0, 10, nullptr, 0, 1};
+    ASSERT_EQ(sp_create_software_canvas(&empty), nullptr);
+    uint8_t buffer[16];
+    sp_software_config_t narrow = {4, 1, buffer, 8, 1};
+    ASSERT_EQ(sp_create_software_canvas(&narrow), nullptr);
+}
+
+TEST(SpirocoreSoftwareTest, DrawsIntoTheCallersBuffer) {
+    // Padded rows: the bytes past each row's pixels must be left alone.
+    const size_t stride = WIDTH * 4 + 12;
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 1, stride);
+    ASSERT_NE(canvas, nullptr);
+    ASSERT_TRUE(sp_canvas_is_offscreen(canvas));
+    sp_vec2_t size = sp_get_canvas_size(canvas);
+    ASSERT_EQ(size.x, (float)WIDTH);
+    ASSERT_EQ(size.y, (float)HEIGHT);
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 100, 20, 30, 40);
+    sp_end_frame(canvas);
+
+    const uint8_t* inside = pixel(pixels, 110, 30, stride);
+    EXPECT_EQ(inside[0], 0); EXPECT_EQ(inside[1], 255); EXPECT_EQ(inside[2], 0); EXPECT_EQ(inside[3], 255);
+    const uint8_t* outside = pixel(pixels, 99, 30, stride);
+    EXPECT_EQ(outside[0], 0); EXPECT_EQ(outside[1], 0); EXPECT_EQ(outside[2], 0); EXPECT_EQ(outside[3], 255);
+    for (int y = 0; y < HEIGHT; ++y) for (size_t i = WIDTH * 4; i < stride; ++i) ASSERT_EQ(pixels[y * stride + i], 0);
+
+    sp_frame_stats_t stats;
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 1u);
+    EXPECT_GE(stats.gpu_ms, 0.0);
+    ASSERT_EQ(sp_request_readback(canvas), 0u);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, EdgesAreAntialiased) {
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 1);
+    ASSERT_NE(canvas, nullptr);
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    // Half of column 20 is covered.
+    sp_fill_rect(canvas, 10.0f, 10.0f, 10.5f, 20.0f);
+    sp_fill_circle(canvas, 80.0f, 48.0f, 30.0f);
+    sp_end_frame(canvas);
+
+    EXPECT_EQ(pixel(pixels, 19, 15)[0], 255);
+    EXPECT_EQ(pixel(pixels, 20, 15)[0], 128);
+    EXPECT_EQ(pixel(pixels, 21, 15)[0], 0);
+    EXPECT_EQ(pixel(pixels, 80, 48)[0], 255);
+    int partial = 0;
+    for (int x = 40; x < 120; ++x) {
+        const uint8_t v = pixel(pixels, x, 48 - 21)[0];
+        partial += v > 0 && v < 255;
+    }
+    EXPECT_GE(partial, 2);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, ThreadCountDoesNotChangeTheImage) {
+    std::vector<uint8_t> single, multi;
+    sp_canvas_t* one = createCanvas(single, 1);
+    sp_canvas_t* many = createCanvas(multi, 4);
+    ASSERT_NE(one, nullptr);
+    ASSERT_NE(many, nullptr);
+    drawScene(one);
+    drawScene(many);
+    EXPECT_EQ(single, multi);
+    sp_destroy_canvas(one);
+    sp_destroy_canvas(many);
+}
+
+TEST(SpirocoreSoftwareTest, ClearsKeepTheirPlaceInTheFrame) {
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 2);
+    ASSERT_NE(canvas, nullptr);
+    sp_begin_frame(canvas);
+    sp_set_color(canvas, {1.0f, 0.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 0, 0, 40, 40);
+    sp_clear(canvas, {0.0f, 0.0f, 1.0f, 1.0f});
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(canvas, 20, 20, 40, 40);
+    sp_end_frame(canvas);
+
+    const uint8_t* cleared = pixel(pixels, 5, 5);
+    EXPECT_EQ(cleared[0], 0); EXPECT_EQ(cleared[2], 255);
+    const uint8_t* drawn = pixel(pixels, 30, 30);
+    EXPECT_EQ(drawn[0], 0); EXPECT_EQ(drawn[1], 255);
+
+    std::vector<uint8_t> copy((size_t)WIDTH * HEIGHT * 4);
+    ASSERT_TRUE(sp_read_pixels(canvas, copy.data(), copy.size()));
+    EXPECT_EQ(copy, pixels);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, BlendModesMatchTheirFormulas) {
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 2);
+    ASSERT_NE(canvas, nullptr);
+    struct Case { sp_blend_mode_t mode; sp_color_rgba_t color; int r, g, b; };
+    // Over a 0.25 gray: overlay doubles the product where the destination is dark.
+    const Case cases[] = {
+        {SP_BLEND_MODE_NORMAL, {0.0f, 0.0f, 1.0f, 1.0f}, 0, 0, 255},
+        {SP_BLEND_MODE_ADD, {0.5f, 0.0f, 0.0f, 1.0f}, 192, 64, 64},
+        {SP_BLEND_MODE_MULTIPLY, {0.5f, 1.0f, 0.0f, 1.0f}, 32, 64, 0},
+        {SP_BLEND_MODE_SCREEN, {0.5f, 0.0f, 0.0f, 1.0f}, 160, 64, 64},
+        {SP_BLEND_MODE_OVERLAY, {1.0f, 0.0f, 0.0f, 1.0f}, 128, 0, 0},
+    };
+    for (int frame = 0; frame < 2; ++frame) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.25f, 0.25f, 0.25f, 1.0f});
+        // Each band crosses tile edges, and the second frame starts in the last frame's mode.
+        for (int i = 0; i < 5; ++i) {
+            sp_set_blend_mode(canvas, cases[i].mode);
+            sp_set_color(canvas, cases[i].color);
+            sp_fill_rect(canvas, 4, 4 + i * 18.0f, 150, 14);
+        }
+        sp_end_frame(canvas);
+        for (int i = 0; i < 5; ++i)
+            for (int x : {10, 80, 150}) {
+                const uint8_t* p = pixel(pixels, x, 10 + i * 18);
+                EXPECT_NEAR(p[0], cases[i].r, 2) << i; EXPECT_NEAR(p[1], cases[i].g, 2) << i; EXPECT_NEAR(p[2], cases[i].b, 2) << i;
+                EXPECT_EQ(p[3], 255);
+            }
+    }
+    sp_frame_stats_t stats;
+    ASSERT_TRUE(sp_get_frame_stats(canvas, &stats));
+    EXPECT_EQ(stats.draw_calls, 5u);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, FillsAnyOutlineUnderEitherRule) {
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 2);
+    ASSERT_NE(canvas, nullptr);
+    sp_path_t* star = sp_create_path(canvas);
+    for (int i = 0; i < 5; ++i) {
+        const float angle = -1.5707963f + i * 2.5132741f;
+        if (i == 0) sp_path_move_to(star, 48.0f + 40.0f * std::cos(angle), 48.0f + 40.0f * std::sin(angle));
+        else sp_path_line_to(star, 48.0f + 40.0f * std::cos(angle), 48.0f + 40.0f * std::sin(angle));
+    }
+    // A wavy ring too large for ear clipping, so it takes the scanline path as well.
+    sp_path_t* ring = sp_create_path(canvas);
+    for (int i = 0; i < 400; ++i) {
+        const float angle = i * 6.2831853f / 400, r = 24.0f + 4.0f * std::sin(angle * 12);
+        if (i == 0) sp_path_move_to(ring, 128.0f + r * std::cos(angle), 48.0f + r * std::sin(angle));
+        else sp_path_line_to(ring, 128.0f + r * std::cos(angle), 48.0f + r * std::sin(angle));
+    }
+    for (sp_fill_rule_t rule : {SP_FILL_RULE_NONZERO, SP_FILL_RULE_EVEN_ODD}) {
+        sp_begin_frame(canvas);
+        sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+        sp_set_fill_rule(canvas, rule);
+        sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+        sp_fill_path(canvas, star);
+        sp_fill_path(canvas, ring);
+        sp_end_frame(canvas);
+        EXPECT_EQ(pixel(pixels, 48, 48)[1], rule == SP_FILL_RULE_NONZERO ? 255 : 0);
+        EXPECT_EQ(pixel(pixels, 48, 20)[1], 255);
+        EXPECT_EQ(pixel(pixels, 128, 48)[1], 255);
+        EXPECT_EQ(pixel(pixels, 128, 90)[1], 0);
+        // Edges are antialiased like the rest of the rasterizer's output.
+        bool partial = false;
+        for (int x = 140; x < 160; ++x) partial = partial || (pixel(pixels, x, 48)[1] > 0 && pixel(pixels, x, 48)[1] < 255);
+        EXPECT_TRUE(partial);
+    }
+    sp_destroy_path(ring);
+    sp_destroy_path(star);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, CurvesFlattenForTheCurrentZoom) {
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 1);
+    ASSERT_NE(canvas, nullptr);
+    // A square with rounded corners of radius 10 from arc_to, and a cubic wave.
+    sp_path_t* rounded = sp_create_path(canvas);
+    sp_path_move_to(rounded, 40, 10);
+    sp_path_arc_to(rounded, 60, 10, 60, 50, 10);
+    sp_path_arc_to(rounded, 60, 50, 20, 50, 10);
+    sp_path_arc_to(rounded, 20, 50, 20, 10, 10);
+    sp_path_arc_to(rounded, 20, 10, 60, 10, 10);
+    sp_path_t* wave = sp_create_path(canvas);
+    sp_path_move_to(wave, 0, 5);
+    sp_path_cubic_bezier_to(wave, 3, -2, 6, 12, 9, 5);
+    sp_pen_config_t penConfig = {0.1f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f};
+    sp_pen_t* pen = sp_create_pen(canvas, &penConfig);
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(canvas, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_path(canvas, rounded);
+    sp_end_frame(canvas);
+    EXPECT_EQ(pixel(pixels, 40, 30)[1], 255);
+    EXPECT_EQ(pixel(pixels, 21, 30)[1], 255);
+    EXPECT_EQ(pixel(pixels, 40, 11)[1], 255);
+    // The corners are cut round: (20, 10) is outside the arc around (30, 20).
+    EXPECT_EQ(pixel(pixels, 21, 11)[1], 0);
+    EXPECT_EQ(pixel(pixels, 58, 48)[1], 0);
+
+    auto strokedVertices = [&](float zoom) {
+        sp_begin_frame(canvas);
+        sp_set_pen(canvas, pen);
+        sp_scale(canvas, zoom, zoom);
+        sp_stroke_path(canvas, wave);
+        sp_reset_transform(canvas);
+        sp_end_frame(canvas);
+        sp_frame_stats_t stats;
+        EXPECT_TRUE(sp_get_frame_stats(canvas, &stats));
+        return stats.vertices;
+    };
+    const uint64_t far = strokedVertices(1.0f), near = strokedVertices(8.0f);
+    EXPECT_GT(far, 0u);
+    EXPECT_GT(near, far * 2);
+    EXPECT_EQ(strokedVertices(8.0f), near);
+    EXPECT_EQ(strokedVertices(1.0f), far);
+
+    sp_destroy_pen(pen);
+    sp_destroy_path(wave);
+    sp_destroy_path(rounded);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, DrawsTextFromTheGlyphAtlas) {
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 2);
+    ASSERT_NE(canvas, nullptr);
+    sp_font_t* font = sp_load_font(canvas, "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+    if (!font) { sp_destroy_canvas(canvas); GTEST_SKIP() << "DejaVu Sans is not installed."; }
+    sp_set_font(canvas, font, 40.0f);
+    const sp_rect_t box = sp_measure_text(canvas, "Hi");
+    ASSERT_GT(box.w, 0.0f);
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {1.0f, 1.0f, 1.0f, 1.0f});
+    sp_set_color(canvas, {0.0f, 0.0f, 1.0f, 1.0f});
+    sp_draw_text(canvas, "Hi", 10.0f, 60.0f);
+    sp_end_frame(canvas);
+
+    // Ink only inside the measured line box, solid in the strokes and smooth at their edges.
+    int solid = 0, partial = 0;
+    for (int y = 0; y < HEIGHT; ++y)
+        for (int x = 0; x < WIDTH; ++x) {
+            const uint8_t* p = pixel(pixels, x, y);
+            if (p[0] == 255) continue;
+            EXPECT_GE(x, (int)(10.0f + box.x) - 1); EXPECT_LE(x, (int)std::ceil(10.0f + box.x + box.w) + 1);
+            EXPECT_GE(y, (int)(60.0f + box.y) - 1); EXPECT_LE(y, (int)std::ceil(60.0f + box.y + box.h) + 1);
+            EXPECT_EQ(p[2], 255);
+            solid += p[0] == 0;
+            partial += p[0] > 0;
+        }
+    EXPECT_GT(solid, 100);
+    EXPECT_GT(partial, 20);
+    // The H's left stem sits between the pen origin and the first few pixels of the run.
+    EXPECT_EQ(pixel(pixels, 16, 45)[0], 0);
+    sp_destroy_font(font);
+    sp_destroy_canvas(canvas);
+}
+
+TEST(SpirocoreSoftwareTest, DrawsImagesInTheirOwnColors) {
+    // A red/green image, made and saved on a software canvas of its own.
+    std::vector<uint8_t> source;
+    sp_canvas_t* painter = createCanvas(source, 1);
+    ASSERT_NE(painter, nullptr);
+    sp_begin_frame(painter);
+    sp_clear(painter, {1.0f, 0.0f, 0.0f, 1.0f});
+    sp_set_color(painter, {0.0f, 1.0f, 0.0f, 1.0f});
+    sp_fill_rect(painter, WIDTH / 2, 0, WIDTH / 2, HEIGHT);
+    sp_end_frame(painter);
+    const char* path = "spiro_software_image.png";
+    ASSERT_TRUE(sp_save_png(painter, path));
+    sp_destroy_canvas(painter);
+
+    std::vector<uint8_t> pixels;
+    sp_canvas_t* canvas = createCanvas(pixels, 2);
+    ASSERT_NE(canvas, nullptr);
+    sp_image_t* image = sp_load_image(canvas, path);
+    ASSERT_NE(image, nullptr);
+    sp_image_t* async = sp_load_image_async(canvas, path);
+    ASSERT_NE(async, nullptr);
+    EXPECT_EQ(sp_get_image_status(async), SP_IMAGE_READY);
+
+    sp_begin_frame(canvas);
+    sp_clear(canvas, {0.0f, 0.0f, 0.0f, 1.0f});
+    sp_draw_image_rect(canvas, image, {0, 0, WIDTH, HEIGHT}, {0, 0, WIDTH / 2, HEIGHT / 2});
+    sp_draw_image_rect(canvas, async, {WIDTH / 2, 0, WIDTH / 2, HEIGHT}, {0, HEIGHT / 2, WIDTH / 2, HEIGHT / 2});
+    sp_end_frame(canvas);
+
+    const uint8_t* red = pixel(pixels, 10, 10);
+    EXPECT_EQ(red[0], 255); EXPECT_EQ(red[1], 0);
+    const uint8_t* green = pixel(pixels, 70, 10);
+    EXPECT_EQ(green[0], 0); EXPECT_EQ(green[1], 255);
+    const uint8_t* cropped = pixel(pixels, 10, 70);
+    EXPECT_EQ(cropped[0], 0); EXPECT_EQ(cropped[1], 255);
+    const uint8_t* outside = pixel(pixels, 120, 10);
+    EXPECT_EQ(outside[0], 0); EXPECT_EQ(outside[1], 0);
+    sp_destroy_image(async);
+    sp_destroy_image(image);
+    sp_destroy_canvas(canvas);
+    std::remove(path);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "stroke_kernel.hpp"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+std::vector<sp_vec2_t> randomPolyline(size_t points, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coord(-2000.0f, 2000.0f);
+    std::vector<sp_vec2_t> result(points);
+    for (size_t i = 0; i < points; ++i) {
+        // Repeat points now and then so zero-length segments are covered.
+        if (i > 0 && rng() % 7 == 0) result[i] = result[i - 1];
+        else result[i] = {coord(rng), coord(rng)};
+    }
+    return result;
+}
+
+}
+
+TEST(SpirocoreStrokeKernelTest, EveryVariantMatchesScalarReferenceBitForBit) {
+    const StrokeParams params{1.75f, {0.8f, 0.6f, -0.6f, 0.8f, 13.25f, -7.5f}, packColor(0.1f, 0.2f, 0.3f, 1.0f)};
+    const SimdLevel levels[] = {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON};
+    for (size_t segments : {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 1001}) {
+        auto points = randomPolyline(segments + 1, (unsigned)segments);
+        std::vector<Vertex> expected(segments * VERTICES_PER_QUAD), actual(segments * VERTICES_PER_QUAD);
+        strokeSegmentsScalar(points.data(), segments, params, expected.data());
+        for (SimdLevel level : levels) {
+            StrokeKernel kernel = strokeKernel(level);
+            if (!kernel) continue;
+            std::fill(actual.begin(), actual.end(), Vertex{});
+            kernel(points.data(), segments, params, actual.data());
+            ASSERT_EQ(std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(Vertex)), 0)
+                << simdLevelName(level) << " differs with " << segments << " segments";
+        }
+    }
+}
+
+TEST(SpirocoreStrokeKernelTest, QuadIsOffsetAlongTheSegmentNormal) {
+    const sp_vec2_t points[] = {{0.0f, 0.0f}, {10.0f, 0.0f}, {10.0f, 0.0f}};
+    const StrokeParams params{2.0f, {1, 0, 0, 1, 5, 5}, 0xFFFFFFFFu};
+    Vertex out[2 * VERTICES_PER_QUAD];
+    strokeSegments(points, 2, params, out);
+    EXPECT_EQ(out[0].position, glm::vec2(5.0f, 3.0f));
+    EXPECT_EQ(out[1].position, glm::vec2(15.0f, 3.0f));
+    EXPECT_EQ(out[2].position, glm::vec2(15.0f, 7.0f));
+    EXPECT_EQ(out[3].position, glm::vec2(5.0f, 7.0f));
+    EXPECT_EQ(out[0].texSlot, NO_TEXTURE_SLOT);
+    // A degenerate segment collapses to its (transformed) point instead of producing NaNs.
+    for (size_t v = VERTICES_PER_QUAD; v < 2 * VERTICES_PER_QUAD; ++v) EXPECT_EQ(out[v].position, glm::vec2(15.0f, 5.0f));
+}
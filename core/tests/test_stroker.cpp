@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "stroker.hpp"
+
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+struct Quad {
+    glm::vec2 a, b, c, d;
+};
+
+std::vector<Quad> strokeQuads(const std::vector<sp_vec2_t>& points, bool closed, StrokeStyle style, float pixelScale = 1.0f)
+{
+    std::vector<Quad> quads;
+    auto emit = [&](glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d) { quads.push_back({a, b, c, d}); };
+    Stroker<decltype(emit)> stroker(style, pixelScale, emit);
+    stroker.stroke(points.data(), points.size(), closed);
+    return quads;
+}
+
+const std::vector<sp_vec2_t> RIGHT_ANGLE = {{0, 0}, {10, 0}, {10, 10}};
+
+}
+
+TEST(SpirocoreStrokerTest, MiterJoinSharesTheCornerBetweenSegments) {
+    auto quads = strokeQuads(RIGHT_ANGLE, false, {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f});
+    ASSERT_EQ(quads.size(), 2u);
+    // The first segment ends on the edge the second starts on: inner corner (9, 1), outer miter (11, -1).
+    EXPECT_EQ(quads[0].b, quads[1].a);
+    EXPECT_EQ(quads[0].c, quads[1].d);
+    EXPECT_FLOAT_EQ(quads[0].b.x, 9.0f);
+    EXPECT_FLOAT_EQ(quads[0].b.y, 1.0f);
+    EXPECT_FLOAT_EQ(quads[0].c.x, 11.0f);
+    EXPECT_FLOAT_EQ(quads[0].c.y, -1.0f);
+}
+
+TEST(SpirocoreStrokerTest, MiterLimitFallsBackToBevel) {
+    // A 90 degree miter has ratio sqrt(2); a limit below that must bevel.
+    auto mitered = strokeQuads(RIGHT_ANGLE, false, {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 1.5f});
+    auto limited = strokeQuads(RIGHT_ANGLE, false, {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 1.2f});
+    auto beveled = strokeQuads(RIGHT_ANGLE, false, {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_BEVEL, 10.0f});
+    EXPECT_EQ(mitered.size(), 2u);
+    ASSERT_EQ(limited.size(), 3u);
+    ASSERT_EQ(beveled.size(), 3u);
+    // The bevel is a single triangle (last corner repeated), emitted before the segment reaching it.
+    EXPECT_EQ(beveled[0].c, beveled[0].d);
+}
+
+TEST(SpirocoreStrokerTest, RoundJoinDensityFollowsOnScreenWidth) {
+    StrokeStyle style{2.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_ROUND, 4.0f};
+    const size_t thin = strokeQuads(RIGHT_ANGLE, false, style, 1.0f).size();
+    const size_t zoomed = strokeQuads(RIGHT_ANGLE, false, style, 20.0f).size();
+    EXPECT_GT(thin, 2u);
+    EXPECT_GT(zoomed, thin);
+}
+
+TEST(SpirocoreStrokerTest, CapsExtendOrRoundTheEnds) {
+    const std::vector<sp_vec2_t> line = {{0, 0}, {10, 0}};
+    auto butt = strokeQuads(line, false, {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f});
+    auto square = strokeQuads(line, false, {1.0f, SP_LINE_CAP_SQUARE, SP_LINE_JOIN_MITER, 4.0f});
+    auto round = strokeQuads(line, false, {1.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_MITER, 4.0f});
+    ASSERT_EQ(butt.size(), 1u);
+    EXPECT_FLOAT_EQ(butt[0].a.x, 0.0f);
+    EXPECT_FLOAT_EQ(butt[0].b.x, 10.0f);
+    ASSERT_EQ(square.size(), 1u);
+    EXPECT_FLOAT_EQ(square[0].a.x, -1.0f);
+    EXPECT_FLOAT_EQ(square[0].b.x, 11.0f);
+    EXPECT_GT(round.size(), 2u);
+}
+
+TEST(SpirocoreStrokerTest, ClosedPathJoinsInsteadOfCapping) {
+    const std::vector<sp_vec2_t> square = {{0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 0}};
+    auto quads = strokeQuads(square, true, {1.0f, SP_LINE_CAP_ROUND, SP_LINE_JOIN_MITER, 4.0f});
+    ASSERT_EQ(quads.size(), 4u);
+    EXPECT_EQ(quads[3].b, quads[0].a);
+    EXPECT_EQ(quads[3].c, quads[0].d);
+}
+
+TEST(SpirocoreStrokerTest, DuplicatePointsAreSkipped) {
+    const std::vector<sp_vec2_t> points = {{0, 0}, {0, 0}, {10, 0}, {10, 0}, {10, 10}};
+    auto quads = strokeQuads(points, false, {1.0f, SP_LINE_CAP_BUTT, SP_LINE_JOIN_MITER, 4.0f});
+    ASSERT_EQ(quads.size(), 2u);
+    for (const Quad& q : quads)
+        for (glm::vec2 v : {q.a, q.b, q.c, q.d}) EXPECT_FALSE(std::isnan(v.x) || std::isnan(v.y));
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "utf8.hpp"
+
+#include <vector>
+
+using namespace spiro::internal;
+
+namespace {
+
+std::vector<uint32_t> decodeAll(const char* text)
+{
+    std::vector<uint32_t> out;
+    for (const char* p = text; *p;) out.push_back(decodeUtf8(p));
+    return out;
+}
+
+}
+
+TEST(SpirocoreUtf8Test, DecodesEveryEncodedLength) {
+    // "A", e-acute, euro sign, and U+1F600.
+    EXPECT_EQ(decodeAll("A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"), (std::vector<uint32_t>{0x41, 0xE9, 0x20AC, 0x1F600}));
+}
+
+TEST(SpirocoreUtf8Test, MalformedInputBecomesReplacementCharacters) {
+    const uint32_t R = REPLACEMENT_CHARACTER;
+    // Stray continuation byte, then a lead byte followed by ASCII.
+    EXPECT_EQ(decodeAll("\x80" "a\xC3" "b"), (std::vector<uint32_t>{R, 'a', R, 'b'}));
+    // Overlong "/" and an encoded surrogate are rejected byte by byte.
+    EXPECT_EQ(decodeAll("\xC0\xAF"), (std::vector<uint32_t>{R, R}));
+    EXPECT_EQ(decodeAll("\xED\xA0\x80"), (std::vector<uint32_t>{R, R, R}));
+    // A sequence cut short by the terminator stops there.
+    EXPECT_EQ(decodeAll("\xE2\x82"), (std::vector<uint32_t>{R, R}));
+}
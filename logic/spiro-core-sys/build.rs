@@ -29,6 +29,18 @@ fn main() {
         }
     }
 
+    // CMake only links EGL when it found it (SPIRO_WITH_EGL / OpenGL_EGL_FOUND) and records
+    // the decision next to the library. Installs from before the file existed always had it.
+    let features_path = lib_dir.join("spiro-core-features.txt");
+    println!("cargo:rerun-if-changed={}", features_path.display());
+    let use_egl = match std::fs::read_to_string(&features_path) {
+        Ok(features) => features
+            .lines()
+            .filter_map(|line| line.split_once('='))
+            .any(|(key, value)| key.trim() == "SPIRO_USE_EGL" && value.trim() == "ON"),
+        Err(_) => true,
+    };
+
     println!("cargo:rustc-link-search=native={}", lib_dir.display());
     println!("cargo:rustc-link-lib=static=spiro-core");
     println!("cargo:rustc-link-lib=static=glfw3"); // Corrected name from 'glfw' to 'glfw3'
@@ -41,6 +53,9 @@ fn main() {
         println!("cargo:rustc-link-lib=dylib=Xcursor");
         println!("cargo:rustc-link-lib=dylib=Xi");
         println!("cargo:rustc-link-lib=dylib=GL");
+        if use_egl {
+            println!("cargo:rustc-link-lib=dylib=EGL");
+        }
     } else if cfg!(target_os = "macos") {
         println!("cargo:rustc-link-lib=dylib=c++");
         println!("cargo:rustc-link-lib=framework=Cocoa");
@@ -73,6 +88,8 @@ fn main() {
         .opaque_type("sp_font_t")
         .opaque_type("sp_gradient_t")
         .opaque_type("sp_shader_t")
+        .opaque_type("sp_mesh_t")
+        .opaque_type("sp_draw_list_t")
         
         .default_enum_style(bindgen::EnumVariation::Rust { non_exhaustive: false })
         
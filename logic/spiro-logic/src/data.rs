@@ -101,7 +101,9 @@ impl AxisConfig {
 #[pyclass]
 #[derive(Debug, Clone)]
 pub struct LineArtist {
-    #[pyo3(get, set)] pub points: Vec<Vec2>,
+    /// An (N, 2) or flat [x0, y0, x1, y1, ...] float32/float64 buffer, or a sequence of Vec2.
+    /// Buffers are read in place at render time rather than converted point by point.
+    #[pyo3(get, set)] pub points: PyObject,
     #[pyo3(get, set)] pub color: Color,
     #[pyo3(get, set)] pub linewidth: f32,
     #[pyo3(get, set)] pub style: LineStyle,
@@ -109,7 +111,23 @@ pub struct LineArtist {
 
 #[pymethods]
 impl LineArtist {
-    #[new] fn new(points: Vec<Vec2>, color: Color, linewidth: f32, style: LineStyle) -> Self { LineArtist { points, color, linewidth, style } }
+    #[new] fn new(points: PyObject, color: Color, linewidth: f32, style: LineStyle) -> Self { LineArtist { points, color, linewidth, style } }
+}
+
+#[pyclass]
+#[derive(Debug, Clone)]
+pub struct ScatterArtist {
+    /// Marker centers, in any of the layouts LineArtist accepts.
+    #[pyo3(get, set)] pub points: PyObject,
+    #[pyo3(get, set)] pub color: Color,
+    /// Marker width in pixels, whatever the axes scale.
+    #[pyo3(get, set)] pub size: f32,
+    #[pyo3(get, set)] pub marker: MarkerStyle,
+}
+
+#[pymethods]
+impl ScatterArtist {
+    #[new] fn new(points: PyObject, color: Color, size: f32, marker: MarkerStyle) -> Self { ScatterArtist { points, color, size, marker } }
 }
 
 #[pyclass]
@@ -129,6 +147,7 @@ impl TextArtist {
 #[derive(Debug, FromPyObject)]
 pub enum Artist {
     Line(LineArtist),
+    Scatter(ScatterArtist),
     Text(TextArtist),
 }
 
@@ -3,6 +3,9 @@
 // Date: June 13, 2025
 
 use pyo3::prelude::*;
+use pyo3::buffer::PyBuffer;
+use pyo3::exceptions::{PyIOError, PyRuntimeError, PyValueError};
+use std::ffi::CString;
 
 mod data;
 use spiro_core_sys as ffi;
@@ -11,74 +14,283 @@ fn to_c_color(color: &data::Color) -> ffi::sp_color_rgba_t {
     ffi::sp_color_rgba_t { r: color.r, g: color.g, b: color.b, a: color.a }
 }
 
+enum PointStorage {
+    // Keeps the exporter's memory pinned until dropped; the core reads it in place.
+    Borrowed(PyBuffer<f32>),
+    Owned(Vec<f32>),
+}
+
+/// `count` points for sp_path_set_points, each an x, y float pair starting every `stride` bytes.
+struct LinePoints {
+    storage: PointStorage,
+    count: usize,
+    stride: usize,
+}
+
+impl LinePoints {
+    fn packed(values: Vec<f32>, count: usize) -> Self {
+        LinePoints { storage: PointStorage::Owned(values), count, stride: 2 * std::mem::size_of::<f32>() }
+    }
+
+    fn as_ptr(&self) -> *const f32 {
+        match &self.storage {
+            PointStorage::Borrowed(view) => view.buf_ptr() as *const f32,
+            PointStorage::Owned(values) => values.as_ptr(),
+        }
+    }
+}
+
+/// A line artist resolved while holding the GIL, so it can be drawn after releasing it.
+struct LineDraw {
+    points: LinePoints,
+    color: ffi::sp_color_rgba_t,
+    linewidth: f32,
+}
+
+/// Artists in drawing order, each resolved while holding the GIL.
+enum ArtistDraw {
+    Line(LineDraw),
+    // Scatter points as the core's per-instance marker records.
+    Markers(Vec<ffi::sp_marker_t>),
+}
+
+fn xy_count(shape: &[usize]) -> PyResult<usize> {
+    match shape {
+        [n, 2] => Ok(*n),
+        [n] if n % 2 == 0 => Ok(n / 2),
+        _ => Err(PyValueError::new_err("Line points must be an (N, 2) array or a flat [x0, y0, x1, y1, ...] array")),
+    }
+}
+
+fn line_points(obj: &Bound<'_, PyAny>) -> PyResult<LinePoints> {
+    let py = obj.py();
+    if let Ok(view) = PyBuffer::<f32>::get_bound(obj) {
+        let count = xy_count(view.shape())?;
+        // Rows of adjacent x, y floats are read in place whatever their spacing.
+        let stride = match (view.shape(), view.strides()) {
+            ([_, 2], &[row, 4]) if row >= 8 => Some(row as usize),
+            ([_], &[4]) => Some(8),
+            _ => None,
+        };
+        return Ok(match stride {
+            Some(stride) => LinePoints { storage: PointStorage::Borrowed(view), count, stride },
+            None => LinePoints::packed(view.to_vec(py)?, count),
+        });
+    }
+    if let Ok(view) = PyBuffer::<f64>::get_bound(obj) {
+        let count = xy_count(view.shape())?;
+        let values = match view.as_slice(py) {
+            Some(cells) => cells.iter().map(|cell| cell.get() as f32).collect(),
+            None => view.to_vec(py)?.into_iter().map(|v| v as f32).collect(),
+        };
+        return Ok(LinePoints::packed(values, count));
+    }
+    let points: Vec<data::Vec2> = obj.extract()?;
+    Ok(LinePoints::packed(points.iter().flat_map(|p| [p.x, p.y]).collect(), points.len()))
+}
+
+fn marker_shape(marker: data::MarkerStyle) -> ffi::sp_marker_shape_t {
+    match marker {
+        data::MarkerStyle::Circle => ffi::sp_marker_shape_t::SP_MARKER_CIRCLE,
+        data::MarkerStyle::Square => ffi::sp_marker_shape_t::SP_MARKER_SQUARE,
+        data::MarkerStyle::Triangle => ffi::sp_marker_shape_t::SP_MARKER_TRIANGLE,
+        data::MarkerStyle::Cross => ffi::sp_marker_shape_t::SP_MARKER_CROSS,
+        data::MarkerStyle::Plus => ffi::sp_marker_shape_t::SP_MARKER_PLUS,
+    }
+}
+
+fn scatter_markers(py: Python<'_>, scatter: &data::ScatterArtist) -> PyResult<Vec<ffi::sp_marker_t>> {
+    let points = line_points(scatter.points.bind(py))?;
+    let color = unsafe { ffi::sp_pack_color(to_c_color(&scatter.color)) };
+    let shape = marker_shape(scatter.marker);
+    let base = points.as_ptr() as *const u8;
+    Ok((0..points.count)
+        .map(|i| {
+            // Every layout line_points returns has an x, y float pair at the start of each stride.
+            let xy = unsafe { std::slice::from_raw_parts(base.add(i * points.stride) as *const f32, 2) };
+            ffi::sp_marker_t { x: xy[0], y: xy[1], size: scatter.size, color, shape }
+        })
+        .collect())
+}
+
+fn collect_artists(py: Python<'_>, figure: &data::Figure) -> PyResult<Vec<ArtistDraw>> {
+    let mut artists = Vec::new();
+    for axes_obj in &figure.axes {
+        let axes_data = axes_obj.downcast_bound::<data::PlotAxes>(py)?;
+        for artist_obj in &axes_data.borrow().artists {
+            if let Ok(line) = artist_obj.downcast_bound::<data::LineArtist>(py) {
+                let line = line.borrow();
+                artists.push(ArtistDraw::Line(LineDraw {
+                    points: line_points(line.points.bind(py))?,
+                    color: to_c_color(&line.color),
+                    linewidth: line.linewidth,
+                }));
+            } else if let Ok(scatter) = artist_obj.downcast_bound::<data::ScatterArtist>(py) {
+                artists.push(ArtistDraw::Markers(scatter_markers(py, &scatter.borrow())?));
+            }
+        }
+    }
+    Ok(artists)
+}
+
+/// Upper bound on one sleep of the event-driven render loop.
+const IDLE_WAIT_SECONDS: f64 = 0.5;
+
 #[pyfunction]
 fn render_figure(py: Python<'_>, figure: &data::Figure) -> PyResult<()> {
-    let window_config = ffi::sp_window_config_t {
-        width: figure.size_pixels.0 as i32,
-        height: figure.size_pixels.1 as i32,
-        title: "Spirographicals".as_ptr() as *const i8,
-        resizable: true,
-        vsync: true,
-    };
+    let (width, height) = (figure.size_pixels.0 as i32, figure.size_pixels.1 as i32);
+    let face_color = to_c_color(&figure.face_color);
+    let artists = collect_artists(py, figure)?;
+
+    // Rendering only touches the collected artists, so other Python threads keep running while
+    // the window is open.
+    py.allow_threads(|| unsafe {
+        let window_config = ffi::sp_window_config_t {
+            width,
+            height,
+            title: "Spirographicals".as_ptr() as *const i8,
+            resizable: true,
+            vsync: true,
+        };
 
-    unsafe {
         ffi::sp_initialize();
         let canvas = ffi::sp_create_canvas(&window_config);
         if canvas.is_null() {
-            return Err(pyo3::exceptions::PyRuntimeError::new_err("Failed to create canvas"));
+            return Err(PyRuntimeError::new_err("Failed to create canvas"));
         }
 
+        // The lines cannot change once collected, so every line is tessellated once into a
+        // GPU-resident mesh and each frame only replays the meshes. A large x-sorted line is
+        // the exception: its mesh keeps the samples and the core decimates them to the window's
+        // pixel columns at each draw. Markers are instanced and already cost one draw per artist.
+        let meshes = build_meshes(canvas, &artists);
+
+        // Nothing changes between frames either, so a frame is only drawn when the window needs
+        // one (the first, and after a resize). In between the thread sleeps on window events;
+        // repaints of an uncovered window re-present the last frame.
         while !ffi::sp_canvas_should_close(canvas) {
-            ffi::sp_begin_frame(canvas);
-            ffi::sp_clear(canvas, to_c_color(&figure.face_color));
-
-            for axes_obj in &figure.axes {
-                let axes_data = axes_obj.downcast_bound::<data::PlotAxes>(py)?;
-                for artist_obj in &axes_data.borrow().artists {
-                    if let Ok(line) = artist_obj.extract::<data::LineArtist>(py) {
-                        draw_line_artist(canvas, &line);
+            if ffi::sp_canvas_needs_redraw(canvas) {
+                ffi::sp_begin_frame(canvas);
+                ffi::sp_clear(canvas, face_color);
+                for (artist, &mesh) in artists.iter().zip(&meshes) {
+                    match artist {
+                        ArtistDraw::Line(_) if !mesh.is_null() => ffi::sp_draw_mesh(canvas, mesh),
+                        ArtistDraw::Line(line) => draw_line_artist(canvas, line),
+                        ArtistDraw::Markers(markers) => ffi::sp_draw_markers(canvas, markers.as_ptr(), markers.len()),
                     }
                 }
+                ffi::sp_end_frame(canvas);
             }
-            ffi::sp_end_frame(canvas);
+            ffi::sp_wait_events(canvas, IDLE_WAIT_SECONDS);
+        }
+
+        for mesh in meshes {
+            if !mesh.is_null() { ffi::sp_destroy_mesh(mesh); }
+        }
+        ffi::sp_destroy_canvas(canvas);
+        ffi::sp_terminate();
+        Ok(())
+    })
+}
+
+#[pyfunction]
+fn save_figure(py: Python<'_>, figure: &data::Figure, path: &str) -> PyResult<()> {
+    let (width, height) = (figure.size_pixels.0 as i32, figure.size_pixels.1 as i32);
+    let offscreen_config = ffi::sp_offscreen_config_t { width, height, readback_buffers: 1 };
+    let software_config = ffi::sp_software_config_t { width, height, pixels: std::ptr::null_mut(), stride: 0, threads: 0 };
+    let c_path = CString::new(path).map_err(|_| PyValueError::new_err("Path must not contain NUL bytes"))?;
+    let raw = path.ends_with(".raw") || path.ends_with(".rgba");
+    let face_color = to_c_color(&figure.face_color);
+    let artists = collect_artists(py, figure)?;
+
+    py.allow_threads(|| unsafe {
+        ffi::sp_initialize();
+        let mut canvas = ffi::sp_create_offscreen_canvas(&offscreen_config);
+        if canvas.is_null() {
+            // No GL at all (e.g. a headless server without Mesa): draw on the CPU instead.
+            canvas = ffi::sp_create_software_canvas(&software_config);
+        }
+        if canvas.is_null() {
+            ffi::sp_terminate();
+            return Err(PyRuntimeError::new_err("Failed to create offscreen canvas"));
         }
 
+        draw_figure(canvas, face_color, &artists);
+        let result = if raw {
+            let mut pixels = vec![0u8; width as usize * height as usize * 4];
+            if ffi::sp_read_pixels(canvas, pixels.as_mut_ptr(), pixels.len()) {
+                std::fs::write(path, &pixels).map_err(|e| PyIOError::new_err(e.to_string()))
+            } else {
+                Err(PyRuntimeError::new_err("Failed to read back canvas pixels"))
+            }
+        } else if ffi::sp_save_png(canvas, c_path.as_ptr()) {
+            Ok(())
+        } else {
+            Err(PyIOError::new_err(format!("Failed to write '{}'", path)))
+        };
+
         ffi::sp_destroy_canvas(canvas);
         ffi::sp_terminate();
+        result
+    })
+}
+
+unsafe fn draw_figure(canvas: *mut ffi::sp_canvas_t, face_color: ffi::sp_color_rgba_t, artists: &[ArtistDraw]) {
+    ffi::sp_begin_frame(canvas);
+    ffi::sp_clear(canvas, face_color);
+    for artist in artists {
+        match artist {
+            ArtistDraw::Line(line) => draw_line_artist(canvas, line),
+            ArtistDraw::Markers(markers) => ffi::sp_draw_markers(canvas, markers.as_ptr(), markers.len()),
+        }
     }
-    Ok(())
+    ffi::sp_end_frame(canvas);
+}
+
+/// One mesh per artist, null for markers and for lines that could not be captured.
+unsafe fn build_meshes(canvas: *mut ffi::sp_canvas_t, artists: &[ArtistDraw]) -> Vec<*mut ffi::sp_mesh_t> {
+    let mut meshes = Vec::new();
+    for artist in artists {
+        let mut mesh = std::ptr::null_mut();
+        if let ArtistDraw::Line(line) = artist {
+            if ffi::sp_begin_mesh(canvas) {
+                draw_line_artist(canvas, line);
+                mesh = ffi::sp_end_mesh(canvas);
+            }
+        }
+        meshes.push(mesh);
+    }
+    meshes
 }
 
-unsafe fn draw_line_artist(canvas: *mut ffi::sp_canvas_t, line: &data::LineArtist) {
-    if line.points.len() < 2 { return; }
+unsafe fn draw_line_artist(canvas: *mut ffi::sp_canvas_t, line: &LineDraw) {
+    if line.points.count < 2 { return; }
 
-    let path = ffi::sp_create_path(canvas);
+    // Frame objects come from the canvas's pools and go back at the next sp_begin_frame, so
+    // redrawing a figure does not allocate a path and pen per artist.
+    let path = ffi::sp_create_frame_path(canvas);
     if path.is_null() { return; }
-    ffi::sp_path_move_to(path, line.points[0].x, line.points[0].y);
-    for point in line.points.iter().skip(1) {
-        ffi::sp_path_line_to(path, point.x, point.y);
-    }
-    
+    // Borrows the artist's buffer for the lifetime of the path; no per-point calls.
+    ffi::sp_path_set_points(path, line.points.as_ptr(), line.points.count, line.points.stride);
+
     let pen_config = ffi::sp_pen_config_t {
         line_width: line.linewidth,
         line_cap: ffi::sp_line_cap_t::SP_LINE_CAP_ROUND,
         line_join: ffi::sp_line_join_t::SP_LINE_JOIN_ROUND,
         miter_limit: 10.0,
     };
-    let pen = ffi::sp_create_pen(canvas, &pen_config);
-    if pen.is_null() { ffi::sp_destroy_path(path); return; }
+    let pen = ffi::sp_create_frame_pen(canvas, &pen_config);
+    if pen.is_null() { return; }
 
     ffi::sp_set_pen(canvas, pen);
-    ffi::sp_set_color(canvas, to_c_color(&line.color));
+    ffi::sp_set_color(canvas, line.color);
     ffi::sp_stroke_path(canvas, path);
-
-    ffi::sp_destroy_pen(pen);
-    ffi::sp_destroy_path(path);
 }
 
 #[pymodule]
 fn spirographicals(_py: Python<'_>, m: &Bound<'_, PyModule>) -> PyResult<()> {
     m.add_function(wrap_pyfunction!(render_figure, m)?)?;
+    m.add_function(wrap_pyfunction!(save_figure, m)?)?;
     m.add_class::<data::HorizontalAlign>()?;
     m.add_class::<data::VerticalAlign>()?;
     m.add_class::<data::LineStyle>()?;
@@ -89,8 +301,88 @@ fn spirographicals(_py: Python<'_>, m: &Bound<'_, PyModule>) -> PyResult<()> {
     m.add_class::<data::GridConfig>()?;
     m.add_class::<data::AxisConfig>()?;
     m.add_class::<data::LineArtist>()?;
+    m.add_class::<data::ScatterArtist>()?;
     m.add_class::<data::TextArtist>()?;
     m.add_class::<data::PlotAxes>()?;
     m.add_class::<data::Figure>()?;
     Ok(())
 }
+
+#[cfg(test)]
+mod tests {
+    use pyo3::types::PySlice;
+
+    use super::*;
+
+    fn read(points: &LinePoints) -> Vec<(f32, f32)> {
+        let base = points.as_ptr() as *const u8;
+        (0..points.count)
+            .map(|i| unsafe {
+                let xy = base.add(i * points.stride) as *const f32;
+                (*xy, *xy.add(1))
+            })
+            .collect()
+    }
+
+    fn float_array<'py>(py: Python<'py>, typecode: &str, values: &[f64]) -> Bound<'py, PyAny> {
+        let array = py.import_bound("array").unwrap().getattr("array").unwrap();
+        array.call1((typecode, values.to_vec())).unwrap()
+    }
+
+    fn memoryview<'py>(py: Python<'py>, obj: Bound<'py, PyAny>) -> Bound<'py, PyAny> {
+        py.import_bound("builtins").unwrap().getattr("memoryview").unwrap().call1((obj,)).unwrap()
+    }
+
+    #[test]
+    fn packed_float32_buffers_are_borrowed_in_place() {
+        pyo3::prepare_freethreaded_python();
+        Python::with_gil(|py| {
+            let flat = float_array(py, "f", &[0.0, 1.0, 2.0, 3.0, 4.0, 5.0]);
+            let points = line_points(&flat).unwrap();
+            assert!(matches!(points.storage, PointStorage::Borrowed(_)));
+            assert_eq!((points.count, points.stride), (3, 8));
+            assert_eq!(read(&points), [(0.0, 1.0), (2.0, 3.0), (4.0, 5.0)]);
+
+            // The same floats viewed as (N, 2) rows.
+            let bytes = memoryview(py, flat).call_method1("cast", ("B",)).unwrap();
+            let rows = bytes.call_method1("cast", ("f", (3, 2))).unwrap();
+            let points = line_points(&rows).unwrap();
+            assert!(matches!(points.storage, PointStorage::Borrowed(_)));
+            assert_eq!((points.count, points.stride), (3, 8));
+            assert_eq!(read(&points), [(0.0, 1.0), (2.0, 3.0), (4.0, 5.0)]);
+        });
+    }
+
+    #[test]
+    fn other_inputs_are_packed_into_owned_floats() {
+        pyo3::prepare_freethreaded_python();
+        Python::with_gil(|py| {
+            let doubles = float_array(py, "d", &[0.5, 1.5, 2.5, 3.5]);
+            let points = line_points(&doubles).unwrap();
+            assert!(matches!(points.storage, PointStorage::Owned(_)));
+            assert_eq!((points.count, points.stride), (2, 8));
+            assert_eq!(read(&points), [(0.5, 1.5), (2.5, 3.5)]);
+
+            // Every other float: x, y pairs no longer adjacent, so they are gathered.
+            let floats = float_array(py, "f", &[0.0, 9.0, 1.0, 9.0, 2.0, 9.0, 3.0, 9.0]);
+            let strided = memoryview(py, floats).get_item(PySlice::new_bound(py, 0, 8, 2)).unwrap();
+            let points = line_points(&strided).unwrap();
+            assert!(matches!(points.storage, PointStorage::Owned(_)));
+            assert_eq!(read(&points), [(0.0, 1.0), (2.0, 3.0)]);
+
+            let vecs = vec![data::Vec2 { x: 1.0, y: 2.0 }, data::Vec2 { x: 3.0, y: 4.0 }].into_py(py);
+            let points = line_points(vecs.bind(py)).unwrap();
+            assert!(matches!(points.storage, PointStorage::Owned(_)));
+            assert_eq!(read(&points), [(1.0, 2.0), (3.0, 4.0)]);
+        });
+    }
+
+    #[test]
+    fn odd_length_buffers_are_rejected() {
+        pyo3::prepare_freethreaded_python();
+        Python::with_gil(|py| {
+            assert!(line_points(&float_array(py, "f", &[0.0, 1.0, 2.0])).is_err());
+            assert!(line_points(&float_array(py, "d", &[0.0, 1.0, 2.0])).is_err());
+        });
+    }
+}
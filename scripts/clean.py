@@ -13,6 +13,7 @@ def main():
     # List of top-level directories to remove completely
     dirs_to_remove = [
         project_root / "build",
+        project_root / "build-bench",
         project_root / "target",
         project_root / "logic" / "target",
     ]
@@ -0,0 +1,210 @@
+# scripts/run_benchmarks.py
+
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+import time
+from datetime import datetime, timezone
+from pathlib import Path
+
+# The suites need no display: offscreen canvases go through EGL, and Mesa's llvmpipe keeps
+# the numbers comparable between machines with and without a GPU.
+HEADLESS_ENV = {
+    "LIBGL_ALWAYS_SOFTWARE": "1",
+    "GALLIUM_DRIVER": "llvmpipe",
+}
+
+
+def build_bench(project_root, build_dir):
+    """
+    Configures a Release build with SPIRO_BUILD_BENCHMARKS=ON and builds the spiro-bench target.
+    """
+    configure_cmd = [
+        "cmake",
+        "-S", str(project_root),
+        "-B", str(build_dir),
+        "-DCMAKE_BUILD_TYPE=Release",
+        "-DSPIRO_BUILD_BENCHMARKS=ON",
+    ]
+    if sys.platform == "win32":
+        configure_cmd.extend(["-G", "Ninja"])
+    build_cmd = ["cmake", "--build", str(build_dir), "--config", "Release", "--target", "spiro-bench"]
+
+    print("\n[--- Configuring spiro-bench ---]")
+    subprocess.run(configure_cmd, check=True)
+    print("\n[--- Building spiro-bench ---]")
+    subprocess.run(build_cmd, check=True)
+
+
+def find_bench(build_dir):
+    for candidate in (build_dir / "core" / "bench" / "spiro-bench",
+                      build_dir / "core" / "bench" / "Release" / "spiro-bench.exe",
+                      build_dir / "core" / "bench" / "spiro-bench.exe"):
+        if candidate.exists():
+            return candidate
+    return None
+
+
+def run_core(bench, out_path, bench_filter):
+    """
+    Runs spiro-bench and returns its Google Benchmark JSON report.
+    """
+    cmd = [str(bench), f"--benchmark_out={out_path}", "--benchmark_out_format=json"]
+    if bench_filter:
+        cmd.append(f"--benchmark_filter={bench_filter}")
+    print(f"\n[--- Running: {' '.join(cmd)} ---]")
+    subprocess.run(cmd, check=True)
+    with open(out_path) as f:
+        return json.load(f)
+
+
+def time_call(name, fn, min_time=0.5, items=None):
+    """
+    Calls fn until at least min_time seconds have passed and reports the mean per call in the
+    same shape as a Google Benchmark entry, so both suites compare with the same code.
+    """
+    fn()
+    iterations, start = 0, time.perf_counter()
+    while True:
+        fn()
+        iterations += 1
+        elapsed = time.perf_counter() - start
+        if elapsed >= min_time:
+            break
+    entry = {
+        "name": name,
+        "run_type": "iteration",
+        "iterations": iterations,
+        "real_time": elapsed / iterations * 1e3,
+        "cpu_time": elapsed / iterations * 1e3,
+        "time_unit": "ms",
+    }
+    if items:
+        entry["items_per_second"] = items * iterations / elapsed
+    print(f"{name:<40} {entry['real_time']:10.3f} ms {iterations:8d}")
+    return entry
+
+
+def run_python(bench_filter):
+    """
+    Times the Python bridge: packing samples, converting a Figure into the Rust model (the
+    work Figure.show() does before it hands over to the render loop), and savefig end to end.
+    """
+    try:
+        import numpy as np
+        import spirographicals as sg
+        from spirographicals.objects import _pack_points
+    except ImportError as e:
+        print(f"[WARN] Python benchmarks skipped: {e}", file=sys.stderr)
+        return []
+
+    theta = np.linspace(0.0, 20.0 * np.pi, 1_000_000)
+    x = 3.0 * np.cos(theta) + 7.0 * np.cos(7.0 / 3.0 * theta)
+    y = 3.0 * np.sin(theta) - 7.0 * np.sin(7.0 / 3.0 * theta)
+
+    def figure(lines, samples):
+        fig = sg.Figure(figsize=(8.0, 6.0), dpi=100.0)
+        ax = fig.add_subplot()
+        for i in range(lines):
+            ax.plot(x[:samples], y[:samples] + i, linewidth=1.0)
+        ax.set_title("spiro-bench")
+        return fig
+
+    wide = figure(1, len(x))
+    many = figure(1000, 1000)
+    cases = [
+        ("BM_PyPackPoints/numpy/1000000", lambda: _pack_points(x, y), len(x)),
+        ("BM_PyPackPoints/list/100000", lambda: _pack_points(x[:100000].tolist(), y[:100000].tolist()), 100000),
+        ("BM_PyFigureConvert/lines:1/samples:1000000", lambda: wide._to_rust_figure(), 1),
+        ("BM_PyFigureConvert/lines:1000/samples:1000", lambda: many._to_rust_figure(), 1000),
+    ]
+    with tempfile.TemporaryDirectory() as tmp:
+        png = os.path.join(tmp, "bench.png")
+        cases.append(("BM_PySavefig/lines:1/samples:1000000", lambda: wide.savefig(png), 1))
+
+        print("\n[--- Running Python bridge benchmarks ---]")
+        return [time_call(name, fn, items=items) for name, fn, items in cases
+                if not bench_filter or re.search(bench_filter, name)]
+
+
+def compare(report, baseline_path, threshold):
+    """
+    Prints the change in real time against an earlier report and returns the names of the
+    benchmarks that got slower by more than threshold.
+    """
+    with open(baseline_path) as f:
+        baseline = {b["name"]: b for b in json.load(f)["benchmarks"] if b.get("run_type", "iteration") == "iteration"}
+    print(f"\n[--- Comparing against {baseline_path} ---]")
+    regressions = []
+    for b in report["benchmarks"]:
+        if b.get("run_type", "iteration") != "iteration" or b["name"] not in baseline:
+            continue
+        old = baseline[b["name"]]
+        if old.get("time_unit") != b.get("time_unit") or not old["real_time"]:
+            continue
+        change = b["real_time"] / old["real_time"] - 1.0
+        flag = "  REGRESSION" if change > threshold else ""
+        print(f"{b['name']:<52} {old['real_time']:10.3f} -> {b['real_time']:10.3f} {b['time_unit']} ({change:+.1%}){flag}")
+        if change > threshold:
+            regressions.append(b["name"])
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs the spiro-bench suite and the Python bridge benchmarks.")
+    parser.add_argument("--out", default="target/bench/spiro-bench.json", help="where to write the combined JSON report")
+    parser.add_argument("--filter", default="", help="only run benchmarks whose names match this regex")
+    parser.add_argument("--baseline", help="an earlier report to compare against")
+    parser.add_argument("--threshold", type=float, default=0.10, help="slowdown that counts as a regression (default 0.10)")
+    parser.add_argument("--skip-build", action="store_true", help="use the spiro-bench already in the build directory")
+    parser.add_argument("--skip-python", action="store_true", help="only run the C++ suite")
+    args = parser.parse_args()
+
+    project_root = Path(__file__).parent.parent.resolve()
+    build_dir = project_root / "build-bench"
+    out_path = (project_root / args.out).resolve()
+    os.makedirs(out_path.parent, exist_ok=True)
+    # Set in this process too: the Python benchmarks render through the same core.
+    for key, value in HEADLESS_ENV.items():
+        os.environ.setdefault(key, value)
+
+    try:
+        if not args.skip_build:
+            build_bench(project_root, build_dir)
+        bench = find_bench(build_dir)
+        if bench is None:
+            print(f"\n[!!!] spiro-bench not found under '{build_dir}'.", file=sys.stderr)
+            sys.exit(1)
+        report = run_core(bench, out_path.with_suffix(".core.json"), args.filter)
+    except subprocess.CalledProcessError as e:
+        print(f"\n[!!!] A benchmark step failed: {e}", file=sys.stderr)
+        sys.exit(1)
+    except FileNotFoundError:
+        print("\n[!!!] Error: 'cmake' not found. Is your C++ build environment configured correctly?", file=sys.stderr)
+        sys.exit(1)
+
+    if not args.skip_python:
+        report["benchmarks"].extend(run_python(args.filter))
+    report["context"]["spiro"] = {
+        "date": datetime.now(timezone.utc).isoformat(),
+        "python": platform.python_version(),
+        "commit": subprocess.run(["git", "rev-parse", "HEAD"], cwd=project_root, capture_output=True, text=True).stdout.strip(),
+    }
+    with open(out_path, "w") as f:
+        json.dump(report, f, indent=2)
+    print(f"\n[OK] Benchmark report written to {out_path}")
+
+    if args.baseline:
+        regressions = compare(report, args.baseline, args.threshold)
+        if regressions:
+            print(f"\n[!!!] {len(regressions)} benchmark(s) slower than the baseline by more than {args.threshold:.0%}.", file=sys.stderr)
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+# tests/python_tests/test_objects.py
+
+import array
+
+import pytest
+
+from spirographicals import Figure, objects
+
+
+def _line_points(ax):
+    return ax._plot_commands[-1]["points"]
+
+
+def _render(points, tmp_path, name):
+    """Draws one line through `points` into a raw RGBA file and returns its bytes."""
+    fig = Figure(figsize=(0.64, 0.32), dpi=100.0, facecolor="#000000")
+    ax = fig.add_subplot()
+    ax._plot_commands.append(
+        {"type": "line", "points": points, "color": "#FFFFFF", "linewidth": 1.0, "label": None}
+    )
+    path = tmp_path / f"{name}.raw"
+    fig.savefig(path)
+    return path.read_bytes()
+
+
+@pytest.fixture
+def without_numpy(monkeypatch):
+    monkeypatch.setattr(objects, "_np", None)
+
+
+def test_plot_rejects_mismatched_lengths():
+    ax = Figure().add_subplot()
+    with pytest.raises(ValueError, match="same length"):
+        ax.plot([0.0, 1.0, 2.0], [0.0, 1.0])
+
+
+def test_plot_rejects_mismatched_lengths_without_numpy(without_numpy):
+    ax = Figure().add_subplot()
+    with pytest.raises(ValueError, match="same length"):
+        ax.plot(array.array("f", [0.0, 1.0, 2.0]), array.array("f", [0.0, 1.0]))
+    with pytest.raises(ValueError, match="same length"):
+        ax.scatter([0.0], [0.0, 1.0])
+
+
+def test_numpy_input_is_packed_into_float32_rows():
+    np = pytest.importorskip("numpy")
+    x = np.linspace(0.0, 63.0, 64)
+    y = np.sin(x) * 10.0 + 16.0
+    ax = Figure().add_subplot()
+    ax.plot(x, y)
+    points = _line_points(ax)
+    assert points.dtype == np.float32
+    assert points.shape == (64, 2)
+    assert np.array_equal(points[:, 0], x.astype(np.float32))
+    assert np.array_equal(points[:, 1], y.astype(np.float32))
+
+
+def test_float_array_input_is_interleaved_without_numpy(without_numpy):
+    ax = Figure().add_subplot()
+    ax.plot(array.array("f", [0.0, 1.0, 2.0]), array.array("f", [3.0, 4.0, 5.0]))
+    points = _line_points(ax)
+    assert isinstance(points, array.array) and points.typecode == "f"
+    assert list(points) == [0.0, 3.0, 1.0, 4.0, 2.0, 5.0]
+
+
+def test_float32_float64_and_vec2_points_draw_the_same_line(tmp_path):
+    xy = [(4.0 * i, 16.0 + (i % 5) * 3.0) for i in range(17)]
+    flat32 = array.array("f", [v for p in xy for v in p])
+    flat64 = array.array("d", flat32)
+    vec2s = [objects._internal.Vec2(x, y) for x, y in xy]
+
+    borrowed = _render(flat32, tmp_path, "float32")
+    assert any(borrowed), "the line should cover some pixels"
+    assert _render(flat64, tmp_path, "float64") == borrowed
+    assert _render(vec2s, tmp_path, "vec2") == borrowed
+
+
+def test_numpy_rows_draw_like_a_float_array(tmp_path):
+    np = pytest.importorskip("numpy")
+    x = np.arange(17, dtype=np.float64) * 4.0
+    y = 16.0 + (np.arange(17) % 5) * 3.0
+    ax = Figure().add_subplot()
+    ax.plot(x, y)
+    rows = _line_points(ax)
+    flat = array.array("f", rows.ravel().tolist())
+    expected = _render(flat, tmp_path, "flat")
+    assert _render(rows, tmp_path, "rows") == expected
+    # Rows spaced apart are still read in place; a column-major copy is gathered instead.
+    assert _render(np.repeat(rows, 2, axis=0)[::2], tmp_path, "spaced") == expected
+    assert _render(np.asfortranarray(rows), tmp_path, "columns") == expected
+
+
+def test_odd_length_flat_points_are_rejected(tmp_path):
+    with pytest.raises(ValueError, match="flat"):
+        _render(array.array("f", [0.0, 1.0, 2.0]), tmp_path, "odd")